@@ -4,15 +4,24 @@
 Common code for unit testing of rules generated with Snakemake 6.0.0.
 """
 
+import argparse
 import gzip
+import hashlib
 import os
 import re
+import shutil
+import stat
+import struct
 import subprocess as sp
-from pathlib import Path
+import sys
+import time
+import zipfile
+from pathlib import Path, PurePosixPath
 
 import magic
 import pandas as pd
 import pytest
+import yaml
 
 
 class OutputChecker:
@@ -24,6 +33,7 @@ class OutputChecker:
         comparators,
         extra_comparison_exclusions,
         workdir,
+        manifest=None,
     ):
         self.data_path = data_path
         self.expected_path = expected_path
@@ -31,6 +41,13 @@ class OutputChecker:
         self.comparators = comparators
         self.extra_comparison_exclusions = extra_comparison_exclusions
         self.workdir = workdir
+        self.manifest = manifest if manifest is not None else {}
+        self.exclude_regexes = [re.compile(pattern) for pattern in exclude_patterns]
+        self.comparator_regexes = [
+            (comparator, [re.compile(pattern) for pattern in comparator["patterns"]])
+            for comparator in (comparators if comparators is not None else [])
+        ]
+        self.magic = None
 
     def check(self):
         input_files = set(
@@ -44,27 +61,99 @@ class OutputChecker:
             for f in files
         )
         unexpected_files = set()
+        pairs = []
         for path, subdirs, files in os.walk(self.workdir):
             for f in files:
                 f = (Path(path) / f).relative_to(self.workdir)
                 if str(f).startswith(".snakemake"):
                     continue
-                if any(regex.search(str(f)) for regex in map(re.compile, self.exclude_patterns)):
+                if any(regex.search(str(f)) for regex in self.exclude_regexes):
                     continue
                 if any(m in str(f) for m in self.extra_comparison_exclusions):
                     continue
                 if f in expected_files:
-                    self.compare_files(self.workdir / f, self.expected_path / f)
+                    if self.matches_manifest(self.workdir / f, self.expected_path / f, f):
+                        continue
+                    pairs.append((self.workdir / f, self.expected_path / f))
                 elif f in input_files:
                     # ignore input files
                     continue
                 else:
                     unexpected_files.add(f)
+        self.compare_all(pairs)
         if unexpected_files:
             raise ValueError(
                 "Unexpected files: {}".format(";".join(sorted(map(str, unexpected_files))))
             )
 
+    def matches_manifest(self, generated_file, expected_file, relative_path):
+        """Check a generated file against the expected output manifest.
+
+        The manifest entry only stands in for the expected copy while that
+        copy has the recorded size and mtime; a copy that has been edited or
+        replaced since the manifest was written is compared in full. A file
+        with the recorded size and hash is then identical to the expected
+        copy, so the expected copy does not need to be read. Anything else
+        falls through to the configured comparators.
+        """
+        entry = self.manifest.get(PurePosixPath(relative_path).as_posix())
+        if entry is None:
+            return False
+        size, mtime, digest = entry
+        expected_stat = os.stat(expected_file)
+        if expected_stat.st_size != size or int(expected_stat.st_mtime) != mtime:
+            return False
+        if os.path.getsize(generated_file) != size:
+            return False
+        return hash_file(generated_file) == digest
+
+    def compare_all(self, pairs):
+        """Compare generated files with their expected copies.
+
+        When the snakemake_unit_tests binary is on the PATH, and compare_files
+        has not been overridden, the byte and plaintext comparisons are handed
+        to its `--compare` engine in a single call, which streams the files
+        and compares them in parallel. Everything else is compared here, as
+        are the handed-off comparisons if the binary cannot run them.
+        """
+        binary = native_comparison_binary()
+        if binary is None or type(self).compare_files is not _default_compare_files:
+            for generated_file, expected_file in pairs:
+                self.compare_files(generated_file, expected_file)
+            return
+        requests = []
+        for generated_file, expected_file in pairs:
+            for kind, args in self.comparison_modes(generated_file):
+                if kind in NATIVE_COMPARATORS and is_list_safe(generated_file, expected_file):
+                    requests.append((kind, args, generated_file, expected_file))
+                else:
+                    self.compare_with(kind, args, generated_file, expected_file)
+        if not requests:
+            return
+        result = sp.run(
+            [binary, "--compare", "-"],
+            input="".join(
+                "{}\t{}\t{}\n".format(kind, generated_file, expected_file)
+                for kind, args, generated_file, expected_file in requests
+            ),
+            capture_output=True,
+            text=True,
+        )
+        if result.returncode == 0:
+            return
+        if result.returncode == 1 and is_mismatch_report(
+            result.stdout, set(str(request[2]) for request in requests)
+        ):
+            raise AssertionError(
+                "generated output differs from expected output:\n{}{}".format(
+                    result.stdout, result.stderr
+                )
+            )
+        # anything else means the binary could not compare at all, for example
+        # an older installation without `--compare`; the comparisons run here instead
+        for kind, args, generated_file, expected_file in requests:
+            self.compare_with(kind, args, generated_file, expected_file)
+
     def compare_files(self, generated_file, expected_file):
         """Compare input files.
 
@@ -77,40 +166,127 @@ class OutputChecker:
         If the files are plain text, then strip comment lines and compare (to
         circumvent datestamps causing assert failures).
         """
-        f = magic.Magic(uncompress=True, mime=True)
-        found_handler = False
-        if self.comparators is not None:
-            for comparator in self.comparators:
-                if any(
-                    regex.search(str(generated_file))
-                    for regex in map(re.compile, comparator["patterns"])
-                ):
-                    found_handler = True
-                    if comparator["type"] == "byte":
-                        sp.check_output(["cmp", generated_file, expected_file])
-                    elif comparator["type"] == "frame":
-                        pandas_assert_frame_equal(
-                            generated_file,
-                            expected_file,
-                            comparator["args"] if "args" in comparator else {},
-                        )
-                    elif comparator["type"] == "plaintext":
-                        gen = process_file(generated_file)
-                        exp = process_file(expected_file)
-                        assert gen == exp
-                    else:
-                        raise LookupError(
-                            "comparator type {} is not defined in snakemake_unit_tests".format(
-                                comparator["type"]
-                            )
-                        )
-        if not found_handler:
-            if f.from_file(str(generated_file)) != "text/plain":
-                sp.check_output(["cmp", generated_file, expected_file])
+        for kind, args in self.comparison_modes(generated_file):
+            self.compare_with(kind, args, generated_file, expected_file)
+
+    def comparison_modes(self, generated_file):
+        """List the comparisons that apply to a generated file.
+
+        Returns (type, args) for each user comparator whose patterns match
+        the file, or else plaintext or byte depending on its mime type.
+        """
+        modes = [
+            (comparator["type"], comparator.get("args", {}))
+            for comparator, regexes in self.comparator_regexes
+            if any(regex.search(str(generated_file)) for regex in regexes)
+        ]
+        if not modes:
+            if self.magic is None:
+                self.magic = magic.Magic(uncompress=True, mime=True)
+            if self.magic.from_file(str(generated_file)) != "text/plain":
+                modes.append(("byte", {}))
             else:
-                gen = process_file(generated_file)
-                exp = process_file(expected_file)
-                assert gen == exp
+                modes.append(("plaintext", {}))
+        return modes
+
+    def compare_with(self, kind, args, generated_file, expected_file):
+        """Compare a generated file with its expected copy using one comparator type."""
+        if kind == "byte":
+            sp.check_output(["cmp", generated_file, expected_file])
+        elif kind == "frame":
+            pandas_assert_frame_equal(generated_file, expected_file, args)
+        elif kind == "plaintext":
+            gen = process_file(generated_file)
+            exp = process_file(expected_file)
+            assert gen == exp
+        else:
+            raise LookupError(
+                "comparator type {} is not defined in snakemake_unit_tests".format(kind)
+            )
+
+
+_default_compare_files = OutputChecker.compare_files
+
+# comparator types the snakemake_unit_tests binary can run itself
+NATIVE_COMPARATORS = ("byte", "plaintext")
+
+
+def native_comparison_binary():
+    """Find the snakemake_unit_tests binary, whose `--compare` engine runs comparisons."""
+    return shutil.which("snakemake_unit_tests.out")
+
+
+def is_mismatch_report(stdout, generated_files):
+    """Check that `--compare` output lists mismatches, one "file<TAB>reason" per line.
+
+    Only such a report means that files differ; any other output on failure
+    is an error from the binary itself.
+    """
+    lines = stdout.splitlines()
+    return bool(lines) and all(
+        "\t" in line and line.split("\t", 1)[0] in generated_files for line in lines
+    )
+
+
+def is_list_safe(*paths):
+    """Check that paths can be written to a tab-delimited `--compare` list."""
+    return not any(c in str(path) for path in paths for c in "\t\n\r")
+
+
+# first line of the manifests load_manifest understands, up to the column names
+MANIFEST_HEADER = "# snakemake_unit_tests manifest v2:"
+
+
+def hash_file(filename):
+    """Compute the BLAKE2b-256 digest used in expected output manifests."""
+    h = hashlib.blake2b(digest_size=32)
+    with open(filename, "rb") as f:
+        for chunk in iter(lambda: f.read(1 << 20), b""):
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def load_manifest(manifest_path):
+    """Read an expected output manifest written by snakemake_unit_tests.
+
+    Returns a dict mapping each path, relative to the expected directory,
+    to its (size, mtime, digest). A missing manifest yields an empty dict,
+    so tests emitted before manifests existed compare every file; so does
+    a manifest from before mtimes were recorded, as nothing in it can say
+    whether the expected copies have changed since.
+    """
+    manifest = {}
+    if not os.path.isfile(manifest_path):
+        return manifest
+    with open(manifest_path, "r") as f:
+        if not f.readline().startswith(MANIFEST_HEADER):
+            return manifest
+        for line in f:
+            line = line.rstrip("\n")
+            if not line or line.startswith("#"):
+                continue
+            digest, size, mtime, path = line.split("\t", 3)
+            manifest[path] = (int(size), int(mtime), digest)
+    return manifest
+
+
+def load_comparison_settings(config_path):
+    """Read the comparison settings of a unit test directory.
+
+    Returns the exclude patterns, the defaults followed by any from
+    `exclude-patterns`, and the user's comparators, from the `unit/config.yaml`
+    written by snakemake_unit_tests.
+    """
+    exclude_patterns = [
+        "\\.snakemake/",
+        "__pycache__",
+    ]
+    with open(config_path, "r") as f:
+        config = yaml.safe_load(f)
+    if config.get("exclude-patterns") is not None:
+        exclude_patterns.extend(config["exclude-patterns"])
+    comparators = config["comparators"] if "comparators" in config else {}
+    return exclude_patterns, comparators
 
 
 def pandas_assert_frame_equal(infile1, infile2, args):
@@ -146,3 +322,97 @@ def remove_headers(f, rmv):
     for line in (line for line in f if not line.startswith(rmv)):
         n.append(line)
     return n
+
+
+def archive_entry_mtime(info):
+    """Get the modification time of an archive entry.
+
+    Prefer the extended timestamp field written by snakemake_unit_tests,
+    as the standard zip timestamp is local time with two second resolution.
+    """
+    extra = info.extra
+    while len(extra) >= 4:
+        tag, size = struct.unpack("<HH", extra[:4])
+        if tag == 0x5455 and size >= 5 and extra[4] & 1:
+            return struct.unpack("<I", extra[5:9])[0]
+        extra = extra[4 + size :]
+    return time.mktime(info.date_time + (0, 0, -1))
+
+
+def extract_rule_archive(archive_path, rulename, target_dir):
+    """Expand one rule's trees from a unit test archive.
+
+    Only entries under `{rulename}/` are read, using the archive's index;
+    they are written to `target_dir` with the rule name stripped, so
+    `target_dir` receives `workspace/` and `expected/`. File modes and
+    modification times are restored.
+    """
+    prefix = "{}/".format(rulename)
+    directories = []
+    with zipfile.ZipFile(archive_path) as archive:
+        for info in archive.infolist():
+            if not info.filename.startswith(prefix):
+                continue
+            target = Path(target_dir) / info.filename[len(prefix) :]
+            mode = info.external_attr >> 16
+            mtime = archive_entry_mtime(info)
+            if info.is_dir():
+                target.mkdir(parents=True, exist_ok=True)
+                directories.append((target, mode, mtime))
+                continue
+            target.parent.mkdir(parents=True, exist_ok=True)
+            if stat.S_ISLNK(mode):
+                os.symlink(archive.read(info).decode(), target)
+                continue
+            with archive.open(info) as src, open(target, "wb") as dst:
+                shutil.copyfileobj(src, dst)
+            if mode:
+                os.chmod(target, stat.S_IMODE(mode))
+            os.utime(target, (mtime, mtime))
+    # apply directory metadata once their contents are in place, deepest first
+    for target, mode, mtime in reversed(directories):
+        if mode:
+            os.chmod(target, stat.S_IMODE(mode))
+        os.utime(target, (mtime, mtime))
+
+
+def main(argv=None):
+    """Compare one rule's test output against its expected output.
+
+    This is the comparison step of `snakemake_unit_tests --run-tests`, which
+    runs the rule itself. Returns 0 if the output matches, 1 otherwise.
+    """
+    parser = argparse.ArgumentParser(
+        description="compare a rule's test output to its expected output"
+    )
+    parser.add_argument("--config", required=True, help="unit/config.yaml of the test directory")
+    parser.add_argument("--workspace", required=True, help="workspace the rule ran from")
+    parser.add_argument("--expected", required=True, help="expected output of the rule")
+    parser.add_argument("--manifest", required=True, help="manifest of the expected output")
+    parser.add_argument("--workdir", required=True, help="directory in which the rule ran")
+    parser.add_argument(
+        "--extra-exclusion",
+        action="append",
+        default=[],
+        help="path fragment of output files not to compare; may be repeated",
+    )
+    args = parser.parse_args(argv)
+    exclude_patterns, comparators = load_comparison_settings(args.config)
+    try:
+        OutputChecker(
+            Path(args.workspace),
+            Path(args.expected),
+            exclude_patterns,
+            comparators,
+            args.extra_exclusion,
+            Path(args.workdir),
+            load_manifest(args.manifest),
+        ).check()
+    except Exception as e:
+        print("output comparison failed: {}: {}".format(type(e).__name__, e))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
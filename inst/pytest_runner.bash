@@ -7,13 +7,14 @@ else
 fi
 ## execute pytest for specified rules if provided
 for i in ${CANDIDATE_TARGETS}; do
-    if [[ ! -d "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/${i}" ]] ; then
+    ## tests emitted with --output-format archive have no rule directory until run
+    if [[ ! -d "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/${i}" && ! ( -f "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/unit_tests.zip" && -f "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/test_${i}.py" ) ]] ; then
         echo "rule ${i} does not seem to have a unit test installed under ${SNAKEMAKE_UNIT_TESTS_DIR}/unit"
 	continue
-    elif [[ -d "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/${i}/output" ]] ; then
+    elif [[ -d "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/.run/${i}/output" ]] ; then
 	echo "removing output from failed prior run for rule ${i}"
         ## remove any existing output directory from a previous failed run
-        rm -Rf "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/${i}/output"
+        rm -Rf "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/.run/${i}/output"
     fi
     ## add to global target list
     VALID_TARGETS="${SNAKEMAKE_UNIT_TESTS_DIR}/unit/test_${i}.py ${VALID_TARGETS}"
@@ -29,7 +30,7 @@ PYTEST_RESULTS=$(echo "${PYTEST_RESULTS}" | sed -E "s:^${SNAKEMAKE_UNIT_TESTS_DI
 ## only if a test succeeds, remove the output directory
 for pytest_file in $(echo ${PYTEST_RESULTS}) ; do
     if ! [[ -z "${pytest_file}" ]] ; then
-	echo "removing output directory for successful test: ${SNAKEMAKE_UNIT_TESTS_DIR}/unit/${pytest_file}/output"
-        rm -Rf "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/${pytest_file}/output"
+	echo "removing output directory for successful test: ${SNAKEMAKE_UNIT_TESTS_DIR}/unit/.run/${pytest_file}/output"
+        rm -Rf "${SNAKEMAKE_UNIT_TESTS_DIR}/unit/.run/${pytest_file}/output"
     fi
 done
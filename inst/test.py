@@ -5,42 +5,44 @@ import sys
 from pathlib import Path, PurePosixPath
 from tempfile import TemporaryDirectory
 
-import yaml
-
 sys.path.insert(0, os.path.dirname(__file__))
 
 import common
 
-exclude_patterns = [
-    "\\.snakemake/",
-    "__pycache__",
-]
-with open("{}/unit/config.yaml".format(testdir), "r") as f:
-    config = yaml.safe_load(f)
-if config["exclude-patterns"] is not None:
-    exclude_patterns.extend(config["exclude-patterns"])
-comparators = config["comparators"] if "comparators" in config else {}
+exclude_patterns, comparators = common.load_comparison_settings(
+    "{}/unit/config.yaml".format(testdir)
+)
 
 
 def test_function():
 
     with TemporaryDirectory() as tmpdir:
-        rundir = PurePosixPath("{}/unit/{}/output".format(testdir, rulename))
+        # The test runs outside unit/{rulename}, which regeneration swaps out.
+        rundir = PurePosixPath("{}/unit/.run/{}/output".format(testdir, rulename))
         workspace_path = PurePosixPath("{}/unit/{}/workspace".format(testdir, rulename))
         expected_path = PurePosixPath("{}/unit/{}/expected".format(testdir, rulename))
+        manifest_path = PurePosixPath("{}/unit/{}/expected.manifest".format(testdir, rulename))
+        archive_path = Path("{}/unit/unit_tests.zip".format(testdir))
+
+        # With --output-format archive, only expand the rule under test.
+        if not os.path.isdir(workspace_path) and archive_path.is_file():
+            common.extract_rule_archive(archive_path, rulename, tmpdir)
+            workspace_path = PurePosixPath(tmpdir) / "workspace"
+            expected_path = PurePosixPath(tmpdir) / "expected"
+            manifest_path = PurePosixPath(tmpdir) / "expected.manifest"
 
         # Copy data to the temporary workdir.
         shutil.copytree(workspace_path, rundir)
 
-        # Run the test job.
+        # Run the test job, with the threads it was scheduled with in the pipeline.
         sp.check_output(
             [
-                "python",
+                "python3",
                 "-m",
                 "snakemake",
                 "all",
                 "-f",
-                "-j1",
+                "-j{}".format(threads),
                 "--notemp",
                 "--keep-target-files",
                 "--use-conda",
@@ -55,7 +57,9 @@ def test_function():
             ]
         )
 
-        # Check the output using assorted comparators.
+        # Check the output using assorted comparators. Files that match the
+        # expected output manifest exactly are accepted without reading the
+        # expected copy.
         # To modify this behavior, you can inherit from common.OutputChecker in here
         # and overwrite the method `compare_files(generated_file, expected_file),
         # also see common.py.
@@ -67,4 +71,5 @@ def test_function():
             comparators,
             extra_comparison_exclusions,
             rundir,
+            common.load_manifest(manifest_path),
         ).check()
@@ -1,5 +1,8 @@
 #!/usr/bin/env python
 
+import os
+import stat
+import zipfile
 from unittest import mock
 
 import common
@@ -37,3 +40,218 @@ def test_remove_headers(test_in, test_param, exp_out):
 #         test_out = common.process_file("file.vcf", True)
 #     exp_out = ["#CHROM", "other stuff"]
 #     assert test_out == exp_out
+
+
+def test_extract_rule_archive(tmp_path):
+    archive_path = tmp_path / "unit_tests.zip"
+    with zipfile.ZipFile(archive_path, "w", zipfile.ZIP_DEFLATED) as archive:
+        directory = zipfile.ZipInfo("rule1/workspace/")
+        directory.external_attr = (stat.S_IFDIR | 0o755) << 16
+        archive.writestr(directory, "")
+        script = zipfile.ZipInfo("rule1/workspace/run.sh")
+        script.external_attr = (stat.S_IFREG | 0o750) << 16
+        archive.writestr(script, "echo hello\n")
+        archive.writestr("rule1/expected/output.tsv", "a\tb\n")
+        archive.writestr("rule10/workspace/other.tsv", "c\n")
+    common.extract_rule_archive(archive_path, "rule1", tmp_path / "extracted")
+    extracted = tmp_path / "extracted"
+    assert (extracted / "workspace" / "run.sh").read_text() == "echo hello\n"
+    assert stat.S_IMODE(os.stat(extracted / "workspace" / "run.sh").st_mode) == 0o750
+    assert (extracted / "expected" / "output.tsv").read_text() == "a\tb\n"
+    assert not (extracted / "workspace" / "other.tsv").exists()
+
+
+def test_load_manifest(tmp_path):
+    manifest_path = tmp_path / "expected.manifest"
+    manifest_path.write_text(
+        "# snakemake_unit_tests manifest v2: blake2b-256\tsize\tmtime\tpath\n"
+        "bddd813c634239723171ef3fee98579b94964e3bb1cb3e427262c8c068d52319"
+        "\t3\t1600000000\tresults/a b.tsv\n"
+    )
+    assert common.load_manifest(manifest_path) == {
+        "results/a b.tsv": (
+            3,
+            1600000000,
+            "bddd813c634239723171ef3fee98579b94964e3bb1cb3e427262c8c068d52319",
+        )
+    }
+    assert common.load_manifest(tmp_path / "missing.manifest") == {}
+    # without mtimes, entries cannot vouch for the expected copies
+    manifest_path.write_text(
+        "# snakemake_unit_tests manifest v1: blake2b-256\tsize\tpath\n"
+        "bddd813c634239723171ef3fee98579b94964e3bb1cb3e427262c8c068d52319\t3\tresults/a b.tsv\n"
+    )
+    assert common.load_manifest(manifest_path) == {}
+
+
+def test_output_checker_manifest(tmp_path):
+    workdir = tmp_path / "output"
+    (workdir / "results").mkdir(parents=True)
+    (workdir / "results" / "match.tsv").write_text("abc")
+    (workdir / "results" / "differ.tsv").write_text("abd")
+    expected = tmp_path / "expected"
+    (expected / "results").mkdir(parents=True)
+    (expected / "results" / "match.tsv").write_text("abc")
+    (expected / "results" / "differ.tsv").write_text("abc")
+    digest = common.hash_file(expected / "results" / "match.tsv")
+    assert digest == "bddd813c634239723171ef3fee98579b94964e3bb1cb3e427262c8c068d52319"
+    for name in ("match.tsv", "differ.tsv"):
+        os.utime(expected / "results" / name, (1600000000, 1600000000))
+    manifest = {
+        "results/match.tsv": (3, 1600000000, digest),
+        "results/differ.tsv": (3, 1600000000, digest),
+    }
+    checker = common.OutputChecker(tmp_path / "input", expected, [], None, [], workdir, manifest)
+    compared = []
+    with mock.patch.object(
+        common.OutputChecker, "compare_files", lambda self, gen, exp: compared.append(gen)
+    ):
+        checker.check()
+    # only the file whose hash differs from the manifest needs a full comparison
+    assert compared == [workdir / "results" / "differ.tsv"]
+    # an expected copy changed after the manifest was written is not vouched for,
+    # even when the generated file matches the recorded hash
+    (expected / "results" / "match.tsv").write_text("abd")
+    compared = []
+    with mock.patch.object(
+        common.OutputChecker, "compare_files", lambda self, gen, exp: compared.append(gen)
+    ):
+        checker.check()
+    assert sorted(compared) == [
+        workdir / "results" / "differ.tsv",
+        workdir / "results" / "match.tsv",
+    ]
+
+
+def test_output_checker_native_comparison(tmp_path):
+    workdir = tmp_path / "output"
+    workdir.mkdir()
+    (workdir / "result.tsv").write_text("abc")
+    (workdir / "table.tsv").write_text("a\tb\n")
+    expected = tmp_path / "expected"
+    expected.mkdir()
+    (expected / "result.tsv").write_text("abc")
+    (expected / "table.tsv").write_text("a\tb\n")
+    comparators = [
+        {"type": "byte", "patterns": ["result"]},
+        {"type": "frame", "patterns": ["table"], "args": {"sep": "\t"}},
+    ]
+    checker = common.OutputChecker(tmp_path / "input", expected, [], comparators, [], workdir)
+    framed = []
+    completed = mock.Mock(returncode=0, stdout="", stderr="")
+    with mock.patch.object(
+        common, "native_comparison_binary", return_value="snakemake_unit_tests.out"
+    ), mock.patch.object(common.sp, "run", return_value=completed) as run, mock.patch.object(
+        common, "pandas_assert_frame_equal", lambda gen, exp, args: framed.append(gen)
+    ):
+        checker.check()
+        # byte comparisons go to the native engine in one call; frame comparisons stay here
+        run.assert_called_once()
+        assert run.call_args[0][0] == ["snakemake_unit_tests.out", "--compare", "-"]
+        assert run.call_args[1]["input"] == "byte\t{}\t{}\n".format(
+            workdir / "result.tsv", expected / "result.tsv"
+        )
+        assert framed == [workdir / "table.tsv"]
+        completed.returncode = 1
+        completed.stdout = "{}\tdiffers from expected at byte 3\n".format(workdir / "result.tsv")
+        with pytest.raises(AssertionError, match="differs from expected at byte 3"):
+            checker.check()
+
+
+def test_output_checker_native_comparison_fallback(tmp_path):
+    workdir = tmp_path / "output"
+    workdir.mkdir()
+    (workdir / "result.tsv").write_text("abc")
+    expected = tmp_path / "expected"
+    expected.mkdir()
+    (expected / "result.tsv").write_text("abc")
+    comparators = [{"type": "plaintext", "patterns": ["result"]}]
+
+    class CustomChecker(common.OutputChecker):
+        def compare_files(self, generated_file, expected_file):
+            compared.append(generated_file)
+
+    compared = []
+    with mock.patch.object(
+        common, "native_comparison_binary", return_value="snakemake_unit_tests.out"
+    ), mock.patch.object(common.sp, "run") as run:
+        # an overridden compare_files is always honored
+        CustomChecker(tmp_path / "input", expected, [], comparators, [], workdir).check()
+        assert compared == [workdir / "result.tsv"]
+        run.assert_not_called()
+    with mock.patch.object(common, "native_comparison_binary", return_value=None):
+        # without the binary, comparisons run in python
+        common.OutputChecker(tmp_path / "input", expected, [], comparators, [], workdir).check()
+        (workdir / "result.tsv").write_text("abd")
+        with pytest.raises(AssertionError):
+            common.OutputChecker(tmp_path / "input", expected, [], comparators, [], workdir).check()
+
+
+def test_output_checker_native_comparison_unsupported(tmp_path):
+    workdir = tmp_path / "output"
+    workdir.mkdir()
+    (workdir / "result.tsv").write_text("abc")
+    expected = tmp_path / "expected"
+    expected.mkdir()
+    (expected / "result.tsv").write_text("abc")
+    comparators = [{"type": "byte", "patterns": ["result"]}]
+    checker = common.OutputChecker(tmp_path / "input", expected, [], comparators, [], workdir)
+    # an older binary rejects the flag instead of reporting mismatches
+    rejected = mock.Mock(returncode=1, stdout="", stderr="unrecognised option '--compare'\n")
+    with mock.patch.object(
+        common, "native_comparison_binary", return_value="snakemake_unit_tests.out"
+    ), mock.patch.object(common.sp, "run", return_value=rejected), mock.patch.object(
+        common.sp, "check_output"
+    ) as cmp:
+        checker.check()
+        cmp.assert_called_once_with(["cmp", workdir / "result.tsv", expected / "result.tsv"])
+        # as does a crash, whatever it prints
+        rejected.returncode = -6
+        rejected.stdout = "{}\tdiffers from expected at byte 3\n".format(workdir / "result.tsv")
+        checker.check()
+        assert cmp.call_count == 2
+
+
+def test_load_comparison_settings(tmp_path):
+    config_path = tmp_path / "config.yaml"
+    config_path.write_text(
+        "exclude-patterns:\n  - '\\.log$'\ncomparators:\n  - type: byte\n    patterns: ['\\.bam$']\n"
+    )
+    exclude_patterns, comparators = common.load_comparison_settings(config_path)
+    assert exclude_patterns == ["\\.snakemake/", "__pycache__", "\\.log$"]
+    assert comparators == [{"type": "byte", "patterns": ["\\.bam$"]}]
+    config_path.write_text("exclude-patterns:\n")
+    assert common.load_comparison_settings(config_path) == (["\\.snakemake/", "__pycache__"], {})
+
+
+def test_main(tmp_path, capsys):
+    (tmp_path / "config.yaml").write_text("exclude-patterns:\n  - '\\.log$'\n")
+    (tmp_path / "workspace").mkdir()
+    (tmp_path / "expected").mkdir()
+    (tmp_path / "expected" / "result.tsv").write_text("abc")
+    (tmp_path / "output").mkdir()
+    (tmp_path / "output" / "result.tsv").write_text("abc")
+    (tmp_path / "output" / "run.log").write_text("ignored")
+    digest = common.hash_file(tmp_path / "expected" / "result.tsv")
+    os.utime(tmp_path / "expected" / "result.tsv", (1600000000, 1600000000))
+    (tmp_path / "expected.manifest").write_text(
+        "{}\n{}\t3\t1600000000\tresult.tsv\n".format(common.MANIFEST_HEADER, digest)
+    )
+    args = [
+        "--config",
+        str(tmp_path / "config.yaml"),
+        "--workspace",
+        str(tmp_path / "workspace"),
+        "--expected",
+        str(tmp_path / "expected"),
+        "--manifest",
+        str(tmp_path / "expected.manifest"),
+        "--workdir",
+        str(tmp_path / "output"),
+    ]
+    assert common.main(args) == 0
+    # a file that is neither expected, input, nor excluded fails the comparison
+    (tmp_path / "output" / "stray.tsv").write_text("x")
+    assert common.main(args) == 1
+    assert "Unexpected files: stray.tsv" in capsys.readouterr().out
+    assert common.main(args + ["--extra-exclusion", "stray"]) == 0
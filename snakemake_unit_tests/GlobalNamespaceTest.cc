@@ -13,10 +13,20 @@ void snakemake_unit_tests::GlobalNamespaceTest::setUp() {
   _test_vec.push_back("a");
   _test_vec.push_back("a");
   _test_vec.push_back("b");
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutGNSXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("GlobalNamespaceTest mkdtemp failed");
+  }
 }
 
 void snakemake_unit_tests::GlobalNamespaceTest::tearDown() {
-  // nothing to do at the moment
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
 }
 
 void snakemake_unit_tests::GlobalNamespaceTest::test_vector_to_map() {
@@ -674,6 +684,105 @@ void snakemake_unit_tests::GlobalNamespaceTest::test_lexical_parse() {
   }
 }
 
+void snakemake_unit_tests::GlobalNamespaceTest::test_lexical_parse_buffer() {
+  std::vector<std::string> lines, output;
+  lines.push_back("   standard lines are preserved  ");
+  lines.push_back("   comments are pruned # like me");
+  lines.push_back("   trailing slashes merge lines \\");
+  lines.push_back(" with their following line");
+  lines.push_back("example: \"comment characters within quotes like # are preserved\"");
+  lines.push_back("example: 'escaped \\' ticks and \\\\' # even escapes");
+  lines.push_back("example: \"\"\" literals crossing lines are ");
+  lines.push_back("  \\");
+  lines.push_back("       merged together sensibly \"\"\"");
+  lines.push_back("\t");
+  lines.push_back("example: ''' mixed \"\"\" literal ''' \"open string");
+  lines.push_back("continues\"  ");
+  lines.push_back("a long line to exercise the vectorized scan, with no marks until here # at the very end");
+  lines.push_back("windows line endings are preserved\r");
+  std::string buffer = "";
+  for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter) {
+    buffer += *iter + "\n";
+  }
+  // the result matches the line-based parser, with or without a final newline
+  std::vector<std::string> expected = lexical_parse(lines);
+  output = lexical_parse(buffer.data(), buffer.size());
+  CPPUNIT_ASSERT(output == expected);
+  output = lexical_parse(buffer.data(), buffer.size() - 1);
+  CPPUNIT_ASSERT(output == expected);
+  CPPUNIT_ASSERT(!output.at(0).compare("   standard lines are preserved"));
+  CPPUNIT_ASSERT(!output.at(2).compare("   trailing slashes merge lines  with their following line"));
+  // lines left inside a string at end of file are flushed
+  buffer = "x = \"\"\" unterminated\nliteral  \n";
+  expected.clear();
+  expected.push_back("x = \"\"\" unterminated\nliteral  \n");
+  CPPUNIT_ASSERT(lexical_parse(buffer.data(), buffer.size()) == expected);
+  CPPUNIT_ASSERT(lexical_parse(buffer.data(), 0).empty());
+  CPPUNIT_ASSERT(lexical_parse(NULL, 0).empty());
+  CPPUNIT_ASSERT_THROW(lexical_parse(NULL, 1), std::runtime_error);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_lexical_parse_arena() {
+  std::string buffer =
+      "rule a:  # comment\n"
+      "    shell: 'one' \\\n"
+      "        'two'\n"
+      "x = \"\"\" literal\n"
+      "continues \"\"\"\n"
+      "x = ''' unterminated  ";
+  std::vector<std::string> expected = lexical_parse(buffer.data(), buffer.size());
+  string_arena arena;
+  std::vector<std::string_view> output = lexical_parse(buffer.data(), buffer.size(), &arena);
+  CPPUNIT_ASSERT(output.size() == expected.size());
+  for (unsigned i = 0; i < output.size(); ++i) {
+    CPPUNIT_ASSERT(!output.at(i).compare(expected.at(i)));
+  }
+  // lines from a single physical line are views into the buffer
+  CPPUNIT_ASSERT(output.at(0).data() == buffer.data());
+  // as are strings continued across lines, which are verbatim
+  CPPUNIT_ASSERT(output.at(2).data() == buffer.data() + buffer.find("x = "));
+  // extended lines, and the remainder lacking its final newline, are held by the arena
+  CPPUNIT_ASSERT(output.at(1).data() < buffer.data() || output.at(1).data() >= buffer.data() + buffer.size());
+  CPPUNIT_ASSERT(output.at(3).data() < buffer.data() || output.at(3).data() >= buffer.data() + buffer.size());
+  CPPUNIT_ASSERT(arena.allocation_count() == 1U);
+  CPPUNIT_ASSERT(lexical_parse(NULL, 0, &arena).empty());
+  CPPUNIT_ASSERT_THROW(lexical_parse(buffer.data(), buffer.size(), static_cast<string_arena *>(NULL)),
+                       std::runtime_error);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_lexical_parse_buffer_examples() {
+  // every file in the example corpus must lex identically with both parsers.
+  // the corpus is found relative to the source tree, where the test suite is run.
+  boost::filesystem::path corpus = "tests/examples";
+  if (!boost::filesystem::is_directory(corpus)) return;
+  unsigned n_compared = 0;
+  boost::filesystem::recursive_directory_iterator rec_iter(corpus), rec_end;
+  for (; rec_iter != rec_end; ++rec_iter) {
+    if (!boost::filesystem::is_regular_file(rec_iter->status())) continue;
+    std::ifstream input(rec_iter->path().string().c_str(), std::ios_base::in | std::ios_base::binary);
+    std::ostringstream contents;
+    contents << input.rdbuf();
+    input.close();
+    std::string buffer = contents.str();
+    std::vector<std::string> lines;
+    std::istringstream line_stream(buffer);
+    std::string line = "";
+    while (line_stream.peek() != EOF) {
+      getline(line_stream, line);
+      lines.push_back(line);
+    }
+    std::vector<std::string> expected = lexical_parse(lines);
+    CPPUNIT_ASSERT_MESSAGE("lexical_parse buffer mismatch: " + rec_iter->path().string(),
+                           lexical_parse(buffer.data(), buffer.size()) == expected);
+    string_arena arena;
+    std::vector<std::string_view> viewed = lexical_parse(buffer.data(), buffer.size(), &arena);
+    CPPUNIT_ASSERT_MESSAGE("lexical_parse arena mismatch: " + rec_iter->path().string(),
+                           std::vector<std::string>(viewed.begin(), viewed.end()) == expected);
+    ++n_compared;
+  }
+  CPPUNIT_ASSERT(n_compared > 0);
+}
+
 void snakemake_unit_tests::GlobalNamespaceTest::test_exec() {
   std::vector<std::string> result = exec("python3 --version", true);
   CPPUNIT_ASSERT(result.size() == 1);
@@ -687,4 +796,151 @@ void snakemake_unit_tests::GlobalNamespaceTest::test_exec_fail_on_error() {
   std::vector<std::string> result = exec("python33333333___43324 2> /dev/null", true, false);
 }
 
+void snakemake_unit_tests::GlobalNamespaceTest::test_exec_streaming() {
+  // lines arrive whole, a final line without newline included; overlong lines arrive in pieces
+  std::vector<std::string> lines;
+  std::function<bool(const std::string &)> collect = [&lines](const std::string &line) {
+    lines.push_back(line);
+    return true;
+  };
+  CPPUNIT_ASSERT(exec_streaming("printf 'first\\nsecond'", collect, true));
+  CPPUNIT_ASSERT(lines.size() == 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("first\n"), lines.at(0));
+  CPPUNIT_ASSERT_EQUAL(std::string("second"), lines.at(1));
+  lines.clear();
+  CPPUNIT_ASSERT(exec_streaming("head -c 100000 /dev/zero | tr '\\0' x", collect, true));
+  CPPUNIT_ASSERT(lines.size() == 2);
+  CPPUNIT_ASSERT_EQUAL(65536ul, lines.at(0).size());
+  CPPUNIT_ASSERT_EQUAL(100000ul - 65536ul, lines.at(1).size());
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_exec_streaming_early_stop() {
+  // a command that never finishes on its own is stopped, along with what its shell started
+  unsigned n_lines = 0;
+  CPPUNIT_ASSERT(!exec_streaming(
+      "yes | cat",
+      [&n_lines](const std::string &line) {
+        CPPUNIT_ASSERT_EQUAL(std::string("y\n"), line);
+        return ++n_lines < 1000;
+      },
+      true));
+  CPPUNIT_ASSERT_EQUAL(1000u, n_lines);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_exec_streaming_fail_on_error() {
+  exec_streaming("echo partial; exit 3", [](const std::string &) { return true; }, true, false);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_exec_streaming_exit_status() {
+  // without fail_on_error, the caller can inspect the exit status instead
+  int exit_status = -2;
+  std::function<bool(const std::string &)> ignore = [](const std::string &) { return true; };
+  CPPUNIT_ASSERT(exec_streaming("echo partial; exit 3", ignore, false, false, &exit_status));
+  CPPUNIT_ASSERT_EQUAL(3, exit_status);
+  CPPUNIT_ASSERT(exec_streaming("true", ignore, false, false, &exit_status));
+  CPPUNIT_ASSERT_EQUAL(0, exit_status);
+  CPPUNIT_ASSERT(exec_streaming("kill -9 $$", ignore, false, false, &exit_status));
+  CPPUNIT_ASSERT_EQUAL(-1, exit_status);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_json_escape() {
+  CPPUNIT_ASSERT(!json_escape("").compare("\"\""));
+  CPPUNIT_ASSERT(!json_escape("rule_a").compare("\"rule_a\""));
+  CPPUNIT_ASSERT(!json_escape("a \"quoted\" \\ path").compare("\"a \\\"quoted\\\" \\\\ path\""));
+  CPPUNIT_ASSERT(!json_escape("two\nlines\t").compare("\"two\\nlines\\t\""));
+  CPPUNIT_ASSERT(!json_escape(std::string(1, '\x01')).compare("\"\\u0001\""));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_shell_quote() {
+  CPPUNIT_ASSERT_EQUAL(std::string("''"), shell_quote(""));
+  CPPUNIT_ASSERT_EQUAL(std::string("'a b;$x'"), shell_quote("a b;$x"));
+  CPPUNIT_ASSERT_EQUAL(std::string("'it'\\''s'"), shell_quote("it's"));
+  // the shell reads the quoted word back unchanged
+  std::string raw = "two words 'quoted' \"and\" $HOME `cmd` \\";
+  std::string echoed;
+  exec_streaming("printf '%s' " + shell_quote(raw),
+                 [&echoed](const std::string &line) {
+                   echoed += line;
+                   return true;
+                 },
+                 true);
+  CPPUNIT_ASSERT_EQUAL(raw, echoed);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_exchange_paths() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path staged = tmp_parent / "staged", target = tmp_parent / "target";
+  boost::filesystem::create_directories(staged / "new_dir");
+  boost::filesystem::create_directories(target / "old_dir");
+  // directories are swapped as a whole
+  exchange_paths(staged, target);
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(target / "new_dir"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(target / "old_dir"));
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(staged / "old_dir"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(staged / "new_dir"));
+  // and a missing target simply receives the staged content
+  boost::filesystem::path fresh = tmp_parent / "fresh";
+  exchange_paths(staged, fresh);
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(fresh / "old_dir"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(staged));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_exchange_paths_missing_source() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::create_directories(tmp_parent / "target");
+  exchange_paths(tmp_parent / "staged", tmp_parent / "target");
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_write_slices() {
+  boost::filesystem::path target = boost::filesystem::path(std::string(_tmp_dir)) / "sliced.txt";
+  // more slices than one writev call accepts, with empty slices mixed in
+  std::string expected;
+  std::vector<std::string_view> slices;
+  const std::string pieces[] = {"rule a:\n", "", "    pass\n\n\n"};
+  for (unsigned i = 0; i < 3000; ++i) {
+    slices.push_back(pieces[i % 3]);
+    expected += pieces[i % 3];
+  }
+  write_slices(target, slices);
+  std::ifstream input(target.string().c_str(), std::ios_base::in | std::ios_base::binary);
+  std::ostringstream observed;
+  observed << input.rdbuf();
+  input.close();
+  CPPUNIT_ASSERT(!observed.str().compare(expected));
+  // an existing file is truncated
+  slices.clear();
+  slices.push_back("x");
+  write_slices(target, slices);
+  CPPUNIT_ASSERT(boost::filesystem::file_size(target) == 1);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_write_slices_bad_path() {
+  std::vector<std::string_view> slices;
+  write_slices(boost::filesystem::path(std::string(_tmp_dir)) / "missing" / "sliced.txt", slices);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_cache_strings() {
+  std::ostringstream o;
+  write_cache_string(o, "two\nlines");
+  write_cache_string(o, "");
+  o << "42 ";
+  std::string record = o.str();
+  CPPUNIT_ASSERT_EQUAL(std::string("9\ntwo\nlines\n0\n\n42 "), record);
+  std::string_view remaining = record;
+  CPPUNIT_ASSERT(!read_cache_string(&remaining).compare("two\nlines"));
+  CPPUNIT_ASSERT(read_cache_string(&remaining).empty());
+  CPPUNIT_ASSERT(read_cache_number(&remaining, ' ') == 42);
+  CPPUNIT_ASSERT(remaining.empty());
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_read_cache_number_malformed() {
+  std::string_view record = "12x";
+  read_cache_number(&record, ' ');
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_read_cache_string_truncated() {
+  std::string_view record = "10\nshort\n";
+  read_cache_string(&record);
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::GlobalNamespaceTest);
@@ -12,7 +12,13 @@
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
 
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <map>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -66,8 +72,24 @@ class GlobalNamespaceTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_EXCEPTION(test_resolve_string_delimiter_index_oob, std::runtime_error);
   CPPUNIT_TEST_EXCEPTION(test_resolve_string_delimiter_index_not_mark, std::runtime_error);
   CPPUNIT_TEST(test_lexical_parse);
+  CPPUNIT_TEST(test_lexical_parse_buffer);
+  CPPUNIT_TEST(test_lexical_parse_arena);
+  CPPUNIT_TEST(test_lexical_parse_buffer_examples);
   CPPUNIT_TEST(test_exec);
   CPPUNIT_TEST_EXCEPTION(test_exec_fail_on_error, std::runtime_error);
+  CPPUNIT_TEST(test_exec_streaming);
+  CPPUNIT_TEST(test_exec_streaming_early_stop);
+  CPPUNIT_TEST_EXCEPTION(test_exec_streaming_fail_on_error, std::runtime_error);
+  CPPUNIT_TEST(test_exec_streaming_exit_status);
+  CPPUNIT_TEST(test_json_escape);
+  CPPUNIT_TEST(test_shell_quote);
+  CPPUNIT_TEST(test_exchange_paths);
+  CPPUNIT_TEST_EXCEPTION(test_exchange_paths_missing_source, std::runtime_error);
+  CPPUNIT_TEST(test_write_slices);
+  CPPUNIT_TEST(test_cache_strings);
+  CPPUNIT_TEST_EXCEPTION(test_read_cache_number_malformed, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_read_cache_string_truncated, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_write_slices_bad_path, std::runtime_error);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -118,12 +140,29 @@ class GlobalNamespaceTest : public CppUnit::TestFixture {
   void test_resolve_string_delimiter_index_oob();
   void test_resolve_string_delimiter_index_not_mark();
   void test_lexical_parse();
+  void test_lexical_parse_buffer();
+  void test_lexical_parse_arena();
+  void test_lexical_parse_buffer_examples();
   void test_exec();
   void test_exec_fail_on_error();
+  void test_exec_streaming();
+  void test_exec_streaming_early_stop();
+  void test_exec_streaming_fail_on_error();
+  void test_exec_streaming_exit_status();
+  void test_json_escape();
+  void test_shell_quote();
+  void test_exchange_paths();
+  void test_exchange_paths_missing_source();
+  void test_write_slices();
+  void test_cache_strings();
+  void test_read_cache_number_malformed();
+  void test_read_cache_string_truncated();
+  void test_write_slices_bad_path();
 
  private:
   std::map<std::string, bool> _test_map;
   std::vector<std::string> _test_vec;
+  char *_tmp_dir;
 };
 }  // namespace snakemake_unit_tests
 
@@ -0,0 +1,631 @@
+/*!
+  @file archive.cc
+  @brief implementation of archive classes
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/archive.h"
+
+// zip record signatures and limits
+#define ARCHIVE_LOCAL_HEADER_SIGNATURE 0x04034b50
+#define ARCHIVE_CENTRAL_HEADER_SIGNATURE 0x02014b50
+#define ARCHIVE_END_SIGNATURE 0x06054b50
+#define ARCHIVE_ZIP64_END_SIGNATURE 0x06064b50
+#define ARCHIVE_ZIP64_LOCATOR_SIGNATURE 0x07064b50
+#define ARCHIVE_LOCAL_HEADER_SIZE 30
+#define ARCHIVE_CENTRAL_HEADER_SIZE 46
+#define ARCHIVE_END_SIZE 22
+#define ARCHIVE_ZIP64_END_SIZE 56
+#define ARCHIVE_ZIP64_LOCATOR_SIZE 20
+#define ARCHIVE_MAX_32 0xffffffffULL
+#define ARCHIVE_MAX_16 0xffffULL
+// deflate can slightly expand incompressible data; any file above this
+// size gets zip64 size fields reserved in its local header
+#define ARCHIVE_ZIP64_THRESHOLD 0xff000000ULL
+#define ARCHIVE_CHUNK_SIZE 262144
+
+void snakemake_unit_tests::append_little_endian(uint64_t value, unsigned n_bytes, std::string *target) {
+  if (!target) throw std::runtime_error("null pointer to append_little_endian");
+  for (unsigned i = 0; i < n_bytes; ++i) {
+    target->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+uint64_t snakemake_unit_tests::read_little_endian(const char *data, unsigned n_bytes) {
+  if (!data) throw std::runtime_error("null pointer to read_little_endian");
+  uint64_t res = 0;
+  for (unsigned i = 0; i < n_bytes; ++i) {
+    res |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+  }
+  return res;
+}
+
+snakemake_unit_tests::archive_entry::archive_entry()
+    : name(""),
+      method(0),
+      crc(0),
+      compressed_size(0),
+      uncompressed_size(0),
+      local_header_offset(0),
+      mode(S_IFREG | 0644),
+      mtime(0) {}
+
+snakemake_unit_tests::archive_entry::archive_entry(const archive_entry &obj)
+    : name(obj.name),
+      method(obj.method),
+      crc(obj.crc),
+      compressed_size(obj.compressed_size),
+      uncompressed_size(obj.uncompressed_size),
+      local_header_offset(obj.local_header_offset),
+      mode(obj.mode),
+      mtime(obj.mtime) {}
+
+snakemake_unit_tests::archive_entry::~archive_entry() throw() {}
+
+bool snakemake_unit_tests::archive_entry::is_directory() const { return S_ISDIR(mode); }
+
+bool snakemake_unit_tests::archive_entry::is_symlink() const { return S_ISLNK(mode); }
+
+/*!
+  @brief convert a unix timestamp to zip's local-time dos format
+  @param t unix timestamp
+  @param dos_time computed dos time field
+  @param dos_date computed dos date field
+ */
+static void to_dos_time(std::time_t t, uint16_t *dos_time, uint16_t *dos_date) {
+  struct tm local;
+  if (!localtime_r(&t, &local) || local.tm_year < 80) {
+    // dos timestamps cannot represent anything before 1980
+    *dos_time = 0;
+    *dos_date = (1 << 5) | 1;
+    return;
+  }
+  *dos_time = static_cast<uint16_t>((local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2));
+  *dos_date = static_cast<uint16_t>(((local.tm_year - 80) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday);
+}
+
+snakemake_unit_tests::archive_writer::~archive_writer() throw() {
+  if (_output.is_open()) _output.close();
+}
+
+void snakemake_unit_tests::archive_writer::open(const boost::filesystem::path &filename) {
+  if (_output.is_open()) throw std::logic_error("archive_writer: archive \"" + _filename.string() + "\" already open");
+  _filename = filename;
+  _entries.clear();
+  _output.open(filename.string().c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!_output.is_open()) throw std::runtime_error("cannot create archive \"" + filename.string() + "\"");
+}
+
+bool snakemake_unit_tests::archive_writer::is_open() const { return _output.is_open(); }
+
+void snakemake_unit_tests::archive_writer::write_bytes(const std::string &data) {
+  if (!_output.write(data.data(), data.size()))
+    throw std::runtime_error("cannot write to archive \"" + _filename.string() + "\"");
+}
+
+void snakemake_unit_tests::archive_writer::write_local_header(const archive_entry &entry, bool zip64) {
+  uint16_t dos_time = 0, dos_date = 0;
+  to_dos_time(entry.mtime, &dos_time, &dos_date);
+  std::string header;
+  append_little_endian(ARCHIVE_LOCAL_HEADER_SIGNATURE, 4, &header);
+  append_little_endian(zip64 ? 45 : 20, 2, &header);
+  // general purpose flag: names are utf-8
+  append_little_endian(0x0800, 2, &header);
+  append_little_endian(entry.method, 2, &header);
+  append_little_endian(dos_time, 2, &header);
+  append_little_endian(dos_date, 2, &header);
+  append_little_endian(entry.crc, 4, &header);
+  append_little_endian(zip64 ? ARCHIVE_MAX_32 : entry.compressed_size, 4, &header);
+  append_little_endian(zip64 ? ARCHIVE_MAX_32 : entry.uncompressed_size, 4, &header);
+  append_little_endian(entry.name.size(), 2, &header);
+  append_little_endian(zip64 ? 20 : 0, 2, &header);
+  header += entry.name;
+  if (zip64) {
+    append_little_endian(0x0001, 2, &header);
+    append_little_endian(16, 2, &header);
+    append_little_endian(entry.uncompressed_size, 8, &header);
+    append_little_endian(entry.compressed_size, 8, &header);
+  }
+  write_bytes(header);
+}
+
+void snakemake_unit_tests::archive_writer::write_stored_entry(archive_entry *entry, const std::string &content) {
+  if (!entry) throw std::runtime_error("null pointer to write_stored_entry");
+  entry->method = 0;
+  entry->crc = crc32(0L, reinterpret_cast<const Bytef *>(content.data()), content.size());
+  entry->compressed_size = entry->uncompressed_size = content.size();
+  entry->local_header_offset = _output.tellp();
+  write_local_header(*entry, false);
+  write_bytes(content);
+  _entries.push_back(*entry);
+}
+
+void snakemake_unit_tests::archive_writer::add_file(const boost::filesystem::path &source, const std::string &name) {
+  if (!_output.is_open()) throw std::logic_error("archive_writer: add_file called without open archive");
+  archive_entry entry;
+  entry.name = name;
+  entry.method = 8;
+  entry.mode = S_IFREG | (boost::filesystem::status(source).permissions() & 07777);
+  entry.mtime = boost::filesystem::last_write_time(source);
+  entry.local_header_offset = _output.tellp();
+  bool zip64 = boost::filesystem::file_size(source) >= ARCHIVE_ZIP64_THRESHOLD;
+  // sizes and crc are placeholders until the data have been streamed
+  write_local_header(entry, zip64);
+
+  std::ifstream input;
+  input.open(source.string().c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!input.is_open()) throw std::runtime_error("cannot read file \"" + source.string() + "\" for archiving");
+  std::vector<char> in_buffer(ARCHIVE_CHUNK_SIZE), out_buffer(ARCHIVE_CHUNK_SIZE);
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  // negative window bits: raw deflate stream, as zip requires
+  if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    throw std::runtime_error("cannot initialize zlib deflate stream");
+  uLong crc = crc32(0L, Z_NULL, 0);
+  int flush = Z_NO_FLUSH;
+  try {
+    do {
+      input.read(&in_buffer[0], in_buffer.size());
+      std::streamsize n_read = input.gcount();
+      if (input.bad()) throw std::runtime_error("error reading file \"" + source.string() + "\" for archiving");
+      flush = input.eof() ? Z_FINISH : Z_NO_FLUSH;
+      crc = crc32(crc, reinterpret_cast<const Bytef *>(&in_buffer[0]), n_read);
+      entry.uncompressed_size += n_read;
+      strm.next_in = reinterpret_cast<Bytef *>(&in_buffer[0]);
+      strm.avail_in = n_read;
+      do {
+        strm.next_out = reinterpret_cast<Bytef *>(&out_buffer[0]);
+        strm.avail_out = out_buffer.size();
+        if (deflate(&strm, flush) == Z_STREAM_ERROR)
+          throw std::runtime_error("zlib deflate failed on \"" + source.string() + "\"");
+        unsigned n_out = out_buffer.size() - strm.avail_out;
+        if (!_output.write(&out_buffer[0], n_out))
+          throw std::runtime_error("cannot write to archive \"" + _filename.string() + "\"");
+        entry.compressed_size += n_out;
+      } while (strm.avail_out == 0);
+    } while (flush != Z_FINISH);
+  } catch (...) {
+    deflateEnd(&strm);
+    throw;
+  }
+  deflateEnd(&strm);
+  input.close();
+  entry.crc = crc;
+  if (!zip64 && (entry.compressed_size >= ARCHIVE_MAX_32 || entry.uncompressed_size >= ARCHIVE_MAX_32))
+    throw std::runtime_error("file \"" + source.string() + "\" changed size while being archived");
+
+  // go back and fill in the local header now that the data are known
+  std::streampos end_of_data = _output.tellp();
+  std::string patch;
+  append_little_endian(entry.crc, 4, &patch);
+  if (!zip64) {
+    append_little_endian(entry.compressed_size, 4, &patch);
+    append_little_endian(entry.uncompressed_size, 4, &patch);
+  }
+  _output.seekp(entry.local_header_offset + 14);
+  write_bytes(patch);
+  if (zip64) {
+    patch.clear();
+    append_little_endian(entry.uncompressed_size, 8, &patch);
+    append_little_endian(entry.compressed_size, 8, &patch);
+    _output.seekp(entry.local_header_offset + ARCHIVE_LOCAL_HEADER_SIZE + entry.name.size() + 4);
+    write_bytes(patch);
+  }
+  _output.seekp(end_of_data);
+  _entries.push_back(entry);
+}
+
+void snakemake_unit_tests::archive_writer::add_directory(const boost::filesystem::path &source,
+                                                         const std::string &name) {
+  if (!_output.is_open()) throw std::logic_error("archive_writer: add_directory called without open archive");
+  archive_entry entry;
+  entry.name = name;
+  if (entry.name.empty() || *entry.name.rbegin() != '/') entry.name += "/";
+  entry.mode = S_IFDIR | (boost::filesystem::status(source).permissions() & 07777);
+  entry.mtime = boost::filesystem::last_write_time(source);
+  write_stored_entry(&entry, "");
+}
+
+void snakemake_unit_tests::archive_writer::add_symlink(const boost::filesystem::path &source, const std::string &name) {
+  if (!_output.is_open()) throw std::logic_error("archive_writer: add_symlink called without open archive");
+  archive_entry entry;
+  entry.name = name;
+  entry.mode = S_IFLNK | 0777;
+  struct stat link_status;
+  if (!lstat(source.string().c_str(), &link_status)) {
+    entry.mtime = link_status.st_mtime;
+  }
+  // the link target is stored as the entry content, as done by Info-ZIP
+  write_stored_entry(&entry, boost::filesystem::read_symlink(source).string());
+}
+
+unsigned snakemake_unit_tests::archive_writer::add_tree(const boost::filesystem::path &source,
+                                                        const std::string &prefix) {
+  if (!boost::filesystem::is_directory(source))
+    throw std::runtime_error("cannot archive \"" + source.string() + "\": not a directory");
+  unsigned res = 1;
+  add_directory(source, prefix);
+  // sort children so that archive contents don't depend on filesystem ordering
+  std::vector<boost::filesystem::path> children;
+  for (boost::filesystem::directory_iterator iter(source), end; iter != end; ++iter) {
+    children.push_back(iter->path());
+  }
+  std::sort(children.begin(), children.end());
+  for (std::vector<boost::filesystem::path>::const_iterator iter = children.begin(); iter != children.end(); ++iter) {
+    std::string child_name = prefix + "/" + iter->filename().string();
+    if (boost::filesystem::is_symlink(*iter)) {
+      add_symlink(*iter, child_name);
+      ++res;
+    } else if (boost::filesystem::is_directory(*iter)) {
+      res += add_tree(*iter, child_name);
+    } else if (boost::filesystem::is_regular_file(*iter)) {
+      add_file(*iter, child_name);
+      ++res;
+    } else {
+      throw std::runtime_error("cannot archive \"" + iter->string() + "\": unsupported file type");
+    }
+  }
+  return res;
+}
+
+void snakemake_unit_tests::archive_writer::copy_entry(const archive_reader &reader, const archive_entry &entry) {
+  if (!_output.is_open()) throw std::logic_error("archive_writer: copy_entry called without open archive");
+  archive_entry copied(entry);
+  copied.local_header_offset = _output.tellp();
+  write_local_header(copied,
+                     copied.compressed_size >= ARCHIVE_MAX_32 || copied.uncompressed_size >= ARCHIVE_MAX_32);
+  reader.read_raw(entry, _output);
+  _entries.push_back(copied);
+}
+
+void snakemake_unit_tests::archive_writer::close() {
+  if (!_output.is_open()) throw std::logic_error("archive_writer: close called without open archive");
+  uint64_t central_offset = _output.tellp();
+  for (std::vector<archive_entry>::const_iterator iter = _entries.begin(); iter != _entries.end(); ++iter) {
+    bool large_usize = iter->uncompressed_size >= ARCHIVE_MAX_32;
+    bool large_csize = iter->compressed_size >= ARCHIVE_MAX_32;
+    bool large_offset = iter->local_header_offset >= ARCHIVE_MAX_32;
+    std::string extra;
+    if (large_usize || large_csize || large_offset) {
+      std::string zip64;
+      if (large_usize) append_little_endian(iter->uncompressed_size, 8, &zip64);
+      if (large_csize) append_little_endian(iter->compressed_size, 8, &zip64);
+      if (large_offset) append_little_endian(iter->local_header_offset, 8, &zip64);
+      append_little_endian(0x0001, 2, &extra);
+      append_little_endian(zip64.size(), 2, &extra);
+      extra += zip64;
+    }
+    // extended timestamp: dos times are local, with two second resolution
+    append_little_endian(0x5455, 2, &extra);
+    append_little_endian(5, 2, &extra);
+    append_little_endian(1, 1, &extra);
+    append_little_endian(iter->mtime > 0 ? static_cast<uint64_t>(iter->mtime) : 0, 4, &extra);
+    uint16_t dos_time = 0, dos_date = 0;
+    to_dos_time(iter->mtime, &dos_time, &dos_date);
+    std::string header;
+    append_little_endian(ARCHIVE_CENTRAL_HEADER_SIGNATURE, 4, &header);
+    // made by: unix, spec version 4.5
+    append_little_endian((3 << 8) | 45, 2, &header);
+    append_little_endian(large_usize || large_csize || large_offset ? 45 : 20, 2, &header);
+    append_little_endian(0x0800, 2, &header);
+    append_little_endian(iter->method, 2, &header);
+    append_little_endian(dos_time, 2, &header);
+    append_little_endian(dos_date, 2, &header);
+    append_little_endian(iter->crc, 4, &header);
+    append_little_endian(large_csize ? ARCHIVE_MAX_32 : iter->compressed_size, 4, &header);
+    append_little_endian(large_usize ? ARCHIVE_MAX_32 : iter->uncompressed_size, 4, &header);
+    append_little_endian(iter->name.size(), 2, &header);
+    append_little_endian(extra.size(), 2, &header);
+    // comment length, disk number, internal attributes
+    append_little_endian(0, 2, &header);
+    append_little_endian(0, 2, &header);
+    append_little_endian(0, 2, &header);
+    // external attributes: unix mode in the high bytes, msdos directory bit in the low
+    append_little_endian((static_cast<uint64_t>(iter->mode) << 16) | (iter->is_directory() ? 0x10 : 0), 4, &header);
+    append_little_endian(large_offset ? ARCHIVE_MAX_32 : iter->local_header_offset, 4, &header);
+    header += iter->name;
+    header += extra;
+    write_bytes(header);
+  }
+  uint64_t central_size = static_cast<uint64_t>(_output.tellp()) - central_offset;
+  std::string trailer;
+  if (_entries.size() >= ARCHIVE_MAX_16 || central_offset >= ARCHIVE_MAX_32 || central_size >= ARCHIVE_MAX_32) {
+    uint64_t zip64_end_offset = _output.tellp();
+    append_little_endian(ARCHIVE_ZIP64_END_SIGNATURE, 4, &trailer);
+    append_little_endian(ARCHIVE_ZIP64_END_SIZE - 12, 8, &trailer);
+    append_little_endian((3 << 8) | 45, 2, &trailer);
+    append_little_endian(45, 2, &trailer);
+    append_little_endian(0, 4, &trailer);
+    append_little_endian(0, 4, &trailer);
+    append_little_endian(_entries.size(), 8, &trailer);
+    append_little_endian(_entries.size(), 8, &trailer);
+    append_little_endian(central_size, 8, &trailer);
+    append_little_endian(central_offset, 8, &trailer);
+    append_little_endian(ARCHIVE_ZIP64_LOCATOR_SIGNATURE, 4, &trailer);
+    append_little_endian(0, 4, &trailer);
+    append_little_endian(zip64_end_offset, 8, &trailer);
+    append_little_endian(1, 4, &trailer);
+  }
+  append_little_endian(ARCHIVE_END_SIGNATURE, 4, &trailer);
+  append_little_endian(0, 2, &trailer);
+  append_little_endian(0, 2, &trailer);
+  append_little_endian(std::min<uint64_t>(_entries.size(), ARCHIVE_MAX_16), 2, &trailer);
+  append_little_endian(std::min<uint64_t>(_entries.size(), ARCHIVE_MAX_16), 2, &trailer);
+  append_little_endian(std::min<uint64_t>(central_size, ARCHIVE_MAX_32), 4, &trailer);
+  append_little_endian(std::min<uint64_t>(central_offset, ARCHIVE_MAX_32), 4, &trailer);
+  append_little_endian(0, 2, &trailer);
+  write_bytes(trailer);
+  _output.close();
+  if (_output.fail()) throw std::runtime_error("cannot finalize archive \"" + _filename.string() + "\"");
+}
+
+void snakemake_unit_tests::archive_reader::open(const boost::filesystem::path &filename) {
+  close();
+  _filename = filename;
+  _input.open(filename.string().c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!_input.is_open()) throw std::runtime_error("cannot open archive \"" + filename.string() + "\"");
+  _input.seekg(0, std::ios_base::end);
+  uint64_t file_size = _input.tellg();
+  // the end record is at most 64k of comment away from the end of the file
+  uint64_t tail_size = std::min<uint64_t>(file_size, ARCHIVE_END_SIZE + ARCHIVE_MAX_16);
+  std::string tail = read_at(file_size - tail_size, tail_size);
+  uint64_t end_position = 0;
+  bool found_end = false;
+  for (uint64_t i = tail_size >= ARCHIVE_END_SIZE ? tail_size - ARCHIVE_END_SIZE + 1 : 0; i > 0; --i) {
+    if (read_little_endian(tail.data() + i - 1, 4) == ARCHIVE_END_SIGNATURE) {
+      end_position = i - 1;
+      found_end = true;
+      break;
+    }
+  }
+  if (!found_end) throw std::runtime_error("\"" + filename.string() + "\" is not a valid archive");
+  uint64_t n_entries = read_little_endian(tail.data() + end_position + 10, 2);
+  uint64_t central_size = read_little_endian(tail.data() + end_position + 12, 4);
+  uint64_t central_offset = read_little_endian(tail.data() + end_position + 16, 4);
+  if (n_entries == ARCHIVE_MAX_16 || central_size == ARCHIVE_MAX_32 || central_offset == ARCHIVE_MAX_32) {
+    uint64_t locator_offset = file_size - tail_size + end_position;
+    if (locator_offset < ARCHIVE_ZIP64_LOCATOR_SIZE)
+      throw std::runtime_error("archive \"" + filename.string() + "\" is missing its zip64 locator");
+    std::string locator = read_at(locator_offset - ARCHIVE_ZIP64_LOCATOR_SIZE, ARCHIVE_ZIP64_LOCATOR_SIZE);
+    if (read_little_endian(locator.data(), 4) != ARCHIVE_ZIP64_LOCATOR_SIGNATURE)
+      throw std::runtime_error("archive \"" + filename.string() + "\" is missing its zip64 locator");
+    std::string zip64_end = read_at(read_little_endian(locator.data() + 8, 8), ARCHIVE_ZIP64_END_SIZE);
+    if (read_little_endian(zip64_end.data(), 4) != ARCHIVE_ZIP64_END_SIGNATURE)
+      throw std::runtime_error("archive \"" + filename.string() + "\" has a corrupt zip64 end record");
+    n_entries = read_little_endian(zip64_end.data() + 32, 8);
+    central_size = read_little_endian(zip64_end.data() + 40, 8);
+    central_offset = read_little_endian(zip64_end.data() + 48, 8);
+  }
+  std::string central = read_at(central_offset, central_size);
+  uint64_t position = 0;
+  _entries.reserve(n_entries);
+  for (uint64_t i = 0; i < n_entries; ++i) {
+    if (position + ARCHIVE_CENTRAL_HEADER_SIZE > central.size() ||
+        read_little_endian(central.data() + position, 4) != ARCHIVE_CENTRAL_HEADER_SIGNATURE)
+      throw std::runtime_error("archive \"" + filename.string() + "\" has a corrupt index");
+    const char *header = central.data() + position;
+    archive_entry entry;
+    entry.method = read_little_endian(header + 10, 2);
+    uint16_t dos_time = read_little_endian(header + 12, 2);
+    uint16_t dos_date = read_little_endian(header + 14, 2);
+    entry.crc = read_little_endian(header + 16, 4);
+    entry.compressed_size = read_little_endian(header + 20, 4);
+    entry.uncompressed_size = read_little_endian(header + 24, 4);
+    uint64_t name_length = read_little_endian(header + 28, 2);
+    uint64_t extra_length = read_little_endian(header + 30, 2);
+    uint64_t comment_length = read_little_endian(header + 32, 2);
+    uint64_t external_attributes = read_little_endian(header + 38, 4);
+    entry.local_header_offset = read_little_endian(header + 42, 4);
+    if (position + ARCHIVE_CENTRAL_HEADER_SIZE + name_length + extra_length + comment_length > central.size())
+      throw std::runtime_error("archive \"" + filename.string() + "\" has a corrupt index");
+    entry.name = central.substr(position + ARCHIVE_CENTRAL_HEADER_SIZE, name_length);
+    const char *extra = header + ARCHIVE_CENTRAL_HEADER_SIZE + name_length;
+    bool found_mtime = false;
+    for (uint64_t offset = 0; offset + 4 <= extra_length;) {
+      uint64_t tag = read_little_endian(extra + offset, 2);
+      uint64_t size = read_little_endian(extra + offset + 2, 2);
+      const char *field = extra + offset + 4;
+      if (offset + 4 + size > extra_length) break;
+      if (tag == 0x0001) {
+        // zip64 fields are present only for values that overflowed the header
+        uint64_t used = 0;
+        if (entry.uncompressed_size == ARCHIVE_MAX_32 && used + 8 <= size) {
+          entry.uncompressed_size = read_little_endian(field + used, 8);
+          used += 8;
+        }
+        if (entry.compressed_size == ARCHIVE_MAX_32 && used + 8 <= size) {
+          entry.compressed_size = read_little_endian(field + used, 8);
+          used += 8;
+        }
+        if (entry.local_header_offset == ARCHIVE_MAX_32 && used + 8 <= size) {
+          entry.local_header_offset = read_little_endian(field + used, 8);
+          used += 8;
+        }
+      } else if (tag == 0x5455 && size >= 5 && (field[0] & 1)) {
+        entry.mtime = read_little_endian(field + 1, 4);
+        found_mtime = true;
+      }
+      offset += 4 + size;
+    }
+    if (!found_mtime) {
+      struct tm local;
+      local.tm_sec = (dos_time & 0x1f) * 2;
+      local.tm_min = (dos_time >> 5) & 0x3f;
+      local.tm_hour = dos_time >> 11;
+      local.tm_mday = dos_date & 0x1f;
+      local.tm_mon = ((dos_date >> 5) & 0x0f) - 1;
+      local.tm_year = (dos_date >> 9) + 80;
+      local.tm_isdst = -1;
+      entry.mtime = mktime(&local);
+    }
+    entry.mode = external_attributes >> 16;
+    if (!entry.mode) {
+      // archives not created on unix have no mode information
+      bool is_dir = !entry.name.empty() && *entry.name.rbegin() == '/';
+      entry.mode = is_dir ? (S_IFDIR | 0755) : (S_IFREG | 0644);
+    }
+    _index[entry.name] = _entries.size();
+    _entries.push_back(entry);
+    position += ARCHIVE_CENTRAL_HEADER_SIZE + name_length + extra_length + comment_length;
+  }
+}
+
+void snakemake_unit_tests::archive_reader::close() {
+  if (_input.is_open()) _input.close();
+  _input.clear();
+  _entries.clear();
+  _index.clear();
+}
+
+std::string snakemake_unit_tests::archive_reader::read_at(uint64_t offset, uint64_t n_bytes) const {
+  std::string res(n_bytes, '\0');
+  _input.clear();
+  _input.seekg(offset);
+  if (n_bytes && !_input.read(&res[0], n_bytes))
+    throw std::runtime_error("unexpected end of archive \"" + _filename.string() + "\"");
+  return res;
+}
+
+uint64_t snakemake_unit_tests::archive_reader::data_offset(const archive_entry &entry) const {
+  std::string header = read_at(entry.local_header_offset, ARCHIVE_LOCAL_HEADER_SIZE);
+  if (read_little_endian(header.data(), 4) != ARCHIVE_LOCAL_HEADER_SIGNATURE)
+    throw std::runtime_error("archive \"" + _filename.string() + "\" has a corrupt header for \"" + entry.name + "\"");
+  return entry.local_header_offset + ARCHIVE_LOCAL_HEADER_SIZE + read_little_endian(header.data() + 26, 2) +
+         read_little_endian(header.data() + 28, 2);
+}
+
+std::vector<unsigned> snakemake_unit_tests::archive_reader::find_prefix(const std::string &prefix) const {
+  std::vector<unsigned> res;
+  for (std::map<std::string, unsigned>::const_iterator iter = _index.lower_bound(prefix);
+       iter != _index.end() && !iter->first.compare(0, prefix.size(), prefix); ++iter) {
+    res.push_back(iter->second);
+  }
+  return res;
+}
+
+std::map<std::string, bool> snakemake_unit_tests::archive_reader::top_level_names() const {
+  std::map<std::string, bool> res;
+  for (std::vector<archive_entry>::const_iterator iter = _entries.begin(); iter != _entries.end(); ++iter) {
+    res[iter->name.substr(0, iter->name.find('/'))] = true;
+  }
+  return res;
+}
+
+void snakemake_unit_tests::archive_reader::read_raw(const archive_entry &entry, std::ostream &out) const {
+  _input.clear();
+  _input.seekg(data_offset(entry));
+  std::vector<char> buffer(ARCHIVE_CHUNK_SIZE);
+  for (uint64_t remaining = entry.compressed_size; remaining > 0;) {
+    uint64_t n_bytes = std::min<uint64_t>(remaining, buffer.size());
+    if (!_input.read(&buffer[0], n_bytes))
+      throw std::runtime_error("unexpected end of archive \"" + _filename.string() + "\"");
+    if (!out.write(&buffer[0], n_bytes))
+      throw std::runtime_error("cannot copy archive entry \"" + entry.name + "\"");
+    remaining -= n_bytes;
+  }
+}
+
+void snakemake_unit_tests::archive_reader::extract_entry(const archive_entry &entry,
+                                                         const boost::filesystem::path &target) const {
+  if (entry.is_directory()) {
+    boost::filesystem::create_directories(target);
+    boost::filesystem::permissions(target, static_cast<boost::filesystem::perms>(entry.mode & 07777));
+    boost::filesystem::last_write_time(target, entry.mtime);
+    return;
+  }
+  boost::filesystem::create_directories(target.parent_path());
+  // for compatibility with read-only test content: clear out whatever is present
+  if (boost::filesystem::exists(boost::filesystem::symlink_status(target))) {
+    if (!boost::filesystem::is_symlink(target)) {
+      boost::filesystem::permissions(target, boost::filesystem::owner_write | boost::filesystem::add_perms);
+    }
+    boost::filesystem::remove_all(target);
+  }
+  if (entry.is_symlink()) {
+    if (entry.method != 0) throw std::runtime_error("compressed symlink entries are not supported");
+    boost::filesystem::create_symlink(read_at(data_offset(entry), entry.compressed_size), target);
+    return;
+  }
+  if (entry.method != 0 && entry.method != 8)
+    throw std::runtime_error("archive entry \"" + entry.name + "\" uses unsupported compression");
+  std::ofstream output;
+  output.open(target.string().c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!output.is_open()) throw std::runtime_error("cannot write extracted file \"" + target.string() + "\"");
+  _input.clear();
+  _input.seekg(data_offset(entry));
+  std::vector<char> in_buffer(ARCHIVE_CHUNK_SIZE), out_buffer(ARCHIVE_CHUNK_SIZE);
+  uLong crc = crc32(0L, Z_NULL, 0);
+  uint64_t n_written = 0;
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  strm.avail_in = 0;
+  strm.next_in = Z_NULL;
+  if (entry.method == 8 && inflateInit2(&strm, -15) != Z_OK)
+    throw std::runtime_error("cannot initialize zlib inflate stream");
+  try {
+    int status = Z_OK;
+    for (uint64_t remaining = entry.compressed_size; remaining > 0 && status != Z_STREAM_END;) {
+      uint64_t n_bytes = std::min<uint64_t>(remaining, in_buffer.size());
+      if (!_input.read(&in_buffer[0], n_bytes))
+        throw std::runtime_error("unexpected end of archive \"" + _filename.string() + "\"");
+      remaining -= n_bytes;
+      if (entry.method == 0) {
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(&in_buffer[0]), n_bytes);
+        n_written += n_bytes;
+        if (!output.write(&in_buffer[0], n_bytes))
+          throw std::runtime_error("cannot write extracted file \"" + target.string() + "\"");
+        continue;
+      }
+      strm.next_in = reinterpret_cast<Bytef *>(&in_buffer[0]);
+      strm.avail_in = n_bytes;
+      do {
+        strm.next_out = reinterpret_cast<Bytef *>(&out_buffer[0]);
+        strm.avail_out = out_buffer.size();
+        status = inflate(&strm, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR)
+          throw std::runtime_error("archive entry \"" + entry.name + "\" is corrupt");
+        unsigned n_out = out_buffer.size() - strm.avail_out;
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(&out_buffer[0]), n_out);
+        n_written += n_out;
+        if (!output.write(&out_buffer[0], n_out))
+          throw std::runtime_error("cannot write extracted file \"" + target.string() + "\"");
+      } while (strm.avail_out == 0 && status != Z_STREAM_END);
+    }
+  } catch (...) {
+    if (entry.method == 8) inflateEnd(&strm);
+    throw;
+  }
+  if (entry.method == 8) inflateEnd(&strm);
+  output.close();
+  if (crc != entry.crc || n_written != entry.uncompressed_size)
+    throw std::runtime_error("archive entry \"" + entry.name + "\" failed integrity check");
+  boost::filesystem::permissions(target, static_cast<boost::filesystem::perms>(entry.mode & 07777));
+  boost::filesystem::last_write_time(target, entry.mtime);
+}
+
+unsigned snakemake_unit_tests::archive_reader::extract_prefix(const std::string &prefix,
+                                                              const boost::filesystem::path &target_dir) const {
+  std::vector<unsigned> matches = find_prefix(prefix);
+  std::vector<unsigned> directories;
+  for (std::vector<unsigned>::const_iterator iter = matches.begin(); iter != matches.end(); ++iter) {
+    const archive_entry &entry = _entries.at(*iter);
+    if (entry.is_directory()) {
+      // directory modes and times are applied once their contents are in place
+      boost::filesystem::create_directories(target_dir / entry.name);
+      directories.push_back(*iter);
+    } else {
+      extract_entry(entry, target_dir / entry.name);
+    }
+  }
+  // children sort after their parents, so apply deepest directories first
+  for (std::vector<unsigned>::const_reverse_iterator iter = directories.rbegin(); iter != directories.rend(); ++iter) {
+    extract_entry(_entries.at(*iter), target_dir / _entries.at(*iter).name);
+  }
+  return matches.size();
+}
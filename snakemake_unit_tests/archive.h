@@ -0,0 +1,314 @@
+/*!
+  @file archive.h
+  @brief single-file, indexed, compressed storage for unit test trees
+  @author Cameron Palmer
+  @note requires zlib library + headers
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  the on-disk layout is a standard zip archive (with zip64 extensions
+  as needed), so that test.py can lazily expand a single rule with
+  nothing more than the python standard library. the central directory
+  at the end of the file is the seekable index.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_ARCHIVE_H_
+#define SNAKEMAKE_UNIT_TESTS_ARCHIVE_H_
+
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
+namespace snakemake_unit_tests {
+/*!
+  @brief append an unsigned integer to a buffer in little-endian byte order
+  @param value integer to append
+  @param n_bytes number of low-order bytes of value to append
+  @param target buffer to which to append
+ */
+void append_little_endian(uint64_t value, unsigned n_bytes, std::string *target);
+/*!
+  @brief read an unsigned little-endian integer from a buffer
+  @param data start of integer in buffer
+  @param n_bytes number of bytes in integer
+  @return integer value
+ */
+uint64_t read_little_endian(const char *data, unsigned n_bytes);
+
+/*!
+  @class archive_entry
+  @brief metadata for a single file, directory, or symlink stored in
+  an archive
+ */
+class archive_entry {
+ public:
+  /*!
+    @brief constructor
+   */
+  archive_entry();
+  /*!
+    @brief copy constructor
+    @param obj existing archive_entry object
+   */
+  archive_entry(const archive_entry &obj);
+  /*!
+    @brief destructor
+   */
+  ~archive_entry() throw();
+  /*!
+    @brief determine whether the entry is a directory
+    @return whether the entry is a directory
+   */
+  bool is_directory() const;
+  /*!
+    @brief determine whether the entry is a symbolic link
+    @return whether the entry is a symbolic link
+   */
+  bool is_symlink() const;
+  /*!
+    @brief path of entry within archive; directories have a trailing '/'
+   */
+  std::string name;
+  /*!
+    @brief zip compression method: 0 for stored, 8 for deflate
+   */
+  uint16_t method;
+  /*!
+    @brief crc32 of uncompressed entry data
+   */
+  uint32_t crc;
+  /*!
+    @brief size of entry data as stored in archive
+   */
+  uint64_t compressed_size;
+  /*!
+    @brief size of entry data once extracted
+   */
+  uint64_t uncompressed_size;
+  /*!
+    @brief byte offset of entry's local header in archive
+   */
+  uint64_t local_header_offset;
+  /*!
+    @brief unix file type and permission bits
+   */
+  uint32_t mode;
+  /*!
+    @brief modification time of source file
+   */
+  std::time_t mtime;
+};
+
+class archive_reader;
+
+/*!
+  @class archive_writer
+  @brief stream files and directory trees into a new archive
+ */
+class archive_writer {
+ public:
+  /*!
+    @brief constructor
+   */
+  archive_writer() {}
+  /*!
+    @brief constructor: open a new archive for writing
+    @param filename name of archive to create
+   */
+  explicit archive_writer(const boost::filesystem::path &filename) { open(filename); }
+  /*!
+    @brief destructor
+
+    an archive that was never closed is left truncated, and
+    will be rejected by any reader
+   */
+  ~archive_writer() throw();
+  /*!
+    @brief open a new archive for writing
+    @param filename name of archive to create; existing files are replaced
+   */
+  void open(const boost::filesystem::path &filename);
+  /*!
+    @brief determine whether an archive is open for writing
+    @return whether an archive is open for writing
+   */
+  bool is_open() const;
+  /*!
+    @brief compress a single regular file into the archive
+    @param source file on disk
+    @param name path of file within archive
+   */
+  void add_file(const boost::filesystem::path &source, const std::string &name);
+  /*!
+    @brief record a directory in the archive
+    @param source directory on disk, for permissions and mtime
+    @param name path of directory within archive; a trailing '/' is added
+    if not present
+   */
+  void add_directory(const boost::filesystem::path &source, const std::string &name);
+  /*!
+    @brief record a symbolic link in the archive without following it
+    @param source link on disk
+    @param name path of link within archive
+   */
+  void add_symlink(const boost::filesystem::path &source, const std::string &name);
+  /*!
+    @brief recursively add a directory and all its contents to the archive
+    @param source directory on disk
+    @param prefix path of directory within archive
+    @return number of entries added
+   */
+  unsigned add_tree(const boost::filesystem::path &source, const std::string &prefix);
+  /*!
+    @brief copy an entry from an existing archive without recompressing it
+    @param reader open archive containing the entry
+    @param entry entry to copy
+   */
+  void copy_entry(const archive_reader &reader, const archive_entry &entry);
+  /*!
+    @brief write the central directory index and close the archive
+   */
+  void close();
+  /*!
+    @brief access entries written so far
+    @return entries written so far
+   */
+  const std::vector<archive_entry> &entries() const { return _entries; }
+
+ private:
+  friend class archiveTest;
+  /*!
+    @brief copy constructor
+    @param obj existing archive_writer object
+    @warning disabled
+   */
+  archive_writer(const archive_writer &obj) { throw std::domain_error("archive_writer: do not use copy constructor"); }
+  /*!
+    @brief write a local file header for an entry at the current position
+    @param entry metadata for entry
+    @param zip64 whether to reserve zip64 size fields
+   */
+  void write_local_header(const archive_entry &entry, bool zip64);
+  /*!
+    @brief write an entry with in-memory content and no compression
+    @param entry metadata for entry; crc and sizes are computed here
+    @param content entry data
+   */
+  void write_stored_entry(archive_entry *entry, const std::string &content);
+  /*!
+    @brief emit raw bytes to the archive
+    @param data bytes to write
+   */
+  void write_bytes(const std::string &data);
+  std::ofstream _output;                //!< archive file handle
+  boost::filesystem::path _filename;    //!< archive file name, for error messages
+  std::vector<archive_entry> _entries;  //!< all entries written so far
+};
+
+/*!
+  @class archive_reader
+  @brief lazily extract selected contents of an archive
+ */
+class archive_reader {
+ public:
+  /*!
+    @brief constructor
+   */
+  archive_reader() {}
+  /*!
+    @brief constructor: open an archive and load its index
+    @param filename name of archive to read
+   */
+  explicit archive_reader(const boost::filesystem::path &filename) { open(filename); }
+  /*!
+    @brief destructor
+   */
+  ~archive_reader() throw() {}
+  /*!
+    @brief open an archive and load its index
+    @param filename name of archive to read
+   */
+  void open(const boost::filesystem::path &filename);
+  /*!
+    @brief release the archive file handle
+   */
+  void close();
+  /*!
+    @brief access all entries in the archive, in storage order
+    @return all entries in the archive
+   */
+  const std::vector<archive_entry> &entries() const { return _entries; }
+  /*!
+    @brief find all entries with names starting with a prefix
+    @param prefix leading portion of entry names to match
+    @return indices of matching entries in entries(), sorted by name
+   */
+  std::vector<unsigned> find_prefix(const std::string &prefix) const;
+  /*!
+    @brief get the distinct first path components of all entries
+    @return first path components of entries as keys
+   */
+  std::map<std::string, bool> top_level_names() const;
+  /*!
+    @brief extract all entries under a prefix
+    @param prefix leading portion of entry names to extract
+    @param target_dir directory into which to write entries
+    @return number of entries extracted
+
+    entries are written at target_dir/name, with the full name (including
+    the prefix) preserved
+   */
+  unsigned extract_prefix(const std::string &prefix, const boost::filesystem::path &target_dir) const;
+  /*!
+    @brief extract a single entry, restoring its permissions and mtime
+    @param entry entry to extract
+    @param target destination path
+   */
+  void extract_entry(const archive_entry &entry, const boost::filesystem::path &target) const;
+  /*!
+    @brief copy an entry's stored (possibly compressed) bytes to a stream
+    @param entry entry to copy
+    @param out stream to which to write bytes
+   */
+  void read_raw(const archive_entry &entry, std::ostream &out) const;
+
+ private:
+  friend class archiveTest;
+  /*!
+    @brief copy constructor
+    @param obj existing archive_reader object
+    @warning disabled
+   */
+  archive_reader(const archive_reader &obj) { throw std::domain_error("archive_reader: do not use copy constructor"); }
+  /*!
+    @brief locate the start of an entry's data, past its local header
+    @param entry entry to locate
+    @return byte offset of entry data
+   */
+  uint64_t data_offset(const archive_entry &entry) const;
+  /*!
+    @brief read a fixed number of bytes from a position in the archive
+    @param offset byte offset at which to start reading
+    @param n_bytes number of bytes to read
+    @return bytes read
+   */
+  std::string read_at(uint64_t offset, uint64_t n_bytes) const;
+  mutable std::ifstream _input;              //!< archive file handle; reads move its position
+  boost::filesystem::path _filename;         //!< archive file name, for error messages
+  std::vector<archive_entry> _entries;       //!< central directory contents
+  std::map<std::string, unsigned> _index;    //!< lookup of entry name to position in _entries
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_ARCHIVE_H_
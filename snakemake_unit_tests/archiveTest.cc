@@ -0,0 +1,316 @@
+/*!
+  \file archiveTest.cc
+  \brief implementation of archive unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/archiveTest.h"
+
+void snakemake_unit_tests::archiveTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutARTXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("archiveTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::archiveTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+void snakemake_unit_tests::archiveTest::write_file(const boost::filesystem::path &p,
+                                                   const std::string &content) const {
+  std::ofstream output;
+  output.open(p.string().c_str(), std::ios_base::out | std::ios_base::binary);
+  if (!output.is_open()) {
+    throw std::runtime_error("cannot write file \"" + p.string() + "\"");
+  }
+  output << content;
+  output.close();
+}
+
+std::string snakemake_unit_tests::archiveTest::read_file(const boost::filesystem::path &p) const {
+  std::ifstream input;
+  std::ostringstream content;
+  input.open(p.string().c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!input.is_open()) {
+    throw std::runtime_error("cannot read file \"" + p.string() + "\"");
+  }
+  content << input.rdbuf();
+  input.close();
+  return content.str();
+}
+
+void snakemake_unit_tests::archiveTest::create_example_tree(const boost::filesystem::path &p) const {
+  boost::filesystem::create_directories(p / "workflow" / "results");
+  boost::filesystem::create_directories(p / "empty_dir");
+  write_file(p / "workflow" / "Snakefile", "rule all:\n    input: \"results/output.tsv\",\n");
+  std::string large_content = "";
+  for (unsigned i = 0; i < 100000; ++i) {
+    large_content += "line " + std::to_string(i) + "\tvalue\n";
+  }
+  write_file(p / "workflow" / "results" / "output.tsv", large_content);
+  write_file(p / "workflow" / "results" / "empty.tsv", "");
+  boost::filesystem::permissions(p / "workflow" / "results" / "empty.tsv",
+                                 boost::filesystem::owner_read | boost::filesystem::group_read);
+  boost::filesystem::create_symlink("results/output.tsv", p / "workflow" / "link.tsv");
+}
+
+void snakemake_unit_tests::archiveTest::test_append_little_endian() {
+  std::string res = "x";
+  append_little_endian(0x04034b50, 4, &res);
+  CPPUNIT_ASSERT(res.size() == 5);
+  CPPUNIT_ASSERT(!res.compare(std::string("xPK\x03\x04")));
+  // only the requested low-order bytes are appended
+  append_little_endian(0x1234, 1, &res);
+  CPPUNIT_ASSERT(res.size() == 6 && res.at(5) == '\x34');
+}
+
+void snakemake_unit_tests::archiveTest::test_append_little_endian_null_pointer() { append_little_endian(1, 1, NULL); }
+
+void snakemake_unit_tests::archiveTest::test_read_little_endian() {
+  std::string data;
+  append_little_endian(0xfedcba9876543210ULL, 8, &data);
+  CPPUNIT_ASSERT(read_little_endian(data.data(), 8) == 0xfedcba9876543210ULL);
+  CPPUNIT_ASSERT(read_little_endian(data.data(), 2) == 0x3210);
+  CPPUNIT_ASSERT(read_little_endian(data.data() + 7, 1) == 0xfe);
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_entry_default_constructor() {
+  archive_entry e;
+  CPPUNIT_ASSERT(e.name.empty());
+  CPPUNIT_ASSERT(e.method == 0);
+  CPPUNIT_ASSERT(e.crc == 0);
+  CPPUNIT_ASSERT(e.compressed_size == 0);
+  CPPUNIT_ASSERT(e.uncompressed_size == 0);
+  CPPUNIT_ASSERT(e.local_header_offset == 0);
+  CPPUNIT_ASSERT(e.mode == (S_IFREG | 0644));
+  CPPUNIT_ASSERT(e.mtime == 0);
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_entry_copy_constructor() {
+  archive_entry e;
+  e.name = "rule/workspace/file.txt";
+  e.method = 8;
+  e.crc = 123;
+  e.compressed_size = 456;
+  e.uncompressed_size = 789;
+  e.local_header_offset = 1011;
+  e.mode = S_IFREG | 0755;
+  e.mtime = 1213;
+  archive_entry f(e);
+  CPPUNIT_ASSERT(!f.name.compare(e.name));
+  CPPUNIT_ASSERT(f.method == e.method);
+  CPPUNIT_ASSERT(f.crc == e.crc);
+  CPPUNIT_ASSERT(f.compressed_size == e.compressed_size);
+  CPPUNIT_ASSERT(f.uncompressed_size == e.uncompressed_size);
+  CPPUNIT_ASSERT(f.local_header_offset == e.local_header_offset);
+  CPPUNIT_ASSERT(f.mode == e.mode);
+  CPPUNIT_ASSERT(f.mtime == e.mtime);
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_entry_is_directory() {
+  archive_entry e;
+  CPPUNIT_ASSERT(!e.is_directory());
+  e.mode = S_IFDIR | 0755;
+  CPPUNIT_ASSERT(e.is_directory());
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_entry_is_symlink() {
+  archive_entry e;
+  CPPUNIT_ASSERT(!e.is_symlink());
+  e.mode = S_IFLNK | 0777;
+  CPPUNIT_ASSERT(e.is_symlink());
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_writer_add_file() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  create_example_tree(tmp_parent / "source");
+  boost::filesystem::path source = tmp_parent / "source" / "workflow" / "results" / "output.tsv";
+  boost::filesystem::permissions(source, boost::filesystem::owner_read | boost::filesystem::owner_exe);
+  boost::filesystem::last_write_time(source, 1600000001);
+  archive_writer aw(tmp_parent / "test.zip");
+  aw.add_file(source, "output.tsv");
+  aw.add_file(tmp_parent / "source" / "workflow" / "results" / "empty.tsv", "empty.tsv");
+  CPPUNIT_ASSERT(aw.entries().size() == 2);
+  CPPUNIT_ASSERT(aw.entries().at(0).method == 8);
+  CPPUNIT_ASSERT(aw.entries().at(0).uncompressed_size == boost::filesystem::file_size(source));
+  // this content is very compressible
+  CPPUNIT_ASSERT(aw.entries().at(0).compressed_size < aw.entries().at(0).uncompressed_size / 4);
+  aw.close();
+  archive_reader ar(tmp_parent / "test.zip");
+  CPPUNIT_ASSERT(ar.entries().size() == 2);
+  ar.extract_entry(ar.entries().at(0), tmp_parent / "output.tsv");
+  ar.extract_entry(ar.entries().at(1), tmp_parent / "empty.tsv");
+  CPPUNIT_ASSERT(!read_file(tmp_parent / "output.tsv").compare(read_file(source)));
+  CPPUNIT_ASSERT(read_file(tmp_parent / "empty.tsv").empty());
+  CPPUNIT_ASSERT(boost::filesystem::status(tmp_parent / "output.tsv").permissions() ==
+                 (boost::filesystem::owner_read | boost::filesystem::owner_exe));
+  CPPUNIT_ASSERT(boost::filesystem::last_write_time(tmp_parent / "output.tsv") == 1600000001);
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_writer_add_file_not_open() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  write_file(tmp_parent / "file.txt", "content");
+  archive_writer aw;
+  aw.add_file(tmp_parent / "file.txt", "file.txt");
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_writer_add_directory() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  boost::filesystem::create_directories(tmp_parent / "dir");
+  archive_writer aw(tmp_parent / "test.zip");
+  aw.add_directory(tmp_parent / "dir", "rule/workspace");
+  aw.close();
+  CPPUNIT_ASSERT(aw.entries().size() == 1);
+  CPPUNIT_ASSERT(!aw.entries().at(0).name.compare("rule/workspace/"));
+  CPPUNIT_ASSERT(aw.entries().at(0).is_directory());
+  CPPUNIT_ASSERT(aw.entries().at(0).uncompressed_size == 0);
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_writer_add_symlink() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  boost::filesystem::create_symlink("target/file.txt", tmp_parent / "link");
+  archive_writer aw(tmp_parent / "test.zip");
+  aw.add_symlink(tmp_parent / "link", "link");
+  aw.close();
+  archive_reader ar(tmp_parent / "test.zip");
+  CPPUNIT_ASSERT(ar.entries().size() == 1);
+  CPPUNIT_ASSERT(ar.entries().at(0).is_symlink());
+  ar.extract_entry(ar.entries().at(0), tmp_parent / "extracted_link");
+  CPPUNIT_ASSERT(boost::filesystem::is_symlink(tmp_parent / "extracted_link"));
+  CPPUNIT_ASSERT(!boost::filesystem::read_symlink(tmp_parent / "extracted_link").string().compare("target/file.txt"));
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_writer_add_tree() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  create_example_tree(tmp_parent / "source");
+  archive_writer aw(tmp_parent / "test.zip");
+  // top directory, two subdirectories, empty directory, three files, one link
+  CPPUNIT_ASSERT(aw.add_tree(tmp_parent / "source", "rule/workspace") == 8);
+  aw.close();
+  CPPUNIT_ASSERT(!aw.entries().at(0).name.compare("rule/workspace/"));
+  // children are added in sorted order
+  CPPUNIT_ASSERT(!aw.entries().at(1).name.compare("rule/workspace/empty_dir/"));
+  CPPUNIT_ASSERT(!aw.entries().at(2).name.compare("rule/workspace/workflow/"));
+  CPPUNIT_ASSERT(!aw.entries().at(3).name.compare("rule/workspace/workflow/Snakefile"));
+  CPPUNIT_ASSERT(!aw.entries().at(4).name.compare("rule/workspace/workflow/link.tsv"));
+  CPPUNIT_ASSERT(aw.entries().at(4).is_symlink());
+  CPPUNIT_ASSERT(!aw.entries().at(5).name.compare("rule/workspace/workflow/results/"));
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_writer_copy_entry() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  create_example_tree(tmp_parent / "source");
+  archive_writer aw1(tmp_parent / "test1.zip");
+  aw1.add_tree(tmp_parent / "source", "rule1");
+  aw1.add_tree(tmp_parent / "source", "rule2");
+  aw1.close();
+  archive_reader ar1(tmp_parent / "test1.zip");
+  archive_writer aw2(tmp_parent / "test2.zip");
+  std::vector<unsigned> rule2 = ar1.find_prefix("rule2/");
+  for (std::vector<unsigned>::const_iterator iter = rule2.begin(); iter != rule2.end(); ++iter) {
+    aw2.copy_entry(ar1, ar1.entries().at(*iter));
+  }
+  aw2.close();
+  archive_reader ar2(tmp_parent / "test2.zip");
+  CPPUNIT_ASSERT(ar2.entries().size() == rule2.size());
+  CPPUNIT_ASSERT(ar2.find_prefix("rule1/").empty());
+  ar2.extract_prefix("rule2/", tmp_parent / "extracted");
+  CPPUNIT_ASSERT(!read_file(tmp_parent / "extracted" / "rule2" / "workflow" / "results" / "output.tsv")
+                      .compare(read_file(tmp_parent / "source" / "workflow" / "results" / "output.tsv")));
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_writer_close_zip64() {
+  // the classic end record can only count 65534 entries
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  boost::filesystem::create_directories(tmp_parent / "dir");
+  archive_writer aw(tmp_parent / "test.zip");
+  for (unsigned i = 0; i < 70000; ++i) {
+    aw.add_directory(tmp_parent / "dir", "dir" + std::to_string(i));
+  }
+  aw.close();
+  archive_reader ar(tmp_parent / "test.zip");
+  CPPUNIT_ASSERT(ar.entries().size() == 70000);
+  CPPUNIT_ASSERT(!ar.entries().at(69999).name.compare("dir69999/"));
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_reader_open_invalid() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  write_file(tmp_parent / "test.zip", "this is not an archive");
+  archive_reader ar(tmp_parent / "test.zip");
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_reader_find_prefix() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  create_example_tree(tmp_parent / "source");
+  archive_writer aw(tmp_parent / "test.zip");
+  aw.add_tree(tmp_parent / "source", "rule1");
+  aw.add_tree(tmp_parent / "source", "rule10");
+  aw.close();
+  archive_reader ar(tmp_parent / "test.zip");
+  CPPUNIT_ASSERT(ar.find_prefix("rule1/").size() == 8);
+  CPPUNIT_ASSERT(ar.find_prefix("rule1").size() == 16);
+  CPPUNIT_ASSERT(ar.find_prefix("rule1/workflow/Snakefile").size() == 1);
+  CPPUNIT_ASSERT(!ar.entries().at(ar.find_prefix("rule10/").at(0)).name.compare("rule10/"));
+  CPPUNIT_ASSERT(ar.find_prefix("rule2/").empty());
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_reader_top_level_names() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  create_example_tree(tmp_parent / "source");
+  archive_writer aw(tmp_parent / "test.zip");
+  aw.add_tree(tmp_parent / "source", "rule1/workspace");
+  aw.add_tree(tmp_parent / "source", "rule2/expected");
+  aw.close();
+  archive_reader ar(tmp_parent / "test.zip");
+  std::map<std::string, bool> names = ar.top_level_names();
+  CPPUNIT_ASSERT(names.size() == 2);
+  CPPUNIT_ASSERT(names.find("rule1") != names.end());
+  CPPUNIT_ASSERT(names.find("rule2") != names.end());
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_reader_extract_prefix() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  create_example_tree(tmp_parent / "source");
+  boost::filesystem::last_write_time(tmp_parent / "source" / "workflow", 1600000002);
+  archive_writer aw(tmp_parent / "test.zip");
+  aw.add_tree(tmp_parent / "source", "rule1");
+  aw.add_tree(tmp_parent / "source", "rule2");
+  aw.close();
+  archive_reader ar(tmp_parent / "test.zip");
+  CPPUNIT_ASSERT(ar.extract_prefix("rule1/", tmp_parent / "extracted") == 8);
+  boost::filesystem::path rule1 = tmp_parent / "extracted" / "rule1";
+  CPPUNIT_ASSERT(!boost::filesystem::exists(tmp_parent / "extracted" / "rule2"));
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(rule1 / "empty_dir"));
+  CPPUNIT_ASSERT(!read_file(rule1 / "workflow" / "Snakefile")
+                      .compare(read_file(tmp_parent / "source" / "workflow" / "Snakefile")));
+  CPPUNIT_ASSERT(read_file(rule1 / "workflow" / "results" / "empty.tsv").empty());
+  CPPUNIT_ASSERT(boost::filesystem::status(rule1 / "workflow" / "results" / "empty.tsv").permissions() ==
+                 (boost::filesystem::owner_read | boost::filesystem::group_read));
+  CPPUNIT_ASSERT(boost::filesystem::is_symlink(rule1 / "workflow" / "link.tsv"));
+  // directory times are restored after their contents are written
+  CPPUNIT_ASSERT(boost::filesystem::last_write_time(rule1 / "workflow") == 1600000002);
+  // extraction over existing, read-only content replaces it
+  CPPUNIT_ASSERT(ar.extract_prefix("rule1/", tmp_parent / "extracted") == 8);
+}
+
+void snakemake_unit_tests::archiveTest::test_archive_reader_extract_entry_corrupt() {
+  boost::filesystem::path tmp_parent = std::string(_tmp_dir);
+  write_file(tmp_parent / "file.txt", "some file content");
+  archive_writer aw(tmp_parent / "test.zip");
+  aw.add_file(tmp_parent / "file.txt", "file.txt");
+  aw.close();
+  archive_reader ar(tmp_parent / "test.zip");
+  archive_entry e(ar.entries().at(0));
+  e.crc ^= 1;
+  ar.extract_entry(e, tmp_parent / "extracted.txt");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::archiveTest);
@@ -0,0 +1,84 @@
+/*!
+  \file archiveTest.h
+  \brief archive test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_ARCHIVETEST_H_
+#define SNAKEMAKE_UNIT_TESTS_ARCHIVETEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/archive.h"
+
+namespace snakemake_unit_tests {
+class archiveTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(archiveTest);
+  CPPUNIT_TEST(test_append_little_endian);
+  CPPUNIT_TEST_EXCEPTION(test_append_little_endian_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_read_little_endian);
+  CPPUNIT_TEST(test_archive_entry_default_constructor);
+  CPPUNIT_TEST(test_archive_entry_copy_constructor);
+  CPPUNIT_TEST(test_archive_entry_is_directory);
+  CPPUNIT_TEST(test_archive_entry_is_symlink);
+  CPPUNIT_TEST(test_archive_writer_add_file);
+  CPPUNIT_TEST_EXCEPTION(test_archive_writer_add_file_not_open, std::logic_error);
+  CPPUNIT_TEST(test_archive_writer_add_directory);
+  CPPUNIT_TEST(test_archive_writer_add_symlink);
+  CPPUNIT_TEST(test_archive_writer_add_tree);
+  CPPUNIT_TEST(test_archive_writer_copy_entry);
+  CPPUNIT_TEST(test_archive_writer_close_zip64);
+  CPPUNIT_TEST_EXCEPTION(test_archive_reader_open_invalid, std::runtime_error);
+  CPPUNIT_TEST(test_archive_reader_find_prefix);
+  CPPUNIT_TEST(test_archive_reader_top_level_names);
+  CPPUNIT_TEST(test_archive_reader_extract_prefix);
+  CPPUNIT_TEST_EXCEPTION(test_archive_reader_extract_entry_corrupt, std::runtime_error);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_append_little_endian();
+  void test_append_little_endian_null_pointer();
+  void test_read_little_endian();
+  void test_archive_entry_default_constructor();
+  void test_archive_entry_copy_constructor();
+  void test_archive_entry_is_directory();
+  void test_archive_entry_is_symlink();
+  void test_archive_writer_add_file();
+  void test_archive_writer_add_file_not_open();
+  void test_archive_writer_add_directory();
+  void test_archive_writer_add_symlink();
+  void test_archive_writer_add_tree();
+  void test_archive_writer_copy_entry();
+  void test_archive_writer_close_zip64();
+  void test_archive_reader_open_invalid();
+  void test_archive_reader_find_prefix();
+  void test_archive_reader_top_level_names();
+  void test_archive_reader_extract_prefix();
+  void test_archive_reader_extract_entry_corrupt();
+
+ private:
+  void write_file(const boost::filesystem::path &p, const std::string &content) const;
+  std::string read_file(const boost::filesystem::path &p) const;
+  void create_example_tree(const boost::filesystem::path &p) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_ARCHIVETEST_H_
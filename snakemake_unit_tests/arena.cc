@@ -0,0 +1,43 @@
+/*!
+  @file arena.cc
+  @brief implementation of string_arena class
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/arena.h"
+
+snakemake_unit_tests::string_arena::string_arena(uint64_t chunk_size)
+    : _chunk_size(chunk_size ? chunk_size : 1), _chunk_remaining(0), _chunk_next(NULL), _bytes_allocated(0) {}
+
+std::string_view snakemake_unit_tests::string_arena::adopt(std::string *contents) {
+  if (!contents) throw std::runtime_error("null pointer provided to string_arena::adopt");
+  _adopted.push_back(std::string());
+  _adopted.back().swap(*contents);
+  _bytes_allocated += _adopted.back().capacity();
+  return std::string_view(_adopted.back().data(), _adopted.back().size());
+}
+
+std::string_view snakemake_unit_tests::string_arena::store(const char *data, uint64_t size) {
+  if (!data && size) throw std::runtime_error("null pointer provided to string_arena::store");
+  if (!size) return std::string_view();
+  if (size > _chunk_remaining) {
+    if (size > _chunk_size / 4) {
+      // large text gets a dedicated chunk, so the partly used chunk stays current
+      _chunks.push_back(std::unique_ptr<char[]>(new char[size]));
+      _bytes_allocated += size;
+      memcpy(_chunks.back().get(), data, size);
+      return std::string_view(_chunks.back().get(), size);
+    }
+    _chunks.push_back(std::unique_ptr<char[]>(new char[_chunk_size]));
+    _bytes_allocated += _chunk_size;
+    _chunk_next = _chunks.back().get();
+    _chunk_remaining = _chunk_size;
+  }
+  char *target = _chunk_next;
+  memcpy(target, data, size);
+  _chunk_next += size;
+  _chunk_remaining -= size;
+  return std::string_view(target, size);
+}
@@ -0,0 +1,160 @@
+/*!
+  @file arena.h
+  @brief append-only storage for parsed snakefile contents
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  a loaded snakefile is owned exactly once, by the arena of the
+  snakemake_file that parsed it. logical lines and rule block contents
+  are string views into that buffer; only text that does not exist
+  verbatim in the file (joined continuation lines, aggregated block
+  bodies) is copied into the arena. nothing is released until the arena
+  itself is destroyed, so views remain valid for the arena's lifetime.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_ARENA_H_
+#define SNAKEMAKE_UNIT_TESTS_ARENA_H_
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace snakemake_unit_tests {
+/*!
+  @class string_arena
+  @brief owner of file buffers and of text derived from them
+ */
+class string_arena {
+ public:
+  /*!
+    @brief constructor
+    @param chunk_size number of bytes reserved at a time for stored text
+   */
+  explicit string_arena(uint64_t chunk_size = 4096);
+  /*!
+    @brief destructor
+   */
+  ~string_arena() throw() {}
+  /*!
+    @brief take ownership of an existing buffer without copying it
+    @param contents buffer to adopt; left empty
+    @return view of the adopted contents
+   */
+  std::string_view adopt(std::string *contents);
+  /*!
+    @brief copy text into the arena
+    @param data start of text
+    @param size number of bytes of text
+    @return view of the stored copy
+   */
+  std::string_view store(const char *data, uint64_t size);
+  /*!
+    @brief copy text into the arena
+    @param s text to copy
+    @return view of the stored copy
+   */
+  std::string_view store(std::string_view s) { return store(s.data(), s.size()); }
+  /*!
+    @brief get the total number of bytes held by the arena
+    @return bytes of adopted buffers plus bytes of reserved chunks
+   */
+  uint64_t bytes_allocated() const { return _bytes_allocated; }
+  /*!
+    @brief get the number of buffers and chunks held by the arena
+    @return number of separate allocations owned by the arena
+   */
+  unsigned allocation_count() const { return _adopted.size() + _chunks.size(); }
+
+ private:
+  friend class arenaTest;
+  /*!
+    @brief copy constructor
+    @param obj existing string_arena object
+    @warning disabled: views would refer to the original
+   */
+  string_arena(const string_arena &obj) { throw std::domain_error("string_arena: do not use copy constructor"); }
+  std::list<std::string> _adopted;               //!< whole buffers owned as-is
+  std::vector<std::unique_ptr<char[]> > _chunks;  //!< storage for copied text
+  uint64_t _chunk_size;                          //!< default size of a new chunk
+  uint64_t _chunk_remaining;                     //!< unused bytes at the end of the last chunk
+  char *_chunk_next;                             //!< first unused byte of the last chunk
+  uint64_t _bytes_allocated;                     //!< total bytes held
+};
+
+/*!
+  @class object_pool
+  @brief contiguous, address-stable storage for many objects of one type
+
+  objects are default constructed in slabs of fixed capacity, so they
+  neither move nor need individual allocations. slab capacity doubles
+  up to a limit, so small files do not reserve much unused space. none
+  are destroyed before the pool itself, apart from the most recent one
+  on request.
+ */
+template <class value_type>
+class object_pool {
+ public:
+  /*!
+    @brief constructor
+    @param slab_size maximum number of objects per slab
+   */
+  explicit object_pool(unsigned slab_size = 256) : _slab_size(slab_size ? slab_size : 1), _size(0) {}
+  /*!
+    @brief destructor
+   */
+  ~object_pool() throw() {}
+  /*!
+    @brief construct a new object in the pool
+    @return pointer to the new object, valid for the pool's lifetime
+   */
+  value_type *allocate() {
+    if (_slabs.empty() || _slabs.back().size() == _slabs.back().capacity()) {
+      unsigned capacity = _slabs.empty() ? 8 : 2 * _slabs.back().capacity();
+      _slabs.push_back(std::vector<value_type>());
+      _slabs.back().reserve(capacity < _slab_size ? capacity : _slab_size);
+    }
+    // capacity is reserved, so earlier objects in the slab do not move
+    _slabs.back().emplace_back();
+    ++_size;
+    return &_slabs.back().back();
+  }
+  /*!
+    @brief destroy the most recently allocated object
+   */
+  void release_last() {
+    if (!_size) throw std::logic_error("object_pool: release_last called on empty pool");
+    _slabs.back().pop_back();
+    if (_slabs.back().empty()) _slabs.pop_back();
+    --_size;
+  }
+  /*!
+    @brief get the number of objects in the pool
+    @return number of objects in the pool
+   */
+  unsigned size() const { return _size; }
+  /*!
+    @brief get the number of slabs in the pool
+    @return number of slabs in the pool
+   */
+  unsigned slab_count() const { return _slabs.size(); }
+
+ private:
+  /*!
+    @brief copy constructor
+    @param obj existing object_pool object
+    @warning disabled: pointers would refer to the original
+   */
+  object_pool(const object_pool &obj) { throw std::domain_error("object_pool: do not use copy constructor"); }
+  std::list<std::vector<value_type> > _slabs;  //!< fixed capacity blocks of objects
+  unsigned _slab_size;                         //!< maximum capacity of a slab
+  unsigned _size;                              //!< number of live objects
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_ARENA_H_
@@ -0,0 +1,102 @@
+/*!
+  \file arenaTest.cc
+  \brief implementation of arena unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/arenaTest.h"
+
+void snakemake_unit_tests::arenaTest::setUp() {}
+
+void snakemake_unit_tests::arenaTest::tearDown() {}
+
+void snakemake_unit_tests::arenaTest::test_string_arena_constructor() {
+  string_arena arena(128);
+  CPPUNIT_ASSERT(arena._adopted.empty());
+  CPPUNIT_ASSERT(arena._chunks.empty());
+  CPPUNIT_ASSERT(arena._chunk_size == 128U);
+  CPPUNIT_ASSERT(!arena._chunk_remaining);
+  CPPUNIT_ASSERT(!arena.bytes_allocated());
+  CPPUNIT_ASSERT(!arena.allocation_count());
+}
+
+void snakemake_unit_tests::arenaTest::test_string_arena_adopt() {
+  string_arena arena;
+  std::string contents = "rule a:\n    shell: 'touch {output}'\n";
+  const char *original = contents.data();
+  std::string_view view = arena.adopt(&contents);
+  // the buffer is taken over, not copied
+  CPPUNIT_ASSERT(contents.empty());
+  CPPUNIT_ASSERT(view.data() == original);
+  CPPUNIT_ASSERT(!view.compare("rule a:\n    shell: 'touch {output}'\n"));
+  CPPUNIT_ASSERT(arena.allocation_count() == 1U);
+}
+
+void snakemake_unit_tests::arenaTest::test_string_arena_adopt_null_pointer() {
+  string_arena arena;
+  arena.adopt(NULL);
+}
+
+void snakemake_unit_tests::arenaTest::test_string_arena_store() {
+  string_arena arena(16);
+  std::string_view first = arena.store("abc"), second = arena.store(std::string("defgh"));
+  CPPUNIT_ASSERT(!first.compare("abc"));
+  CPPUNIT_ASSERT(!second.compare("defgh"));
+  // small stores share a chunk
+  CPPUNIT_ASSERT(second.data() == first.data() + 3);
+  CPPUNIT_ASSERT(arena.allocation_count() == 1U);
+  CPPUNIT_ASSERT(arena.bytes_allocated() == 16U);
+  // large stores get their own chunk, without abandoning the current one
+  std::string_view large = arena.store(std::string(40, 'x'));
+  CPPUNIT_ASSERT(large.size() == 40U);
+  CPPUNIT_ASSERT(arena.allocation_count() == 2U);
+  std::string_view third = arena.store("ij");
+  CPPUNIT_ASSERT(third.data() == second.data() + 5);
+  // a full chunk starts a new one; earlier views are untouched
+  std::string_view fourth = arena.store("klmnopq");
+  CPPUNIT_ASSERT(!fourth.compare("klmnopq"));
+  CPPUNIT_ASSERT(arena.allocation_count() == 3U);
+  CPPUNIT_ASSERT(!first.compare("abc"));
+  CPPUNIT_ASSERT(!third.compare("ij"));
+  CPPUNIT_ASSERT(arena.store(NULL, 0).empty());
+  CPPUNIT_ASSERT_THROW(arena.store(NULL, 1), std::runtime_error);
+}
+
+void snakemake_unit_tests::arenaTest::test_object_pool_allocate() {
+  object_pool<std::string> pool(2);
+  std::vector<std::string *> allocated;
+  for (unsigned i = 0; i < 5; ++i) {
+    allocated.push_back(pool.allocate());
+    *allocated.back() = std::to_string(i);
+  }
+  CPPUNIT_ASSERT(pool.size() == 5U);
+  CPPUNIT_ASSERT(pool.slab_count() == 3U);
+  // objects do not move as the pool grows
+  for (unsigned i = 0; i < 5; ++i) {
+    CPPUNIT_ASSERT(!allocated.at(i)->compare(std::to_string(i)));
+  }
+  CPPUNIT_ASSERT(allocated.at(1) == allocated.at(0) + 1);
+}
+
+void snakemake_unit_tests::arenaTest::test_object_pool_release_last() {
+  object_pool<std::string> pool(2);
+  std::string *first = pool.allocate();
+  *first = "kept";
+  pool.allocate();
+  pool.allocate();
+  CPPUNIT_ASSERT(pool.slab_count() == 2U);
+  pool.release_last();
+  CPPUNIT_ASSERT(pool.size() == 2U);
+  CPPUNIT_ASSERT(pool.slab_count() == 1U);
+  pool.release_last();
+  CPPUNIT_ASSERT(pool.size() == 1U);
+  CPPUNIT_ASSERT(!first->compare("kept"));
+}
+
+void snakemake_unit_tests::arenaTest::test_object_pool_release_last_empty() {
+  object_pool<std::string> pool;
+  pool.release_last();
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::arenaTest);
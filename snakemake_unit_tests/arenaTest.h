@@ -0,0 +1,50 @@
+/*!
+  \file arenaTest.h
+  \brief arena test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_ARENATEST_H_
+#define SNAKEMAKE_UNIT_TESTS_ARENATEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "snakemake_unit_tests/arena.h"
+
+namespace snakemake_unit_tests {
+class arenaTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(arenaTest);
+  CPPUNIT_TEST(test_string_arena_constructor);
+  CPPUNIT_TEST(test_string_arena_adopt);
+  CPPUNIT_TEST_EXCEPTION(test_string_arena_adopt_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_string_arena_store);
+  CPPUNIT_TEST(test_object_pool_allocate);
+  CPPUNIT_TEST(test_object_pool_release_last);
+  CPPUNIT_TEST_EXCEPTION(test_object_pool_release_last_empty, std::logic_error);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_string_arena_constructor();
+  void test_string_arena_adopt();
+  void test_string_arena_adopt_null_pointer();
+  void test_string_arena_store();
+  void test_object_pool_allocate();
+  void test_object_pool_release_last();
+  void test_object_pool_release_last_empty();
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_ARENATEST_H_
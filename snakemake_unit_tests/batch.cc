@@ -0,0 +1,156 @@
+/*!
+  @file batch.cc
+  @brief implementation of batch and line_prefix_buffer classes
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/batch.h"
+
+// label of lines written by this thread, while a line_prefix_buffer is installed
+static thread_local std::string thread_prefix;
+
+snakemake_unit_tests::line_prefix_buffer::line_prefix_buffer(std::ostream *stream, std::mutex *lock)
+    : _stream(stream), _target(0), _lock(lock) {
+  if (!stream || !lock) throw std::runtime_error("null pointer provided to line_prefix_buffer constructor");
+  _target = _stream->rdbuf(this);
+}
+
+snakemake_unit_tests::line_prefix_buffer::~line_prefix_buffer() throw() {
+  flush_thread();
+  _stream->rdbuf(_target);
+}
+
+void snakemake_unit_tests::line_prefix_buffer::set_prefix(const std::string &prefix) { thread_prefix = prefix; }
+
+void snakemake_unit_tests::line_prefix_buffer::flush_thread() {
+  std::string &held = pending();
+  if (!held.empty()) write_labeled(held);
+  held.clear();
+}
+
+std::string &snakemake_unit_tests::line_prefix_buffer::pending() {
+  // one buffer per stream and thread, so lines from std::cout and std::cerr stay apart
+  static thread_local std::map<const line_prefix_buffer *, std::string> held;
+  return held[this];
+}
+
+void snakemake_unit_tests::line_prefix_buffer::write_labeled(const std::string &text) {
+  std::lock_guard<std::mutex> lock(*_lock);
+  std::string::size_type start = 0;
+  while (start < text.size()) {
+    std::string::size_type end = text.find('\n', start);
+    end = end == std::string::npos ? text.size() : end + 1;
+    _target->sputn(thread_prefix.data(), thread_prefix.size());
+    _target->sputn(text.data() + start, end - start);
+    start = end;
+  }
+}
+
+snakemake_unit_tests::line_prefix_buffer::int_type snakemake_unit_tests::line_prefix_buffer::overflow(int_type c) {
+  if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+  std::string &held = pending();
+  held += traits_type::to_char_type(c);
+  if (traits_type::to_char_type(c) == '\n') {
+    write_labeled(held);
+    held.clear();
+  }
+  return c;
+}
+
+std::streamsize snakemake_unit_tests::line_prefix_buffer::xsputn(const char *s, std::streamsize n) {
+  std::string &held = pending();
+  held.append(s, n);
+  std::string::size_type last_newline = held.rfind('\n');
+  if (last_newline != std::string::npos) {
+    write_labeled(held.substr(0, last_newline + 1));
+    held.erase(0, last_newline + 1);
+  }
+  return n;
+}
+
+int snakemake_unit_tests::line_prefix_buffer::sync() {
+  // incomplete lines are held back, so other threads cannot split them
+  std::lock_guard<std::mutex> lock(*_lock);
+  return _target->pubsync();
+}
+
+snakemake_unit_tests::batch::batch(const boost::filesystem::path &filename) : _filename(filename) {
+  if (!boost::filesystem::is_regular_file(filename))
+    throw std::runtime_error("batch manifest \"" + filename.string() + "\" is not a regular file");
+  yaml_reader manifest(filename.string());
+  if (!manifest.query_valid("configs"))
+    throw std::runtime_error("batch manifest \"" + filename.string() + "\" does not list any \"configs\"");
+  std::vector<std::string> configs = manifest.get_sequence("configs");
+  for (std::vector<std::string>::const_iterator iter = configs.begin(); iter != configs.end(); ++iter) {
+    boost::filesystem::path config(*iter);
+    _configs.push_back(config.is_absolute() ? config : filename.parent_path() / config);
+  }
+  if (_configs.empty())
+    throw std::runtime_error("batch manifest \"" + filename.string() + "\" does not list any \"configs\"");
+}
+
+unsigned snakemake_unit_tests::batch::concurrent_pipelines(unsigned n_pipelines, unsigned n_threads, bool verbose) {
+  // verbose logging is only readable one pipeline at a time
+  if (verbose) return n_pipelines ? 1 : 0;
+  unsigned budget = n_threads ? n_threads : std::thread::hardware_concurrency();
+  return std::min(n_pipelines, std::max(budget, 1u));
+}
+
+void snakemake_unit_tests::batch::run(const std::vector<params> &pipelines, unsigned n_threads, bool verbose,
+                                      const std::function<void(const params &)> &generate,
+                                      std::ostream &out) const {
+  unsigned n_concurrent = concurrent_pipelines(pipelines.size(), n_threads, verbose);
+  if (!n_concurrent) return;
+  unsigned budget = n_threads ? n_threads : std::thread::hardware_concurrency();
+  unsigned threads_per_pipeline = std::max(budget / n_concurrent, 1u);
+  std::vector<std::string> failures(pipelines.size());
+  std::function<void(unsigned)> generate_one = [&pipelines, &generate, &failures,
+                                                threads_per_pipeline](unsigned index) {
+    params p(pipelines.at(index));
+    p.threads = threads_per_pipeline;
+    // one failed pipeline should not cost the others their tests
+    try {
+      generate(p);
+    } catch (const std::exception &e) {
+      failures.at(index) = e.what();
+      std::cerr << "error: " << e.what() << std::endl;
+    } catch (...) {
+      failures.at(index) = "unknown error";
+      std::cerr << "error: unknown error" << std::endl;
+    }
+  };
+  if (n_concurrent == 1) {
+    for (unsigned i = 0; i < pipelines.size(); ++i) {
+      out << "processing pipeline \"" << pipelines.at(i).config_filename.string() << "\"" << std::endl;
+      generate_one(i);
+    }
+  } else {
+    std::mutex output_lock;
+    line_prefix_buffer labeled_out(&std::cout, &output_lock), labeled_err(&std::cerr, &output_lock);
+    // the pool is declared last, so every pipeline finishes before the streams are restored
+    thread_pool pool(n_concurrent);
+    for (unsigned i = 0; i < pipelines.size(); ++i) {
+      pool.submit([i, &pipelines, &generate_one, &labeled_out, &labeled_err]() {
+        line_prefix_buffer::set_prefix("[" + pipelines.at(i).config_filename.string() + "] ");
+        generate_one(i);
+        labeled_out.flush_thread();
+        labeled_err.flush_thread();
+        line_prefix_buffer::set_prefix("");
+      });
+    }
+    pool.wait();
+  }
+  std::string failed;
+  unsigned n_failed = 0;
+  for (unsigned i = 0; i < failures.size(); ++i) {
+    if (failures.at(i).empty()) continue;
+    ++n_failed;
+    out << "pipeline \"" << pipelines.at(i).config_filename.string() << "\" failed: " << failures.at(i) << std::endl;
+    failed += (failed.empty() ? "\"" : ", \"") + pipelines.at(i).config_filename.string() + "\"";
+  }
+  if (n_failed)
+    throw std::runtime_error(std::to_string(n_failed) + " of " + std::to_string(pipelines.size()) +
+                             " pipeline(s) in batch \"" + _filename.string() + "\" failed: " + failed);
+}
@@ -0,0 +1,178 @@
+/*!
+  @file batch.h
+  @brief generation of tests for several pipelines in one run
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  a repository with many pipelines would otherwise start the program once
+  per pipeline, and each run would mostly wait on its own snakemake
+  subprocesses. a batch lists the configuration files of every pipeline,
+  and runs the pipelines side by side in one process, dividing a single
+  thread budget between them.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_BATCH_H_
+#define SNAKEMAKE_UNIT_TESTS_BATCH_H_
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/cargs.h"
+#include "snakemake_unit_tests/thread_pool.h"
+#include "snakemake_unit_tests/yaml_reader.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @class line_prefix_buffer
+  @brief stream buffer that writes whole lines, labeled by the thread that wrote them
+
+  while installed, output sent to the stream is held per thread until a
+  line is complete, and each line is written to the original buffer at once,
+  after the writing thread's prefix. concurrent pipelines can then log as
+  they always have, without their lines interleaving.
+ */
+class line_prefix_buffer : public std::streambuf {
+ public:
+  /*!
+    @brief constructor: install the buffer on a stream
+    @param stream stream whose output is labeled, e.g. std::cout
+    @param lock mutex held while writing to any stream sharing it
+   */
+  line_prefix_buffer(std::ostream *stream, std::mutex *lock);
+  /*!
+    @brief destructor: restore the original buffer of the stream
+   */
+  ~line_prefix_buffer() throw();
+  /*!
+    @brief set the label of lines written by the calling thread
+    @param prefix text to write before each line; empty for none
+   */
+  static void set_prefix(const std::string &prefix);
+  /*!
+    @brief write any incomplete line held for the calling thread
+   */
+  void flush_thread();
+
+ protected:
+  /*!
+    @brief accept one character
+    @param c character to write
+    @return c, or eof on failure
+   */
+  int_type overflow(int_type c);
+  /*!
+    @brief accept a run of characters
+    @param s characters to write
+    @param n number of characters
+    @return number of characters accepted
+   */
+  std::streamsize xsputn(const char *s, std::streamsize n);
+  /*!
+    @brief flush the original buffer
+    @return 0 on success, -1 otherwise
+   */
+  int sync();
+
+ private:
+  friend class batchTest;
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  line_prefix_buffer() { throw std::domain_error("line_prefix_buffer: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing line_prefix_buffer object
+    @warning disabled
+   */
+  line_prefix_buffer(const line_prefix_buffer &obj) {
+    throw std::domain_error("line_prefix_buffer: do not use copy constructor");
+  }
+  /*!
+    @brief get the calling thread's incomplete line
+    @return held output of the calling thread
+   */
+  std::string &pending();
+  /*!
+    @brief write text to the original buffer, after the calling thread's prefix
+    @param text complete line(s), or the final partial line
+   */
+  void write_labeled(const std::string &text);
+  std::ostream *_stream;    //!< stream on which the buffer is installed
+  std::streambuf *_target;  //!< original buffer of the stream
+  std::mutex *_lock;        //!< serializes writes to the original buffer
+};
+/*!
+  @class batch
+  @brief manifest of pipelines to process together
+ */
+class batch {
+ public:
+  /*!
+    @brief constructor: load a manifest
+    @param filename yaml file listing configuration files under 'configs'
+
+    relative configuration file names are relative to the manifest
+   */
+  explicit batch(const boost::filesystem::path &filename);
+  /*!
+    @brief destructor
+   */
+  ~batch() throw() {}
+  /*!
+    @brief get the configuration file of each pipeline
+    @return configuration file of each pipeline, in manifest order
+   */
+  const std::vector<boost::filesystem::path> &get_configs() const { return _configs; }
+  /*!
+    @brief generate tests for every pipeline
+    @param pipelines resolved settings of each pipeline
+    @param n_threads total number of threads; 0 means one per available core
+    @param verbose whether verbose logging is on; pipelines then run one at a time
+    @param generate function generating the tests of one pipeline
+    @param out where to report which pipelines failed
+
+    pipelines run concurrently, each with an equal share of n_threads. a
+    pipeline that fails does not stop the others; once all have finished,
+    the failures are reported and the batch fails.
+   */
+  void run(const std::vector<params> &pipelines, unsigned n_threads, bool verbose,
+           const std::function<void(const params &)> &generate, std::ostream &out) const;
+  /*!
+    @brief decide how many pipelines to run at once
+    @param n_pipelines number of pipelines
+    @param n_threads total number of threads; 0 means one per available core
+    @param verbose whether verbose logging is on
+    @return number of pipelines to run at once
+   */
+  static unsigned concurrent_pipelines(unsigned n_pipelines, unsigned n_threads, bool verbose);
+
+ private:
+  friend class batchTest;
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  batch() { throw std::domain_error("batch: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing batch object
+    @warning disabled
+   */
+  batch(const batch &obj) { throw std::domain_error("batch: do not use copy constructor"); }
+  boost::filesystem::path _filename;              //!< manifest file
+  std::vector<boost::filesystem::path> _configs;  //!< configuration file of each pipeline
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_BATCH_H_
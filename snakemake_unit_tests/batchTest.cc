@@ -0,0 +1,223 @@
+/*!
+  \file batchTest.cc
+  \brief implementation of batch unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/batchTest.h"
+
+void snakemake_unit_tests::batchTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutBATXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("batchTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::batchTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+snakemake_unit_tests::params snakemake_unit_tests::batchTest::pipeline(const std::string &config_filename) const {
+  params p;
+  p.config_filename = config_filename;
+  return p;
+}
+
+void snakemake_unit_tests::batchTest::test_line_prefix_buffer_constructor() {
+  std::ostringstream stream;
+  std::ostream &as_ostream = stream;
+  std::streambuf *original = as_ostream.rdbuf();
+  std::mutex lock;
+  {
+    line_prefix_buffer buffer(&stream, &lock);
+    CPPUNIT_ASSERT(as_ostream.rdbuf() == &buffer);
+    CPPUNIT_ASSERT(buffer._target == original);
+    stream << "line" << std::endl;
+  }
+  // the destructor puts the original buffer back
+  CPPUNIT_ASSERT(as_ostream.rdbuf() == original);
+  stream << "after";
+  CPPUNIT_ASSERT_EQUAL(std::string("line\nafter"), stream.str());
+}
+
+void snakemake_unit_tests::batchTest::test_line_prefix_buffer_constructor_null_pointer() {
+  std::mutex lock;
+  line_prefix_buffer buffer(NULL, &lock);
+}
+
+void snakemake_unit_tests::batchTest::test_line_prefix_buffer_set_prefix() {
+  std::ostringstream stream;
+  std::mutex lock;
+  {
+    line_prefix_buffer buffer(&stream, &lock);
+    line_prefix_buffer::set_prefix("[a] ");
+    stream << "first" << ' ' << 1 << '\n' << "second\nthird" << std::endl;
+    line_prefix_buffer::set_prefix("");
+    stream << "unlabeled" << std::endl;
+  }
+  CPPUNIT_ASSERT_EQUAL(std::string("[a] first 1\n[a] second\n[a] third\nunlabeled\n"), stream.str());
+}
+
+void snakemake_unit_tests::batchTest::test_line_prefix_buffer_flush_thread() {
+  std::ostringstream stream;
+  std::mutex lock;
+  line_prefix_buffer buffer(&stream, &lock);
+  line_prefix_buffer::set_prefix("[b] ");
+  stream << "partial" << std::flush;
+  // incomplete lines are held until they end or the thread is flushed
+  CPPUNIT_ASSERT(stream.str().empty());
+  buffer.flush_thread();
+  CPPUNIT_ASSERT_EQUAL(std::string("[b] partial"), stream.str());
+  buffer.flush_thread();
+  CPPUNIT_ASSERT_EQUAL(std::string("[b] partial"), stream.str());
+  line_prefix_buffer::set_prefix("");
+}
+
+void snakemake_unit_tests::batchTest::test_line_prefix_buffer_concurrent_lines() {
+  std::ostringstream stream;
+  std::mutex lock;
+  {
+    line_prefix_buffer buffer(&stream, &lock);
+    std::vector<std::thread> writers;
+    for (unsigned i = 0; i < 4; ++i) {
+      writers.push_back(std::thread([i, &stream, &buffer]() {
+        line_prefix_buffer::set_prefix("[" + std::to_string(i) + "] ");
+        for (unsigned j = 0; j < 200; ++j) {
+          stream << "line " << j << " of writer " << i << std::endl;
+        }
+        buffer.flush_thread();
+      }));
+    }
+    for (std::vector<std::thread>::iterator iter = writers.begin(); iter != writers.end(); ++iter) {
+      iter->join();
+    }
+  }
+  // every line is whole, and labeled by the thread that wrote it
+  std::istringstream lines(stream.str());
+  std::string line;
+  std::map<std::string, unsigned> counts;
+  while (std::getline(lines, line)) {
+    std::string writer = line.substr(1, line.find(']') - 1);
+    std::string expected = "[" + writer + "] line " + std::to_string(counts[writer]) + " of writer " + writer;
+    CPPUNIT_ASSERT_EQUAL(expected, line);
+    ++counts[writer];
+  }
+  CPPUNIT_ASSERT(counts.size() == 4);
+  for (std::map<std::string, unsigned>::const_iterator iter = counts.begin(); iter != counts.end(); ++iter) {
+    CPPUNIT_ASSERT(iter->second == 200U);
+  }
+}
+
+void snakemake_unit_tests::batchTest::test_batch_constructor() {
+  boost::filesystem::path manifest_path = boost::filesystem::path(_tmp_dir) / "batch.yaml";
+  std::ofstream output(manifest_path.string().c_str());
+  output << "configs:\n  - pipelines/a/config.yaml\n  - /abs/b/config.yaml" << std::endl;
+  output.close();
+  batch b(manifest_path);
+  CPPUNIT_ASSERT(b._filename == manifest_path);
+  // relative entries are relative to the manifest
+  CPPUNIT_ASSERT(b.get_configs().size() == 2);
+  CPPUNIT_ASSERT(b.get_configs().at(0) == boost::filesystem::path(_tmp_dir) / "pipelines/a/config.yaml");
+  CPPUNIT_ASSERT(b.get_configs().at(1) == boost::filesystem::path("/abs/b/config.yaml"));
+}
+
+void snakemake_unit_tests::batchTest::test_batch_constructor_missing_manifest() {
+  batch b(boost::filesystem::path(_tmp_dir) / "missing.yaml");
+}
+
+void snakemake_unit_tests::batchTest::test_batch_constructor_no_configs() {
+  boost::filesystem::path manifest_path = boost::filesystem::path(_tmp_dir) / "batch.yaml";
+  std::ofstream output(manifest_path.string().c_str());
+  output << "pipelines:\n  - config.yaml" << std::endl;
+  output.close();
+  batch b(manifest_path);
+}
+
+void snakemake_unit_tests::batchTest::test_batch_concurrent_pipelines() {
+  CPPUNIT_ASSERT(batch::concurrent_pipelines(10, 4, false) == 4U);
+  CPPUNIT_ASSERT(batch::concurrent_pipelines(3, 8, false) == 3U);
+  CPPUNIT_ASSERT(batch::concurrent_pipelines(3, 8, true) == 1U);
+  CPPUNIT_ASSERT(batch::concurrent_pipelines(0, 8, false) == 0U);
+  CPPUNIT_ASSERT(batch::concurrent_pipelines(2, 0, false) >= 1U);
+}
+
+void snakemake_unit_tests::batchTest::test_batch_run() {
+  boost::filesystem::path manifest_path = boost::filesystem::path(_tmp_dir) / "batch.yaml";
+  std::ofstream output(manifest_path.string().c_str());
+  output << "configs:\n  - a.yaml\n  - b.yaml" << std::endl;
+  output.close();
+  batch b(manifest_path);
+  std::vector<params> pipelines;
+  pipelines.push_back(pipeline("a.yaml"));
+  pipelines.push_back(pipeline("b.yaml"));
+  std::mutex lock;
+  std::map<std::string, unsigned> threads;
+  std::ostringstream out;
+  // the thread budget is divided between the pipelines running at once
+  b.run(
+      pipelines, 4, false,
+      [&lock, &threads](const params &p) {
+        std::lock_guard<std::mutex> guard(lock);
+        threads[p.config_filename.string()] = p.threads;
+      },
+      out);
+  CPPUNIT_ASSERT(threads.size() == 2);
+  CPPUNIT_ASSERT(threads["a.yaml"] == 2U);
+  CPPUNIT_ASSERT(threads["b.yaml"] == 2U);
+  CPPUNIT_ASSERT(out.str().empty());
+}
+
+void snakemake_unit_tests::batchTest::test_batch_run_verbose() {
+  boost::filesystem::path manifest_path = boost::filesystem::path(_tmp_dir) / "batch.yaml";
+  std::ofstream output(manifest_path.string().c_str());
+  output << "configs:\n  - a.yaml\n  - b.yaml" << std::endl;
+  output.close();
+  batch b(manifest_path);
+  std::vector<params> pipelines;
+  pipelines.push_back(pipeline("a.yaml"));
+  pipelines.push_back(pipeline("b.yaml"));
+  std::vector<std::string> order;
+  std::ostringstream out;
+  // verbose pipelines run one at a time, in manifest order, with every thread
+  b.run(
+      pipelines, 4, true,
+      [&order](const params &p) { order.push_back(p.config_filename.string() + ":" + std::to_string(p.threads)); },
+      out);
+  CPPUNIT_ASSERT(order.size() == 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("a.yaml:4"), order.at(0));
+  CPPUNIT_ASSERT_EQUAL(std::string("b.yaml:4"), order.at(1));
+  CPPUNIT_ASSERT_EQUAL(std::string("processing pipeline \"a.yaml\"\nprocessing pipeline \"b.yaml\"\n"), out.str());
+}
+
+void snakemake_unit_tests::batchTest::test_batch_run_failure() {
+  boost::filesystem::path manifest_path = boost::filesystem::path(_tmp_dir) / "batch.yaml";
+  std::ofstream output(manifest_path.string().c_str());
+  output << "configs:\n  - a.yaml\n  - b.yaml\n  - c.yaml" << std::endl;
+  output.close();
+  batch b(manifest_path);
+  std::vector<params> pipelines;
+  pipelines.push_back(pipeline("a.yaml"));
+  pipelines.push_back(pipeline("b.yaml"));
+  pipelines.push_back(pipeline("c.yaml"));
+  std::mutex lock;
+  std::vector<std::string> completed;
+  std::ostringstream out;
+  std::function<void(const params &)> generate = [&lock, &completed](const params &p) {
+    if (!p.config_filename.string().compare("b.yaml")) throw std::logic_error("b is broken");
+    std::lock_guard<std::mutex> guard(lock);
+    completed.push_back(p.config_filename.string());
+  };
+  // the other pipelines still finish, and the batch fails afterwards
+  CPPUNIT_ASSERT_THROW(b.run(pipelines, 3, false, generate, out), std::runtime_error);
+  CPPUNIT_ASSERT(completed.size() == 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("pipeline \"b.yaml\" failed: b is broken\n"), out.str());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::batchTest);
@@ -0,0 +1,71 @@
+/*!
+  \file batchTest.h
+  \brief batch test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_BATCHTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_BATCHTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/batch.h"
+
+namespace snakemake_unit_tests {
+class batchTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(batchTest);
+  CPPUNIT_TEST(test_line_prefix_buffer_constructor);
+  CPPUNIT_TEST_EXCEPTION(test_line_prefix_buffer_constructor_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_line_prefix_buffer_set_prefix);
+  CPPUNIT_TEST(test_line_prefix_buffer_flush_thread);
+  CPPUNIT_TEST(test_line_prefix_buffer_concurrent_lines);
+  CPPUNIT_TEST(test_batch_constructor);
+  CPPUNIT_TEST_EXCEPTION(test_batch_constructor_missing_manifest, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_batch_constructor_no_configs, std::runtime_error);
+  CPPUNIT_TEST(test_batch_concurrent_pipelines);
+  CPPUNIT_TEST(test_batch_run);
+  CPPUNIT_TEST(test_batch_run_verbose);
+  CPPUNIT_TEST(test_batch_run_failure);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_line_prefix_buffer_constructor();
+  void test_line_prefix_buffer_constructor_null_pointer();
+  void test_line_prefix_buffer_set_prefix();
+  void test_line_prefix_buffer_flush_thread();
+  void test_line_prefix_buffer_concurrent_lines();
+  void test_batch_constructor();
+  void test_batch_constructor_missing_manifest();
+  void test_batch_constructor_no_configs();
+  void test_batch_concurrent_pipelines();
+  void test_batch_run();
+  void test_batch_run_verbose();
+  void test_batch_run_failure();
+
+ private:
+  params pipeline(const std::string &config_filename) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_BATCHTEST_H_
@@ -0,0 +1,439 @@
+/*!
+  \file benchmark_suite.cc
+  \brief time performance-sensitive components of snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+
+  build with `make benchmark_suite.out`. with no arguments, a synthetic
+  snakefile is generated; otherwise each named file is timed. every
+  benchmark also checks that the compared implementations agree.
+ */
+
+#include <malloc.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "boost/regex.hpp"
+#include "boost/shared_ptr.hpp"
+#include "snakemake_unit_tests/recognizers.h"
+#include "snakemake_unit_tests/parse_cache.h"
+#include "snakemake_unit_tests/rule_registry.h"
+#include "snakemake_unit_tests/snakemake_file.h"
+#include "snakemake_unit_tests/utilities.h"
+
+/*!
+  @brief heap use by the whole process, tracked by the operators below
+ */
+struct heap_counters {
+  uint64_t allocations;    //!< number of calls to operator new
+  uint64_t current_bytes;  //!< bytes currently allocated
+  uint64_t peak_bytes;     //!< high water mark of current_bytes
+};
+static heap_counters heap = {0, 0, 0};
+
+void *operator new(std::size_t size) {
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) throw std::bad_alloc();
+  ++heap.allocations;
+  heap.current_bytes += malloc_usable_size(ptr);
+  if (heap.current_bytes > heap.peak_bytes) heap.peak_bytes = heap.current_bytes;
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+  if (!ptr) return;
+  heap.current_bytes -= malloc_usable_size(ptr);
+  free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t size) noexcept { operator delete(ptr); }
+
+/*!
+  @brief create a large snakefile-like buffer exercising every lexer feature
+  @param n_rules number of rule blocks to emit
+  @return synthetic file contents
+ */
+std::string synthesize_snakefile(unsigned n_rules) {
+  std::ostringstream out;
+  out << "#!/usr/bin/env snakemake\n\nconfigfile: \"config/config.yaml\"\n\n";
+  for (unsigned i = 0; i < n_rules; ++i) {
+    out << "rule rule" << i << ":\n"
+        << "    \"\"\"\n    docstring for rule " << i << "\n    with 'embedded' \"quotes\" and # marks\n    \"\"\"\n"
+        << "    input:\n        \"results/{sample}/input" << i << ".tsv\",  # the input\n"
+        << "        lambda wildcards: config[\"samples\"][wildcards.sample]['path'],\n"
+        << "    output:\n        \"results/{sample}/output" << i << ".tsv\",\n"
+        << "    params:\n        extra=\"--flag value \" \\\n        \"--other 'quoted \\\\' value'\",\n"
+        << "    threads: 4\n"
+        << "    shell:\n        \"command {input} > {output} \"\n        \"&& echo done # not a comment\"\n\n";
+    if (i % 10 == 9) {
+      out << "use rule rule" << i << " as derived" << i << " with:\n    threads: 2\n\n"
+          << "include: \"rules/module" << i << ".smk\"\n\n";
+    }
+  }
+  return out.str();
+}
+
+/*!
+  @brief split a buffer into lines the way snakemake_file::load_lines does
+  @param buffer file contents
+  @return newline-delimited lines
+ */
+std::vector<std::string> split_lines(const std::string &buffer) {
+  std::vector<std::string> lines;
+  std::istringstream input(buffer);
+  std::string line = "";
+  while (input.peek() != EOF) {
+    getline(input, line);
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+/*!
+  @brief compare line-based and buffer-based lexical parsing of one input
+  @param label name of input for reporting
+  @param buffer input contents
+  @param iterations number of repetitions of each parser
+  @return whether the parsers agree
+ */
+bool benchmark_lexical_parse(const std::string &label, const std::string &buffer, unsigned iterations) {
+  std::vector<std::string> line_result, buffer_result;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < iterations; ++i) {
+    line_result = snakemake_unit_tests::lexical_parse(split_lines(buffer));
+  }
+  std::chrono::duration<double> line_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < iterations; ++i) {
+    buffer_result = snakemake_unit_tests::lexical_parse(buffer.data(), buffer.size());
+  }
+  std::chrono::duration<double> buffer_time = std::chrono::steady_clock::now() - start;
+  double megabytes = static_cast<double>(buffer.size()) * iterations / 1048576.0;
+  std::cout << std::fixed << std::setprecision(1) << "lexical_parse\t" << label << "\t" << buffer.size() << " bytes\t"
+            << line_result.size() << " logical lines" << std::endl
+            << "\tline-based:   " << megabytes / line_time.count() << " MiB/s" << std::endl
+            << "\tbuffer-based: " << megabytes / buffer_time.count() << " MiB/s" << std::endl;
+  if (line_result != buffer_result) {
+    std::cout << "\tERROR: parser results differ" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/*!
+  @brief tally of declarations found by one matching strategy
+ */
+struct declaration_counts {
+  unsigned rules;     //!< rule and checkpoint declarations
+  unsigned derived;   //!< use rule declarations
+  unsigned blocks;    //!< named block headers at rule indentation
+  unsigned includes;  //!< include directives
+  declaration_counts() : rules(0), derived(0), blocks(0), includes(0) {}
+  bool operator==(const declaration_counts &obj) const {
+    return rules == obj.rules && derived == obj.derived && blocks == obj.blocks && includes == obj.includes;
+  }
+};
+
+/*!
+  @brief classify lines with regular expressions
+  @param lines logical lines from lexical_parse
+  @param counts tally of matches
+  @param precompiled whether to reuse one set of regexes; otherwise each
+  line constructs its own, as rule_block did at every call site
+ */
+void count_with_regex(const std::vector<std::string> &lines, declaration_counts *counts, bool precompiled) {
+  const boost::regex rule_shared("^( *)rule ([^ ]+):.*$"), checkpoint_shared("^( *)checkpoint ([^ ]+):.*$"),
+      derived_shared("^( *)use rule ([^ ]+) as ([^ ]+) with:.*$"), block_shared("^    ([a-zA-Z_\\-]+):(.*)$"),
+      include_shared("^( *)include: *(.*[^ ]) *$");
+  boost::smatch result;
+  for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter) {
+    if (precompiled) {
+      if (boost::regex_match(*iter, result, rule_shared) || boost::regex_match(*iter, result, checkpoint_shared)) {
+        ++counts->rules;
+      } else if (boost::regex_match(*iter, result, derived_shared)) {
+        ++counts->derived;
+      } else if (boost::regex_match(*iter, result, block_shared)) {
+        ++counts->blocks;
+      } else if (boost::regex_match(*iter, result, include_shared)) {
+        ++counts->includes;
+      }
+    } else {
+      const boost::regex rule("^( *)rule ([^ ]+):.*$"), checkpoint("^( *)checkpoint ([^ ]+):.*$"),
+          derived("^( *)use rule ([^ ]+) as ([^ ]+) with:.*$"), block("^    ([a-zA-Z_\\-]+):(.*)$"),
+          include("^( *)include: *(.*[^ ]) *$");
+      if (boost::regex_match(*iter, result, rule) || boost::regex_match(*iter, result, checkpoint)) {
+        ++counts->rules;
+      } else if (boost::regex_match(*iter, result, derived)) {
+        ++counts->derived;
+      } else if (boost::regex_match(*iter, result, block)) {
+        ++counts->blocks;
+      } else if (boost::regex_match(*iter, result, include)) {
+        ++counts->includes;
+      }
+    }
+  }
+}
+
+/*!
+  @brief classify lines with the hand-written recognizers
+  @param lines logical lines from lexical_parse
+  @param counts tally of matches
+ */
+void count_with_recognizers(const std::vector<std::string> &lines, declaration_counts *counts) {
+  unsigned indentation = 0;
+  std::string_view first, second;
+  for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter) {
+    if (snakemake_unit_tests::match_rule_declaration(*iter, "rule", &indentation, &first) ||
+        snakemake_unit_tests::match_rule_declaration(*iter, "checkpoint", &indentation, &first)) {
+      ++counts->rules;
+    } else if (snakemake_unit_tests::match_derived_rule_declaration(*iter, &indentation, &first, &second)) {
+      ++counts->derived;
+    } else if (snakemake_unit_tests::match_named_block_header(*iter, 4, &first, &second)) {
+      ++counts->blocks;
+    } else if (snakemake_unit_tests::match_include_directive(*iter, &first)) {
+      ++counts->includes;
+    }
+  }
+}
+
+/*!
+  @brief compare regex and recognizer classification of one input
+  @param label name of input for reporting
+  @param buffer input contents
+  @param iterations number of repetitions of each strategy
+  @return whether the strategies agree
+ */
+bool benchmark_recognizers(const std::string &label, const std::string &buffer, unsigned iterations) {
+  std::vector<std::string> lines = snakemake_unit_tests::lexical_parse(buffer.data(), buffer.size());
+  declaration_counts per_call, precompiled, recognized;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < iterations; ++i) {
+    per_call = declaration_counts();
+    count_with_regex(lines, &per_call, false);
+  }
+  std::chrono::duration<double> per_call_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < iterations; ++i) {
+    precompiled = declaration_counts();
+    count_with_regex(lines, &precompiled, true);
+  }
+  std::chrono::duration<double> precompiled_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < iterations; ++i) {
+    recognized = declaration_counts();
+    count_with_recognizers(lines, &recognized);
+  }
+  std::chrono::duration<double> recognized_time = std::chrono::steady_clock::now() - start;
+  double n_lines = static_cast<double>(lines.size()) * iterations / 1000000.0;
+  std::cout << std::fixed << std::setprecision(2) << "recognizers\t" << label << "\t" << lines.size()
+            << " logical lines\t" << recognized.rules << " rules\t" << recognized.derived << " derived\t"
+            << recognized.blocks << " blocks\t" << recognized.includes << " includes" << std::endl
+            << "\tregex, per call:    " << n_lines / per_call_time.count() << " Mlines/s" << std::endl
+            << "\tregex, precompiled: " << n_lines / precompiled_time.count() << " Mlines/s" << std::endl
+            << "\trecognizers:        " << n_lines / recognized_time.count() << " Mlines/s" << std::endl;
+  if (!(per_call == recognized) || !(precompiled == recognized)) {
+    std::cout << "\tERROR: matcher results differ" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/*!
+  @brief report heap use for parsing a pipeline of many snakefiles
+  @param n_files number of snakefiles, as for a top level with that many includes
+  @param n_rules number of rules in each snakefile
+  @return true; this benchmark has nothing to compare
+
+  every file is kept loaded, as it is in a resolved include tree
+ */
+bool benchmark_parse_memory(unsigned n_files, unsigned n_rules) {
+  std::string tmp_template = (boost::filesystem::temp_directory_path() / "sutBENXXXXXX").string();
+  std::vector<char> tmp_dir(tmp_template.begin(), tmp_template.end());
+  tmp_dir.push_back('\0');
+  if (!mkdtemp(tmp_dir.data())) throw std::runtime_error("cannot create benchmark directory");
+  boost::filesystem::path workspace(tmp_dir.data());
+  std::string contents = synthesize_snakefile(n_rules);
+  for (unsigned i = 0; i < n_files; ++i) {
+    std::ofstream output((workspace / ("rules" + std::to_string(i) + ".smk")).string().c_str());
+    output << contents;
+    output.close();
+  }
+  heap_counters before = heap;
+  heap.peak_bytes = heap.current_bytes;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::vector<boost::shared_ptr<snakemake_unit_tests::snakemake_file> > files;
+  unsigned n_blocks = 0;
+  for (unsigned i = 0; i < n_files; ++i) {
+    files.push_back(boost::shared_ptr<snakemake_unit_tests::snakemake_file>(new snakemake_unit_tests::snakemake_file));
+    files.back()->load_everything("rules" + std::to_string(i) + ".smk", workspace, false);
+    n_blocks += files.back()->get_blocks().size();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  double source_megabytes = static_cast<double>(contents.size()) * n_files / 1048576.0;
+  std::cout << std::fixed << std::setprecision(1) << "parse_memory\t" << n_files << " files\t" << n_blocks
+            << " blocks\t" << source_megabytes << " MiB of source" << std::endl
+            << "\tallocations:   " << heap.allocations - before.allocations << std::endl
+            << "\tpeak heap:     " << (heap.peak_bytes - before.current_bytes) / 1048576.0 << " MiB" << std::endl
+            << "\tretained heap: " << (heap.current_bytes - before.current_bytes) / 1048576.0 << " MiB" << std::endl
+            << "\ttime:          " << std::setprecision(3) << elapsed.count() << " s" << std::endl;
+  files.clear();
+  boost::filesystem::remove_all(workspace);
+  return true;
+}
+
+/*!
+  @brief time loading a pipeline with no parse cache, an empty one, and a complete one
+  @param n_files number of included rule files
+  @param n_rules number of rules per file
+  @return whether restored files print the same as parsed ones
+ */
+bool benchmark_parse_cache(unsigned n_files, unsigned n_rules) {
+  std::string tmp_template = (boost::filesystem::temp_directory_path() / "sutBENXXXXXX").string();
+  std::vector<char> tmp_dir(tmp_template.begin(), tmp_template.end());
+  tmp_dir.push_back('\0');
+  if (!mkdtemp(tmp_dir.data())) throw std::runtime_error("cannot create benchmark directory");
+  boost::filesystem::path workspace(tmp_dir.data());
+  std::string contents = synthesize_snakefile(n_rules);
+  for (unsigned i = 0; i < n_files; ++i) {
+    // distinct contents, so every file has its own cache entry
+    std::ofstream output((workspace / ("rules" + std::to_string(i) + ".smk")).string().c_str());
+    output << "# rule file " << i << "\n" << contents;
+    output.close();
+  }
+  const char *labels[] = {"uncached", "cold cache", "warm cache"};
+  boost::shared_ptr<snakemake_unit_tests::parse_cache> cache;
+  std::vector<std::string> printed[3];
+  std::cout << "parse_cache\t" << n_files << " files" << std::endl;
+  for (unsigned pass = 0; pass < 3; ++pass) {
+    if (pass == 1) cache.reset(new snakemake_unit_tests::parse_cache(workspace / "cache", false));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<boost::shared_ptr<snakemake_unit_tests::snakemake_file> > files;
+    for (unsigned i = 0; i < n_files; ++i) {
+      files.push_back(
+          boost::shared_ptr<snakemake_unit_tests::snakemake_file>(new snakemake_unit_tests::snakemake_file));
+      files.back()->set_parse_cache(cache);
+      files.back()->load_everything("rules" + std::to_string(i) + ".smk", workspace, false);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "\t" << labels[pass] << ":\t" << std::fixed << std::setprecision(3) << elapsed.count() << " s"
+              << std::endl;
+    for (unsigned i = 0; i < n_files; ++i) {
+      std::ostringstream out;
+      for (std::list<boost::shared_ptr<snakemake_unit_tests::rule_block> >::const_iterator iter =
+               files.at(i)->get_blocks().begin();
+           iter != files.at(i)->get_blocks().end(); ++iter) {
+        (*iter)->print_contents(out);
+      }
+      printed[pass].push_back(out.str());
+    }
+  }
+  boost::filesystem::remove_all(workspace);
+  bool agree = printed[0] == printed[1] && printed[0] == printed[2] && cache->hits() == n_files;
+  if (!agree) std::cout << "\tERROR: cached parse does not match" << std::endl;
+  return agree;
+}
+
+/*!
+  @brief time emitting one synthetic snakefile per rule, streaming every block
+  through print_contents as opposed to writing pre-rendered slices
+  @param n_rules number of rules in the pipeline, each of which gets a snakefile
+  @return whether both methods write the same files
+ */
+bool benchmark_emission(unsigned n_rules) {
+  std::string tmp_template = (boost::filesystem::temp_directory_path() / "sutBENXXXXXX").string();
+  std::vector<char> tmp_dir(tmp_template.begin(), tmp_template.end());
+  tmp_dir.push_back('\0');
+  if (!mkdtemp(tmp_dir.data())) throw std::runtime_error("cannot create benchmark directory");
+  boost::filesystem::path workspace(tmp_dir.data());
+  std::ofstream output((workspace / "Snakefile").string().c_str());
+  output << synthesize_snakefile(n_rules);
+  output.close();
+  snakemake_unit_tests::snakemake_file sf;
+  sf.load_everything("Snakefile", workspace, false);
+  for (std::list<boost::shared_ptr<snakemake_unit_tests::rule_block> >::iterator iter = sf.get_blocks().begin();
+       iter != sf.get_blocks().end(); ++iter) {
+    (*iter)->set_resolution(snakemake_unit_tests::RESOLVED_INCLUDED);
+  }
+  snakemake_unit_tests::rule_registry registry(sf);
+  boost::filesystem::create_directories(workspace / "streamed");
+  boost::filesystem::create_directories(workspace / "sliced");
+  // the previous emission path: every block formatted for every file
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned id = 0; id < registry.size(); ++id) {
+    std::ofstream out((workspace / "streamed" / registry.get_name(id)).string().c_str());
+    for (std::list<boost::shared_ptr<snakemake_unit_tests::rule_block> >::const_iterator iter =
+             sf.get_blocks().begin();
+         iter != sf.get_blocks().end(); ++iter) {
+      if ((*iter)->get_rule_name().empty() || registry.get_block(id) == iter->get()) {
+        (*iter)->print_contents(out);
+      } else {
+        for (unsigned i = 0; i < (*iter)->get_local_indentation(); ++i) out << ' ';
+        out << "pass" << std::endl << std::endl << std::endl;
+      }
+    }
+    out.close();
+  }
+  std::chrono::duration<double> streamed = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  sf.render_blocks();
+  std::vector<std::string_view> slices;
+  for (unsigned id = 0; id < registry.size(); ++id) {
+    snakemake_unit_tests::rule_set rules = registry.empty_set();
+    rules.set(id);
+    slices.clear();
+    sf.report_single_rule(registry, rules, NULL, &slices);
+    snakemake_unit_tests::write_slices(workspace / "sliced" / registry.get_name(id), slices);
+  }
+  std::chrono::duration<double> sliced = std::chrono::steady_clock::now() - start;
+  std::cout << "emission\t" << registry.size() << " snakefiles" << std::endl
+            << "\tstreamed:\t" << std::fixed << std::setprecision(3) << streamed.count() << " s" << std::endl
+            << "\tpre-rendered:\t" << sliced.count() << " s" << std::endl;
+  bool agree = true;
+  for (unsigned id = 0; id < registry.size() && agree; ++id) {
+    std::ifstream streamed_input((workspace / "streamed" / registry.get_name(id)).string().c_str());
+    std::ifstream sliced_input((workspace / "sliced" / registry.get_name(id)).string().c_str());
+    std::ostringstream streamed_contents, sliced_contents;
+    streamed_contents << streamed_input.rdbuf();
+    sliced_contents << sliced_input.rdbuf();
+    agree = !streamed_contents.str().compare(sliced_contents.str());
+  }
+  boost::filesystem::remove_all(workspace);
+  if (!agree) std::cout << "\tERROR: emitted snakefiles do not match" << std::endl;
+  return agree;
+}
+
+int main(int argc, char **argv) {
+  bool all_agree = true;
+  if (argc < 2) {
+    std::string synthetic = synthesize_snakefile(20000);
+    all_agree = benchmark_lexical_parse("synthetic", synthetic, 5);
+    all_agree = benchmark_recognizers("synthetic", synthetic, 1) && all_agree;
+    // a top level snakefile with 300 included rule files
+    all_agree = benchmark_parse_memory(300, 40) && all_agree;
+    all_agree = benchmark_parse_cache(300, 40) && all_agree;
+    all_agree = benchmark_emission(600) && all_agree;
+  }
+  for (int i = 1; i < argc; ++i) {
+    std::ifstream input(argv[i], std::ios_base::in | std::ios_base::binary);
+    if (!input.is_open()) {
+      std::cerr << "cannot open benchmark input \"" << argv[i] << "\"" << std::endl;
+      return 1;
+    }
+    std::ostringstream contents;
+    contents << input.rdbuf();
+    input.close();
+    all_agree = benchmark_lexical_parse(argv[i], contents.str(), 20) && all_agree;
+    all_agree = benchmark_recognizers(argv[i], contents.str(), 20) && all_agree;
+  }
+  return !all_agree;
+}
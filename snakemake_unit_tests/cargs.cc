@@ -17,14 +17,23 @@ snakemake_unit_tests::params::params()
       update_outputs(false),
       update_pytest(false),
       include_entire_dag(false),
+      shared_includes(false),
       skip_validation(false),
+      plan(false),
+      plan_format("text"),
+      threads(0),
+      run_tests(false),
+      junit_xml(""),
+      memory_budget(0),
       config_filename(""),
       output_test_dir(""),
       snakefile(""),
       pipeline_top_dir(""),
       pipeline_run_dir(""),
       inst_dir(""),
-      snakemake_log("") {}
+      snakemake_log(""),
+      output_format("directory"),
+      resolution_harness("dryrun") {}
 
 snakemake_unit_tests::params::params(const params &obj)
     : verbose(obj.verbose),
@@ -36,7 +45,14 @@ snakemake_unit_tests::params::params(const params &obj)
       update_outputs(obj.update_outputs),
       update_pytest(obj.update_pytest),
       include_entire_dag(obj.include_entire_dag),
+      shared_includes(obj.shared_includes),
       skip_validation(obj.skip_validation),
+      plan(obj.plan),
+      plan_format(obj.plan_format),
+      threads(obj.threads),
+      run_tests(obj.run_tests),
+      junit_xml(obj.junit_xml),
+      memory_budget(obj.memory_budget),
       config_filename(obj.config_filename),
       config(obj.config),
       output_test_dir(obj.output_test_dir),
@@ -50,7 +66,9 @@ snakemake_unit_tests::params::params(const params &obj)
       include_rules(obj.include_rules),
       exclude_rules(obj.exclude_rules),
       exclude_patterns(obj.exclude_patterns),
-      comparators(obj.comparators) {}
+      comparators(obj.comparators),
+      output_format(obj.output_format),
+      resolution_harness(obj.resolution_harness) {}
 
 snakemake_unit_tests::params::~params() throw() {}
 
@@ -89,17 +107,80 @@ void snakemake_unit_tests::cargs::initialize_options() {
       "include-entire-dag",
       "add entire DAG to test snakefiles, instead of choosing target rules "
       "only (not recommended)")(
+      "shared-includes",
+      "write included snakefiles that contain no target rules once, under unit/.shared.N, "
+      "and symlink them into each test workspace; not compatible with '--output-format archive'")(
       "disable-config-validation",
-      "skip validation of user configuration yaml (if provided) with json schema (not recommended)");
+      "skip validation of user configuration yaml (if provided) with json schema (not recommended)")(
+      "output-format", boost::program_options::value<std::string>(),
+      "layout of emitted tests: 'directory' (loose files, default) or 'archive' (single indexed "
+      "archive per test directory)")(
+      "resolution-harness", boost::program_options::value<std::string>(),
+      "how snakemake evaluates snakefiles to decide which rules and include directives are active: "
+      "'dryrun' (full dry run, default) or 'parse' (parse the workflow only, without building its DAG)")(
+      "plan", "report the files, bytes, and snakemake runs that test emission would require, without writing anything")(
+      "plan-format", boost::program_options::value<std::string>(),
+      "format of --plan report: 'text' (default) or 'json'")(
+      "threads,t", boost::program_options::value<unsigned>(),
+      "number of threads for parsing included snakefiles and hashing expected test output "
+      "(default: one per available core)")(
+      "batch", boost::program_options::value<std::string>(),
+      "yaml manifest listing the config files (under 'configs') of several pipelines, "
+      "whose tests are generated together in one run; not compatible with '--config'")(
+      "run-tests",
+      "run the tests already generated under --output-test-dir, several at once within the --threads "
+      "core budget, instead of generating tests")(
+      "junit-xml", boost::program_options::value<std::string>(), "with --run-tests, also write a junit xml report")(
+      "memory-budget", boost::program_options::value<unsigned>(),
+      "with --run-tests, megabytes of memory that concurrently running tests may reserve in total "
+      "(default: no limit)")(
+      "compare", boost::program_options::value<std::string>(),
+      "compare generated test output with its expected copies, several files at once within the --threads "
+      "budget, and exit; takes a list ('-' for standard input) of tab-delimited comparison mode ('byte' or "
+      "'plaintext'), generated file, and expected file, and reports each mismatch");
 }
 
 snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool use_schema_validation) const {
+  return resolve_parameters(get_config_yaml(), use_schema_validation);
+}
+
+std::vector<snakemake_unit_tests::params> snakemake_unit_tests::cargs::set_batch_parameters(
+    const std::vector<boost::filesystem::path> &config_filenames, bool use_schema_validation) const {
+  // these name one pipeline's files, so on the command line they would apply to every pipeline at once
+  const std::vector<std::string> per_pipeline_options = {"config", "snakefile", "snakemake-log", "output-test-dir",
+                                                         "pipeline-top-dir", "pipeline-run-dir"};
+  for (std::vector<std::string>::const_iterator iter = per_pipeline_options.begin();
+       iter != per_pipeline_options.end(); ++iter) {
+    if (_vm.count(*iter))
+      throw std::logic_error("\"" + *iter +
+                             "\" cannot be combined with \"batch\"; set it in each pipeline's configuration file");
+  }
+  if (config_filenames.empty()) throw std::logic_error("\"batch\" requires at least one configuration file");
+  if (run_tests()) throw std::logic_error("\"run-tests\" cannot be combined with \"batch\"");
+  std::vector<params> res;
+  std::map<boost::filesystem::path, boost::filesystem::path> output_owners;
+  for (std::vector<boost::filesystem::path>::const_iterator iter = config_filenames.begin();
+       iter != config_filenames.end(); ++iter) {
+    res.push_back(resolve_parameters(iter->string(), use_schema_validation));
+    // pipelines run concurrently, and each owns its output directory, workspace and caches
+    boost::filesystem::path output_dir = boost::filesystem::absolute(res.back().output_test_dir).lexically_normal();
+    std::map<boost::filesystem::path, boost::filesystem::path>::const_iterator owner =
+        output_owners.insert(std::make_pair(output_dir, *iter)).first;
+    if (owner->second != *iter)
+      throw std::logic_error("configuration files \"" + owner->second.string() + "\" and \"" + iter->string() +
+                             "\" both write tests to \"" + output_dir.string() + "\"");
+  }
+  return res;
+}
+
+snakemake_unit_tests::params snakemake_unit_tests::cargs::resolve_parameters(const std::string &config_filename,
+                                                                             bool use_schema_validation) const {
   params p;
   // new: allow user to skip over config yaml validation
   p.skip_validation = skip_validation();
 
   // start with config yaml
-  p.config_filename = get_config_yaml();
+  p.config_filename = config_filename;
   // if the user specified a configuration file
   if (!p.config_filename.string().empty()) {
     // if the file exists at all
@@ -145,7 +226,7 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
         // note that, due to the override behavior of the program,
         // this doesn't enforce all of what it might; rather, it
         // primarily detects config files with unsupported features
-        validate_config(p.config_filename, p.inst_dir);
+        validate_config(p.config, p.config_filename, p.inst_dir);
       }
 
       if (p.config.query_valid("output-test-dir")) {
@@ -181,6 +262,12 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
       if (p.config.query_valid("comparators")) {
         p.comparators = p.config.get_node("comparators");
       }
+      if (p.config.query_valid("output-format")) {
+        p.output_format = p.config.get_entry("output-format");
+      }
+      if (p.config.query_valid("resolution-harness")) {
+        p.resolution_harness = p.config.get_entry("resolution-harness");
+      }
     } else {
       throw std::runtime_error("configuration file \"" + p.config_filename.string() + "\" is not a regular file");
     }
@@ -198,6 +285,15 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
   p.update_outputs = update_outputs();
   p.update_pytest = update_pytest();
   p.include_entire_dag = include_entire_dag();
+  p.shared_includes = shared_includes();
+  p.plan = plan();
+  if (!get_plan_format().empty()) {
+    p.plan_format = get_plan_format();
+  }
+  p.threads = get_threads();
+  p.run_tests = run_tests();
+  p.junit_xml = get_junit_xml();
+  p.memory_budget = get_memory_budget();
 
   // output_test_dir: override if specified
   p.output_test_dir = override_if_specified(get_output_test_dir(), p.output_test_dir);
@@ -234,6 +330,14 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
   add_contents<std::string>(get_include_rules(), &p.include_rules);
   // exclude_rules: augment whatever is present in config.yaml
   add_contents<std::string>(get_exclude_rules(), &p.exclude_rules);
+  // output_format: override if specified
+  if (!get_output_format().empty()) {
+    p.output_format = get_output_format();
+  }
+  // resolution_harness: override if specified
+  if (!get_resolution_harness().empty()) {
+    p.resolution_harness = get_resolution_harness();
+  }
   // add "all" to exclusion list, always
   // it's ok if it dups with user specification, it's uniqued later
   p.exclude_rules["all"] = true;
@@ -244,6 +348,15 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
   p.output_test_dir = p.output_test_dir.remove_trailing_separator();
   // but it should at least be nonempty
   check_nonempty(p.output_test_dir, "output-test-dir");
+  // running tests only needs to find them; the pipeline need not be present
+  if (p.run_tests) {
+    if (!boost::filesystem::is_directory(p.output_test_dir / "unit"))
+      throw std::runtime_error("output test directory \"" + p.output_test_dir.string() +
+                               "\" does not contain generated tests under \"unit\"");
+    return p;
+  }
+  if (!p.junit_xml.string().empty()) throw std::logic_error("\"junit-xml\" requires \"run-tests\"");
+  if (p.memory_budget) throw std::logic_error("\"memory-budget\" requires \"run-tests\"");
   // snakefile: should exist, be regular file
   check_nonempty(p.snakefile, "snakefile");
   check_regular_file(p.snakefile, "", "snakefile");
@@ -273,6 +386,25 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
                              "this option; otherwise, if using conda, you can provide "
                              "$CONDA_PREFIX/share/snakemake_unit_tests/inst");
   }
+  // output_format: should be one of the supported layouts
+  if (p.output_format.compare("directory") && p.output_format.compare("archive")) {
+    throw std::logic_error("for \"output-format\", provided value \"" + p.output_format +
+                           "\" is not one of 'directory' or 'archive'");
+  }
+  // shared_includes: extracted archive entries cannot follow links to shared content
+  if (p.shared_includes && !p.output_format.compare("archive")) {
+    throw std::logic_error("\"shared-includes\" is not supported with \"output-format\" 'archive'");
+  }
+  // resolution_harness: should be one of the supported ways of running snakemake
+  if (p.resolution_harness.compare("dryrun") && p.resolution_harness.compare("parse")) {
+    throw std::logic_error("for \"resolution-harness\", provided value \"" + p.resolution_harness +
+                           "\" is not one of 'dryrun' or 'parse'");
+  }
+  // plan_format: should be one of the supported report formats
+  if (p.plan_format.compare("text") && p.plan_format.compare("json")) {
+    throw std::logic_error("for \"plan-format\", provided value \"" + p.plan_format +
+                           "\" is not one of 'text' or 'json'");
+  }
   // snakemake_log: should exist, be a regular file
   check_nonempty(p.snakemake_log, "snakemake-log");
   check_regular_file(p.snakemake_log, "", "snakemake-log");
@@ -375,6 +507,10 @@ void snakemake_unit_tests::params::report_settings(const boost::filesystem::path
   if (comparators.size()) {
     out << YAML::Key << "comparators" << YAML::Value << comparators;
   }
+  // output-format: only reported if not the default layout
+  if (output_format.compare("directory")) {
+    out << YAML::Key << "output-format" << YAML::Value << output_format;
+  }
   // end the content
   out << YAML::EndMap;
   // write to output file
@@ -421,26 +557,18 @@ void snakemake_unit_tests::params::emit_yaml_vector(YAML::Emitter *out,
   }
 }
 
-void snakemake_unit_tests::cargs::validate_config(const boost::filesystem::path &config_filename,
-                                                  const boost::filesystem::path &inst_directory,
-                                                  bool suppress_screen_output) const {
+void snakemake_unit_tests::cargs::validate_config(const yaml_reader &config,
+                                                  const boost::filesystem::path &config_filename,
+                                                  const boost::filesystem::path &inst_directory) const {
   boost::filesystem::path schema = inst_directory / "user_config_schema.yaml";
   if (!boost::filesystem::exists(schema)) {
     throw std::runtime_error("expected json schema file \"" + schema.string() + "\" could not be located");
   }
-  std::string command =
-      "python3 -c \"from snakemake.utils import validate ; import yaml ; "
-      "validate(yaml.safe_load(open(\\\"" +
-      config_filename.string() + "\\\", \\\"r\\\")), schema=\\\"" + schema.string() + "\\\")\"" +
-      (suppress_screen_output ? std::string(" > /dev/null 2>&1") : std::string(""));
-  try {
-    std::vector<std::string> result = exec(command, true, true);
-  } catch (const std::runtime_error &e) {
+  std::string failure;
+  if (!config_schema(schema).validate(config.get_document(), &failure)) {
     std::string message =
-        "validation of --config/-c file \"" + config_filename.string() +
-        "\" has failed. "
-        "the schema for this validation is at \"" +
-        schema.string() +
+        "validation of --config/-c file \"" + config_filename.string() + "\" has failed:\n\n" + failure +
+        "\n\nthe schema for this validation is at \"" + schema.string() +
         "\" for review. due to how the "
         "command line and config files interact with snakemake_unit_tests, this schema does not strictly "
         "enforce most properties. however, it does detect configuration features that are not part of "
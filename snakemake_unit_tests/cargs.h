@@ -22,6 +22,7 @@
 
 #include "boost/filesystem.hpp"
 #include "boost/program_options.hpp"
+#include "snakemake_unit_tests/config_schema.h"
 #include "snakemake_unit_tests/utilities.h"
 #include "snakemake_unit_tests/yaml_reader.h"
 #include "yaml-cpp/yaml.h"
@@ -144,6 +145,11 @@ class params {
    the actual tests.
    */
   bool include_entire_dag;
+  /*!
+    @brief emit include files that contain no target rules once,
+    under unit/.shared.N, and link to them from each workspace
+   */
+  bool shared_includes;
   /*!
     @brief do not attempt to validate user configuration file, if provided,
     agaist json schema in inst/user_config_schema.yaml
@@ -152,6 +158,34 @@ class params {
     but doesn't want to update the json schema to support it
    */
   bool skip_validation;
+  /*!
+    @brief only report the estimated cost of test emission, without
+    writing anything to disk
+   */
+  bool plan;
+  /*!
+    @brief format of plan report: "text" or "json"
+   */
+  std::string plan_format;
+  /*!
+    @brief number of worker threads for parsing included snakefiles
+    and hashing expected output; 0 means one per available core
+   */
+  unsigned threads;
+  /*!
+    @brief run the generated tests under output_test_dir, instead
+    of generating them
+   */
+  bool run_tests;
+  /*!
+    @brief where to write a junit xml report of a test run, if anywhere
+   */
+  boost::filesystem::path junit_xml;
+  /*!
+    @brief memory, in megabytes, that concurrently running tests
+    may reserve in total; 0 means no limit
+   */
+  unsigned memory_budget;
   /*!
     @brief name of yaml configuration file
    */
@@ -209,6 +243,18 @@ class params {
     @brief user-defined file extensions to flag as needing binary comparison
    */
   YAML::Node comparators;
+  /*!
+    @brief layout of emitted unit test content: "directory" for
+    loose files under unit/<rule>, or "archive" for a single
+    indexed archive at unit/unit_tests.zip
+   */
+  std::string output_format;
+  /*!
+    @brief how snakemake is run to resolve rules and include
+    directives: "dryrun" for a full dry run, or "parse" to stop
+    once the workflow is parsed
+   */
+  std::string resolution_harness;
 };
 
 /*!
@@ -229,6 +275,7 @@ class cargs {
     _permitted_flags["help"] = true;
     _permitted_flags["verbose"] = true;
     _permitted_flags["include-entire-dag"] = true;
+    _permitted_flags["shared-includes"] = true;
     _permitted_flags["disable-config-validation"] = true;
     _permitted_flags["update-all"] = true;
     _permitted_flags["update-pytest"] = true;
@@ -237,6 +284,8 @@ class cargs {
     _permitted_flags["update-config"] = true;
     _permitted_flags["update-inputs"] = true;
     _permitted_flags["update-outputs"] = true;
+    _permitted_flags["plan"] = true;
+    _permitted_flags["run-tests"] = true;
   }
   /*!
     @brief copy constructor
@@ -269,6 +318,20 @@ class cargs {
    */
   params set_parameters(bool use_schema_validation = true) const;
 
+  /*!
+    @brief deal with parameter settings for each pipeline of a batch
+    @param config_filenames config yaml file of each pipeline
+    @param use_schema_validation whether to validate each config with
+    the preset schema; defaults to on, but can be disabled for unit testing
+    @return params object for each pipeline, in the order of config_filenames
+
+    every other command line option applies to each pipeline, as it would
+    with '-c'. options that name a single pipeline's files are rejected,
+    as are pipelines that would write tests to the same directory.
+   */
+  std::vector<params> set_batch_parameters(const std::vector<boost::filesystem::path> &config_filenames,
+                                           bool use_schema_validation = true) const;
+
   /*!
     @brief determine whether the user has requested help documentation
     @return whether the user has requested help documentation
@@ -287,6 +350,13 @@ class cargs {
    */
   std::string get_config_yaml() const { return compute_parameter<std::string>("config", true); }
 
+  /*!
+    @brief get user-specified batch manifest, listing the config
+    yaml files of several pipelines to process in one run
+    @return string filename of batch manifest, or empty string if unset
+   */
+  std::string get_batch() const { return compute_parameter<std::string>("batch", true); }
+
   /*!
     @brief get the top-level snakefile used for the full workflow
     @return name of and path to snakefile as a string
@@ -398,6 +468,27 @@ class cargs {
     return compute_parameter<std::vector<std::string> >("exclude-rules", true);
   }
 
+  /*!
+    @brief get optional layout for emitted unit test content
+    @return requested output format, or empty string if unset
+
+    "directory" (the default) writes each rule's workspace and expected
+    trees as loose files. "archive" streams them into a single indexed
+    archive instead, which dramatically reduces inode counts for large
+    pipelines; test.py expands only the rule under test.
+   */
+  std::string get_output_format() const { return compute_parameter<std::string>("output-format", true); }
+
+  /*!
+    @brief get optional harness for python resolution passes
+    @return requested harness, or empty string if unset
+
+    "dryrun" (the default) runs a complete snakemake dry run. "parse"
+    only lists the workflow's rules, which executes every snakefile
+    without building the DAG or checking any files.
+   */
+  std::string get_resolution_harness() const { return compute_parameter<std::string>("resolution-harness", true); }
+
   /*!
     @brief get user flag for overriding default behavior and adding entire DAG
     to synthetic snakefiles
@@ -410,6 +501,17 @@ class cargs {
    */
   bool include_entire_dag() const { return compute_flag("include-entire-dag"); }
 
+  /*!
+    @brief get user flag for sharing include files without target rules
+    across workspaces
+    @return whether the user wants shared include files
+
+    in a large pipeline, most included snakefiles contain none of a given
+    test's rules, and are identical in every workspace. with this flag,
+    they are written once and symlinked into each workspace.
+   */
+  bool shared_includes() const { return compute_flag("shared-includes"); }
+
   /*!
     @brief get user flag for overriding schema validation of user-specified
     yaml configuration file, if provided
@@ -420,6 +522,58 @@ class cargs {
    */
   bool skip_validation() const { return compute_flag("disable-config-validation"); }
 
+  /*!
+    @brief get user flag for reporting planned work instead of emitting tests
+    @return whether the user wants a dry run cost estimate
+
+    in plan mode, the snakefiles and log are parsed and every fixture
+    that would be copied is measured, but nothing is written to disk
+    and no snakemake subprocesses are launched
+   */
+  bool plan() const { return compute_flag("plan"); }
+
+  /*!
+    @brief get optional format for plan report
+    @return requested plan format, or empty string if unset
+   */
+  std::string get_plan_format() const { return compute_parameter<std::string>("plan-format", true); }
+
+  /*!
+    @brief get optional number of worker threads
+    @return requested number of threads, or 0 if unset
+   */
+  unsigned get_threads() const { return compute_parameter<unsigned>("threads", true); }
+
+  /*!
+    @brief get user flag for running existing tests instead of generating them
+    @return whether the user wants to run the tests under the output directory
+
+    only the output test directory is needed to find the tests, so the
+    pipeline itself need not be available
+   */
+  bool run_tests() const { return compute_flag("run-tests"); }
+
+  /*!
+    @brief get optional junit xml report file for a test run
+    @return requested report filename, or empty string if unset
+   */
+  std::string get_junit_xml() const { return compute_parameter<std::string>("junit-xml", true); }
+
+  /*!
+    @brief get optional memory budget for a test run
+    @return requested budget in megabytes, or 0 if unset
+   */
+  unsigned get_memory_budget() const { return compute_parameter<unsigned>("memory-budget", true); }
+
+  /*!
+    @brief get user-specified list of files to compare with their expected copies
+    @return string filename of comparison list, '-' for standard input, or empty string if unset
+
+    the comparison list is written by the generated tests' common.py, so
+    no pipeline or configuration is needed
+   */
+  std::string get_compare() const { return compute_parameter<std::string>("compare", true); }
+
   /*!
     @brief get user flag for updating all parts of unit tests
     @return whether the user wants a full replacement of all unit test content
@@ -551,18 +705,24 @@ class cargs {
                                                 const boost::filesystem::path &params_entry) const;
 
   /*!
-    @brief validate a configuration yaml file with json schema in python
-
-    I'm not familiar with a straightforward way to do this directly in c++,
-    and we already have python lying around, so may as well do it this way.
+    @brief resolve parameter settings across a config yaml and the command line
+    @param config_filename config yaml file; empty if none
+    @param use_schema_validation whether to validate the config with the preset schema
+    @return params object containing consistent parameter settings
+   */
+  params resolve_parameters(const std::string &config_filename, bool use_schema_validation) const;
 
-    @param config_filename name of config file to validate
+  /*!
+    @brief validate a configuration yaml file with json schema
+    @param config loaded configuration
+    @param config_filename name of config file, for error reporting
     @param inst_directory path to inst/ that should contain json schema
-    @param suppress_screen_output whether the raw python validation text should
-    be suppressed; error message from snakemake_unit_tests will still be emitted.
+
+    validation runs in process (see config_schema), so it needs neither
+    python nor snakemake.
    */
-  void validate_config(const boost::filesystem::path &config_filename, const boost::filesystem::path &inst_directory,
-                       bool suppress_screen_output = false) const;
+  void validate_config(const yaml_reader &config, const boost::filesystem::path &config_filename,
+                       const boost::filesystem::path &inst_directory) const;
 
   /*!
     @brief append any CLI entries for a multitoken parameter to
@@ -45,7 +45,9 @@ void snakemake_unit_tests::cargsTest::setUp() {
       "--pipeline-top-dir project --pipeline-run-dir rundir --snakefile Snakefile "
       "--verbose --update-all --update-snakefiles --update-added-content "
       "--update-config --update-inputs --update-outputs --update-pytest --include-entire-dag "
-      "--disable-config-validation";
+      "--disable-config-validation --output-format archive --plan --plan-format json --threads 4 --shared-includes "
+      "--resolution-harness parse --batch batch.yaml --run-tests --junit-xml report.xml --memory-budget 8000 "
+      "--compare comparisons.tsv";
   std::string shortform =
       "./snakemake_unit_tests.out -c configname.yaml "
       "-d added_dir -n keepme -e rulename -f added_file "
@@ -92,7 +94,14 @@ void snakemake_unit_tests::cargsTest::test_params_default_constructor() {
   CPPUNIT_ASSERT(!p.update_outputs);
   CPPUNIT_ASSERT(!p.update_pytest);
   CPPUNIT_ASSERT(!p.include_entire_dag);
+  CPPUNIT_ASSERT(!p.shared_includes);
   CPPUNIT_ASSERT(!p.skip_validation);
+  CPPUNIT_ASSERT(!p.plan);
+  CPPUNIT_ASSERT(!p.plan_format.compare("text"));
+  CPPUNIT_ASSERT(!p.threads);
+  CPPUNIT_ASSERT(!p.run_tests);
+  CPPUNIT_ASSERT(p.junit_xml.string().empty());
+  CPPUNIT_ASSERT(!p.memory_budget);
   CPPUNIT_ASSERT(p.config_filename.string().empty());
   CPPUNIT_ASSERT(p.config == yaml_reader());
   CPPUNIT_ASSERT(p.output_test_dir.string().empty());
@@ -107,15 +116,21 @@ void snakemake_unit_tests::cargsTest::test_params_default_constructor() {
   CPPUNIT_ASSERT(p.exclude_rules.empty());
   CPPUNIT_ASSERT(p.exclude_patterns.empty());
   CPPUNIT_ASSERT(!p.comparators.size());
+  CPPUNIT_ASSERT(!p.output_format.compare("directory"));
+  CPPUNIT_ASSERT(!p.resolution_harness.compare("dryrun"));
 }
 
 void snakemake_unit_tests::cargsTest::test_params_copy_constructor() {
   params p;
   p.verbose = p.update_all = p.update_snakefiles = p.update_added_content = true;
   p.update_config = p.update_inputs = p.update_outputs = p.update_pytest = p.include_entire_dag = p.skip_validation =
-      true;
+      p.plan = p.shared_includes = p.run_tests = true;
+  p.plan_format = "json";
+  p.threads = 3;
+  p.junit_xml = "thing12";
+  p.memory_budget = 4000;
   p.config_filename = "thing1";
-  p.config._data = YAML::Load("[1, 2, 3]");
+  p.config.load_node(YAML::Load("[1, 2, 3]"));
   p.output_test_dir = "thing2";
   p.snakefile = "thing3";
   p.pipeline_top_dir = "thing4";
@@ -128,6 +143,8 @@ void snakemake_unit_tests::cargsTest::test_params_copy_constructor() {
   p.exclude_rules["thing10"] = true;
   p.exclude_patterns["thing11"] = true;
   p.comparators = YAML::Load("{comp1: {type: byte}}");
+  p.output_format = "archive";
+  p.resolution_harness = "parse";
   params q(p);
   CPPUNIT_ASSERT(p.verbose == q.verbose);
   CPPUNIT_ASSERT(p.update_all = q.update_all);
@@ -138,7 +155,14 @@ void snakemake_unit_tests::cargsTest::test_params_copy_constructor() {
   CPPUNIT_ASSERT(p.update_outputs == q.update_outputs);
   CPPUNIT_ASSERT(p.update_pytest == q.update_pytest);
   CPPUNIT_ASSERT(p.include_entire_dag == q.include_entire_dag);
+  CPPUNIT_ASSERT(p.shared_includes == q.shared_includes);
   CPPUNIT_ASSERT(p.skip_validation == q.skip_validation);
+  CPPUNIT_ASSERT(p.plan == q.plan);
+  CPPUNIT_ASSERT(p.plan_format == q.plan_format);
+  CPPUNIT_ASSERT(p.threads == q.threads);
+  CPPUNIT_ASSERT(p.run_tests == q.run_tests);
+  CPPUNIT_ASSERT(p.junit_xml == q.junit_xml);
+  CPPUNIT_ASSERT(p.memory_budget == q.memory_budget);
   CPPUNIT_ASSERT(p.config_filename == q.config_filename);
   CPPUNIT_ASSERT(p.config == q.config);
   CPPUNIT_ASSERT(p.output_test_dir == q.output_test_dir);
@@ -152,6 +176,8 @@ void snakemake_unit_tests::cargsTest::test_params_copy_constructor() {
   CPPUNIT_ASSERT(p.exclude_rules == q.exclude_rules);
   CPPUNIT_ASSERT(p.exclude_patterns == q.exclude_patterns);
   CPPUNIT_ASSERT(p.comparators == q.comparators);
+  CPPUNIT_ASSERT(p.output_format == q.output_format);
+  CPPUNIT_ASSERT(p.resolution_harness == q.resolution_harness);
 }
 void snakemake_unit_tests::cargsTest::test_params_report_settings() {
   boost::filesystem::path output_filename =
@@ -213,6 +239,23 @@ void snakemake_unit_tests::cargsTest::test_params_report_settings() {
   input.close();
   CPPUNIT_ASSERT(!observed_contents.str().compare(expected_contents));
 }
+void snakemake_unit_tests::cargsTest::test_params_report_settings_output_format() {
+  boost::filesystem::path output_filename =
+      boost::filesystem::path(std::string(_tmp_dir)) / "params_report_settings_output_format.yaml";
+  params p;
+  p.output_test_dir = "outdir";
+  p.snakefile = "Snakefile";
+  p.pipeline_top_dir = "ptop";
+  p.pipeline_run_dir = "prun";
+  p.inst_dir = "inst";
+  p.snakemake_log = "slog";
+  p.output_format = "archive";
+  p.report_settings(output_filename);
+  yaml_reader observed(output_filename.string());
+  CPPUNIT_ASSERT(observed.query_valid("output-format"));
+  CPPUNIT_ASSERT(!observed.get_entry("output-format").compare("archive"));
+  CPPUNIT_ASSERT(!observed.query_valid("comparators"));
+}
 void snakemake_unit_tests::cargsTest::test_params_emit_yaml_map_multiple_entries() {
   YAML::Emitter out;
   std::string key = "mykey";
@@ -345,7 +388,8 @@ void snakemake_unit_tests::cargsTest::test_cargs_validate_config_schema_violatio
       "./snakemake_unit_tests.out --update-all -c " + configfile.string() + " --inst-dir " + instdir.string();
   populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
   cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
-  ap.validate_config(configfile, instdir, true);
+  yaml_reader config(configfile.string());
+  ap.validate_config(config, configfile, instdir);
 }
 void snakemake_unit_tests::cargsTest::test_cargs_default_constructor() { cargs ap; }
 void snakemake_unit_tests::cargsTest::test_cargs_standard_constructor() {
@@ -377,6 +421,9 @@ void snakemake_unit_tests::cargsTest::test_cargs_copy_constructor() {
         std::vector<std::string> result = ap2._vm[prev].as<std::vector<std::string> >();
         CPPUNIT_ASSERT_MESSAGE("cargs copy constructor key->value: " + prev + " -> " + current,
                                result.size() == 1 && !result.at(0).compare(current));
+      } else if (!prev.compare("threads") || !prev.compare("memory-budget")) {
+        CPPUNIT_ASSERT_MESSAGE("cargs copy constructor key->value: " + prev + " -> " + current,
+                               std::to_string(ap2._vm[prev].as<unsigned>()) == current);
       } else {
         std::string result = ap2._vm[prev].as<std::string>();
         CPPUNIT_ASSERT_MESSAGE("cargs copy constructor key->value: " + prev + " -> " + current,
@@ -410,6 +457,8 @@ void snakemake_unit_tests::cargsTest::test_cargs_initialize_options() {
   CPPUNIT_ASSERT(o.str().find("-i [ --inst-dir ] arg") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("-l [ --snakemake-log ] arg") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("-o [ --output-test-dir ] arg") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--output-format arg") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--resolution-harness arg") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("-p [ --pipeline-top-dir ] arg") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("-r [ --pipeline-run-dir ] arg") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("-s [ --snakefile ] arg") != std::string::npos);
@@ -422,7 +471,16 @@ void snakemake_unit_tests::cargsTest::test_cargs_initialize_options() {
   CPPUNIT_ASSERT(o.str().find("--update-outputs") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("--update-pytest") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("--include-entire-dag") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--shared-includes") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("--disable-config-validation") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--plan ") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--plan-format arg") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("-t [ --threads ] arg") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--batch arg") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--run-tests") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--junit-xml arg") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--memory-budget arg") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--compare arg") != std::string::npos);
 }
 void snakemake_unit_tests::cargsTest::test_cargs_set_parameters() {
   /*
@@ -445,7 +503,9 @@ void snakemake_unit_tests::cargsTest::test_cargs_set_parameters() {
     - (update-outputs, NA, update_outputs)
     - (update-pytest, NA, update_pytest)
     - (include-entire-dag, NA, include_entire_dag)
+    - (shared-includes, NA, shared_includes)
     - (disable-config-validation, NA, skip_validation)
+    - (plan, NA, plan)
 
     parameters that override when present on the CLI:
     - (output-test-dir, output-test-dir, output_test_dir)
@@ -957,6 +1017,239 @@ void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_inst_dir_invalid
   params p = ap.set_parameters(false);
 }
 
+void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_output_format_invalid() {
+  // construct an otherwise valid command, but the output format is unrecognized
+  boost::filesystem::path prefix = std::string(_tmp_dir);
+  // pipeline top level directory
+  boost::filesystem::path top_dir = prefix / "set_parameters";
+  std::filesystem::create_directory(top_dir.string().c_str());
+  // pipeline run directory
+  boost::filesystem::path run_dir = "workflow";
+  std::filesystem::create_directory((top_dir / run_dir).string().c_str());
+  // inst directory
+  boost::filesystem::path inst_dir = prefix / "inst";
+  std::filesystem::create_directory(inst_dir.string().c_str());
+  create_empty_file(inst_dir / "test.py");
+  create_empty_file(inst_dir / "common.py");
+  // snakemake run log
+  boost::filesystem::path run_log = top_dir / "set_parameters.log";
+  create_empty_file(run_log);
+  // snakefile
+  boost::filesystem::path snakefile = top_dir / run_dir / "Snakefile";
+  create_empty_file(snakefile);
+  // output directory
+  boost::filesystem::path outdir = prefix / "outdir";
+  std::string command =
+      "./snakemake_unit_tests.out "
+      "--inst-dir " +
+      inst_dir.string() + " --snakemake-log " + run_log.string() + " -o " + outdir.string() + " --pipeline-top-dir " +
+      top_dir.string() + " --pipeline-run-dir " + run_dir.string() + " --snakefile " + snakefile.string() +
+      " --output-format tarball";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_parameters(false);
+}
+
+void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_resolution_harness_invalid() {
+  // construct an otherwise valid command, but the resolution harness is unrecognized
+  boost::filesystem::path prefix = std::string(_tmp_dir);
+  // pipeline top level directory
+  boost::filesystem::path top_dir = prefix / "set_parameters";
+  std::filesystem::create_directory(top_dir.string().c_str());
+  // pipeline run directory
+  boost::filesystem::path run_dir = "workflow";
+  std::filesystem::create_directory((top_dir / run_dir).string().c_str());
+  // inst directory
+  boost::filesystem::path inst_dir = prefix / "inst";
+  std::filesystem::create_directory(inst_dir.string().c_str());
+  create_empty_file(inst_dir / "test.py");
+  create_empty_file(inst_dir / "common.py");
+  // snakemake run log
+  boost::filesystem::path run_log = top_dir / "set_parameters.log";
+  create_empty_file(run_log);
+  // snakefile
+  boost::filesystem::path snakefile = top_dir / run_dir / "Snakefile";
+  create_empty_file(snakefile);
+  // output directory
+  boost::filesystem::path outdir = prefix / "outdir";
+  std::string command =
+      "./snakemake_unit_tests.out "
+      "--inst-dir " +
+      inst_dir.string() + " --snakemake-log " + run_log.string() + " -o " + outdir.string() + " --pipeline-top-dir " +
+      top_dir.string() + " --pipeline-run-dir " + run_dir.string() + " --snakefile " + snakefile.string() +
+      " --resolution-harness python";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_parameters(false);
+}
+
+void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_plan_format_invalid() {
+  // construct an otherwise valid command, but the plan format is unrecognized
+  boost::filesystem::path prefix = std::string(_tmp_dir);
+  // pipeline top level directory
+  boost::filesystem::path top_dir = prefix / "set_parameters";
+  std::filesystem::create_directory(top_dir.string().c_str());
+  // pipeline run directory
+  boost::filesystem::path run_dir = "workflow";
+  std::filesystem::create_directory((top_dir / run_dir).string().c_str());
+  // inst directory
+  boost::filesystem::path inst_dir = prefix / "inst";
+  std::filesystem::create_directory(inst_dir.string().c_str());
+  create_empty_file(inst_dir / "test.py");
+  create_empty_file(inst_dir / "common.py");
+  // snakemake run log
+  boost::filesystem::path run_log = top_dir / "set_parameters.log";
+  create_empty_file(run_log);
+  // snakefile
+  boost::filesystem::path snakefile = top_dir / run_dir / "Snakefile";
+  create_empty_file(snakefile);
+  // output directory
+  boost::filesystem::path outdir = prefix / "outdir";
+  std::string command =
+      "./snakemake_unit_tests.out "
+      "--inst-dir " +
+      inst_dir.string() + " --snakemake-log " + run_log.string() + " -o " + outdir.string() + " --pipeline-top-dir " +
+      top_dir.string() + " --pipeline-run-dir " + run_dir.string() + " --snakefile " + snakefile.string() +
+      " --plan --plan-format csv";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_parameters(false);
+}
+
+void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_shared_includes_archive() {
+  // construct an otherwise valid command, but shared includes are requested for archive output
+  boost::filesystem::path prefix = std::string(_tmp_dir);
+  // pipeline top level directory
+  boost::filesystem::path top_dir = prefix / "set_parameters";
+  std::filesystem::create_directory(top_dir.string().c_str());
+  // pipeline run directory
+  boost::filesystem::path run_dir = "workflow";
+  std::filesystem::create_directory((top_dir / run_dir).string().c_str());
+  // inst directory
+  boost::filesystem::path inst_dir = prefix / "inst";
+  std::filesystem::create_directory(inst_dir.string().c_str());
+  create_empty_file(inst_dir / "test.py");
+  create_empty_file(inst_dir / "common.py");
+  // snakemake run log
+  boost::filesystem::path run_log = top_dir / "set_parameters.log";
+  create_empty_file(run_log);
+  // snakefile
+  boost::filesystem::path snakefile = top_dir / run_dir / "Snakefile";
+  create_empty_file(snakefile);
+  // output directory
+  boost::filesystem::path outdir = prefix / "outdir";
+  std::string command =
+      "./snakemake_unit_tests.out "
+      "--inst-dir " +
+      inst_dir.string() + " --snakemake-log " + run_log.string() + " -o " + outdir.string() + " --pipeline-top-dir " +
+      top_dir.string() + " --pipeline-run-dir " + run_dir.string() + " --snakefile " + snakefile.string() +
+      " --shared-includes --output-format archive";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_parameters(false);
+}
+boost::filesystem::path snakemake_unit_tests::cargsTest::create_batch_pipeline(const std::string &name,
+                                                                             const std::string &output_dir) const {
+  // a minimal pipeline, and a configuration file naming everything it needs
+  boost::filesystem::path prefix = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path top_dir = prefix / name;
+  boost::filesystem::path inst_dir = prefix / "inst";
+  boost::filesystem::create_directories(top_dir / "workflow");
+  boost::filesystem::create_directories(inst_dir);
+  create_empty_file(top_dir / "workflow" / "Snakefile");
+  create_empty_file(top_dir / "run.log");
+  create_empty_file(inst_dir / "common.py");
+  create_empty_file(inst_dir / "test.py");
+  boost::filesystem::path config = top_dir / "config.yaml";
+  std::ofstream output(config.string().c_str());
+  if (!output.is_open()) {
+    throw std::runtime_error("cannot create batch pipeline configuration file");
+  }
+  output << "output-test-dir: " << (prefix / output_dir).string() << "\n"
+         << "snakefile: " << (top_dir / "workflow" / "Snakefile").string() << "\n"
+         << "snakemake-log: " << (top_dir / "run.log").string() << "\n"
+         << "inst-dir: " << inst_dir.string() << std::endl;
+  output.close();
+  return config;
+}
+void snakemake_unit_tests::cargsTest::test_cargs_set_batch_parameters() {
+  std::vector<boost::filesystem::path> configs;
+  configs.push_back(create_batch_pipeline("first", "first_tests"));
+  configs.push_back(create_batch_pipeline("second", "second_tests"));
+  std::string command = "./snakemake_unit_tests.out --batch batch.yaml --update-all -t 2 -e skipme";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  std::vector<params> pipelines = ap.set_batch_parameters(configs, false);
+  CPPUNIT_ASSERT(pipelines.size() == 2);
+  for (unsigned i = 0; i < pipelines.size(); ++i) {
+    CPPUNIT_ASSERT(pipelines.at(i).config_filename == configs.at(i));
+    // every other command line option applies to each pipeline
+    CPPUNIT_ASSERT(pipelines.at(i).update_all);
+    CPPUNIT_ASSERT(pipelines.at(i).threads == 2U);
+    CPPUNIT_ASSERT(pipelines.at(i).exclude_rules.find("skipme") != pipelines.at(i).exclude_rules.end());
+  }
+  CPPUNIT_ASSERT(pipelines.at(0).output_test_dir == boost::filesystem::path(std::string(_tmp_dir)) / "first_tests");
+  CPPUNIT_ASSERT(pipelines.at(1).pipeline_top_dir == boost::filesystem::path(std::string(_tmp_dir)) / "second");
+}
+void snakemake_unit_tests::cargsTest::test_cargs_set_batch_parameters_pipeline_option() {
+  std::vector<boost::filesystem::path> configs;
+  configs.push_back(create_batch_pipeline("first", "first_tests"));
+  std::string command = "./snakemake_unit_tests.out --batch batch.yaml -o shared_tests";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  ap.set_batch_parameters(configs, false);
+}
+void snakemake_unit_tests::cargsTest::test_cargs_set_batch_parameters_shared_output() {
+  std::vector<boost::filesystem::path> configs;
+  configs.push_back(create_batch_pipeline("first", "tests"));
+  configs.push_back(create_batch_pipeline("second", "tests/../tests"));
+  std::string command = "./snakemake_unit_tests.out --batch batch.yaml";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  ap.set_batch_parameters(configs, false);
+}
+void snakemake_unit_tests::cargsTest::test_cargs_set_batch_parameters_run_tests() {
+  std::vector<boost::filesystem::path> configs;
+  configs.push_back(create_batch_pipeline("first", "first_tests"));
+  std::string command = "./snakemake_unit_tests.out --batch batch.yaml --run-tests";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  ap.set_batch_parameters(configs, false);
+}
+void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_run_tests() {
+  // running tests only needs the output directory; the pipeline itself need not exist
+  boost::filesystem::path outdir = boost::filesystem::path(std::string(_tmp_dir)) / "run_tests";
+  boost::filesystem::create_directories(outdir / "unit");
+  std::string command = "./snakemake_unit_tests.out --run-tests -o " + outdir.string() +
+                        " -t 3 --memory-budget 4000 --junit-xml report.xml -n keepme -e skipme";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_parameters(false);
+  CPPUNIT_ASSERT(p.run_tests);
+  CPPUNIT_ASSERT(p.output_test_dir == outdir);
+  CPPUNIT_ASSERT(p.threads == 3U);
+  CPPUNIT_ASSERT(p.memory_budget == 4000U);
+  CPPUNIT_ASSERT(p.junit_xml == "report.xml");
+  CPPUNIT_ASSERT(p.include_rules.size() == 1 && p.include_rules.find("keepme") != p.include_rules.end());
+  CPPUNIT_ASSERT(p.exclude_rules.find("skipme") != p.exclude_rules.end());
+  CPPUNIT_ASSERT(p.exclude_rules.find("all") != p.exclude_rules.end());
+  CPPUNIT_ASSERT(p.snakefile.string().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_run_tests_missing_tests() {
+  boost::filesystem::path outdir = boost::filesystem::path(std::string(_tmp_dir)) / "run_tests_missing";
+  std::string command = "./snakemake_unit_tests.out --run-tests -o " + outdir.string();
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  ap.set_parameters(false);
+}
+void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_junit_xml_without_run_tests() {
+  // a report is only written by a test run
+  std::string command = "./snakemake_unit_tests.out -o outdir --junit-xml report.xml";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  ap.set_parameters(false);
+}
+
 void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_inst_dir_missing_test() {
   // construct an otherwise valid command, but test.py isn't present under inst
   boost::filesystem::path prefix = std::string(_tmp_dir);
@@ -1144,6 +1437,12 @@ void snakemake_unit_tests::cargsTest::test_cargs_get_config_yaml() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(!ap.get_config_yaml().compare("configname.yaml"));
 }
+void snakemake_unit_tests::cargsTest::test_cargs_get_batch() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap.get_batch().compare("batch.yaml"));
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap_short.get_batch().empty());
+}
 void snakemake_unit_tests::cargsTest::test_cargs_get_snakefile() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(!ap.get_snakefile().compare("Snakefile"));
@@ -1168,6 +1467,48 @@ void snakemake_unit_tests::cargsTest::test_cargs_get_inst_dir() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(!ap.get_inst_dir().compare("inst"));
 }
+void snakemake_unit_tests::cargsTest::test_cargs_get_output_format() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap.get_output_format().compare("archive"));
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap_short.get_output_format().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_resolution_harness() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap.get_resolution_harness().compare("parse"));
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap_short.get_resolution_harness().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_plan_format() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap.get_plan_format().compare("json"));
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap_short.get_plan_format().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_threads() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap.get_threads() == 4U);
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap_short.get_threads());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_junit_xml() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap.get_junit_xml().compare("report.xml"));
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap_short.get_junit_xml().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_memory_budget() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap.get_memory_budget() == 8000U);
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap_short.get_memory_budget());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_compare() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap.get_compare().compare("comparisons.tsv"));
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap_short.get_compare().empty());
+}
 void snakemake_unit_tests::cargsTest::test_cargs_get_added_files() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   std::vector<std::string> res = ap.get_added_files();
@@ -1192,10 +1533,28 @@ void snakemake_unit_tests::cargsTest::test_cargs_include_entire_dag() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(ap.include_entire_dag());
 }
+void snakemake_unit_tests::cargsTest::test_cargs_shared_includes() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap.shared_includes());
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap_short.shared_includes());
+}
 void snakemake_unit_tests::cargsTest::test_cargs_skip_validation() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(ap.skip_validation());
 }
+void snakemake_unit_tests::cargsTest::test_cargs_plan() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap.plan());
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap_short.plan());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_run_tests() {
+  cargs ap(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap.run_tests());
+  cargs ap_short(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap_short.run_tests());
+}
 void snakemake_unit_tests::cargsTest::test_cargs_update_all() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(ap.update_all());
@@ -1237,6 +1596,7 @@ void snakemake_unit_tests::cargsTest::test_cargs_compute_flag() {
   CPPUNIT_ASSERT_MESSAGE("cargs compute_flag gracefully handles absent tags", !ap.compute_flag("update-all"));
   // make sure all permitted flags are in fact permitted
   CPPUNIT_ASSERT(!ap.compute_flag("include-entire-dag"));
+  CPPUNIT_ASSERT(!ap.compute_flag("shared-includes"));
   CPPUNIT_ASSERT(!ap.compute_flag("disable-config-validation"));
   CPPUNIT_ASSERT(!ap.compute_flag("update-all"));
   CPPUNIT_ASSERT(!ap.compute_flag("update-snakefiles"));
@@ -1245,6 +1605,7 @@ void snakemake_unit_tests::cargsTest::test_cargs_compute_flag() {
   CPPUNIT_ASSERT(!ap.compute_flag("update-outputs"));
   CPPUNIT_ASSERT(!ap.compute_flag("update-pytest"));
   CPPUNIT_ASSERT(!ap.compute_flag("update-config"));
+  CPPUNIT_ASSERT(!ap.compute_flag("plan"));
 }
 void snakemake_unit_tests::cargsTest::test_cargs_compute_flag_invalid_flag() {
   cargs ap(_arg_vec_short.size(), _argv_short);
@@ -30,6 +30,7 @@ class cargsTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_params_default_constructor);
   CPPUNIT_TEST(test_params_copy_constructor);
   CPPUNIT_TEST(test_params_report_settings);
+  CPPUNIT_TEST(test_params_report_settings_output_format);
   CPPUNIT_TEST(test_params_emit_yaml_map_multiple_entries);
   CPPUNIT_TEST(test_params_emit_yaml_map_single_entry);
   CPPUNIT_TEST(test_params_emit_yaml_map_no_entries);
@@ -54,20 +55,42 @@ class cargsTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_added_files_invalid, std::logic_error);
   CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_added_directories_invalid, std::logic_error);
   CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_inst_dir_missing_schema, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_output_format_invalid, std::logic_error);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_resolution_harness_invalid, std::logic_error);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_plan_format_invalid, std::logic_error);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_shared_includes_archive, std::logic_error);
+  CPPUNIT_TEST(test_cargs_set_batch_parameters);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_batch_parameters_pipeline_option, std::logic_error);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_batch_parameters_shared_output, std::logic_error);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_batch_parameters_run_tests, std::logic_error);
+  CPPUNIT_TEST(test_cargs_set_parameters_run_tests);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_run_tests_missing_tests, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_junit_xml_without_run_tests, std::logic_error);
   CPPUNIT_TEST(test_cargs_help);
   CPPUNIT_TEST(test_cargs_get_config_yaml);
+  CPPUNIT_TEST(test_cargs_get_batch);
   CPPUNIT_TEST(test_cargs_get_snakefile);
   CPPUNIT_TEST(test_cargs_get_snakemake_log);
   CPPUNIT_TEST(test_cargs_get_output_test_dir);
   CPPUNIT_TEST(test_cargs_get_pipeline_top_dir);
   CPPUNIT_TEST(test_cargs_get_pipeline_run_dir);
   CPPUNIT_TEST(test_cargs_get_inst_dir);
+  CPPUNIT_TEST(test_cargs_get_output_format);
+  CPPUNIT_TEST(test_cargs_get_resolution_harness);
+  CPPUNIT_TEST(test_cargs_get_plan_format);
+  CPPUNIT_TEST(test_cargs_get_threads);
+  CPPUNIT_TEST(test_cargs_get_junit_xml);
+  CPPUNIT_TEST(test_cargs_get_memory_budget);
+  CPPUNIT_TEST(test_cargs_get_compare);
   CPPUNIT_TEST(test_cargs_get_added_files);
   CPPUNIT_TEST(test_cargs_get_added_directories);
   CPPUNIT_TEST(test_cargs_get_include_rules);
   CPPUNIT_TEST(test_cargs_get_exclude_rules);
   CPPUNIT_TEST(test_cargs_include_entire_dag);
+  CPPUNIT_TEST(test_cargs_shared_includes);
   CPPUNIT_TEST(test_cargs_skip_validation);
+  CPPUNIT_TEST(test_cargs_plan);
+  CPPUNIT_TEST(test_cargs_run_tests);
   CPPUNIT_TEST(test_cargs_update_all);
   CPPUNIT_TEST(test_cargs_update_snakefiles);
   CPPUNIT_TEST(test_cargs_update_added_content);
@@ -105,6 +128,7 @@ class cargsTest : public CppUnit::TestFixture {
   void test_params_default_constructor();
   void test_params_copy_constructor();
   void test_params_report_settings();
+  void test_params_report_settings_output_format();
   void test_params_emit_yaml_map_multiple_entries();
   void test_params_emit_yaml_map_single_entry();
   void test_params_emit_yaml_map_no_entries();
@@ -129,20 +153,42 @@ class cargsTest : public CppUnit::TestFixture {
   void test_cargs_set_parameters_added_files_invalid();
   void test_cargs_set_parameters_added_directories_invalid();
   void test_cargs_set_parameters_inst_dir_missing_schema();
+  void test_cargs_set_parameters_output_format_invalid();
+  void test_cargs_set_parameters_resolution_harness_invalid();
+  void test_cargs_set_parameters_plan_format_invalid();
+  void test_cargs_set_parameters_shared_includes_archive();
+  void test_cargs_set_batch_parameters();
+  void test_cargs_set_batch_parameters_pipeline_option();
+  void test_cargs_set_batch_parameters_shared_output();
+  void test_cargs_set_batch_parameters_run_tests();
+  void test_cargs_set_parameters_run_tests();
+  void test_cargs_set_parameters_run_tests_missing_tests();
+  void test_cargs_set_parameters_junit_xml_without_run_tests();
   void test_cargs_help();
   void test_cargs_get_config_yaml();
+  void test_cargs_get_batch();
   void test_cargs_get_snakefile();
   void test_cargs_get_snakemake_log();
   void test_cargs_get_output_test_dir();
   void test_cargs_get_pipeline_top_dir();
   void test_cargs_get_pipeline_run_dir();
   void test_cargs_get_inst_dir();
+  void test_cargs_get_output_format();
+  void test_cargs_get_resolution_harness();
+  void test_cargs_get_plan_format();
+  void test_cargs_get_threads();
+  void test_cargs_get_junit_xml();
+  void test_cargs_get_memory_budget();
+  void test_cargs_get_compare();
   void test_cargs_get_added_files();
   void test_cargs_get_added_directories();
   void test_cargs_get_include_rules();
   void test_cargs_get_exclude_rules();
   void test_cargs_include_entire_dag();
+  void test_cargs_shared_includes();
   void test_cargs_skip_validation();
+  void test_cargs_plan();
+  void test_cargs_run_tests();
   void test_cargs_update_all();
   void test_cargs_update_snakefiles();
   void test_cargs_update_added_content();
@@ -174,6 +220,7 @@ class cargsTest : public CppUnit::TestFixture {
  private:
   void populate_arguments(const std::string &cmd, std::vector<std::string> *vec, const char ***arr) const;
   void create_empty_file(const boost::filesystem::path &p) const;
+  boost::filesystem::path create_batch_pipeline(const std::string &name, const std::string &output_dir) const;
 
   const char **_argv_long;
   const char **_argv_short;
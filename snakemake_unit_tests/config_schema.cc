@@ -0,0 +1,257 @@
+/*!
+  @file config_schema.cc
+  @brief implementation of config_schema class
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/config_schema.h"
+
+snakemake_unit_tests::config_schema::config_schema(const boost::filesystem::path &filename) {
+  compile(YAML::LoadFile(filename.string()), "", &_root);
+}
+
+snakemake_unit_tests::config_schema::config_schema(const YAML::Node &schema) { compile(schema, "", &_root); }
+
+bool snakemake_unit_tests::config_schema::validate(const YAML::Node &instance, std::string *error) const {
+  if (!error) throw std::runtime_error("null pointer provided to config_schema::validate");
+  error->clear();
+  return validate_node(_root, instance, "", error);
+}
+
+std::string snakemake_unit_tests::config_schema::instance_type(const YAML::Node &node) {
+  if (node.IsSequence()) return "array";
+  if (node.IsMap()) return "object";
+  if (!node.IsScalar()) return "null";
+  // quoted scalars, and scalars tagged as strings, are never resolved
+  if (!node.Tag().compare("!") || !node.Tag().compare("tag:yaml.org,2002:str")) return "string";
+  if (!node.Tag().compare("tag:yaml.org,2002:bool")) return "boolean";
+  if (!node.Tag().compare("tag:yaml.org,2002:int")) return "integer";
+  if (!node.Tag().compare("tag:yaml.org,2002:float")) return "number";
+  if (!node.Tag().compare("tag:yaml.org,2002:null")) return "null";
+  // the implicit resolvers of pyyaml's SafeLoader
+  static const boost::regex bool_value("yes|Yes|YES|no|No|NO|true|True|TRUE|false|False|FALSE|on|On|ON|off|Off|OFF");
+  static const boost::regex int_value(
+      "[-+]?0b[0-1_]+|[-+]?0[0-7_]+|[-+]?(?:0|[1-9][0-9_]*)|[-+]?0x[0-9a-fA-F_]+|[-+]?[1-9][0-9_]*(?::[0-5]?[0-9])+");
+  static const boost::regex float_value(
+      "[-+]?(?:[0-9][0-9_]*)\\.[0-9_]*(?:[eE][-+][0-9]+)?|\\.[0-9][0-9_]*(?:[eE][-+][0-9]+)?"
+      "|[-+]?[0-9][0-9_]*(?::[0-5]?[0-9])+\\.[0-9_]*|[-+]?\\.(?:inf|Inf|INF)|\\.(?:nan|NaN|NAN)");
+  const std::string &value = node.Scalar();
+  if (boost::regex_match(value, bool_value)) return "boolean";
+  if (boost::regex_match(value, int_value)) return "integer";
+  if (boost::regex_match(value, float_value)) return "number";
+  return "string";
+}
+
+std::string snakemake_unit_tests::config_schema::python_repr(const YAML::Node &node) {
+  std::string type = instance_type(node);
+  if (!type.compare("null")) return "None";
+  if (!type.compare("boolean")) {
+    char first = node.Scalar().at(0);
+    return first == 'y' || first == 'Y' || first == 't' || first == 'T' || !node.Scalar().compare("on") ||
+                   !node.Scalar().compare("On") || !node.Scalar().compare("ON")
+               ? "True"
+               : "False";
+  }
+  if (!type.compare("integer") || !type.compare("number")) return node.Scalar();
+  if (!type.compare("string")) {
+    // python prefers single quotes, unless only double quotes avoid escaping
+    const std::string &value = node.Scalar();
+    char quote = value.find('\'') != std::string::npos && value.find('"') == std::string::npos ? '"' : '\'';
+    std::string res(1, quote);
+    for (std::string::const_iterator iter = value.begin(); iter != value.end(); ++iter) {
+      if (*iter == '\\' || *iter == quote) {
+        res += '\\';
+        res += *iter;
+      } else if (*iter == '\n') {
+        res += "\\n";
+      } else if (*iter == '\t') {
+        res += "\\t";
+      } else {
+        res += *iter;
+      }
+    }
+    return res + quote;
+  }
+  std::string res = node.IsSequence() ? "[" : "{";
+  for (YAML::const_iterator iter = node.begin(); iter != node.end(); ++iter) {
+    if (res.size() > 1) res += ", ";
+    if (node.IsSequence()) {
+      res += python_repr(*iter);
+    } else {
+      res += python_repr(iter->first) + ": " + python_repr(iter->second);
+    }
+  }
+  return res + (node.IsSequence() ? "]" : "}");
+}
+
+void snakemake_unit_tests::config_schema::compile(const YAML::Node &schema, const std::string &location,
+                                                  schema_node *target) {
+  if (!target) throw std::runtime_error("null pointer provided to config_schema::compile");
+  if (!schema.IsMap()) throw std::runtime_error("config schema at schema" + location + " is not an object");
+  target->location = location;
+  target->additional_properties = true;
+  target->has_pattern = false;
+  for (YAML::const_iterator iter = schema.begin(); iter != schema.end(); ++iter) {
+    const std::string keyword = iter->first.Scalar();
+    const YAML::Node &value = iter->second;
+    const std::string keyword_location = location + "['" + keyword + "']";
+    if (!keyword.compare("$schema") || !keyword.compare("description")) {
+      // annotations only
+      continue;
+    } else if (!keyword.compare("type")) {
+      if (value.IsScalar()) {
+        target->types.push_back(value.Scalar());
+      } else if (value.IsSequence()) {
+        for (YAML::const_iterator type = value.begin(); type != value.end(); ++type) {
+          target->types.push_back(type->Scalar());
+        }
+      } else {
+        throw std::runtime_error("config schema type at schema" + keyword_location + " is not a name or list");
+      }
+      for (std::vector<std::string>::const_iterator type = target->types.begin(); type != target->types.end();
+           ++type) {
+        if (type->compare("null") && type->compare("boolean") && type->compare("integer") &&
+            type->compare("number") && type->compare("string") && type->compare("array") && type->compare("object"))
+          throw std::runtime_error("config schema type \"" + *type + "\" at schema" + keyword_location +
+                                   " is not recognized");
+      }
+    } else if (!keyword.compare("properties")) {
+      if (!value.IsMap())
+        throw std::runtime_error("config schema properties at schema" + keyword_location + " is not an object");
+      for (YAML::const_iterator property = value.begin(); property != value.end(); ++property) {
+        target->property_names.push_back(property->first.Scalar());
+        target->property_schemas.push_back(schema_node());
+        compile(property->second, keyword_location + "['" + property->first.Scalar() + "']",
+                &target->property_schemas.back());
+      }
+    } else if (!keyword.compare("required")) {
+      if (!value.IsSequence())
+        throw std::runtime_error("config schema required at schema" + keyword_location + " is not a list");
+      for (YAML::const_iterator name = value.begin(); name != value.end(); ++name) {
+        target->required.push_back(name->Scalar());
+      }
+    } else if (!keyword.compare("additionalProperties")) {
+      if (!value.IsScalar() || instance_type(value).compare("boolean"))
+        throw std::runtime_error("config schema additionalProperties at schema" + keyword_location +
+                                 " is only supported as true or false");
+      target->additional_properties = !python_repr(value).compare("True");
+    } else if (!keyword.compare("items")) {
+      target->items = boost::shared_ptr<schema_node>(new schema_node);
+      compile(value, keyword_location, target->items.get());
+    } else if (!keyword.compare("pattern")) {
+      if (!value.IsScalar())
+        throw std::runtime_error("config schema pattern at schema" + keyword_location + " is not a string");
+      target->has_pattern = true;
+      target->pattern_text = value.Scalar();
+      target->pattern = boost::regex(target->pattern_text);
+    } else if (!keyword.compare("oneOf")) {
+      if (!value.IsSequence())
+        throw std::runtime_error("config schema oneOf at schema" + keyword_location + " is not a list");
+      for (YAML::const_iterator alternative = value.begin(); alternative != value.end(); ++alternative) {
+        target->one_of.push_back(schema_node());
+        compile(*alternative, keyword_location + "[" + std::to_string(target->one_of.size() - 1) + "]",
+                &target->one_of.back());
+      }
+    } else {
+      throw std::runtime_error("config schema keyword \"" + keyword + "\" at schema" + keyword_location +
+                               " is not supported");
+    }
+  }
+}
+
+std::string snakemake_unit_tests::config_schema::describe_failure(const std::string &message,
+                                                                  const std::string &keyword,
+                                                                  const schema_node &schema,
+                                                                  const std::string &path) {
+  return message + "\n\nFailed validating '" + keyword + "' in schema" + schema.location + "\n\nOn instance" + path;
+}
+
+bool snakemake_unit_tests::config_schema::validate_node(const schema_node &schema, const YAML::Node &instance,
+                                                        const std::string &path, std::string *error) {
+  std::string type = instance_type(instance);
+  // type
+  if (!schema.types.empty()) {
+    bool matched = false;
+    for (std::vector<std::string>::const_iterator iter = schema.types.begin(); iter != schema.types.end() && !matched;
+         ++iter) {
+      matched = !iter->compare(type) || (!iter->compare("number") && !type.compare("integer"));
+    }
+    if (!matched) {
+      std::string names;
+      for (std::vector<std::string>::const_iterator iter = schema.types.begin(); iter != schema.types.end();
+           ++iter) {
+        names += (names.empty() ? "'" : ", '") + *iter + "'";
+      }
+      *error = describe_failure(python_repr(instance) + " is not of type " + names, "type", schema, path);
+      return false;
+    }
+  }
+  if (!type.compare("object")) {
+    // properties
+    for (YAML::const_iterator iter = instance.begin(); iter != instance.end(); ++iter) {
+      const std::string name = iter->first.Scalar();
+      for (unsigned i = 0; i < schema.property_names.size(); ++i) {
+        if (!schema.property_names.at(i).compare(name) &&
+            !validate_node(schema.property_schemas.at(i), iter->second, path + "['" + name + "']", error))
+          return false;
+      }
+    }
+    // required
+    for (std::vector<std::string>::const_iterator iter = schema.required.begin(); iter != schema.required.end();
+         ++iter) {
+      if (!instance[*iter]) {
+        *error = describe_failure("'" + *iter + "' is a required property", "required", schema, path);
+        return false;
+      }
+    }
+    // additionalProperties
+    if (!schema.additional_properties) {
+      std::vector<std::string> unexpected;
+      for (YAML::const_iterator iter = instance.begin(); iter != instance.end(); ++iter) {
+        if (std::find(schema.property_names.begin(), schema.property_names.end(), iter->first.Scalar()) ==
+            schema.property_names.end())
+          unexpected.push_back(python_repr(iter->first));
+      }
+      if (!unexpected.empty()) {
+        std::string names;
+        for (std::vector<std::string>::const_iterator iter = unexpected.begin(); iter != unexpected.end(); ++iter) {
+          names += (names.empty() ? "" : ", ") + *iter;
+        }
+        *error = describe_failure("Additional properties are not allowed (" + names +
+                                      (unexpected.size() == 1 ? " was" : " were") + " unexpected)",
+                                  "additionalProperties", schema, path);
+        return false;
+      }
+    }
+  } else if (!type.compare("array") && schema.items) {
+    // items
+    unsigned index = 0;
+    for (YAML::const_iterator iter = instance.begin(); iter != instance.end(); ++iter, ++index) {
+      if (!validate_node(*schema.items, *iter, path + "[" + std::to_string(index) + "]", error)) return false;
+    }
+  } else if (!type.compare("string") && schema.has_pattern) {
+    // pattern, which like python's re.search need not match the whole string
+    if (!boost::regex_search(instance.Scalar(), schema.pattern)) {
+      *error = describe_failure(python_repr(instance) + " does not match '" + schema.pattern_text + "'", "pattern",
+                                schema, path);
+      return false;
+    }
+  }
+  // oneOf
+  if (!schema.one_of.empty()) {
+    unsigned n_valid = 0;
+    std::string ignored;
+    for (std::vector<schema_node>::const_iterator iter = schema.one_of.begin(); iter != schema.one_of.end(); ++iter) {
+      if (validate_node(*iter, instance, path, &ignored)) ++n_valid;
+    }
+    if (n_valid != 1) {
+      *error = describe_failure(python_repr(instance) + (n_valid ? " is valid under each of the given schemas"
+                                                                 : " is not valid under any of the given schemas"),
+                                "oneOf", schema, path);
+      return false;
+    }
+  }
+  return true;
+}
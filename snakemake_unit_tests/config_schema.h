@@ -0,0 +1,136 @@
+/*!
+  @file config_schema.h
+  @brief validation of yaml configuration against a json schema
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  user configuration was previously validated by snakemake's python
+  validator, which paid for an interpreter and a snakemake import on every
+  run, and could not run at all without snakemake installed. the schema in
+  inst/ only uses a handful of draft-07 keywords, which are implemented
+  here. schemas that use any other keyword are rejected when they are
+  loaded, rather than silently enforced in part.
+
+  scalars are typed the way python's yaml.safe_load types them, and
+  failures are described in the words of python's jsonschema package.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_CONFIG_SCHEMA_H_
+#define SNAKEMAKE_UNIT_TESTS_CONFIG_SCHEMA_H_
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "boost/regex.hpp"
+#include "boost/shared_ptr.hpp"
+#include "yaml-cpp/yaml.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @class config_schema
+  @brief compiled json schema, for validating yaml documents in process
+ */
+class config_schema {
+ public:
+  /*!
+    @brief constructor: load and compile a schema file
+    @param filename yaml or json file containing the schema
+   */
+  explicit config_schema(const boost::filesystem::path &filename);
+  /*!
+    @brief constructor: compile a loaded schema
+    @param schema top level node of the schema
+   */
+  explicit config_schema(const YAML::Node &schema);
+  /*!
+    @brief destructor
+   */
+  ~config_schema() throw() {}
+  /*!
+    @brief validate a document against the schema
+    @param instance top level node of the document
+    @param error where to describe the first failure found, if any
+    @return whether the document is valid
+   */
+  bool validate(const YAML::Node &instance, std::string *error) const;
+  /*!
+    @brief get the json type of a yaml node
+    @param node node to inspect
+    @return one of null, boolean, integer, number, string, array, or object
+
+    plain scalars are resolved with the YAML 1.1 rules of python's yaml.safe_load,
+    so for example "yes" is a boolean and "1e5" is a string
+   */
+  static std::string instance_type(const YAML::Node &node);
+  /*!
+    @brief describe a yaml node as python would print it
+    @param node node to describe
+    @return python representation of the node's value
+   */
+  static std::string python_repr(const YAML::Node &node);
+
+ private:
+  friend class config_schemaTest;
+  /*!
+    @brief one compiled (sub)schema
+   */
+  struct schema_node {
+    std::string location;                       //!< path to this subschema, as jsonschema reports it
+    std::vector<std::string> types;             //!< permitted types; empty permits any
+    std::vector<std::string> property_names;    //!< names with property schemas
+    std::vector<schema_node> property_schemas;  //!< schemas of named properties
+    std::vector<std::string> required;          //!< properties that must be present
+    bool additional_properties;                 //!< whether unnamed properties are permitted
+    boost::shared_ptr<schema_node> items;       //!< schema of every array element, if any
+    bool has_pattern;                           //!< whether strings must match pattern
+    std::string pattern_text;                   //!< pattern, as written in the schema
+    boost::regex pattern;                       //!< compiled pattern
+    std::vector<schema_node> one_of;            //!< alternatives, exactly one of which must match
+  };
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  config_schema() { throw std::domain_error("config_schema: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing config_schema object
+    @warning disabled
+   */
+  config_schema(const config_schema &obj) { throw std::domain_error("config_schema: do not use copy constructor"); }
+  /*!
+    @brief compile a schema node
+    @param schema schema node to compile
+    @param location path to the node, as jsonschema reports it
+    @param target where to store the compiled schema
+   */
+  static void compile(const YAML::Node &schema, const std::string &location, schema_node *target);
+  /*!
+    @brief validate a document node against a compiled schema node
+    @param schema compiled schema node
+    @param instance document node
+    @param path path to the document node, as jsonschema reports it
+    @param error where to describe the first failure found, if any
+    @return whether the document node is valid
+   */
+  static bool validate_node(const schema_node &schema, const YAML::Node &instance, const std::string &path,
+                            std::string *error);
+  /*!
+    @brief describe a failure the way jsonschema does
+    @param message description of the failure
+    @param keyword schema keyword that failed
+    @param schema compiled schema node containing the keyword
+    @param path path to the failing document node
+    @return complete description
+   */
+  static std::string describe_failure(const std::string &message, const std::string &keyword,
+                                      const schema_node &schema, const std::string &path);
+  schema_node _root;  //!< compiled top level schema
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_CONFIG_SCHEMA_H_
@@ -0,0 +1,173 @@
+/*!
+  \file config_schemaTest.cc
+  \brief implementation of config_schema unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/config_schemaTest.h"
+
+void snakemake_unit_tests::config_schemaTest::setUp() {}
+
+void snakemake_unit_tests::config_schemaTest::tearDown() {}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_file_constructor() {
+  config_schema schema(boost::filesystem::path("inst/user_config_schema.yaml"));
+  CPPUNIT_ASSERT(schema._root.location.empty());
+  CPPUNIT_ASSERT(schema._root.types.size() == 1);
+  CPPUNIT_ASSERT(!schema._root.types.at(0).compare("object"));
+  CPPUNIT_ASSERT(!schema._root.additional_properties);
+  CPPUNIT_ASSERT(!schema._root.property_names.empty());
+  CPPUNIT_ASSERT(schema._root.property_names.size() == schema._root.property_schemas.size());
+  CPPUNIT_ASSERT(!schema._root.property_names.at(0).compare("output-test-dir"));
+  CPPUNIT_ASSERT(!schema._root.property_schemas.at(0).location.compare("['properties']['output-test-dir']"));
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_node_constructor() {
+  config_schema schema(YAML::Load(
+      "type: object\nproperties:\n  a:\n    type: [string, \"null\"]\n    pattern: \"^x\"\n  b:\n    type: array\n"
+      "    items:\n      oneOf:\n        - type: integer\n        - type: boolean\nrequired:\n  - a\n"
+      "additionalProperties: no\n"));
+  CPPUNIT_ASSERT(schema._root.property_names.size() == 2);
+  const config_schema::schema_node &a = schema._root.property_schemas.at(0);
+  CPPUNIT_ASSERT(a.types.size() == 2);
+  CPPUNIT_ASSERT(!a.types.at(1).compare("null"));
+  CPPUNIT_ASSERT(a.has_pattern);
+  CPPUNIT_ASSERT(!a.pattern_text.compare("^x"));
+  const config_schema::schema_node &b = schema._root.property_schemas.at(1);
+  CPPUNIT_ASSERT(b.items);
+  CPPUNIT_ASSERT(!b.items->location.compare("['properties']['b']['items']"));
+  CPPUNIT_ASSERT(b.items->one_of.size() == 2);
+  CPPUNIT_ASSERT(!b.items->one_of.at(1).location.compare("['properties']['b']['items']['oneOf'][1]"));
+  CPPUNIT_ASSERT(schema._root.required.size() == 1);
+  CPPUNIT_ASSERT(!schema._root.additional_properties);
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_unsupported_keyword() {
+  config_schema schema(YAML::Load("type: object\nminProperties: 1\n"));
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_unrecognized_type() {
+  config_schema schema(YAML::Load("type: text\n"));
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_instance_type() {
+  CPPUNIT_ASSERT_EQUAL(std::string("boolean"), config_schema::instance_type(YAML::Load("yes")));
+  CPPUNIT_ASSERT_EQUAL(std::string("boolean"), config_schema::instance_type(YAML::Load("False")));
+  CPPUNIT_ASSERT_EQUAL(std::string("integer"), config_schema::instance_type(YAML::Load("-12")));
+  CPPUNIT_ASSERT_EQUAL(std::string("integer"), config_schema::instance_type(YAML::Load("0x1F")));
+  CPPUNIT_ASSERT_EQUAL(std::string("number"), config_schema::instance_type(YAML::Load("1.5")));
+  CPPUNIT_ASSERT_EQUAL(std::string("number"), config_schema::instance_type(YAML::Load("1.0e+5")));
+  // pyyaml requires a dot and a signed exponent
+  CPPUNIT_ASSERT_EQUAL(std::string("string"), config_schema::instance_type(YAML::Load("1e5")));
+  CPPUNIT_ASSERT_EQUAL(std::string("string"), config_schema::instance_type(YAML::Load("\"1\"")));
+  CPPUNIT_ASSERT_EQUAL(std::string("string"), config_schema::instance_type(YAML::Load("'yes'")));
+  CPPUNIT_ASSERT_EQUAL(std::string("string"), config_schema::instance_type(YAML::Load("plain text")));
+  CPPUNIT_ASSERT_EQUAL(std::string("null"), config_schema::instance_type(YAML::Load("~")));
+  CPPUNIT_ASSERT_EQUAL(std::string("null"), config_schema::instance_type(YAML::Load("a:")["a"]));
+  CPPUNIT_ASSERT_EQUAL(std::string("array"), config_schema::instance_type(YAML::Load("[1, 2]")));
+  CPPUNIT_ASSERT_EQUAL(std::string("object"), config_schema::instance_type(YAML::Load("{a: 1}")));
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_python_repr() {
+  CPPUNIT_ASSERT_EQUAL(std::string("None"), config_schema::python_repr(YAML::Load("null")));
+  CPPUNIT_ASSERT_EQUAL(std::string("True"), config_schema::python_repr(YAML::Load("on")));
+  CPPUNIT_ASSERT_EQUAL(std::string("False"), config_schema::python_repr(YAML::Load("no")));
+  CPPUNIT_ASSERT_EQUAL(std::string("3"), config_schema::python_repr(YAML::Load("3")));
+  CPPUNIT_ASSERT_EQUAL(std::string("'abc'"), config_schema::python_repr(YAML::Load("abc")));
+  CPPUNIT_ASSERT_EQUAL(std::string("\"it's\""), config_schema::python_repr(YAML::Load("\"it's\"")));
+  CPPUNIT_ASSERT_EQUAL(std::string("'a\\nb'"), config_schema::python_repr(YAML::Load("\"a\\nb\"")));
+  CPPUNIT_ASSERT_EQUAL(std::string("['x', 1]"), config_schema::python_repr(YAML::Load("[x, 1]")));
+  CPPUNIT_ASSERT_EQUAL(std::string("{'a': None}"), config_schema::python_repr(YAML::Load("{a: ~}")));
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_validate_type() {
+  config_schema schema(YAML::Load("properties:\n  a:\n    type: number\n  b:\n    type: [string, array]\n"));
+  std::string error;
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("a: 2\nb: [1]\n"), &error));
+  CPPUNIT_ASSERT(error.empty());
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("a: 2.5\nb: x\n"), &error));
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("a: x\n"), &error));
+  CPPUNIT_ASSERT_EQUAL(std::string("'x' is not of type 'number'\n\nFailed validating 'type' in "
+                                   "schema['properties']['a']\n\nOn instance['a']"),
+                       error);
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("b: true\n"), &error));
+  CPPUNIT_ASSERT_EQUAL(std::string("True is not of type 'string', 'array'\n\nFailed validating 'type' in "
+                                   "schema['properties']['b']\n\nOn instance['b']"),
+                       error);
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_validate_required() {
+  config_schema schema(YAML::Load("type: object\nrequired:\n  - big-hat\n"));
+  std::string error;
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("big-hat: ~\n"), &error));
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("added-files:\n  - filename.txt\n"), &error));
+  CPPUNIT_ASSERT_EQUAL(std::string("'big-hat' is a required property\n\nFailed validating 'required' in "
+                                   "schema\n\nOn instance"),
+                       error);
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_validate_additional_properties() {
+  config_schema schema(YAML::Load("properties:\n  a:\n    type: string\nadditionalProperties: false\n"));
+  std::string error;
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("a: x\n"), &error));
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("a: x\nb: 1\n"), &error));
+  CPPUNIT_ASSERT_EQUAL(std::string("Additional properties are not allowed ('b' was unexpected)\n\nFailed "
+                                   "validating 'additionalProperties' in schema\n\nOn instance"),
+                       error);
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("b: 1\nc: 2\n"), &error));
+  CPPUNIT_ASSERT(error.find("('b', 'c' were unexpected)") != std::string::npos);
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_validate_items() {
+  config_schema schema(YAML::Load("type: array\nitems:\n  type: string\n"));
+  std::string error;
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("[a, b]"), &error));
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("[]"), &error));
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("[a, 1]"), &error));
+  CPPUNIT_ASSERT_EQUAL(std::string("1 is not of type 'string'\n\nFailed validating 'type' in "
+                                   "schema['items']\n\nOn instance[1]"),
+                       error);
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_validate_pattern() {
+  config_schema schema(YAML::Load("type: string\npattern: \"^directory$|^archive$\"\n"));
+  std::string error;
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("archive"), &error));
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("tarball"), &error));
+  CPPUNIT_ASSERT_EQUAL(std::string("'tarball' does not match '^directory$|^archive$'\n\nFailed validating "
+                                   "'pattern' in schema\n\nOn instance"),
+                       error);
+  // patterns are searched for, not matched against the whole string
+  config_schema unanchored(YAML::Load("pattern: \"ar\"\n"));
+  CPPUNIT_ASSERT(unanchored.validate(YAML::Load("archive"), &error));
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_validate_one_of() {
+  config_schema schema(YAML::Load("oneOf:\n  - type: string\n  - type: \"null\"\n"));
+  std::string error;
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("infer"), &error));
+  CPPUNIT_ASSERT(schema.validate(YAML::Load("~"), &error));
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("3"), &error));
+  CPPUNIT_ASSERT_EQUAL(std::string("3 is not valid under any of the given schemas\n\nFailed validating 'oneOf' "
+                                   "in schema\n\nOn instance"),
+                       error);
+  config_schema overlapping(YAML::Load("oneOf:\n  - type: number\n  - type: integer\n"));
+  CPPUNIT_ASSERT(!overlapping.validate(YAML::Load("3"), &error));
+  CPPUNIT_ASSERT(error.find("3 is valid under each of the given schemas") == 0);
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_validate_null_pointer() {
+  config_schema schema(YAML::Load("type: object\n"));
+  schema.validate(YAML::Load("{}"), NULL);
+}
+
+void snakemake_unit_tests::config_schemaTest::test_config_schema_validate_example_config() {
+  config_schema schema(boost::filesystem::path("inst/user_config_schema.yaml"));
+  std::string error;
+  CPPUNIT_ASSERT(schema.validate(YAML::LoadFile("config.example.yaml"), &error));
+  CPPUNIT_ASSERT(error.empty());
+  CPPUNIT_ASSERT(!schema.validate(YAML::Load("pipeline_dir: /path\n"), &error));
+  CPPUNIT_ASSERT(error.find("('pipeline_dir' was unexpected)") != std::string::npos);
+}
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::config_schemaTest);
@@ -0,0 +1,63 @@
+/*!
+  \file config_schemaTest.h
+  \brief config_schema test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_CONFIG_SCHEMATEST_H_
+#define SNAKEMAKE_UNIT_TESTS_CONFIG_SCHEMATEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "snakemake_unit_tests/config_schema.h"
+#include "yaml-cpp/yaml.h"
+
+namespace snakemake_unit_tests {
+class config_schemaTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(config_schemaTest);
+  CPPUNIT_TEST(test_config_schema_file_constructor);
+  CPPUNIT_TEST(test_config_schema_node_constructor);
+  CPPUNIT_TEST_EXCEPTION(test_config_schema_unsupported_keyword, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_config_schema_unrecognized_type, std::runtime_error);
+  CPPUNIT_TEST(test_config_schema_instance_type);
+  CPPUNIT_TEST(test_config_schema_python_repr);
+  CPPUNIT_TEST(test_config_schema_validate_type);
+  CPPUNIT_TEST(test_config_schema_validate_required);
+  CPPUNIT_TEST(test_config_schema_validate_additional_properties);
+  CPPUNIT_TEST(test_config_schema_validate_items);
+  CPPUNIT_TEST(test_config_schema_validate_pattern);
+  CPPUNIT_TEST(test_config_schema_validate_one_of);
+  CPPUNIT_TEST_EXCEPTION(test_config_schema_validate_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_config_schema_validate_example_config);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_config_schema_file_constructor();
+  void test_config_schema_node_constructor();
+  void test_config_schema_unsupported_keyword();
+  void test_config_schema_unrecognized_type();
+  void test_config_schema_instance_type();
+  void test_config_schema_python_repr();
+  void test_config_schema_validate_type();
+  void test_config_schema_validate_required();
+  void test_config_schema_validate_additional_properties();
+  void test_config_schema_validate_items();
+  void test_config_schema_validate_pattern();
+  void test_config_schema_validate_one_of();
+  void test_config_schema_validate_null_pointer();
+  void test_config_schema_validate_example_config();
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_CONFIG_SCHEMATEST_H_
@@ -8,6 +8,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -20,31 +21,21 @@
 #include <vector>
 
 #include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/batch.h"
 #include "snakemake_unit_tests/cargs.h"
+#include "snakemake_unit_tests/output_comparison.h"
+#include "snakemake_unit_tests/parse_cache.h"
 #include "snakemake_unit_tests/rule_block.h"
 #include "snakemake_unit_tests/snakemake_file.h"
 #include "snakemake_unit_tests/solved_rules.h"
+#include "snakemake_unit_tests/unit_test_runner.h"
 #include "snakemake_unit_tests/yaml_reader.h"
 
 /*!
-  @brief main program implementation
-  @param argc number of command line entries, including program name
-  @param argv array of command line entries
-  @return exit code: 0 on success, nonzero otherwise
+  @brief generate the tests of one pipeline
+  @param p resolved settings of the pipeline
  */
-int main(int argc, const char** const argv) {
-  // parse command line input
-  snakemake_unit_tests::cargs ap(argc, argv);
-  snakemake_unit_tests::params p;
-  // if help is requested or no flags specified
-  if (ap.help() || argc == 1) {
-    // print a help message and exist
-    ap.print_help(std::cout);
-    return 0;
-  }
-
-  p = ap.set_parameters();
-
+static void generate_tests(const snakemake_unit_tests::params &p) {
   // parse the top-level snakefile and all include files (hopefully)
   snakemake_unit_tests::snakemake_file sf;
   // express snakefile as path relative to top-level pipeline dir
@@ -63,12 +54,27 @@ int main(int argc, const char** const argv) {
   if (p.verbose) {
     std::cout << "computed snakefile is \"" << snakefile_str << "\"" << std::endl;
   }
+  // reuse parses of unchanged snakefiles from earlier runs; plan mode only reads the cache
+  boost::shared_ptr<snakemake_unit_tests::parse_cache> cache(
+      new snakemake_unit_tests::parse_cache(p.output_test_dir / ".parse_cache", p.plan));
+  sf.set_parse_cache(cache);
   sf.load_everything(boost::filesystem::path(snakefile_str), p.pipeline_top_dir, p.verbose);
 
   // parse the log file to determine the solved system of rules and outputs
   snakemake_unit_tests::solved_rules sr;
   sr.load_file(p.snakemake_log.string());
 
+  // plan mode: report what would be emitted, and stop before anything is written
+  if (p.plan) {
+    // what resolves without python needs no snakemake run
+    sf.resolve_statically(p.pipeline_top_dir, p.verbose, p.threads);
+    sr.report_plan(sf, p.pipeline_top_dir, p.pipeline_run_dir, p.include_rules, p.exclude_rules, p.added_files,
+                   p.added_directories, p.update_snakefiles || p.update_all, p.update_added_content || p.update_all,
+                   p.update_inputs || p.update_all, p.update_outputs || p.update_all, p.include_entire_dag,
+                   !p.plan_format.compare("json"), std::cout);
+    return;
+  }
+
   // new feature: python integration to resolve ambiguous rules
   // create empty workspace for run
   // should have: added files and directories
@@ -78,28 +84,44 @@ int main(int argc, const char** const argv) {
   std::map<std::string, std::vector<std::string> > files_outside_workspace;
   sr.create_empty_workspace(p.output_test_dir, p.pipeline_top_dir, p.added_files, p.added_directories,
                             &files_outside_workspace);
-  // do things in this location
-  do {
-    // scan the rule set for blockers
-    if (p.verbose) {
-      std::cout << "running a python/snakemake logic resolution pass" << std::endl;
+  // python sees the snakefiles and the added content; if none of it has changed, reuse the last resolution
+  std::vector<boost::filesystem::path> resolution_inputs(p.added_files);
+  resolution_inputs.insert(resolution_inputs.end(), p.added_directories.begin(), p.added_directories.end());
+  std::string resolution_key =
+      cache->contents_key(p.pipeline_top_dir, resolution_inputs) + " " + p.pipeline_run_dir.string();
+  if (!sf.restore_resolution(resolution_key, p.pipeline_top_dir, p.threads, p.verbose)) {
+    // literal includes and top level rules need no python at all
+    sf.resolve_statically(p.pipeline_top_dir, p.verbose, p.threads);
+    // do things in this location
+    while (sf.contains_blockers()) {
+      // scan the rule set for blockers
+      if (p.verbose) {
+        std::cout << "running a python/snakemake logic resolution pass" << std::endl;
+      }
+      sf.resolve_with_python(p.output_test_dir / ".snakemake_unit_tests", p.pipeline_top_dir, p.pipeline_run_dir,
+                             p.verbose, false, p.threads, !p.resolution_harness.compare("parse"), resolution_key);
     }
-    sf.resolve_with_python(p.output_test_dir / ".snakemake_unit_tests", p.pipeline_top_dir, p.pipeline_run_dir,
-                           p.verbose, false);
-  } while (sf.contains_blockers());
+    sf.store_resolution(resolution_key);
+  }
+  if (p.verbose) {
+    std::cout << "parse cache: " << cache->hits() << " snakefile(s) restored, " << cache->misses() << " parsed"
+              << std::endl;
+  }
 
   // remove the location
   sr.remove_empty_workspace(p.output_test_dir);
 
   // refactor: move postflight snakefile checks to after the python passes
   sf.postflight_checks(p.include_rules, p.exclude_rules);
+  // every synthetic snakefile is assembled from the same formatted blocks
+  sf.render_blocks();
 
   // iterate over the solved rules, emitting them with modifiers as desired
   sr.emit_tests(sf, p.output_test_dir, p.pipeline_top_dir, p.pipeline_run_dir, p.inst_dir, p.include_rules,
                 p.exclude_rules, p.added_files, p.added_directories, p.update_snakefiles || p.update_all,
                 p.update_added_content || p.update_all, p.update_inputs || p.update_all,
                 p.update_outputs || p.update_all, p.update_pytest || p.update_all, p.include_entire_dag,
-                &files_outside_workspace);
+                !p.output_format.compare("archive"), p.shared_includes, p.threads, &files_outside_workspace);
 
   if (!files_outside_workspace.empty()) {
     std::cout << "warning: file from outside of contained workspace detected."
@@ -129,6 +151,90 @@ int main(int argc, const char** const argv) {
   if (p.update_config || p.update_all) {
     p.report_settings(p.output_test_dir / "unit" / "config.yaml");
   }
-  std::cout << "all done woo!" << std::endl;
+  // entries for old versions of the snakefiles, and for passes this run did not need, are never used again
+  unsigned n_pruned = cache->prune();
+  if (p.verbose) {
+    std::cout << "parse cache: removed " << n_pruned << " unused entries" << std::endl;
+  }
+}
+
+/*!
+  @brief run the generated tests of one pipeline
+  @param p resolved settings of the pipeline
+  @return whether every test passed
+ */
+static bool run_tests(const snakemake_unit_tests::params &p) {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  snakemake_unit_tests::unit_test_runner runner(p.output_test_dir);
+  std::vector<snakemake_unit_tests::rule_test_result> results =
+      runner.run(runner.discover(p.include_rules, p.exclude_rules), p.threads, p.memory_budget, std::cout);
+  if (!p.junit_xml.string().empty()) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    snakemake_unit_tests::unit_test_runner::report_junit(results, seconds, p.junit_xml);
+  }
+  for (std::vector<snakemake_unit_tests::rule_test_result>::const_iterator iter = results.begin();
+       iter != results.end(); ++iter) {
+    if (!iter->passed) return false;
+  }
+  return true;
+}
+
+/*!
+  @brief compare generated test output with its expected copies
+  @param list file listing the comparisons, or '-' for standard input
+  @param n_threads number of files compared at once; 0 means one per available core
+  @return whether every file matched
+ */
+static bool compare_outputs(const std::string &list, unsigned n_threads) {
+  snakemake_unit_tests::output_comparison comparison;
+  if (!list.compare("-")) {
+    comparison.load(std::cin, "standard input");
+  } else {
+    std::ifstream input(list.c_str());
+    if (!input.is_open()) throw std::runtime_error("cannot open comparison list \"" + list + "\"");
+    comparison.load(input, list);
+    input.close();
+  }
+  bool matched = comparison.run(n_threads);
+  comparison.report(std::cout);
+  return matched;
+}
+
+/*!
+  @brief main program implementation
+  @param argc number of command line entries, including program name
+  @param argv array of command line entries
+  @return exit code: 0 on success, nonzero otherwise
+ */
+int main(int argc, const char** const argv) {
+  // parse command line input
+  snakemake_unit_tests::cargs ap(argc, argv);
+  // if help is requested or no flags specified
+  if (ap.help() || argc == 1) {
+    // print a help message and exist
+    ap.print_help(std::cout);
+    return 0;
+  }
+
+  if (!ap.get_compare().empty()) {
+    // compare mode serves the generated tests, and only reports mismatches
+    if (!ap.get_batch().empty() || ap.run_tests())
+      throw std::logic_error("\"compare\" cannot be combined with \"batch\" or \"run-tests\"");
+    return compare_outputs(ap.get_compare(), ap.get_threads()) ? 0 : 1;
+  } else if (!ap.get_batch().empty()) {
+    // batch mode: every listed pipeline in this one process, validated before any is started
+    snakemake_unit_tests::batch manifest(ap.get_batch());
+    std::vector<snakemake_unit_tests::params> pipelines = ap.set_batch_parameters(manifest.get_configs());
+    manifest.run(pipelines, ap.get_threads(), ap.verbose(), generate_tests, std::cout);
+  } else if (ap.run_tests()) {
+    // run mode reports as TAP, so nothing else is printed
+    return run_tests(ap.set_parameters()) ? 0 : 1;
+  } else {
+    generate_tests(ap.set_parameters());
+  }
+  // plan mode reports instead of generating anything
+  if (!ap.plan()) {
+    std::cout << "all done woo!" << std::endl;
+  }
   return 0;
 }
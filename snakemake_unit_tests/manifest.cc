@@ -0,0 +1,238 @@
+/*!
+  @file manifest.cc
+  @brief implementation of blake2b and manifest classes
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/manifest.h"
+
+#define MANIFEST_HEADER "# snakemake_unit_tests manifest v2: blake2b-256\tsize\tmtime\tpath"
+#define MANIFEST_READ_BUFFER_SIZE 1048576
+
+static const uint64_t blake2b_iv[8] = {0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+                                       0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+                                       0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL};
+
+static const unsigned char blake2b_sigma[12][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4}, {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13}, {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11}, {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5}, {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}};
+
+static inline uint64_t rotr64(uint64_t x, unsigned n) { return (x >> n) | (x << (64 - n)); }
+
+static inline void blake2b_mix(uint64_t *v, unsigned a, unsigned b, unsigned c, unsigned d, uint64_t x, uint64_t y) {
+  v[a] = v[a] + v[b] + x;
+  v[d] = rotr64(v[d] ^ v[a], 32);
+  v[c] = v[c] + v[d];
+  v[b] = rotr64(v[b] ^ v[c], 24);
+  v[a] = v[a] + v[b] + y;
+  v[d] = rotr64(v[d] ^ v[a], 16);
+  v[c] = v[c] + v[d];
+  v[b] = rotr64(v[b] ^ v[c], 63);
+}
+
+snakemake_unit_tests::blake2b::blake2b(unsigned digest_size)
+    : _buffer_size(0), _digest_size(digest_size), _finalized(false) {
+  if (!digest_size || digest_size > 64) {
+    throw std::logic_error("blake2b: digest size must be between 1 and 64 bytes");
+  }
+  for (unsigned i = 0; i < 8; ++i) {
+    _h[i] = blake2b_iv[i];
+  }
+  // parameter block: digest length, no key, fanout and depth 1
+  _h[0] ^= 0x01010000ULL ^ digest_size;
+  _t[0] = _t[1] = 0;
+  memset(_buffer, 0, 128);
+}
+
+snakemake_unit_tests::blake2b::blake2b(const blake2b &obj)
+    : _buffer_size(obj._buffer_size), _digest_size(obj._digest_size), _finalized(obj._finalized) {
+  memcpy(_h, obj._h, sizeof(_h));
+  memcpy(_t, obj._t, sizeof(_t));
+  memcpy(_buffer, obj._buffer, sizeof(_buffer));
+}
+
+void snakemake_unit_tests::blake2b::compress(bool last) {
+  uint64_t v[16], m[16];
+  for (unsigned i = 0; i < 8; ++i) {
+    v[i] = _h[i];
+    v[i + 8] = blake2b_iv[i];
+  }
+  v[12] ^= _t[0];
+  v[13] ^= _t[1];
+  if (last) v[14] = ~v[14];
+  for (unsigned i = 0; i < 16; ++i) {
+    m[i] = 0;
+    for (unsigned j = 0; j < 8; ++j) {
+      m[i] |= static_cast<uint64_t>(_buffer[8 * i + j]) << (8 * j);
+    }
+  }
+  for (unsigned i = 0; i < 12; ++i) {
+    blake2b_mix(v, 0, 4, 8, 12, m[blake2b_sigma[i][0]], m[blake2b_sigma[i][1]]);
+    blake2b_mix(v, 1, 5, 9, 13, m[blake2b_sigma[i][2]], m[blake2b_sigma[i][3]]);
+    blake2b_mix(v, 2, 6, 10, 14, m[blake2b_sigma[i][4]], m[blake2b_sigma[i][5]]);
+    blake2b_mix(v, 3, 7, 11, 15, m[blake2b_sigma[i][6]], m[blake2b_sigma[i][7]]);
+    blake2b_mix(v, 0, 5, 10, 15, m[blake2b_sigma[i][8]], m[blake2b_sigma[i][9]]);
+    blake2b_mix(v, 1, 6, 11, 12, m[blake2b_sigma[i][10]], m[blake2b_sigma[i][11]]);
+    blake2b_mix(v, 2, 7, 8, 13, m[blake2b_sigma[i][12]], m[blake2b_sigma[i][13]]);
+    blake2b_mix(v, 3, 4, 9, 14, m[blake2b_sigma[i][14]], m[blake2b_sigma[i][15]]);
+  }
+  for (unsigned i = 0; i < 8; ++i) {
+    _h[i] ^= v[i] ^ v[i + 8];
+  }
+}
+
+void snakemake_unit_tests::blake2b::update(const char *data, uint64_t n_bytes) {
+  if (_finalized) throw std::logic_error("blake2b: cannot update a finalized hash");
+  if (!data && n_bytes) throw std::runtime_error("null pointer provided to blake2b::update");
+  while (n_bytes) {
+    // the final block must be compressed with the last-block flag,
+    // so a full buffer is only flushed once more data arrives
+    if (_buffer_size == 128) {
+      _t[0] += 128;
+      if (_t[0] < 128) ++_t[1];
+      compress(false);
+      _buffer_size = 0;
+    }
+    unsigned n_copied = n_bytes < 128 - _buffer_size ? static_cast<unsigned>(n_bytes) : 128 - _buffer_size;
+    memcpy(_buffer + _buffer_size, data, n_copied);
+    _buffer_size += n_copied;
+    data += n_copied;
+    n_bytes -= n_copied;
+  }
+}
+
+std::string snakemake_unit_tests::blake2b::hexdigest() {
+  if (!_finalized) {
+    _t[0] += _buffer_size;
+    if (_t[0] < _buffer_size) ++_t[1];
+    memset(_buffer + _buffer_size, 0, 128 - _buffer_size);
+    compress(true);
+    _finalized = true;
+  }
+  std::string res;
+  const char *hex = "0123456789abcdef";
+  for (unsigned i = 0; i < _digest_size; ++i) {
+    unsigned char byte = static_cast<unsigned char>(_h[i / 8] >> (8 * (i % 8)));
+    res += hex[byte >> 4];
+    res += hex[byte & 0xf];
+  }
+  return res;
+}
+
+/*!
+  @brief convert a path to the form recorded in a manifest
+  @param p path to convert
+  @return normalized path with '/' separators and no '.' components
+
+  boost keeps a leading "./" through lexically_normal, but the pytest side
+  compares against paths relative to the expected directory
+ */
+static std::string manifest_key(const boost::filesystem::path &p) {
+  std::string res;
+  boost::filesystem::path normalized = p.lexically_normal();
+  for (boost::filesystem::path::const_iterator iter = normalized.begin(); iter != normalized.end(); ++iter) {
+    if (iter->empty() || !iter->string().compare(".")) continue;
+    if (!res.empty()) res += "/";
+    res += iter->string();
+  }
+  return res;
+}
+
+std::string snakemake_unit_tests::hash_file(const boost::filesystem::path &filename, uint64_t *size) {
+  if (!size) throw std::runtime_error("null pointer provided to hash_file");
+  std::ifstream input(filename.string().c_str(), std::ios_base::binary);
+  if (!input.is_open()) throw std::runtime_error("cannot open file for hashing: \"" + filename.string() + "\"");
+  std::vector<char> buffer(MANIFEST_READ_BUFFER_SIZE);
+  blake2b hash;
+  *size = 0;
+  while (input) {
+    input.read(buffer.data(), buffer.size());
+    hash.update(buffer.data(), input.gcount());
+    *size += input.gcount();
+  }
+  if (!input.eof()) throw std::runtime_error("error reading file for hashing: \"" + filename.string() + "\"");
+  return hash.hexdigest();
+}
+
+void snakemake_unit_tests::manifest::add_tree(const boost::filesystem::path &source,
+                                              const boost::filesystem::path &prefix, thread_pool *pool) {
+  std::vector<std::pair<boost::filesystem::path, std::string> > files;
+  if (boost::filesystem::is_regular_file(source)) {
+    files.push_back(std::make_pair(source, manifest_key(prefix)));
+  } else if (boost::filesystem::is_directory(source)) {
+    boost::filesystem::recursive_directory_iterator rec_iter(source), rec_end;
+    for (; rec_iter != rec_end; ++rec_iter) {
+      if (boost::filesystem::is_regular_file(rec_iter->status())) {
+        boost::filesystem::path relative_path = boost::filesystem::relative(rec_iter->path(), source);
+        files.push_back(std::make_pair(rec_iter->path(), manifest_key(prefix / relative_path)));
+      }
+    }
+  }
+  for (std::vector<std::pair<boost::filesystem::path, std::string> >::const_iterator iter = files.begin();
+       iter != files.end(); ++iter) {
+    boost::filesystem::path filename = iter->first;
+    std::string name = iter->second;
+    std::function<void()> task = [this, filename, name]() {
+      uint64_t size = 0;
+      std::time_t mtime = boost::filesystem::last_write_time(filename);
+      std::string digest = hash_file(filename, &size);
+      add_entry(name, size, mtime, digest);
+    };
+    if (pool) {
+      pool->submit(task);
+    } else {
+      task();
+    }
+  }
+}
+
+void snakemake_unit_tests::manifest::add_entry(const std::string &path, uint64_t size, std::time_t mtime,
+                                               const std::string &digest) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _entries[path] = manifest_entry(size, mtime, digest);
+}
+
+void snakemake_unit_tests::manifest::clear() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _entries.clear();
+}
+
+void snakemake_unit_tests::manifest::save(const boost::filesystem::path &filename) const {
+  std::ofstream output(filename.string().c_str());
+  if (!output.is_open()) throw std::runtime_error("cannot write manifest file \"" + filename.string() + "\"");
+  if (!(output << MANIFEST_HEADER << '\n'))
+    throw std::runtime_error("cannot write header to manifest file \"" + filename.string() + "\"");
+  for (std::map<std::string, manifest_entry>::const_iterator iter = _entries.begin(); iter != _entries.end(); ++iter) {
+    if (!(output << iter->second.digest << '\t' << iter->second.size << '\t' << iter->second.mtime << '\t'
+                 << iter->first << '\n'))
+      throw std::runtime_error("cannot write entry to manifest file \"" + filename.string() + "\"");
+  }
+  output.close();
+}
+
+void snakemake_unit_tests::manifest::load(const boost::filesystem::path &filename) {
+  std::ifstream input(filename.string().c_str());
+  if (!input.is_open()) throw std::runtime_error("cannot read manifest file \"" + filename.string() + "\"");
+  std::map<std::string, manifest_entry> entries;
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::string::size_type first_tab = line.find('\t');
+    std::string::size_type second_tab = first_tab == std::string::npos ? first_tab : line.find('\t', first_tab + 1);
+    std::string::size_type third_tab = second_tab == std::string::npos ? second_tab : line.find('\t', second_tab + 1);
+    if (third_tab == std::string::npos)
+      throw std::runtime_error("invalid line in manifest file \"" + filename.string() + "\": \"" + line + "\"");
+    entries[line.substr(third_tab + 1)] =
+        manifest_entry(std::stoull(line.substr(first_tab + 1, second_tab - first_tab - 1)),
+                       static_cast<std::time_t>(std::stoll(line.substr(second_tab + 1, third_tab - second_tab - 1))),
+                       line.substr(0, first_tab));
+  }
+  std::unique_lock<std::mutex> lock(_mutex);
+  _entries = entries;
+}
@@ -0,0 +1,191 @@
+/*!
+  @file manifest.h
+  @brief content hashes for emitted unit test fixtures
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  hashes are BLAKE2b (RFC 7693) with a 32 byte digest, which matches
+  python's hashlib.blake2b(digest_size=32); this lets the pytest side
+  check a generated file against the manifest without reading the
+  expected copy at all. each entry also records the size and mtime of
+  the hashed copy, so an expected file changed after the manifest was
+  written is noticed without reading it.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_MANIFEST_H_
+#define SNAKEMAKE_UNIT_TESTS_MANIFEST_H_
+
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/thread_pool.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @class blake2b
+  @brief incremental BLAKE2b hash
+ */
+class blake2b {
+ public:
+  /*!
+    @brief constructor
+    @param digest_size number of bytes of hash output, between 1 and 64
+   */
+  explicit blake2b(unsigned digest_size = 32);
+  /*!
+    @brief copy constructor
+    @param obj existing blake2b object
+   */
+  blake2b(const blake2b &obj);
+  /*!
+    @brief destructor
+   */
+  ~blake2b() throw() {}
+  /*!
+    @brief add data to the hash
+    @param data start of data
+    @param n_bytes number of bytes of data
+   */
+  void update(const char *data, uint64_t n_bytes);
+  /*!
+    @brief complete the hash
+    @return digest as lowercase hexadecimal
+
+    no further data can be added once the digest has been computed
+   */
+  std::string hexdigest();
+
+ private:
+  friend class manifestTest;
+  /*!
+    @brief mix a full block into the hash state
+    @param last whether this is the final block
+   */
+  void compress(bool last);
+  uint64_t _h[8];              //!< chained state
+  uint64_t _t[2];              //!< total bytes hashed
+  unsigned char _buffer[128];  //!< pending partial block
+  unsigned _buffer_size;       //!< bytes in pending block
+  unsigned _digest_size;       //!< requested output length
+  bool _finalized;             //!< whether hexdigest has been called
+};
+
+/*!
+  @brief hash the contents of a file
+  @param filename file to hash
+  @param size set to number of bytes in file
+  @return hexadecimal BLAKE2b-256 digest of file contents
+ */
+std::string hash_file(const boost::filesystem::path &filename, uint64_t *size);
+
+/*!
+  @class manifest_entry
+  @brief size, modification time, and content hash of one file
+ */
+class manifest_entry {
+ public:
+  /*!
+    @brief constructor
+   */
+  manifest_entry() : size(0), mtime(0) {}
+  /*!
+    @brief constructor
+    @param file_size size of file in bytes
+    @param file_mtime modification time of file, in seconds
+    @param file_digest hexadecimal digest of file contents
+   */
+  manifest_entry(uint64_t file_size, std::time_t file_mtime, const std::string &file_digest)
+      : size(file_size), mtime(file_mtime), digest(file_digest) {}
+  /*!
+    @brief test equality of entries
+    @param obj entry to compare with
+    @return whether all fields match
+   */
+  bool operator==(const manifest_entry &obj) const {
+    return size == obj.size && mtime == obj.mtime && !digest.compare(obj.digest);
+  }
+  uint64_t size;       //!< size of file in bytes
+  std::time_t mtime;   //!< modification time of file
+  std::string digest;  //!< hexadecimal digest of file contents
+};
+
+/*!
+  @class manifest
+  @brief relative path, size, mtime, and content hash for every file in a tree
+
+  on disk, a manifest is a header comment followed by one tab-delimited
+  line per file: digest, size, mtime, path; sorted by path
+ */
+class manifest {
+ public:
+  /*!
+    @brief constructor
+   */
+  manifest() {}
+  /*!
+    @brief copy constructor
+    @param obj existing manifest object
+   */
+  manifest(const manifest &obj) : _entries(obj._entries) {}
+  /*!
+    @brief destructor
+   */
+  ~manifest() throw() {}
+  /*!
+    @brief hash every regular file in a file or directory tree
+    @param source file or directory on disk; mtimes are recorded from
+    here, so this should be the copy that is shipped with the test
+    @param prefix path under which source is recorded in the manifest
+    @param pool worker threads on which to hash files; if null, files
+    are hashed immediately on the calling thread
+
+    with a pool, this returns once hashing has been queued; call
+    pool->wait() before using the results. missing sources are ignored.
+   */
+  void add_tree(const boost::filesystem::path &source, const boost::filesystem::path &prefix, thread_pool *pool);
+  /*!
+    @brief record a single file
+    @param path path of file within the manifest
+    @param size size of file in bytes
+    @param mtime modification time of file, in seconds
+    @param digest hexadecimal digest of file contents
+   */
+  void add_entry(const std::string &path, uint64_t size, std::time_t mtime, const std::string &digest);
+  /*!
+    @brief remove all recorded entries
+   */
+  void clear();
+  /*!
+    @brief access recorded entries
+    @return map of path to recorded entry
+   */
+  const std::map<std::string, manifest_entry> &entries() const { return _entries; }
+  /*!
+    @brief write the manifest to file
+    @param filename name of file to write
+   */
+  void save(const boost::filesystem::path &filename) const;
+  /*!
+    @brief replace the current entries with those from a manifest file
+    @param filename name of file to read
+   */
+  void load(const boost::filesystem::path &filename);
+
+ private:
+  friend class manifestTest;
+  std::map<std::string, manifest_entry> _entries;  //!< path -> (size, mtime, digest)
+  std::mutex _mutex;                               //!< guards _entries across workers
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_MANIFEST_H_
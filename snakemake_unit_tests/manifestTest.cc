@@ -0,0 +1,202 @@
+/*!
+  \file manifestTest.cc
+  \brief implementation of manifest unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/manifestTest.h"
+
+void snakemake_unit_tests::manifestTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutMANXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("manifestTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::manifestTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+void snakemake_unit_tests::manifestTest::write_file(const boost::filesystem::path &p,
+                                                    const std::string &content) const {
+  std::ofstream output;
+  output.open(p.string().c_str(), std::ios_base::out | std::ios_base::binary);
+  if (!output.is_open()) {
+    throw std::runtime_error("cannot write file \"" + p.string() + "\"");
+  }
+  output << content;
+  output.close();
+}
+
+void snakemake_unit_tests::manifestTest::test_blake2b_constructor() {
+  blake2b h;
+  CPPUNIT_ASSERT(!h._buffer_size);
+  CPPUNIT_ASSERT(h._digest_size == 32U);
+  CPPUNIT_ASSERT(!h._finalized);
+  CPPUNIT_ASSERT(!h._t[0] && !h._t[1]);
+  // the parameter block only touches the first word of state
+  CPPUNIT_ASSERT(h._h[0] == (0x6a09e667f3bcc908ULL ^ 0x01010020ULL));
+  CPPUNIT_ASSERT(h._h[7] == 0x5be0cd19137e2179ULL);
+  blake2b h20(20);
+  CPPUNIT_ASSERT(h20._digest_size == 20U);
+}
+
+void snakemake_unit_tests::manifestTest::test_blake2b_constructor_invalid_size() { blake2b h(65); }
+
+void snakemake_unit_tests::manifestTest::test_blake2b_copy_constructor() {
+  blake2b h;
+  h.update("abc", 3);
+  blake2b copy(h);
+  CPPUNIT_ASSERT(copy._buffer_size == 3U);
+  CPPUNIT_ASSERT(!copy.hexdigest().compare(h.hexdigest()));
+}
+
+void snakemake_unit_tests::manifestTest::test_blake2b_update() {
+  // a full block is held back until more data arrives, as the last block is compressed differently
+  std::string data(129, 'a');
+  blake2b h;
+  h.update(data.data(), 128);
+  CPPUNIT_ASSERT(h._buffer_size == 128U);
+  CPPUNIT_ASSERT(!h._t[0]);
+  h.update(data.data() + 128, 1);
+  CPPUNIT_ASSERT(h._buffer_size == 1U);
+  CPPUNIT_ASSERT(h._t[0] == 128U);
+  // splitting input across calls does not change the result
+  blake2b whole;
+  whole.update(data.data(), data.size());
+  CPPUNIT_ASSERT(!h.hexdigest().compare(whole.hexdigest()));
+  CPPUNIT_ASSERT_THROW(whole.update(NULL, 1), std::logic_error);
+  blake2b empty;
+  CPPUNIT_ASSERT_THROW(empty.update(NULL, 1), std::runtime_error);
+}
+
+void snakemake_unit_tests::manifestTest::test_blake2b_update_finalized() {
+  blake2b h;
+  h.hexdigest();
+  h.update("abc", 3);
+}
+
+void snakemake_unit_tests::manifestTest::test_blake2b_hexdigest() {
+  // reference values from python hashlib.blake2b
+  blake2b empty;
+  CPPUNIT_ASSERT(!empty.hexdigest().compare("0e5751c026e543b2e8ab2eb06099daa1d1e5df47778f7787faab45cdf12fe3a8"));
+  blake2b abc;
+  abc.update("abc", 3);
+  CPPUNIT_ASSERT(!abc.hexdigest().compare("bddd813c634239723171ef3fee98579b94964e3bb1cb3e427262c8c068d52319"));
+  // repeated calls return the same digest
+  CPPUNIT_ASSERT(!abc.hexdigest().compare("bddd813c634239723171ef3fee98579b94964e3bb1cb3e427262c8c068d52319"));
+  blake2b abc64(64);
+  abc64.update("abc", 3);
+  CPPUNIT_ASSERT(!abc64.hexdigest().compare(
+      "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+      "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923"));
+  blake2b abc20(20);
+  abc20.update("abc", 3);
+  CPPUNIT_ASSERT(!abc20.hexdigest().compare("384264f676f39536840523f284921cdc68b6846b"));
+  std::string block(128, 'a');
+  blake2b one_block;
+  one_block.update(block.data(), block.size());
+  CPPUNIT_ASSERT(!one_block.hexdigest().compare("ae2aa48507885c4c950fb809b2076f959cde9f8ea6da260d9a3587df33dac450"));
+}
+
+void snakemake_unit_tests::manifestTest::test_hash_file() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  // spans multiple read buffers
+  write_file(tmp_parent / "large.txt", std::string(1000000, 'a'));
+  write_file(tmp_parent / "empty.txt", "");
+  uint64_t size = 1;
+  CPPUNIT_ASSERT(!hash_file(tmp_parent / "large.txt", &size)
+                      .compare("0741850f36cba4259628355d1073e24ddb9ca0e1bfac36fd39ae5dc2101e23a4"));
+  CPPUNIT_ASSERT(size == 1000000U);
+  CPPUNIT_ASSERT(!hash_file(tmp_parent / "empty.txt", &size)
+                      .compare("0e5751c026e543b2e8ab2eb06099daa1d1e5df47778f7787faab45cdf12fe3a8"));
+  CPPUNIT_ASSERT(!size);
+  CPPUNIT_ASSERT_THROW(hash_file(tmp_parent / "empty.txt", NULL), std::runtime_error);
+}
+
+void snakemake_unit_tests::manifestTest::test_hash_file_missing() {
+  uint64_t size = 0;
+  hash_file(boost::filesystem::path(std::string(_tmp_dir)) / "missing.txt", &size);
+}
+
+void snakemake_unit_tests::manifestTest::test_manifest_add_tree() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::create_directories(tmp_parent / "tree" / "subdir");
+  write_file(tmp_parent / "tree" / "file1.txt", "abc");
+  write_file(tmp_parent / "tree" / "subdir" / "file2.txt", "");
+  write_file(tmp_parent / "single.txt", "abc");
+  boost::filesystem::last_write_time(tmp_parent / "tree" / "file1.txt", 1600000003);
+  manifest m;
+  thread_pool pool(2);
+  m.add_tree(tmp_parent / "tree", "workflow/results", &pool);
+  m.add_tree(tmp_parent / "missing", "workflow/missing", &pool);
+  pool.wait();
+  // without a pool, hashing happens immediately
+  m.add_tree(tmp_parent / "single.txt", "./workflow/single.txt", NULL);
+  CPPUNIT_ASSERT(m.entries().size() == 3U);
+  CPPUNIT_ASSERT(m.entries().find("workflow/results/file1.txt") != m.entries().end());
+  CPPUNIT_ASSERT(m.entries().find("workflow/results/file1.txt")->second ==
+                 manifest_entry(3, 1600000003, "bddd813c634239723171ef3fee98579b94964e3bb1cb3e427262c8c068d52319"));
+  CPPUNIT_ASSERT(m.entries().find("workflow/results/subdir/file2.txt") != m.entries().end());
+  CPPUNIT_ASSERT(m.entries().find("workflow/single.txt") != m.entries().end());
+}
+
+void snakemake_unit_tests::manifestTest::test_manifest_add_entry() {
+  manifest m;
+  m.add_entry("a/b.txt", 10, 100, "ff");
+  m.add_entry("a/b.txt", 12, 200, "ee");
+  CPPUNIT_ASSERT(m.entries().size() == 1U);
+  CPPUNIT_ASSERT(m.entries().find("a/b.txt")->second == manifest_entry(12, 200, "ee"));
+}
+
+void snakemake_unit_tests::manifestTest::test_manifest_clear() {
+  manifest m;
+  m.add_entry("a/b.txt", 10, 100, "ff");
+  m.clear();
+  CPPUNIT_ASSERT(m.entries().empty());
+}
+
+void snakemake_unit_tests::manifestTest::test_manifest_save() {
+  boost::filesystem::path filename = boost::filesystem::path(std::string(_tmp_dir)) / "expected.manifest";
+  manifest m;
+  m.add_entry("z.txt", 3, 1600000000, "abcd");
+  m.add_entry("a b/c.txt", 0, 0, "ef01");
+  m.save(filename);
+  std::ifstream input(filename.string().c_str());
+  std::string line;
+  CPPUNIT_ASSERT(std::getline(input, line));
+  CPPUNIT_ASSERT(!line.compare("# snakemake_unit_tests manifest v2: blake2b-256\tsize\tmtime\tpath"));
+  CPPUNIT_ASSERT(std::getline(input, line));
+  CPPUNIT_ASSERT(!line.compare("ef01\t0\t0\ta b/c.txt"));
+  CPPUNIT_ASSERT(std::getline(input, line));
+  CPPUNIT_ASSERT(!line.compare("abcd\t3\t1600000000\tz.txt"));
+  CPPUNIT_ASSERT(!std::getline(input, line));
+}
+
+void snakemake_unit_tests::manifestTest::test_manifest_load() {
+  boost::filesystem::path filename = boost::filesystem::path(std::string(_tmp_dir)) / "expected.manifest";
+  manifest m, n;
+  m.add_entry("z.txt", 3, 1600000000, "abcd");
+  m.add_entry("a b/c\tx.txt", 5000000000ULL, 1700000000, "ef01");
+  m.save(filename);
+  n.add_entry("replaced.txt", 1, 1, "00");
+  n.load(filename);
+  CPPUNIT_ASSERT(n.entries() == m.entries());
+}
+
+void snakemake_unit_tests::manifestTest::test_manifest_load_invalid() {
+  boost::filesystem::path filename = boost::filesystem::path(std::string(_tmp_dir)) / "expected.manifest";
+  // manifests from before mtimes were recorded are not read back
+  write_file(filename, "# header\nabcd\t3\tz.txt\n");
+  manifest m;
+  m.load(filename);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::manifestTest);
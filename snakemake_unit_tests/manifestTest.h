@@ -0,0 +1,73 @@
+/*!
+  \file manifestTest.h
+  \brief manifest test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_MANIFESTTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_MANIFESTTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/manifest.h"
+#include "snakemake_unit_tests/thread_pool.h"
+
+namespace snakemake_unit_tests {
+class manifestTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(manifestTest);
+  CPPUNIT_TEST(test_blake2b_constructor);
+  CPPUNIT_TEST_EXCEPTION(test_blake2b_constructor_invalid_size, std::logic_error);
+  CPPUNIT_TEST(test_blake2b_copy_constructor);
+  CPPUNIT_TEST(test_blake2b_update);
+  CPPUNIT_TEST_EXCEPTION(test_blake2b_update_finalized, std::logic_error);
+  CPPUNIT_TEST(test_blake2b_hexdigest);
+  CPPUNIT_TEST(test_hash_file);
+  CPPUNIT_TEST_EXCEPTION(test_hash_file_missing, std::runtime_error);
+  CPPUNIT_TEST(test_manifest_add_tree);
+  CPPUNIT_TEST(test_manifest_add_entry);
+  CPPUNIT_TEST(test_manifest_clear);
+  CPPUNIT_TEST(test_manifest_save);
+  CPPUNIT_TEST(test_manifest_load);
+  CPPUNIT_TEST_EXCEPTION(test_manifest_load_invalid, std::runtime_error);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_blake2b_constructor();
+  void test_blake2b_constructor_invalid_size();
+  void test_blake2b_copy_constructor();
+  void test_blake2b_update();
+  void test_blake2b_update_finalized();
+  void test_blake2b_hexdigest();
+  void test_hash_file();
+  void test_hash_file_missing();
+  void test_manifest_add_tree();
+  void test_manifest_add_entry();
+  void test_manifest_clear();
+  void test_manifest_save();
+  void test_manifest_load();
+  void test_manifest_load_invalid();
+
+ private:
+  void write_file(const boost::filesystem::path &p, const std::string &content) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_MANIFESTTEST_H_
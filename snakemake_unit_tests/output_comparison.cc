@@ -0,0 +1,321 @@
+/*!
+  @file output_comparison.cc
+  @brief implementation of output_comparison and supporting classes
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/output_comparison.h"
+
+// bytes read from a file at a time
+#define COMPARISON_BLOCK_SIZE 1048576
+// inflated blocks held ahead of the reader, per compressed file
+#define COMPARISON_BLOCKS_AHEAD 4
+
+/*!
+  @brief test whether a file name ends with a suffix, ignoring case
+  @param filename file name to test
+  @param suffix lowercase suffix
+  @return whether the file name ends with the suffix
+ */
+static bool has_suffix(const boost::filesystem::path &filename, const std::string &suffix) {
+  std::string name = filename.string();
+  if (name.size() < suffix.size()) return false;
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+  return !name.compare(name.size() - suffix.size(), suffix.size(), suffix);
+}
+
+snakemake_unit_tests::block_reader::block_reader(const boost::filesystem::path &filename, bool decompress)
+    : _filename(filename), _file(NULL), _gz_file(NULL), _finished(false), _stopping(false) {
+  if (decompress) {
+    _gz_file = gzopen(filename.string().c_str(), "rb");
+    if (!_gz_file) throw std::runtime_error("cannot open file for comparison: \"" + filename.string() + "\"");
+    gzbuffer(_gz_file, COMPARISON_BLOCK_SIZE);
+    _inflater = std::thread(&block_reader::inflate_ahead, this);
+  } else {
+    _file = fopen(filename.string().c_str(), "rb");
+    if (!_file) throw std::runtime_error("cannot open file for comparison: \"" + filename.string() + "\"");
+  }
+}
+
+snakemake_unit_tests::block_reader::~block_reader() throw() {
+  if (_inflater.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopping = true;
+    }
+    _changed.notify_all();
+    _inflater.join();
+  }
+  if (_file) fclose(_file);
+  if (_gz_file) gzclose(_gz_file);
+}
+
+bool snakemake_unit_tests::block_reader::next(std::vector<char> *block) {
+  if (!block) throw std::runtime_error("null pointer provided to block_reader::next");
+  if (!_gz_file) return read_block(block);
+  std::unique_lock<std::mutex> lock(_mutex);
+  _changed.wait(lock, [this]() { return !_ready.empty() || _finished; });
+  if (!_ready.empty()) {
+    block->swap(_ready.front());
+    _ready.pop_front();
+    lock.unlock();
+    _changed.notify_all();
+    return true;
+  }
+  block->clear();
+  if (!_error.empty()) throw std::runtime_error(_error);
+  return false;
+}
+
+bool snakemake_unit_tests::block_reader::read_block(std::vector<char> *block) {
+  block->resize(COMPARISON_BLOCK_SIZE);
+  uint64_t n_read = 0;
+  if (_gz_file) {
+    int res = gzread(_gz_file, block->data(), block->size());
+    int errnum = Z_OK;
+    const char *error = gzerror(_gz_file, &errnum);
+    // a truncated stream ends without error from gzread itself
+    if (res < 0 || (errnum != Z_OK && errnum != Z_STREAM_END))
+      throw std::runtime_error("cannot decompress \"" + _filename.string() + "\": " + error);
+    n_read = res;
+  } else {
+    n_read = fread(block->data(), 1, block->size(), _file);
+    if (n_read < block->size() && ferror(_file))
+      throw std::runtime_error("cannot read \"" + _filename.string() + "\" for comparison");
+  }
+  block->resize(n_read);
+  return n_read > 0;
+}
+
+void snakemake_unit_tests::block_reader::inflate_ahead() {
+  try {
+    std::vector<char> block;
+    while (read_block(&block)) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _changed.wait(lock, [this]() { return _ready.size() < COMPARISON_BLOCKS_AHEAD || _stopping; });
+      if (_stopping) break;
+      _ready.push_back(std::vector<char>());
+      _ready.back().swap(block);
+      lock.unlock();
+      _changed.notify_all();
+    }
+  } catch (const std::exception &e) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _error = e.what();
+  }
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _finished = true;
+  }
+  _changed.notify_all();
+}
+
+snakemake_unit_tests::line_reader::line_reader(const boost::filesystem::path &filename, bool decompress)
+    : _reader(new block_reader(filename, decompress)), _offset(0), _after_cr(false), _line_number(0) {}
+
+bool snakemake_unit_tests::line_reader::next(std::string *line) {
+  if (!line) throw std::runtime_error("null pointer provided to line_reader::next");
+  line->clear();
+  while (true) {
+    if (_offset == _block.size()) {
+      if (!_reader->next(&_block)) {
+        _block.clear();
+        _offset = 0;
+        if (line->empty()) return false;
+        ++_line_number;
+        return true;
+      }
+      _offset = 0;
+    }
+    // the '\n' of a '\r\n' pair may start the next block
+    if (_after_cr) {
+      _after_cr = false;
+      if (_block.at(_offset) == '\n') {
+        ++_offset;
+        continue;
+      }
+    }
+    const char *start = _block.data() + _offset;
+    const char *end = _block.data() + _block.size();
+    const char *found = std::find_if(start, end, [](char c) { return c == '\n' || c == '\r'; });
+    line->append(start, found);
+    if (found == end) {
+      _offset = _block.size();
+      continue;
+    }
+    line->push_back('\n');
+    _after_cr = *found == '\r';
+    _offset = found - _block.data() + 1;
+    ++_line_number;
+    return true;
+  }
+}
+
+snakemake_unit_tests::file_comparison::file_comparison() : mode(COMPARISON_BYTE), matched(false) {}
+
+snakemake_unit_tests::file_comparison::file_comparison(const file_comparison &obj)
+    : mode(obj.mode), generated(obj.generated), expected(obj.expected), matched(obj.matched), message(obj.message) {}
+
+snakemake_unit_tests::file_comparison::~file_comparison() throw() {}
+
+void snakemake_unit_tests::output_comparison::load(std::istream &input, const std::string &source) {
+  std::string line;
+  uint64_t line_number = 0;
+  while (std::getline(input, line)) {
+    ++line_number;
+    if (line.empty()) continue;
+    std::string::size_type first = line.find('\t');
+    std::string::size_type second = first == std::string::npos ? first : line.find('\t', first + 1);
+    if (second == std::string::npos)
+      throw std::runtime_error("line " + std::to_string(line_number) + " of comparison list \"" + source +
+                               "\" is not tab-delimited mode, generated file, expected file");
+    std::string mode = line.substr(0, first);
+    if (!mode.compare("byte")) {
+      add(COMPARISON_BYTE, line.substr(first + 1, second - first - 1), line.substr(second + 1));
+    } else if (!mode.compare("plaintext")) {
+      add(COMPARISON_PLAINTEXT, line.substr(first + 1, second - first - 1), line.substr(second + 1));
+    } else {
+      throw std::runtime_error("line " + std::to_string(line_number) + " of comparison list \"" + source +
+                               "\" has unknown comparison mode \"" + mode + "\"; expected 'byte' or 'plaintext'");
+    }
+  }
+}
+
+void snakemake_unit_tests::output_comparison::add(comparison_mode mode, const boost::filesystem::path &generated,
+                                                  const boost::filesystem::path &expected) {
+  file_comparison comparison;
+  comparison.mode = mode;
+  comparison.generated = generated;
+  comparison.expected = expected;
+  _comparisons.push_back(comparison);
+}
+
+bool snakemake_unit_tests::output_comparison::run(unsigned n_threads) {
+  if (!_comparisons.empty()) {
+    // the largest files first, so they are not left running alone at the end
+    std::vector<std::pair<uint64_t, unsigned>> order;
+    for (unsigned i = 0; i < _comparisons.size(); ++i) {
+      boost::system::error_code ec;
+      uint64_t size = boost::filesystem::file_size(_comparisons.at(i).generated, ec);
+      order.push_back(std::make_pair(ec ? 0 : size, i));
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const std::pair<uint64_t, unsigned> &a, const std::pair<uint64_t, unsigned> &b) {
+                       return a.first > b.first;
+                     });
+    unsigned n_workers = n_threads ? n_threads : std::max(std::thread::hardware_concurrency(), 1u);
+    thread_pool pool(std::min(n_workers, static_cast<unsigned>(_comparisons.size())));
+    for (std::vector<std::pair<uint64_t, unsigned>>::const_iterator iter = order.begin(); iter != order.end();
+         ++iter) {
+      file_comparison *comparison = &_comparisons.at(iter->second);
+      pool.submit([comparison]() {
+        // a file that cannot be read does not match, and does not stop the other comparisons
+        try {
+          comparison->matched = comparison->mode == COMPARISON_BYTE
+                                    ? compare_bytes(comparison->generated, comparison->expected, &comparison->message)
+                                    : compare_plaintext(comparison->generated, comparison->expected,
+                                                        &comparison->message);
+        } catch (const std::exception &e) {
+          comparison->matched = false;
+          comparison->message = e.what();
+        }
+      });
+    }
+    pool.wait();
+  }
+  for (std::vector<file_comparison>::const_iterator iter = _comparisons.begin(); iter != _comparisons.end(); ++iter) {
+    if (!iter->matched) return false;
+  }
+  return true;
+}
+
+void snakemake_unit_tests::output_comparison::report(std::ostream &out) const {
+  for (std::vector<file_comparison>::const_iterator iter = _comparisons.begin(); iter != _comparisons.end(); ++iter) {
+    if (!iter->matched) out << iter->generated.string() << '\t' << iter->message << std::endl;
+  }
+}
+
+bool snakemake_unit_tests::output_comparison::compare_bytes(const boost::filesystem::path &generated,
+                                                            const boost::filesystem::path &expected,
+                                                            std::string *message) {
+  if (!message) throw std::runtime_error("null pointer provided to compare_bytes");
+  message->clear();
+  uint64_t generated_size = boost::filesystem::file_size(generated);
+  uint64_t expected_size = boost::filesystem::file_size(expected);
+  if (generated_size != expected_size) {
+    *message = "size " + std::to_string(generated_size) + " differs from expected size " +
+               std::to_string(expected_size);
+    return false;
+  }
+  block_reader generated_reader(generated, false), expected_reader(expected, false);
+  std::vector<char> generated_block, expected_block;
+  uint64_t generated_offset = 0, expected_offset = 0, position = 0;
+  while (true) {
+    if (generated_offset == generated_block.size()) {
+      generated_reader.next(&generated_block);
+      generated_offset = 0;
+    }
+    if (expected_offset == expected_block.size()) {
+      expected_reader.next(&expected_block);
+      expected_offset = 0;
+    }
+    uint64_t n_bytes =
+        std::min(generated_block.size() - generated_offset, expected_block.size() - expected_offset);
+    if (!n_bytes) {
+      // the sizes matched, so only a file changing while it is read ends one early
+      if (generated_block.empty() && expected_block.empty()) return true;
+      *message = "file changed size while it was compared";
+      return false;
+    }
+    const char *generated_data = generated_block.data() + generated_offset;
+    const char *expected_data = expected_block.data() + expected_offset;
+    if (memcmp(generated_data, expected_data, n_bytes)) {
+      uint64_t differs = std::mismatch(generated_data, generated_data + n_bytes, expected_data).first - generated_data;
+      *message = "differs from expected at byte " + std::to_string(position + differs + 1);
+      return false;
+    }
+    generated_offset += n_bytes;
+    expected_offset += n_bytes;
+    position += n_bytes;
+  }
+}
+
+bool snakemake_unit_tests::output_comparison::compare_plaintext(const boost::filesystem::path &generated,
+                                                                const boost::filesystem::path &expected,
+                                                                std::string *message) {
+  if (!message) throw std::runtime_error("null pointer provided to compare_plaintext");
+  message->clear();
+  line_reader generated_reader(generated, has_suffix(generated, ".gz"));
+  line_reader expected_reader(expected, has_suffix(expected, ".gz"));
+  std::string generated_comment = has_suffix(generated, ".vcf") || has_suffix(generated, ".vcf.gz") ? "##" : "#";
+  std::string expected_comment = has_suffix(expected, ".vcf") || has_suffix(expected, ".vcf.gz") ? "##" : "#";
+  std::string generated_line, expected_line;
+  while (true) {
+    bool has_generated = next_content_line(&generated_reader, generated_comment, &generated_line);
+    bool has_expected = next_content_line(&expected_reader, expected_comment, &expected_line);
+    if (!has_generated && !has_expected) return true;
+    if (!has_generated) {
+      *message = "ends before expected line " + std::to_string(expected_reader.line_number());
+      return false;
+    }
+    if (!has_expected) {
+      *message = "line " + std::to_string(generated_reader.line_number()) + " is beyond the end of the expected file";
+      return false;
+    }
+    if (generated_line.compare(expected_line)) {
+      *message = "line " + std::to_string(generated_reader.line_number()) + " differs from expected line " +
+                 std::to_string(expected_reader.line_number());
+      return false;
+    }
+  }
+}
+
+bool snakemake_unit_tests::output_comparison::next_content_line(line_reader *reader, const std::string &comment,
+                                                                std::string *line) {
+  while (reader->next(line)) {
+    if (line->compare(0, comment.size(), comment)) return true;
+  }
+  return false;
+}
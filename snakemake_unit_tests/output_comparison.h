@@ -0,0 +1,288 @@
+/*!
+  @file output_comparison.h
+  @brief native comparison of generated test output against expected output
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  inst/common.py compares a rule's output with its 'byte' and 'plaintext'
+  comparators by reading whole files into python, decompressing gzip
+  output in python as it goes. the comparisons here have the same
+  semantics, but stream both files in fixed-size blocks, inflate gzip
+  output on background threads, and compare many files at once.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_OUTPUT_COMPARISON_H_
+#define SNAKEMAKE_UNIT_TESTS_OUTPUT_COMPARISON_H_
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/thread_pool.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @brief how a generated file is compared to its expected copy
+ */
+typedef enum { COMPARISON_BYTE, COMPARISON_PLAINTEXT } comparison_mode;
+
+/*!
+  @class block_reader
+  @brief sequential reader of a file's contents in fixed-size blocks
+
+  gzip input, including multi-member files such as BGZF, is inflated on
+  a background thread a few blocks ahead of the reader, so the two files
+  of a comparison inflate concurrently with each other and with the
+  comparison itself.
+ */
+class block_reader {
+ public:
+  /*!
+    @brief constructor: open a file
+    @param filename file to read
+    @param decompress whether the file is gzip compressed
+   */
+  block_reader(const boost::filesystem::path &filename, bool decompress);
+  /*!
+    @brief destructor: stop any background inflation and close the file
+   */
+  ~block_reader() throw();
+  /*!
+    @brief get the next block of the file's contents
+    @param block where to store the block; replaced, not appended to
+    @return whether a block was read; false at the end of the file
+   */
+  bool next(std::vector<char> *block);
+
+ private:
+  friend class output_comparisonTest;
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  block_reader() { throw std::domain_error("block_reader: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing block_reader object
+    @warning disabled
+   */
+  block_reader(const block_reader &obj) { throw std::domain_error("block_reader: do not use copy constructor"); }
+  /*!
+    @brief read one block from the open file
+    @param block where to store the block
+    @return whether a block was read; false at the end of the file
+   */
+  bool read_block(std::vector<char> *block);
+  /*!
+    @brief background thread: inflate blocks ahead of the reader
+   */
+  void inflate_ahead();
+  boost::filesystem::path _filename;     //!< file being read
+  FILE *_file;                           //!< handle of uncompressed input
+  gzFile _gz_file;                       //!< handle of compressed input
+  std::thread _inflater;                 //!< thread inflating compressed input
+  std::deque<std::vector<char>> _ready;  //!< inflated blocks not yet read
+  bool _finished;                        //!< whether the inflater has stopped
+  bool _stopping;                        //!< whether the inflater should stop early
+  std::string _error;                    //!< why the inflater stopped, if it failed
+  std::mutex _mutex;                     //!< guards the inflater state
+  std::condition_variable _changed;      //!< signals changes to the inflater state
+};
+
+/*!
+  @class line_reader
+  @brief sequential reader of a file's lines
+
+  as with python text mode, '\r\n' and '\r' line endings are read as '\n'
+ */
+class line_reader {
+ public:
+  /*!
+    @brief constructor: open a file
+    @param filename file to read
+    @param decompress whether the file is gzip compressed
+   */
+  line_reader(const boost::filesystem::path &filename, bool decompress);
+  /*!
+    @brief destructor
+   */
+  ~line_reader() throw() {}
+  /*!
+    @brief get the next line of the file
+    @param line where to store the line, including its '\n' terminator if it has one
+    @return whether a line was read; false at the end of the file
+   */
+  bool next(std::string *line);
+  /*!
+    @brief get the number of lines read so far
+    @return number of lines read so far
+   */
+  uint64_t line_number() const { return _line_number; }
+
+ private:
+  friend class output_comparisonTest;
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  line_reader() { throw std::domain_error("line_reader: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing line_reader object
+    @warning disabled
+   */
+  line_reader(const line_reader &obj) { throw std::domain_error("line_reader: do not use copy constructor"); }
+  boost::shared_ptr<block_reader> _reader;  //!< source of the file's contents
+  std::vector<char> _block;                 //!< most recently read block
+  uint64_t _offset;                         //!< position of the next unread byte in _block
+  bool _after_cr;                           //!< whether the previous line ended with '\r'
+  uint64_t _line_number;                    //!< number of lines read so far
+};
+
+/*!
+  @class file_comparison
+  @brief one generated file to compare with its expected copy
+ */
+class file_comparison {
+ public:
+  /*!
+    @brief constructor
+   */
+  file_comparison();
+  /*!
+    @brief copy constructor
+    @param obj existing file_comparison object
+   */
+  file_comparison(const file_comparison &obj);
+  /*!
+    @brief destructor
+   */
+  ~file_comparison() throw();
+  /*!
+    @brief how the files are compared
+   */
+  comparison_mode mode;
+  /*!
+    @brief file generated by the test
+   */
+  boost::filesystem::path generated;
+  /*!
+    @brief expected copy of the file
+   */
+  boost::filesystem::path expected;
+  /*!
+    @brief whether the files matched
+   */
+  bool matched;
+  /*!
+    @brief how the files differed, if they did
+   */
+  std::string message;
+};
+
+/*!
+  @class output_comparison
+  @brief comparison of generated files with their expected copies
+ */
+class output_comparison {
+ public:
+  /*!
+    @brief constructor
+   */
+  output_comparison() {}
+  /*!
+    @brief destructor
+   */
+  ~output_comparison() throw() {}
+  /*!
+    @brief read a list of comparisons
+    @param input one tab-delimited line per comparison: mode ('byte' or
+    'plaintext'), generated file, expected file
+    @param source name of the list, for error messages
+   */
+  void load(std::istream &input, const std::string &source);
+  /*!
+    @brief add a comparison
+    @param mode how the files are compared
+    @param generated file generated by the test
+    @param expected expected copy of the file
+   */
+  void add(comparison_mode mode, const boost::filesystem::path &generated, const boost::filesystem::path &expected);
+  /*!
+    @brief access comparisons
+    @return every comparison, in the order added, with results once run
+   */
+  const std::vector<file_comparison> &get_comparisons() const { return _comparisons; }
+  /*!
+    @brief compare every pair of files
+    @param n_threads number of files compared at once; 0 means one per available core
+    @return whether every pair matched
+   */
+  bool run(unsigned n_threads);
+  /*!
+    @brief report the comparisons that did not match
+    @param out where to write one tab-delimited line per mismatch: generated file, message
+   */
+  void report(std::ostream &out) const;
+  /*!
+    @brief compare two files byte for byte, as cmp does
+    @param generated file generated by the test
+    @param expected expected copy of the file
+    @param message set to how the files differ, if they do
+    @return whether the files are identical
+   */
+  static bool compare_bytes(const boost::filesystem::path &generated, const boost::filesystem::path &expected,
+                            std::string *message);
+  /*!
+    @brief compare two text files, ignoring comment lines
+    @param generated file generated by the test
+    @param expected expected copy of the file
+    @param message set to how the files differ, if they do
+    @return whether the files match
+
+    lines starting with '#' are ignored, or with '##' for .vcf and
+    .vcf.gz files, so only their metadata header is ignored. files
+    ending in .gz are decompressed.
+   */
+  static bool compare_plaintext(const boost::filesystem::path &generated, const boost::filesystem::path &expected,
+                                std::string *message);
+
+ private:
+  friend class output_comparisonTest;
+  /*!
+    @brief copy constructor
+    @param obj existing output_comparison object
+    @warning disabled
+   */
+  output_comparison(const output_comparison &obj) {
+    throw std::domain_error("output_comparison: do not use copy constructor");
+  }
+  /*!
+    @brief get the next line of a file that is not a comment
+    @param reader source of lines
+    @param comment prefix of comment lines
+    @param line where to store the line
+    @return whether a line was read; false at the end of the file
+   */
+  static bool next_content_line(line_reader *reader, const std::string &comment, std::string *line);
+  std::vector<file_comparison> _comparisons;  //!< pairs of files to compare
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_OUTPUT_COMPARISON_H_
@@ -0,0 +1,313 @@
+/*!
+  \file output_comparisonTest.cc
+  \brief implementation of output_comparison unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/output_comparisonTest.h"
+
+void snakemake_unit_tests::output_comparisonTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutCMPXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("output_comparisonTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::output_comparisonTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+void snakemake_unit_tests::output_comparisonTest::write_file(const boost::filesystem::path &filename,
+                                                             const std::string &contents) const {
+  std::ofstream output(filename.string().c_str(), std::ios_base::out | std::ios_base::binary);
+  if (!(output << contents)) throw std::runtime_error("cannot write \"" + filename.string() + "\"");
+  output.close();
+}
+
+void snakemake_unit_tests::output_comparisonTest::write_gzip(const boost::filesystem::path &filename,
+                                                             const std::vector<std::string> &members) const {
+  // each member is appended as its own gzip stream, as BGZF does
+  for (std::vector<std::string>::const_iterator iter = members.begin(); iter != members.end(); ++iter) {
+    gzFile output = gzopen(filename.string().c_str(), iter == members.begin() ? "wb" : "ab");
+    if (!output) throw std::runtime_error("cannot write \"" + filename.string() + "\"");
+    if (!iter->empty() && gzwrite(output, iter->data(), iter->size()) != static_cast<int>(iter->size())) {
+      gzclose(output);
+      throw std::runtime_error("cannot write \"" + filename.string() + "\"");
+    }
+    gzclose(output);
+  }
+}
+
+std::string snakemake_unit_tests::output_comparisonTest::read_all(block_reader *reader) const {
+  std::string res;
+  std::vector<char> block;
+  while (reader->next(&block)) res.append(block.begin(), block.end());
+  return res;
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_block_reader_constructor_missing_file() {
+  block_reader reader(boost::filesystem::path(std::string(_tmp_dir)) / "missing.txt", false);
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_block_reader_next() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  // one block and a little more
+  std::string contents(1048576 + 10, 'a');
+  contents.at(1048576) = 'b';
+  write_file(tmp_parent / "file.txt", contents);
+  block_reader reader(tmp_parent / "file.txt", false);
+  std::vector<char> block;
+  CPPUNIT_ASSERT(reader.next(&block));
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1048576), block.size());
+  CPPUNIT_ASSERT(reader.next(&block));
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(10), block.size());
+  CPPUNIT_ASSERT_EQUAL('b', block.at(0));
+  CPPUNIT_ASSERT(!reader.next(&block));
+  CPPUNIT_ASSERT(block.empty());
+  // an empty file has no blocks
+  write_file(tmp_parent / "empty.txt", "");
+  block_reader empty(tmp_parent / "empty.txt", false);
+  CPPUNIT_ASSERT(!empty.next(&block));
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_block_reader_next_compressed() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  std::vector<std::string> members;
+  members.push_back(std::string(3000000, 'x'));
+  members.push_back("second member\n");
+  members.push_back("third member\n");
+  write_gzip(tmp_parent / "file.txt.gz", members);
+  block_reader reader(tmp_parent / "file.txt.gz", true);
+  CPPUNIT_ASSERT(!read_all(&reader).compare(members.at(0) + members.at(1) + members.at(2)));
+  // a reader abandoned partway stops its inflater
+  block_reader abandoned(tmp_parent / "file.txt.gz", true);
+  std::vector<char> block;
+  CPPUNIT_ASSERT(abandoned.next(&block));
+  CPPUNIT_ASSERT(!block.empty());
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_block_reader_next_truncated() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  std::string contents;
+  for (unsigned i = 0; i < 100000; ++i) contents += std::to_string(i) + "\n";
+  write_gzip(tmp_parent / "full.txt.gz", std::vector<std::string>(1, contents));
+  uint64_t size = boost::filesystem::file_size(tmp_parent / "full.txt.gz");
+  boost::filesystem::copy_file(tmp_parent / "full.txt.gz", tmp_parent / "truncated.txt.gz");
+  boost::filesystem::resize_file(tmp_parent / "truncated.txt.gz", size / 2);
+  block_reader reader(tmp_parent / "truncated.txt.gz", true);
+  read_all(&reader);
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_line_reader_next() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  // windows and old mac line endings are read as '\n'; the last line has no terminator
+  write_file(tmp_parent / "file.txt", "one\ntwo\r\nthree\rfour");
+  line_reader reader(tmp_parent / "file.txt", false);
+  std::string line;
+  CPPUNIT_ASSERT(reader.next(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("one\n"), line);
+  CPPUNIT_ASSERT(reader.next(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("two\n"), line);
+  CPPUNIT_ASSERT(reader.next(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("three\n"), line);
+  CPPUNIT_ASSERT(reader.next(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("four"), line);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(4), reader.line_number());
+  CPPUNIT_ASSERT(!reader.next(&line));
+  CPPUNIT_ASSERT(line.empty());
+  // lines, and '\r\n' pairs, spanning blocks
+  std::string contents(1048575, 'a');
+  contents += "\r\nb\n";
+  write_file(tmp_parent / "long.txt", contents);
+  line_reader long_reader(tmp_parent / "long.txt", false);
+  CPPUNIT_ASSERT(long_reader.next(&line));
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1048576), line.size());
+  CPPUNIT_ASSERT(long_reader.next(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("b\n"), line);
+  CPPUNIT_ASSERT(!long_reader.next(&line));
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_file_comparison_constructor() {
+  file_comparison a;
+  CPPUNIT_ASSERT(a.mode == COMPARISON_BYTE);
+  CPPUNIT_ASSERT(!a.matched);
+  CPPUNIT_ASSERT(a.message.empty());
+  a.mode = COMPARISON_PLAINTEXT;
+  a.generated = "output/result.txt";
+  a.expected = "expected/result.txt";
+  a.matched = true;
+  a.message = "message";
+  file_comparison b(a);
+  CPPUNIT_ASSERT(b.mode == COMPARISON_PLAINTEXT);
+  CPPUNIT_ASSERT(b.generated == a.generated);
+  CPPUNIT_ASSERT(b.expected == a.expected);
+  CPPUNIT_ASSERT(b.matched);
+  CPPUNIT_ASSERT_EQUAL(std::string("message"), b.message);
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_load() {
+  std::istringstream input("byte\tout/a.bam\texp/a.bam\n\nplaintext\tout/b c.txt\texp/b c.txt\n");
+  output_comparison comparison;
+  comparison.load(input, "list");
+  CPPUNIT_ASSERT(comparison._comparisons.size() == 2);
+  CPPUNIT_ASSERT(comparison._comparisons.at(0).mode == COMPARISON_BYTE);
+  CPPUNIT_ASSERT_EQUAL(std::string("out/a.bam"), comparison._comparisons.at(0).generated.string());
+  CPPUNIT_ASSERT_EQUAL(std::string("exp/a.bam"), comparison._comparisons.at(0).expected.string());
+  CPPUNIT_ASSERT(comparison._comparisons.at(1).mode == COMPARISON_PLAINTEXT);
+  CPPUNIT_ASSERT_EQUAL(std::string("out/b c.txt"), comparison._comparisons.at(1).generated.string());
+  CPPUNIT_ASSERT_EQUAL(std::string("exp/b c.txt"), comparison._comparisons.at(1).expected.string());
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_load_malformed_line() {
+  std::istringstream input("byte\tout/a.bam exp/a.bam\n");
+  output_comparison comparison;
+  comparison.load(input, "list");
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_load_unknown_mode() {
+  std::istringstream input("frame\tout/a.tsv\texp/a.tsv\n");
+  output_comparison comparison;
+  comparison.load(input, "list");
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_add() {
+  output_comparison comparison;
+  comparison.add(COMPARISON_PLAINTEXT, "out/a.txt", "exp/a.txt");
+  CPPUNIT_ASSERT(comparison.get_comparisons().size() == 1);
+  CPPUNIT_ASSERT(comparison.get_comparisons().at(0).mode == COMPARISON_PLAINTEXT);
+  CPPUNIT_ASSERT_EQUAL(std::string("out/a.txt"), comparison.get_comparisons().at(0).generated.string());
+  CPPUNIT_ASSERT_EQUAL(std::string("exp/a.txt"), comparison.get_comparisons().at(0).expected.string());
+  CPPUNIT_ASSERT(!comparison.get_comparisons().at(0).matched);
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_run() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  write_file(tmp_parent / "a.txt", "# made today\nresult\n");
+  write_file(tmp_parent / "a_expected.txt", "# made yesterday\nresult\n");
+  write_file(tmp_parent / "b.bin", std::string(5000, 'b'));
+  write_file(tmp_parent / "b_expected.bin", std::string(5000, 'b'));
+  output_comparison comparison;
+  CPPUNIT_ASSERT(comparison.run(2));
+  comparison.add(COMPARISON_PLAINTEXT, tmp_parent / "a.txt", tmp_parent / "a_expected.txt");
+  comparison.add(COMPARISON_BYTE, tmp_parent / "b.bin", tmp_parent / "b_expected.bin");
+  CPPUNIT_ASSERT(comparison.run(2));
+  CPPUNIT_ASSERT(comparison.get_comparisons().at(0).matched);
+  CPPUNIT_ASSERT(comparison.get_comparisons().at(1).matched);
+  // mismatches and unreadable files are reported without stopping other comparisons
+  comparison.add(COMPARISON_BYTE, tmp_parent / "a.txt", tmp_parent / "a_expected.txt");
+  comparison.add(COMPARISON_PLAINTEXT, tmp_parent / "missing.txt", tmp_parent / "a_expected.txt");
+  CPPUNIT_ASSERT(!comparison.run(0));
+  CPPUNIT_ASSERT(comparison.get_comparisons().at(0).matched);
+  CPPUNIT_ASSERT(comparison.get_comparisons().at(1).matched);
+  CPPUNIT_ASSERT(!comparison.get_comparisons().at(2).matched);
+  CPPUNIT_ASSERT(!comparison.get_comparisons().at(2).message.empty());
+  CPPUNIT_ASSERT(!comparison.get_comparisons().at(3).matched);
+  CPPUNIT_ASSERT(comparison.get_comparisons().at(3).message.find("missing.txt") != std::string::npos);
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_report() {
+  output_comparison comparison;
+  comparison.add(COMPARISON_BYTE, "out/a.bam", "exp/a.bam");
+  comparison.add(COMPARISON_BYTE, "out/b.bam", "exp/b.bam");
+  comparison._comparisons.at(0).matched = true;
+  comparison._comparisons.at(1).message = "differs from expected at byte 4";
+  std::ostringstream out;
+  comparison.report(out);
+  CPPUNIT_ASSERT_EQUAL(std::string("out/b.bam\tdiffers from expected at byte 4\n"), out.str());
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_compare_bytes() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  std::string contents(1048576 + 100, 'a');
+  write_file(tmp_parent / "a", contents);
+  write_file(tmp_parent / "same", contents);
+  std::string message = "stale";
+  CPPUNIT_ASSERT(output_comparison::compare_bytes(tmp_parent / "a", tmp_parent / "same", &message));
+  CPPUNIT_ASSERT(message.empty());
+  // a difference in the second block is located
+  contents.at(1048576 + 50) = 'b';
+  write_file(tmp_parent / "different", contents);
+  CPPUNIT_ASSERT(!output_comparison::compare_bytes(tmp_parent / "different", tmp_parent / "a", &message));
+  CPPUNIT_ASSERT_EQUAL(std::string("differs from expected at byte 1048627"), message);
+  write_file(tmp_parent / "shorter", contents.substr(1));
+  CPPUNIT_ASSERT(!output_comparison::compare_bytes(tmp_parent / "shorter", tmp_parent / "a", &message));
+  CPPUNIT_ASSERT_EQUAL(std::string("size 1048675 differs from expected size 1048676"), message);
+  // comment lines are not ignored
+  write_file(tmp_parent / "comment1", "# one\n");
+  write_file(tmp_parent / "comment2", "# two\n");
+  CPPUNIT_ASSERT(!output_comparison::compare_bytes(tmp_parent / "comment1", tmp_parent / "comment2", &message));
+  write_file(tmp_parent / "empty1", "");
+  write_file(tmp_parent / "empty2", "");
+  CPPUNIT_ASSERT(output_comparison::compare_bytes(tmp_parent / "empty1", tmp_parent / "empty2", &message));
+  CPPUNIT_ASSERT_THROW(output_comparison::compare_bytes(tmp_parent / "a", tmp_parent / "same", NULL),
+                       std::runtime_error);
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_compare_plaintext() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  std::string message = "stale";
+  // comment lines are ignored wherever they are, and line endings do not matter
+  write_file(tmp_parent / "a.txt", "# run on monday\nx\ty\n# midway\n1\t2\n");
+  write_file(tmp_parent / "b.txt", "# run on tuesday\r\nx\ty\r\n1\t2\r\n# done\r\n");
+  CPPUNIT_ASSERT(output_comparison::compare_plaintext(tmp_parent / "a.txt", tmp_parent / "b.txt", &message));
+  CPPUNIT_ASSERT(message.empty());
+  write_file(tmp_parent / "c.txt", "# run on monday\nx\ty\n1\t3\n");
+  CPPUNIT_ASSERT(!output_comparison::compare_plaintext(tmp_parent / "c.txt", tmp_parent / "a.txt", &message));
+  CPPUNIT_ASSERT_EQUAL(std::string("line 3 differs from expected line 4"), message);
+  write_file(tmp_parent / "d.txt", "x\ty\n");
+  CPPUNIT_ASSERT(!output_comparison::compare_plaintext(tmp_parent / "d.txt", tmp_parent / "a.txt", &message));
+  CPPUNIT_ASSERT_EQUAL(std::string("ends before expected line 4"), message);
+  CPPUNIT_ASSERT(!output_comparison::compare_plaintext(tmp_parent / "a.txt", tmp_parent / "d.txt", &message));
+  CPPUNIT_ASSERT_EQUAL(std::string("line 4 is beyond the end of the expected file"), message);
+  // as in python, a missing final newline is a difference
+  write_file(tmp_parent / "e.txt", "x\ty\n1\t2");
+  CPPUNIT_ASSERT(!output_comparison::compare_plaintext(tmp_parent / "e.txt", tmp_parent / "a.txt", &message));
+  // vcf files only ignore their metadata, so the column header is compared
+  write_file(tmp_parent / "a.vcf", "##fileDate=20230101\n#CHROM\tPOS\n1\t100\n");
+  write_file(tmp_parent / "b.vcf", "##fileDate=20230102\n#CHROM\tPOS\n1\t100\n");
+  write_file(tmp_parent / "c.vcf", "##fileDate=20230102\n#CHROM\tPOS\tID\n1\t100\n");
+  CPPUNIT_ASSERT(output_comparison::compare_plaintext(tmp_parent / "a.vcf", tmp_parent / "b.vcf", &message));
+  CPPUNIT_ASSERT(!output_comparison::compare_plaintext(tmp_parent / "a.vcf", tmp_parent / "c.vcf", &message));
+  CPPUNIT_ASSERT_EQUAL(std::string("line 2 differs from expected line 2"), message);
+  CPPUNIT_ASSERT_THROW(output_comparison::compare_plaintext(tmp_parent / "a.vcf", tmp_parent / "b.vcf", NULL),
+                       std::runtime_error);
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_compare_plaintext_compressed() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  std::string message;
+  std::vector<std::string> members;
+  members.push_back("##fileDate=20230101\n#CHROM\tPOS\n");
+  members.push_back("1\t100\n1\t200\n");
+  write_gzip(tmp_parent / "a.vcf.gz", members);
+  members.at(0) = "##fileDate=20230102\n#CHROM\tPOS\n";
+  write_gzip(tmp_parent / "b.VCF.GZ", members);
+  CPPUNIT_ASSERT(output_comparison::compare_plaintext(tmp_parent / "a.vcf.gz", tmp_parent / "b.VCF.GZ", &message));
+  // compressed output can match an uncompressed expected copy
+  write_file(tmp_parent / "c.vcf", "##other\n#CHROM\tPOS\n1\t100\n1\t200\n");
+  CPPUNIT_ASSERT(output_comparison::compare_plaintext(tmp_parent / "a.vcf.gz", tmp_parent / "c.vcf", &message));
+  members.at(1) = "1\t100\n1\t201\n";
+  write_gzip(tmp_parent / "d.vcf.gz", members);
+  CPPUNIT_ASSERT(!output_comparison::compare_plaintext(tmp_parent / "d.vcf.gz", tmp_parent / "a.vcf.gz", &message));
+  CPPUNIT_ASSERT_EQUAL(std::string("line 4 differs from expected line 4"), message);
+}
+
+void snakemake_unit_tests::output_comparisonTest::test_output_comparison_next_content_line() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  write_file(tmp_parent / "a.txt", "#one\n#two\nthree\n#\n");
+  line_reader reader(tmp_parent / "a.txt", false);
+  std::string line;
+  CPPUNIT_ASSERT(output_comparison::next_content_line(&reader, "#", &line));
+  CPPUNIT_ASSERT_EQUAL(std::string("three\n"), line);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), reader.line_number());
+  CPPUNIT_ASSERT(!output_comparison::next_content_line(&reader, "#", &line));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::output_comparisonTest);
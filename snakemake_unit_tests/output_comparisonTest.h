@@ -0,0 +1,79 @@
+/*!
+  \file output_comparisonTest.h
+  \brief output_comparison test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_OUTPUT_COMPARISONTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_OUTPUT_COMPARISONTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <zlib.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/output_comparison.h"
+
+namespace snakemake_unit_tests {
+class output_comparisonTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(output_comparisonTest);
+  CPPUNIT_TEST_EXCEPTION(test_block_reader_constructor_missing_file, std::runtime_error);
+  CPPUNIT_TEST(test_block_reader_next);
+  CPPUNIT_TEST(test_block_reader_next_compressed);
+  CPPUNIT_TEST_EXCEPTION(test_block_reader_next_truncated, std::runtime_error);
+  CPPUNIT_TEST(test_line_reader_next);
+  CPPUNIT_TEST(test_file_comparison_constructor);
+  CPPUNIT_TEST(test_output_comparison_load);
+  CPPUNIT_TEST_EXCEPTION(test_output_comparison_load_malformed_line, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_output_comparison_load_unknown_mode, std::runtime_error);
+  CPPUNIT_TEST(test_output_comparison_add);
+  CPPUNIT_TEST(test_output_comparison_run);
+  CPPUNIT_TEST(test_output_comparison_report);
+  CPPUNIT_TEST(test_output_comparison_compare_bytes);
+  CPPUNIT_TEST(test_output_comparison_compare_plaintext);
+  CPPUNIT_TEST(test_output_comparison_compare_plaintext_compressed);
+  CPPUNIT_TEST(test_output_comparison_next_content_line);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_block_reader_constructor_missing_file();
+  void test_block_reader_next();
+  void test_block_reader_next_compressed();
+  void test_block_reader_next_truncated();
+  void test_line_reader_next();
+  void test_file_comparison_constructor();
+  void test_output_comparison_load();
+  void test_output_comparison_load_malformed_line();
+  void test_output_comparison_load_unknown_mode();
+  void test_output_comparison_add();
+  void test_output_comparison_run();
+  void test_output_comparison_report();
+  void test_output_comparison_compare_bytes();
+  void test_output_comparison_compare_plaintext();
+  void test_output_comparison_compare_plaintext_compressed();
+  void test_output_comparison_next_content_line();
+
+ private:
+  void write_file(const boost::filesystem::path &filename, const std::string &contents) const;
+  void write_gzip(const boost::filesystem::path &filename, const std::vector<std::string> &members) const;
+  std::string read_all(block_reader *reader) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_OUTPUT_COMPARISONTEST_H_
@@ -0,0 +1,227 @@
+/*!
+  @file parse_cache.cc
+  @brief implementation of parse_cache class
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/parse_cache.h"
+
+// bump the version whenever the lexer, the parser, or the payload format changes what is recorded
+#define PARSE_CACHE_HEADER "snakemake_unit_tests parse cache v2 "
+
+static const uint64_t xxh64_prime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t xxh64_prime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t xxh64_prime3 = 0x165667B19E3779F9ULL;
+static const uint64_t xxh64_prime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t xxh64_prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl64(uint64_t x, unsigned n) { return (x << n) | (x >> (64 - n)); }
+
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+  acc += input * xxh64_prime2;
+  return rotl64(acc, 31) * xxh64_prime1;
+}
+
+static inline uint64_t xxh64_merge(uint64_t acc, uint64_t value) {
+  acc ^= xxh64_round(0, value);
+  return acc * xxh64_prime1 + xxh64_prime4;
+}
+
+// words are read in host byte order; keys only need to be stable on one machine
+static inline uint64_t read64(const char *p) {
+  uint64_t res;
+  memcpy(&res, p, 8);
+  return res;
+}
+
+static inline uint32_t read32(const char *p) {
+  uint32_t res;
+  memcpy(&res, p, 4);
+  return res;
+}
+
+/*
+  XXH64 with seed 0. keys are checked many times per run, and a cryptographic
+  hash of every snakefile cost more than parsing it; accidental collisions are
+  what matters here, and the file size is part of the key as well.
+ */
+static uint64_t xxh64(const char *data, uint64_t size) {
+  const char *p = data, *end = data + size;
+  uint64_t h;
+  if (size >= 32) {
+    uint64_t v1 = xxh64_prime1 + xxh64_prime2, v2 = xxh64_prime2, v3 = 0, v4 = -xxh64_prime1;
+    for (; p + 32 <= end; p += 32) {
+      v1 = xxh64_round(v1, read64(p));
+      v2 = xxh64_round(v2, read64(p + 8));
+      v3 = xxh64_round(v3, read64(p + 16));
+      v4 = xxh64_round(v4, read64(p + 24));
+    }
+    h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+    h = xxh64_merge(h, v1);
+    h = xxh64_merge(h, v2);
+    h = xxh64_merge(h, v3);
+    h = xxh64_merge(h, v4);
+  } else {
+    h = xxh64_prime5;
+  }
+  h += size;
+  for (; p + 8 <= end; p += 8) {
+    h ^= xxh64_round(0, read64(p));
+    h = rotl64(h, 27) * xxh64_prime1 + xxh64_prime4;
+  }
+  if (p + 4 <= end) {
+    h ^= static_cast<uint64_t>(read32(p)) * xxh64_prime1;
+    h = rotl64(h, 23) * xxh64_prime2 + xxh64_prime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h ^= static_cast<uint64_t>(static_cast<unsigned char>(*p)) * xxh64_prime5;
+    h = rotl64(h, 11) * xxh64_prime1;
+  }
+  h ^= h >> 33;
+  h *= xxh64_prime2;
+  h ^= h >> 29;
+  h *= xxh64_prime3;
+  h ^= h >> 32;
+  return h;
+}
+
+snakemake_unit_tests::parse_cache::parse_cache(const boost::filesystem::path &cache_dir, bool read_only)
+    : _cache_dir(cache_dir), _read_only(read_only), _hits(0), _misses(0) {}
+
+std::string snakemake_unit_tests::parse_cache::key(std::string_view contents) const {
+  std::ostringstream o;
+  o << std::hex << std::setfill('0') << std::setw(16) << xxh64(contents.data(), contents.size()) << '-' << std::dec
+    << contents.size();
+  return o.str();
+}
+
+std::string snakemake_unit_tests::parse_cache::contents_key(const boost::filesystem::path &base_dir,
+                                                            const std::vector<boost::filesystem::path> &paths) const {
+  std::ostringstream o;
+  for (std::vector<boost::filesystem::path>::const_iterator iter = paths.begin(); iter != paths.end(); ++iter) {
+    boost::filesystem::path full_path = base_dir / *iter;
+    if (boost::filesystem::is_regular_file(full_path)) {
+      o << iter->string() << '\0' << file_key(full_path) << '\n';
+    } else if (boost::filesystem::is_directory(full_path)) {
+      // directory iteration order is unspecified, so sort the entries
+      std::vector<boost::filesystem::path> contents;
+      for (boost::filesystem::recursive_directory_iterator walker(full_path);
+           walker != boost::filesystem::recursive_directory_iterator(); ++walker) {
+        if (boost::filesystem::is_regular_file(walker->path())) contents.push_back(walker->path());
+      }
+      std::sort(contents.begin(), contents.end());
+      for (std::vector<boost::filesystem::path>::const_iterator entry = contents.begin(); entry != contents.end();
+           ++entry) {
+        o << entry->string().substr(base_dir.string().size()) << '\0' << file_key(*entry) << '\n';
+      }
+    } else {
+      o << iter->string() << '\0' << "missing" << '\n';
+    }
+  }
+  return key(o.str());
+}
+
+std::string snakemake_unit_tests::parse_cache::file_key(const boost::filesystem::path &filename) const {
+  std::ifstream input(filename.string().c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!input.is_open()) throw std::runtime_error("cannot open file for cache key: \"" + filename.string() + "\"");
+  // inserting an empty stream buffer flags an error, so empty files are keyed directly
+  if (boost::filesystem::is_empty(filename)) return key("");
+  std::ostringstream contents;
+  if (!(contents << input.rdbuf()))
+    throw std::runtime_error("cannot read file for cache key: \"" + filename.string() + "\"");
+  return key(contents.str());
+}
+
+boost::filesystem::path snakemake_unit_tests::parse_cache::entry_path(const std::string &key) const {
+  return _cache_dir / (key + ".blocks");
+}
+
+bool snakemake_unit_tests::parse_cache::find(const std::string &key, std::string *payload) {
+  if (!payload) throw std::runtime_error("null pointer provided to parse_cache::find");
+  payload->clear();
+  mark_used(key);
+  std::ifstream input;
+  input.open(entry_path(key).string().c_str(), std::ios_base::in | std::ios_base::binary);
+  if (!input.is_open()) {
+    ++_misses;
+    return false;
+  }
+  // entries are "<header><payload size>\n<payload>"
+  std::string header;
+  std::getline(input, header);
+  const std::string expected_header = PARSE_CACHE_HEADER;
+  uint64_t payload_size = 0;
+  bool valid = input && !header.compare(0, expected_header.size(), expected_header) &&
+               header.size() > expected_header.size() &&
+               header.find_first_not_of("0123456789", expected_header.size()) == std::string::npos;
+  if (valid) {
+    // a damaged entry can be shorter or longer than it claims
+    std::streamoff payload_start = input.tellg();
+    input.seekg(0, std::ios_base::end);
+    std::streamoff remaining = input.tellg() - payload_start;
+    input.seekg(payload_start, std::ios_base::beg);
+    valid = header.size() - expected_header.size() < 20 &&
+            (payload_size = std::stoull(header.substr(expected_header.size()))) == static_cast<uint64_t>(remaining);
+    if (valid && payload_size) {
+      payload->resize(payload_size);
+      valid = static_cast<bool>(input.read(&(*payload)[0], payload_size));
+    }
+  }
+  input.close();
+  if (!valid) {
+    payload->clear();
+    ++_misses;
+    return false;
+  }
+  ++_hits;
+  return true;
+}
+
+void snakemake_unit_tests::parse_cache::store(const std::string &key, const std::string &payload) {
+  if (_read_only) return;
+  mark_used(key);
+  boost::filesystem::create_directories(_cache_dir);
+  // a unique temporary name, so concurrent stores of identical files do not collide
+  boost::filesystem::path tmp_path = _cache_dir / boost::filesystem::unique_path(key + ".%%%%-%%%%-%%%%.tmp");
+  std::ofstream output;
+  try {
+    output.open(tmp_path.string().c_str(), std::ios_base::out | std::ios_base::binary);
+    if (!output.is_open()) throw std::runtime_error("cannot write parse cache entry \"" + tmp_path.string() + "\"");
+    if (!(output << PARSE_CACHE_HEADER << payload.size() << '\n') || !output.write(payload.data(), payload.size()))
+      throw std::runtime_error("cannot write to parse cache entry \"" + tmp_path.string() + "\"");
+    output.close();
+    boost::filesystem::rename(tmp_path, entry_path(key));
+  } catch (...) {
+    if (output.is_open()) output.close();
+    boost::filesystem::remove(tmp_path);
+    throw;
+  }
+}
+
+void snakemake_unit_tests::parse_cache::mark_used(const std::string &key) {
+  std::lock_guard<std::mutex> lock(_used_mutex);
+  _used.insert(key);
+}
+
+unsigned snakemake_unit_tests::parse_cache::prune() {
+  if (_read_only || !boost::filesystem::is_directory(_cache_dir)) return 0;
+  std::vector<boost::filesystem::path> unused;
+  {
+    std::lock_guard<std::mutex> lock(_used_mutex);
+    for (boost::filesystem::directory_iterator iter(_cache_dir); iter != boost::filesystem::directory_iterator();
+         ++iter) {
+      boost::filesystem::path filename = iter->path().filename();
+      if (!filename.extension().compare(".blocks") && _used.find(filename.stem().string()) != _used.end()) continue;
+      if (!filename.extension().compare(".blocks") || !filename.extension().compare(".tmp")) {
+        unused.push_back(iter->path());
+      }
+    }
+  }
+  for (std::vector<boost::filesystem::path>::const_iterator iter = unused.begin(); iter != unused.end(); ++iter) {
+    boost::filesystem::remove(*iter);
+  }
+  return unused.size();
+}
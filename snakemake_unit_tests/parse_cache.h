@@ -0,0 +1,157 @@
+/*!
+  @file parse_cache.h
+  @brief on-disk cache of parsed snakefiles, keyed by content hash
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  between regenerations of a test suite, most snakefiles are unchanged.
+  each parsed file is recorded under a hash of its contents, so an
+  unchanged file can be restored without lexing or parsing it again.
+  the cache only stores opaque payloads; what they contain is up to the
+  caller.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_PARSE_CACHE_H_
+#define SNAKEMAKE_UNIT_TESTS_PARSE_CACHE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
+namespace snakemake_unit_tests {
+/*!
+  @class parse_cache
+  @brief directory of cached parse results
+
+  each entry is written to a temporary file and renamed into place, so
+  entries can be stored and found from several threads at once, and an
+  interrupted run never leaves a partial entry behind
+ */
+class parse_cache {
+ public:
+  /*!
+    @brief constructor
+    @param cache_dir directory holding cache entries; created on first store
+    @param read_only whether to skip storing new entries
+   */
+  parse_cache(const boost::filesystem::path &cache_dir, bool read_only);
+  /*!
+    @brief destructor
+   */
+  ~parse_cache() throw() {}
+  /*!
+    @brief compute the cache key for some file contents
+    @param contents complete contents of a file
+    @return hexadecimal XXH64 digest of contents, a dash, and the size of contents
+   */
+  std::string key(std::string_view contents) const;
+  /*!
+    @brief compute a cache key over the contents of files and directories
+    @param base_dir directory to which paths are relative
+    @param paths files and directories to describe; directories are walked recursively
+    @return cache key over the relative path and content key of every file
+
+    missing paths are described as missing, so creating them changes the key
+   */
+  std::string contents_key(const boost::filesystem::path &base_dir,
+                           const std::vector<boost::filesystem::path> &paths) const;
+  /*!
+    @brief look up a cached payload
+    @param key cache key of the original file contents
+    @param payload where to store the payload, if found
+    @return whether a valid entry for the key was found
+
+    entries written by a different cache format version, or damaged
+    on disk, are reported as missing
+   */
+  bool find(const std::string &key, std::string *payload);
+  /*!
+    @brief record a payload for later runs
+    @param key cache key of the original file contents
+    @param payload data to record
+   */
+  void store(const std::string &key, const std::string &payload);
+  /*!
+    @brief remove entries that this run did not use
+    @return number of entries removed
+
+    every key looked up or stored since construction is kept; anything
+    else, including temporary files left by an interrupted run, is
+    deleted, so the cache only holds what the current pipeline needs.
+    read-only caches are left untouched.
+   */
+  unsigned prune();
+  /*!
+    @brief keep an entry that this run needs but does not look up
+    @param key cache key
+   */
+  void retain(const std::string &key) { mark_used(key); }
+  /*!
+    @brief get the directory holding cache entries
+    @return the directory holding cache entries
+   */
+  const boost::filesystem::path &get_cache_dir() const { return _cache_dir; }
+  /*!
+    @brief get the number of successful lookups
+    @return the number of successful lookups
+   */
+  unsigned hits() const { return _hits; }
+  /*!
+    @brief get the number of failed lookups
+    @return the number of failed lookups
+   */
+  unsigned misses() const { return _misses; }
+
+ private:
+  friend class parse_cacheTest;
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  parse_cache() { throw std::domain_error("parse_cache: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing parse_cache object
+    @warning disabled
+   */
+  parse_cache(const parse_cache &obj) { throw std::domain_error("parse_cache: do not use copy constructor"); }
+  /*!
+    @brief get the location of the entry for a key
+    @param key cache key
+    @return path to the entry
+   */
+  boost::filesystem::path entry_path(const std::string &key) const;
+  /*!
+    @brief record that a key was used by this run, so prune keeps its entry
+    @param key cache key
+   */
+  void mark_used(const std::string &key);
+  /*!
+    @brief compute the cache key for the contents of a file on disk
+    @param filename file to read
+    @return cache key of the file's contents
+   */
+  std::string file_key(const boost::filesystem::path &filename) const;
+  boost::filesystem::path _cache_dir;  //!< directory holding cache entries
+  bool _read_only;                     //!< whether new entries are discarded
+  std::atomic<unsigned> _hits;         //!< number of successful lookups
+  std::atomic<unsigned> _misses;       //!< number of failed lookups
+  std::set<std::string> _used;         //!< keys looked up or stored since construction
+  std::mutex _used_mutex;              //!< guards _used
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_PARSE_CACHE_H_
@@ -0,0 +1,204 @@
+/*!
+  \file parse_cacheTest.cc
+  \brief implementation of parse_cache unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/parse_cacheTest.h"
+
+void snakemake_unit_tests::parse_cacheTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutPCAXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("parse_cacheTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::parse_cacheTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_constructor() {
+  boost::filesystem::path cache_dir = boost::filesystem::path(_tmp_dir) / "cache";
+  parse_cache cache(cache_dir, false);
+  CPPUNIT_ASSERT(cache._cache_dir == cache_dir);
+  CPPUNIT_ASSERT(!cache._read_only);
+  CPPUNIT_ASSERT(!cache.hits());
+  CPPUNIT_ASSERT(!cache.misses());
+  CPPUNIT_ASSERT(cache.get_cache_dir() == cache_dir);
+  // nothing is created until something is stored
+  CPPUNIT_ASSERT(!boost::filesystem::exists(cache_dir));
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_key() {
+  parse_cache cache(boost::filesystem::path(_tmp_dir), true);
+  // reference XXH64 values
+  CPPUNIT_ASSERT_EQUAL(std::string("ef46db3751d8e999-0"), cache.key(""));
+  CPPUNIT_ASSERT_EQUAL(std::string("44bc2cf5ad770999-3"), cache.key("abc"));
+  CPPUNIT_ASSERT(cache.key("rule a:\n").compare(cache.key("rule b:\n")));
+  // long enough to use all four accumulators
+  std::string long_input(100, 'x');
+  CPPUNIT_ASSERT(cache.key(long_input).size() == 20);
+  CPPUNIT_ASSERT(!cache.key(long_input).compare(cache.key(std::string(100, 'x'))));
+  CPPUNIT_ASSERT(cache.key(long_input).compare(cache.key(std::string(99, 'x') + "y")));
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_contents_key() {
+  boost::filesystem::path base_dir(_tmp_dir);
+  parse_cache cache(base_dir / "cache", true);
+  boost::filesystem::create_directories(base_dir / "extra" / "nested");
+  std::ofstream output((base_dir / "config.yaml").string().c_str());
+  output << "a: 1" << std::endl;
+  output.close();
+  output.open((base_dir / "extra" / "nested" / "data.tsv").string().c_str());
+  output << "x" << std::endl;
+  output.close();
+  std::vector<boost::filesystem::path> paths;
+  paths.push_back("config.yaml");
+  paths.push_back("extra");
+  paths.push_back("missing.txt");
+  std::string original = cache.contents_key(base_dir, paths);
+  CPPUNIT_ASSERT(!original.compare(cache.contents_key(base_dir, paths)));
+  // a file growing inside a directory changes the key
+  output.open((base_dir / "extra" / "nested" / "data.tsv").string().c_str(), std::ios_base::app);
+  output << "y" << std::endl;
+  output.close();
+  std::string grown = cache.contents_key(base_dir, paths);
+  CPPUNIT_ASSERT(original.compare(grown));
+  // so does a missing file appearing
+  output.open((base_dir / "missing.txt").string().c_str());
+  output.close();
+  std::string appeared = cache.contents_key(base_dir, paths);
+  CPPUNIT_ASSERT(grown.compare(appeared));
+  // and a same-size edit within the timestamp resolution
+  std::time_t modified = boost::filesystem::last_write_time(base_dir / "config.yaml");
+  output.open((base_dir / "config.yaml").string().c_str());
+  output << "a: 2" << std::endl;
+  output.close();
+  boost::filesystem::last_write_time(base_dir / "config.yaml", modified);
+  CPPUNIT_ASSERT(appeared.compare(cache.contents_key(base_dir, paths)));
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_find() {
+  parse_cache cache(boost::filesystem::path(_tmp_dir), false);
+  std::string payload = "1\nblock 0 0 0 1\n0\n\n0\n\n0\n\n5\nx = 1\n", found = "leftover";
+  cache.store("abc", payload);
+  CPPUNIT_ASSERT(cache.find("abc", &found));
+  CPPUNIT_ASSERT_EQUAL(payload, found);
+  CPPUNIT_ASSERT(cache.hits() == 1);
+  cache.store("empty", "");
+  CPPUNIT_ASSERT(cache.find("empty", &found));
+  CPPUNIT_ASSERT(found.empty());
+  CPPUNIT_ASSERT(cache.hits() == 2);
+  CPPUNIT_ASSERT(!cache.misses());
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_find_missing() {
+  parse_cache cache(boost::filesystem::path(_tmp_dir) / "absent", false);
+  std::string found = "leftover";
+  CPPUNIT_ASSERT(!cache.find("abc", &found));
+  CPPUNIT_ASSERT(found.empty());
+  CPPUNIT_ASSERT(cache.misses() == 1);
+  CPPUNIT_ASSERT(!cache.hits());
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_find_damaged() {
+  parse_cache cache(boost::filesystem::path(_tmp_dir), false);
+  std::string found;
+  // truncated, overlong, and from a different format version
+  const char *entries[] = {"snakemake_unit_tests parse cache v2 10\nshort",
+                           "snakemake_unit_tests parse cache v2 2\nlong",
+                           "snakemake_unit_tests parse cache v1 4\nolds",
+                           "snakemake_unit_tests parse cache v2 x\n"};
+  for (unsigned i = 0; i < 4; ++i) {
+    std::ofstream output((boost::filesystem::path(_tmp_dir) / ("entry" + std::to_string(i) + ".blocks")).string());
+    output << entries[i];
+    output.close();
+    CPPUNIT_ASSERT(!cache.find("entry" + std::to_string(i), &found));
+    CPPUNIT_ASSERT(found.empty());
+  }
+  CPPUNIT_ASSERT(cache.misses() == 4);
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_find_null_pointer() {
+  parse_cache cache(boost::filesystem::path(_tmp_dir), false);
+  cache.find("abc", NULL);
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_store() {
+  boost::filesystem::path cache_dir = boost::filesystem::path(_tmp_dir) / "nested/cache";
+  parse_cache cache(cache_dir, false);
+  cache.store("abc", "first");
+  cache.store("abc", "second");
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(cache_dir / "abc.blocks"));
+  std::ifstream input((cache_dir / "abc.blocks").string().c_str());
+  std::string header, payload;
+  std::getline(input, header);
+  std::getline(input, payload);
+  CPPUNIT_ASSERT_EQUAL(std::string("snakemake_unit_tests parse cache v2 6"), header);
+  CPPUNIT_ASSERT_EQUAL(std::string("second"), payload);
+  // no temporary files are left behind
+  unsigned n_entries = 0;
+  for (boost::filesystem::directory_iterator iter(cache_dir); iter != boost::filesystem::directory_iterator();
+       ++iter) {
+    ++n_entries;
+  }
+  CPPUNIT_ASSERT(n_entries == 1);
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_store_read_only() {
+  boost::filesystem::path cache_dir = boost::filesystem::path(_tmp_dir) / "cache";
+  parse_cache cache(cache_dir, true);
+  cache.store("abc", "payload");
+  CPPUNIT_ASSERT(!boost::filesystem::exists(cache_dir));
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_prune() {
+  boost::filesystem::path cache_dir = boost::filesystem::path(_tmp_dir) / "cache";
+  // nothing to do before anything is stored
+  parse_cache empty(cache_dir, false);
+  CPPUNIT_ASSERT(!empty.prune());
+  {
+    parse_cache previous_run(cache_dir, false);
+    previous_run.store("old", "payload");
+    previous_run.store("kept", "payload");
+    previous_run.store("restored", "payload");
+  }
+  std::ofstream output((cache_dir / "interrupted.1234-5678-9abc.tmp").string().c_str());
+  output.close();
+  output.open((cache_dir / "unrelated.txt").string().c_str());
+  output.close();
+  // entries looked up or stored by this run survive; everything else it wrote is removed
+  parse_cache cache(cache_dir, false);
+  std::string found;
+  CPPUNIT_ASSERT(cache.find("restored", &found));
+  cache.store("kept", "updated");
+  cache.store("new", "payload");
+  CPPUNIT_ASSERT(cache.prune() == 2);
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(cache_dir / "kept.blocks"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(cache_dir / "restored.blocks"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(cache_dir / "new.blocks"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(cache_dir / "old.blocks"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(cache_dir / "interrupted.1234-5678-9abc.tmp"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(cache_dir / "unrelated.txt"));
+}
+
+void snakemake_unit_tests::parse_cacheTest::test_parse_cache_prune_read_only() {
+  boost::filesystem::path cache_dir = boost::filesystem::path(_tmp_dir) / "cache";
+  {
+    parse_cache previous_run(cache_dir, false);
+    previous_run.store("old", "payload");
+  }
+  // plan mode only reads the cache, and must not empty it
+  parse_cache cache(cache_dir, true);
+  CPPUNIT_ASSERT(!cache.prune());
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(cache_dir / "old.blocks"));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::parse_cacheTest);
@@ -0,0 +1,64 @@
+/*!
+  \file parse_cacheTest.h
+  \brief parse_cache test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_PARSE_CACHETEST_H_
+#define SNAKEMAKE_UNIT_TESTS_PARSE_CACHETEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/parse_cache.h"
+
+namespace snakemake_unit_tests {
+class parse_cacheTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(parse_cacheTest);
+  CPPUNIT_TEST(test_parse_cache_constructor);
+  CPPUNIT_TEST(test_parse_cache_key);
+  CPPUNIT_TEST(test_parse_cache_contents_key);
+  CPPUNIT_TEST(test_parse_cache_find);
+  CPPUNIT_TEST(test_parse_cache_find_missing);
+  CPPUNIT_TEST(test_parse_cache_find_damaged);
+  CPPUNIT_TEST_EXCEPTION(test_parse_cache_find_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_parse_cache_store);
+  CPPUNIT_TEST(test_parse_cache_store_read_only);
+  CPPUNIT_TEST(test_parse_cache_prune);
+  CPPUNIT_TEST(test_parse_cache_prune_read_only);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_parse_cache_constructor();
+  void test_parse_cache_key();
+  void test_parse_cache_contents_key();
+  void test_parse_cache_find();
+  void test_parse_cache_find_missing();
+  void test_parse_cache_find_damaged();
+  void test_parse_cache_find_null_pointer();
+  void test_parse_cache_store();
+  void test_parse_cache_store_read_only();
+  void test_parse_cache_prune();
+  void test_parse_cache_prune_read_only();
+
+ private:
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_PARSE_CACHETEST_H_
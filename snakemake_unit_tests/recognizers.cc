@@ -0,0 +1,107 @@
+/*!
+  @file recognizers.cc
+  @brief implementations of hand-written snakefile declaration matchers
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/recognizers.h"
+
+/*!
+  @brief count leading spaces
+  @param line line to scan
+  @return index of first character that is not a space
+ */
+static std::string_view::size_type leading_spaces(std::string_view line) {
+  std::string_view::size_type pos = 0;
+  while (pos < line.size() && line[pos] == ' ') ++pos;
+  return pos;
+}
+
+/*!
+  @brief find the end of a run of non-space characters
+  @param line line to scan
+  @param start first index of run
+  @return index of first space at or after start, or line size
+ */
+static std::string_view::size_type non_space_run_end(std::string_view line, std::string_view::size_type start) {
+  std::string_view::size_type pos = line.find(' ', start);
+  return pos == std::string_view::npos ? line.size() : pos;
+}
+
+bool snakemake_unit_tests::match_rule_declaration(std::string_view line, std::string_view keyword,
+                                                  unsigned *indentation, std::string_view *rule_name) {
+  if (!indentation || !rule_name) throw std::runtime_error("null pointer provided to match_rule_declaration");
+  std::string_view::size_type pos = leading_spaces(line);
+  if (line.compare(pos, keyword.size(), keyword) || line.size() <= pos + keyword.size() ||
+      line[pos + keyword.size()] != ' ') {
+    return false;
+  }
+  std::string_view::size_type name_start = pos + keyword.size() + 1;
+  std::string_view::size_type run_end = non_space_run_end(line, name_start);
+  // the name is nonempty and greedy, so it ends at the last colon in the run
+  if (run_end <= name_start + 1) return false;
+  std::string_view::size_type colon = line.rfind(':', run_end - 1);
+  if (colon == std::string_view::npos || colon <= name_start) return false;
+  *indentation = pos;
+  *rule_name = line.substr(name_start, colon - name_start);
+  return true;
+}
+
+bool snakemake_unit_tests::match_derived_rule_declaration(std::string_view line, unsigned *indentation,
+                                                          std::string_view *base_rule_name,
+                                                          std::string_view *rule_name) {
+  if (!indentation || !base_rule_name || !rule_name)
+    throw std::runtime_error("null pointer provided to match_derived_rule_declaration");
+  std::string_view::size_type pos = leading_spaces(line);
+  if (line.compare(pos, 9, "use rule ")) return false;
+  std::string_view::size_type base_start = pos + 9;
+  std::string_view::size_type base_end = non_space_run_end(line, base_start);
+  if (base_end == base_start || line.compare(base_end, 4, " as ")) return false;
+  std::string_view::size_type name_start = base_end + 4;
+  std::string_view::size_type name_end = non_space_run_end(line, name_start);
+  if (name_end == name_start || line.compare(name_end, 6, " with:")) return false;
+  *indentation = pos;
+  *base_rule_name = line.substr(base_start, base_end - base_start);
+  *rule_name = line.substr(name_start, name_end - name_start);
+  return true;
+}
+
+bool snakemake_unit_tests::match_named_block_header(std::string_view line, unsigned indentation,
+                                                    std::string_view *block_name, std::string_view *block_contents) {
+  if (!block_name || !block_contents) throw std::runtime_error("null pointer provided to match_named_block_header");
+  if (line.size() <= indentation || leading_spaces(line) != indentation) return false;
+  std::string_view::size_type pos = indentation;
+  while (pos < line.size() && ((line[pos] >= 'a' && line[pos] <= 'z') || (line[pos] >= 'A' && line[pos] <= 'Z') ||
+                               line[pos] == '_' || line[pos] == '-')) {
+    ++pos;
+  }
+  if (pos == indentation || pos == line.size() || line[pos] != ':') return false;
+  *block_name = line.substr(indentation, pos - indentation);
+  *block_contents = line.substr(pos + 1);
+  return true;
+}
+
+bool snakemake_unit_tests::match_include_directive(std::string_view line, std::string_view *filename_expression) {
+  std::string_view::size_type pos = leading_spaces(line);
+  if (line.compare(pos, 8, "include:")) return false;
+  pos += 8;
+  while (pos < line.size() && line[pos] == ' ') ++pos;
+  // the expression runs to the last non-space character, and must not be empty
+  std::string_view::size_type last = line.find_last_not_of(' ');
+  if (last == std::string_view::npos || last < pos) return false;
+  if (filename_expression) *filename_expression = line.substr(pos, last + 1 - pos);
+  return true;
+}
+
+bool snakemake_unit_tests::match_string_literal(std::string_view expression, std::string_view *contents) {
+  // prefixed strings such as f-strings do not begin with a quote
+  if (expression.size() < 2 || (expression[0] != '"' && expression[0] != '\'')) return false;
+  for (std::string_view::size_type i = 1; i < expression.size() - 1; ++i) {
+    if (expression[i] == expression[0] || expression[i] == '\\') return false;
+  }
+  if (expression[expression.size() - 1] != expression[0]) return false;
+  if (contents) *contents = expression.substr(1, expression.size() - 2);
+  return true;
+}
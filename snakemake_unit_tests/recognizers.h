@@ -0,0 +1,85 @@
+/*!
+  @file recognizers.h
+  @brief hand-written matchers for snakefile declarations
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  each matcher accepts exactly the lines accepted by the regular expression
+  in its description, with the same captures, but in a single pass and
+  without constructing a regex. lines come from the lexical parser, so
+  they may contain embedded newlines from multiline string literals;
+  "non-space" below includes tabs and newlines, as in the regex '[^ ]'.
+  captures are views into the tested line and share its lifetime.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_RECOGNIZERS_H_
+#define SNAKEMAKE_UNIT_TESTS_RECOGNIZERS_H_
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace snakemake_unit_tests {
+/*!
+  @brief match a rule or checkpoint declaration
+  @param line line to test
+  @param keyword declaration keyword, e.g. "rule" or "checkpoint"
+  @param indentation set to number of leading spaces, if matched
+  @param rule_name set to declared rule name, if matched
+  @return whether the line matches
+
+  equivalent to "^( *)keyword ([^ ]+):.*$": the name runs up to the
+  last colon before the next space
+ */
+bool match_rule_declaration(std::string_view line, std::string_view keyword, unsigned *indentation,
+                            std::string_view *rule_name);
+/*!
+  @brief match a derived rule declaration
+  @param line line to test
+  @param indentation set to number of leading spaces, if matched
+  @param base_rule_name set to name of inherited rule, if matched
+  @param rule_name set to name of new rule, if matched
+  @return whether the line matches
+
+  equivalent to "^( *)use rule ([^ ]+) as ([^ ]+) with:.*$"
+ */
+bool match_derived_rule_declaration(std::string_view line, unsigned *indentation, std::string_view *base_rule_name,
+                                    std::string_view *rule_name);
+/*!
+  @brief match the header line of a named block within a rule
+  @param line line to test
+  @param indentation exact number of leading spaces required
+  @param block_name set to block name, if matched
+  @param block_contents set to content after the colon, if matched
+  @return whether the line matches
+
+  equivalent to "^{indentation spaces}([a-zA-Z_\-]+):(.*)$"
+ */
+bool match_named_block_header(std::string_view line, unsigned indentation, std::string_view *block_name,
+                              std::string_view *block_contents);
+/*!
+  @brief match an include directive
+  @param line line to test
+  @param filename_expression if not null, set to the included expression,
+  if matched
+  @return whether the line matches
+
+  equivalent to "^( *)include: *(.*[^ ]) *$", with the expression being
+  the second capture
+ */
+bool match_include_directive(std::string_view line, std::string_view *filename_expression);
+/*!
+  @brief match a python expression that is a plain string literal
+  @param expression python expression to test
+  @param contents if not null, set to the text between the quotes,
+  if matched
+  @return whether the expression is a single- or double-quoted string
+  with no prefix, escapes, or embedded quotes of the same kind
+
+  such a literal evaluates to its own contents, without python
+ */
+bool match_string_literal(std::string_view expression, std::string_view *contents);
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_RECOGNIZERS_H_
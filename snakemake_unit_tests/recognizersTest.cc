@@ -0,0 +1,185 @@
+/*!
+  \file recognizersTest.cc
+  \brief implementation of recognizers unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/recognizersTest.h"
+
+void snakemake_unit_tests::recognizersTest::setUp() {
+  _lines.clear();
+  _lines.push_back("");
+  _lines.push_back("rule");
+  _lines.push_back("rule :");
+  _lines.push_back("rule a:");
+  _lines.push_back("rule a:b:");
+  _lines.push_back("rule a:b: c:");
+  _lines.push_back("rule a b:");
+  _lines.push_back("rule a\tb:  # comment");
+  _lines.push_back("rule a:\n    input: 'x'");
+  _lines.push_back("   rule name_1:");
+  _lines.push_back("\trule a:");
+  _lines.push_back("rules a:");
+  _lines.push_back("checkpoint c:");
+  _lines.push_back("  checkpoint c:d");
+  _lines.push_back("use rule a as b with:");
+  _lines.push_back("  use rule a as b with: # trailing");
+  _lines.push_back("use rule a as  b with:");
+  _lines.push_back("use rule a as b with");
+  _lines.push_back("use rule a as b as c with:");
+  _lines.push_back("use rule * from other as other_* with:");
+  _lines.push_back("    input:");
+  _lines.push_back("    input: \"a\",");
+  _lines.push_back("    input:: x");
+  _lines.push_back("    my-block_name:");
+  _lines.push_back("     input:");
+  _lines.push_back("    in put:");
+  _lines.push_back("    input2:");
+  _lines.push_back("    :");
+  _lines.push_back("include:");
+  _lines.push_back("include: ");
+  _lines.push_back("include: a");
+  _lines.push_back("include:    \"path/to/file.smk\"   ");
+  _lines.push_back("  include: os.path.join(a, b)");
+  _lines.push_back("include:\"x\"");
+  _lines.push_back("include: a b ");
+  _lines.push_back("include: a\n");
+  _lines.push_back("includes: a");
+}
+
+void snakemake_unit_tests::recognizersTest::tearDown() {}
+
+void snakemake_unit_tests::recognizersTest::test_match_rule_declaration() {
+  unsigned indentation = 100;
+  std::string_view rule_name;
+  CPPUNIT_ASSERT(match_rule_declaration("  rule myrule: # comment", "rule", &indentation, &rule_name));
+  CPPUNIT_ASSERT(indentation == 2U);
+  CPPUNIT_ASSERT(!rule_name.compare("myrule"));
+  // the name extends to the last colon before a space
+  CPPUNIT_ASSERT(match_rule_declaration("checkpoint a:b:", "checkpoint", &indentation, &rule_name));
+  CPPUNIT_ASSERT(indentation == 0U);
+  CPPUNIT_ASSERT(!rule_name.compare("a:b"));
+  CPPUNIT_ASSERT(!match_rule_declaration("checkpoint a:", "rule", &indentation, &rule_name));
+  CPPUNIT_ASSERT(!match_rule_declaration("rule a", "rule", &indentation, &rule_name));
+  CPPUNIT_ASSERT(!match_rule_declaration("rule a b:", "rule", &indentation, &rule_name));
+}
+
+void snakemake_unit_tests::recognizersTest::test_match_rule_declaration_null_pointer() {
+  std::string_view rule_name;
+  match_rule_declaration("rule a:", "rule", NULL, &rule_name);
+}
+
+void snakemake_unit_tests::recognizersTest::test_match_derived_rule_declaration() {
+  unsigned indentation = 100;
+  std::string_view base_rule_name, rule_name;
+  CPPUNIT_ASSERT(match_derived_rule_declaration("    use rule base as derived with: # x", &indentation,
+                                                &base_rule_name, &rule_name));
+  CPPUNIT_ASSERT(indentation == 4U);
+  CPPUNIT_ASSERT(!base_rule_name.compare("base"));
+  CPPUNIT_ASSERT(!rule_name.compare("derived"));
+  CPPUNIT_ASSERT(!match_derived_rule_declaration("use rule base as derived", &indentation, &base_rule_name,
+                                                 &rule_name));
+  CPPUNIT_ASSERT(!match_derived_rule_declaration("use rule base as  derived with:", &indentation, &base_rule_name,
+                                                 &rule_name));
+}
+
+void snakemake_unit_tests::recognizersTest::test_match_derived_rule_declaration_null_pointer() {
+  unsigned indentation = 0;
+  std::string_view rule_name;
+  match_derived_rule_declaration("use rule a as b with:", &indentation, NULL, &rule_name);
+}
+
+void snakemake_unit_tests::recognizersTest::test_match_named_block_header() {
+  std::string_view block_name, block_contents;
+  CPPUNIT_ASSERT(match_named_block_header("    input: \"a\",", 4, &block_name, &block_contents));
+  CPPUNIT_ASSERT(!block_name.compare("input"));
+  CPPUNIT_ASSERT(!block_contents.compare(" \"a\","));
+  CPPUNIT_ASSERT(match_named_block_header("log-file_x:", 0, &block_name, &block_contents));
+  CPPUNIT_ASSERT(!block_name.compare("log-file_x"));
+  CPPUNIT_ASSERT(block_contents.empty());
+  // indentation must match exactly
+  CPPUNIT_ASSERT(!match_named_block_header("     input:", 4, &block_name, &block_contents));
+  CPPUNIT_ASSERT(!match_named_block_header("   input:", 4, &block_name, &block_contents));
+  CPPUNIT_ASSERT(!match_named_block_header("    input2:", 4, &block_name, &block_contents));
+}
+
+void snakemake_unit_tests::recognizersTest::test_match_named_block_header_null_pointer() {
+  std::string_view block_name;
+  match_named_block_header("    input:", 4, &block_name, NULL);
+}
+
+void snakemake_unit_tests::recognizersTest::test_match_include_directive() {
+  std::string_view filename_expression;
+  CPPUNIT_ASSERT(match_include_directive("  include:   \"rules/a.smk\"  ", &filename_expression));
+  CPPUNIT_ASSERT(!filename_expression.compare("\"rules/a.smk\""));
+  // the expression is optional
+  CPPUNIT_ASSERT(match_include_directive("include: a", NULL));
+  CPPUNIT_ASSERT(!match_include_directive("include:   ", &filename_expression));
+  CPPUNIT_ASSERT(!match_include_directive("includes: a", &filename_expression));
+}
+
+void snakemake_unit_tests::recognizersTest::test_match_string_literal() {
+  std::string_view contents;
+  CPPUNIT_ASSERT(match_string_literal("\"rules/a.smk\"", &contents));
+  CPPUNIT_ASSERT(!contents.compare("rules/a.smk"));
+  CPPUNIT_ASSERT(match_string_literal("'rules/\"b\".smk'", &contents));
+  CPPUNIT_ASSERT(!contents.compare("rules/\"b\".smk"));
+  CPPUNIT_ASSERT(match_string_literal("''", &contents));
+  CPPUNIT_ASSERT(contents.empty());
+  CPPUNIT_ASSERT(match_string_literal("\"a\"", NULL));
+  // prefixes, escapes, and anything computed need python
+  CPPUNIT_ASSERT(!match_string_literal("f\"rules/{x}.smk\"", &contents));
+  CPPUNIT_ASSERT(!match_string_literal("\"rules\\\\a.smk\"", &contents));
+  CPPUNIT_ASSERT(!match_string_literal("\"rules/\" + x", &contents));
+  CPPUNIT_ASSERT(!match_string_literal("\"a\" \"b\"", &contents));
+  CPPUNIT_ASSERT(!match_string_literal("\"a'", &contents));
+  CPPUNIT_ASSERT(!match_string_literal("\"", &contents));
+  CPPUNIT_ASSERT(!match_string_literal("x", &contents));
+}
+
+void snakemake_unit_tests::recognizersTest::test_recognizers_match_regex() {
+  // these are the expressions the recognizers replaced in rule_block
+  const boost::regex rule_declaration("^( *)rule ([^ ]+):.*$");
+  const boost::regex checkpoint_declaration("^( *)checkpoint ([^ ]+):.*$");
+  const boost::regex derived_rule_declaration("^( *)use rule ([^ ]+) as ([^ ]+) with:.*$");
+  const boost::regex named_block_tag("^    ([a-zA-Z_\\-]+):(.*)$");
+  const boost::regex include_directive("^( *)include: *(.*[^ ]) *$");
+  boost::smatch regex_result;
+  unsigned indentation = 0;
+  std::string_view first, second;
+  for (std::vector<std::string>::const_iterator iter = _lines.begin(); iter != _lines.end(); ++iter) {
+    bool expected = boost::regex_match(*iter, regex_result, rule_declaration);
+    CPPUNIT_ASSERT(match_rule_declaration(*iter, "rule", &indentation, &first) == expected);
+    if (expected) {
+      CPPUNIT_ASSERT(indentation == regex_result[1].str().size());
+      CPPUNIT_ASSERT(!first.compare(regex_result[2].str()));
+    }
+    expected = boost::regex_match(*iter, regex_result, checkpoint_declaration);
+    CPPUNIT_ASSERT(match_rule_declaration(*iter, "checkpoint", &indentation, &first) == expected);
+    if (expected) {
+      CPPUNIT_ASSERT(indentation == regex_result[1].str().size());
+      CPPUNIT_ASSERT(!first.compare(regex_result[2].str()));
+    }
+    expected = boost::regex_match(*iter, regex_result, derived_rule_declaration);
+    CPPUNIT_ASSERT(match_derived_rule_declaration(*iter, &indentation, &first, &second) == expected);
+    if (expected) {
+      CPPUNIT_ASSERT(indentation == regex_result[1].str().size());
+      CPPUNIT_ASSERT(!first.compare(regex_result[2].str()));
+      CPPUNIT_ASSERT(!second.compare(regex_result[3].str()));
+    }
+    expected = boost::regex_match(*iter, regex_result, named_block_tag);
+    CPPUNIT_ASSERT(match_named_block_header(*iter, 4, &first, &second) == expected);
+    if (expected) {
+      CPPUNIT_ASSERT(!first.compare(regex_result[1].str()));
+      CPPUNIT_ASSERT(!second.compare(regex_result[2].str()));
+    }
+    expected = boost::regex_match(*iter, regex_result, include_directive);
+    CPPUNIT_ASSERT(match_include_directive(*iter, &first) == expected);
+    if (expected) {
+      CPPUNIT_ASSERT(!first.compare(regex_result[2].str()));
+    }
+  }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::recognizersTest);
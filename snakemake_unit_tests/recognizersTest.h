@@ -0,0 +1,57 @@
+/*!
+  \file recognizersTest.h
+  \brief recognizers test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_RECOGNIZERSTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_RECOGNIZERSTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/regex.hpp"
+#include "snakemake_unit_tests/recognizers.h"
+
+namespace snakemake_unit_tests {
+class recognizersTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(recognizersTest);
+  CPPUNIT_TEST(test_match_rule_declaration);
+  CPPUNIT_TEST_EXCEPTION(test_match_rule_declaration_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_match_derived_rule_declaration);
+  CPPUNIT_TEST_EXCEPTION(test_match_derived_rule_declaration_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_match_named_block_header);
+  CPPUNIT_TEST_EXCEPTION(test_match_named_block_header_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_match_include_directive);
+  CPPUNIT_TEST(test_match_string_literal);
+  CPPUNIT_TEST(test_recognizers_match_regex);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_match_rule_declaration();
+  void test_match_rule_declaration_null_pointer();
+  void test_match_derived_rule_declaration();
+  void test_match_derived_rule_declaration_null_pointer();
+  void test_match_named_block_header();
+  void test_match_named_block_header_null_pointer();
+  void test_match_include_directive();
+  void test_match_string_literal();
+  void test_recognizers_match_regex();
+
+ private:
+  std::vector<std::string> _lines;  //!< awkward lines for comparison against regex
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_RECOGNIZERSTEST_H_
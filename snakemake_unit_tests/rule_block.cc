@@ -17,7 +17,8 @@ snakemake_unit_tests::rule_block::rule_block()
       _local_indentation(0),
       _resolution(UNRESOLVED),
       _queried_by_python(false),
-      _python_tag(0) {}
+      _python_tag(0),
+      _rendered(false) {}
 
 snakemake_unit_tests::rule_block::rule_block(const rule_block &obj)
     : _rule_name(obj._rule_name),
@@ -30,21 +31,23 @@ snakemake_unit_tests::rule_block::rule_block(const rule_block &obj)
       _resolution(obj._resolution),
       _queried_by_python(obj._queried_by_python),
       _python_tag(obj._python_tag),
-      _resolved_included_filename(obj._resolved_included_filename) {}
+      _resolved_included_filename(obj._resolved_included_filename),
+      _arena(obj._arena),
+      _rendered(obj._rendered),
+      _rendered_contents(obj._rendered_contents),
+      _rendered_placeholder(obj._rendered_placeholder) {}
 
 snakemake_unit_tests::rule_block::~rule_block() throw() {}
 
-bool snakemake_unit_tests::rule_block::load_content_block(const std::vector<std::string> &loaded_lines, bool verbose,
-                                                          unsigned *current_line) {
+bool snakemake_unit_tests::rule_block::load_content_block(const std::vector<std::string_view> &loaded_lines,
+                                                          bool verbose, unsigned *current_line) {
   if (!current_line) throw std::runtime_error("null pointer for counter passed to load_content_block");
   // clear out internals, just to be safe
   clear();
   // define variables for processing
-  std::string line = "";
-  // define regex patterns for testing
-  const boost::regex standard_rule_declaration("^( *)rule ([^ ]+):.*$");
-  const boost::regex checkpoint_rule_declaration("^( *)checkpoint ([^ ]+):.*$");
-  const boost::regex derived_rule_declaration("^( *)use rule ([^ ]+) as ([^ ]+) with:.*$");
+  std::string_view line, rule_name, base_rule_name;
+  unsigned declaration_indentation = 0;
+  bool consumed = false;
   if (*current_line >= loaded_lines.size()) return false;
   while (*current_line < loaded_lines.size()) {
     line = loaded_lines.at(*current_line);
@@ -54,29 +57,34 @@ bool snakemake_unit_tests::rule_block::load_content_block(const std::vector<std:
     }
     if (line.empty() || line.find_first_not_of(" ") == std::string::npos) continue;
     // if the line is a valid rule declaration
-    boost::smatch regex_result;
-    if (boost::regex_match(line, regex_result, standard_rule_declaration) ||
-        boost::regex_match(line, regex_result, checkpoint_rule_declaration)) {
+    if (match_rule_declaration(line, "rule", &declaration_indentation, &rule_name) ||
+        match_rule_declaration(line, "checkpoint", &declaration_indentation, &rule_name)) {
       if (verbose) {
-        std::cout << "consuming rule with name \"" << regex_result[2] << "\"" << std::endl;
+        std::cout << "consuming rule with name \"" << rule_name << "\"" << std::endl;
       }
-      set_rule_name(regex_result[2]);
+      set_rule_name(std::string(rule_name));
       if (line.find_first_not_of(" ") == line.find("checkpoint")) {
         set_checkpoint(true);
       }
-      _local_indentation = regex_result[1].str().size();
-      return consume_rule_contents(loaded_lines, verbose, current_line);
-    } else if (boost::regex_match(line, regex_result, derived_rule_declaration)) {
+      _local_indentation = declaration_indentation;
+      consumed = consume_rule_contents(loaded_lines, verbose, current_line);
+      // blocks are not added after loading, so release unused capacity
+      _named_blocks.shrink_to_fit();
+      return consumed;
+    } else if (match_derived_rule_declaration(line, &declaration_indentation, &base_rule_name, &rule_name)) {
       if (verbose) {
-        std::cout << "consuming derived rule with name \"" << regex_result[3] << "\"" << std::endl;
+        std::cout << "consuming derived rule with name \"" << rule_name << "\"" << std::endl;
       }
-      set_rule_name(regex_result[3]);
-      _local_indentation += regex_result[1].str().size();
+      set_rule_name(std::string(rule_name));
+      _local_indentation += declaration_indentation;
       // derived rules declare a base rule from which they inherit certain
       // fields. setting those certain fields must be deferred until all rules
       // are available.
-      set_base_rule_name(regex_result[2]);
-      return consume_rule_contents(loaded_lines, verbose, current_line);
+      set_base_rule_name(std::string(base_rule_name));
+      consumed = consume_rule_contents(loaded_lines, verbose, current_line);
+      // blocks are not added after loading, so release unused capacity
+      _named_blocks.shrink_to_fit();
+      return consumed;
     } else {
       // new to refactor: this is arbitrary python and we're leaving it like that
       if (verbose) {
@@ -90,14 +98,13 @@ bool snakemake_unit_tests::rule_block::load_content_block(const std::vector<std:
   return !_rule_name.empty() || !_code_chunk.empty();
 }
 
-bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<std::string> &loaded_lines, bool verbose,
-                                                             unsigned *current_line) {
-  std::ostringstream regex_formatter;
-  regex_formatter << "^" << indentation(get_local_indentation() + 4) << "([a-zA-Z_\\-]+):(.*)$";
-  const boost::regex named_block_tag(regex_formatter.str());
+bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<std::string_view> &loaded_lines,
+                                                             bool verbose, unsigned *current_line) {
   if (!current_line) throw std::runtime_error("null pointer for counter passed to consume_rule_contents");
-  std::string line = "", block_name = "", block_contents = "";
-  std::string::size_type line_indentation = 0;
+  std::string_view line, block_name, block_contents;
+  // multiline block contents are assembled here, then moved to the arena
+  std::string aggregated_contents = "";
+  std::string_view::size_type line_indentation = 0;
   unsigned starting_line = 0;
   while (*current_line < loaded_lines.size()) {
     // deal with reverting multiline consumption of content
@@ -123,10 +130,8 @@ bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<s
     // expose this to user space?
     if (line_indentation == get_local_indentation() + 4) {
       // enforce named tag here
-      boost::smatch named_block_tag_result;
-      if (boost::regex_match(line, named_block_tag_result, named_block_tag)) {
-        block_name = named_block_tag_result[1];
-        block_contents = named_block_tag_result[2];
+      if (match_named_block_header(line, get_local_indentation() + 4, &block_name, &block_contents)) {
+        aggregated_contents.clear();
         // remove_comments_and_docstrings is deprecated by lexical parser
         // while additional block contents are theoretically available
         while (*current_line < loaded_lines.size()) {
@@ -141,6 +146,7 @@ bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<s
           // if a line that's not contents is found
           if (line_indentation <= get_local_indentation() + 4) {
             *current_line = starting_line;
+            if (!aggregated_contents.empty()) block_contents = arena()->store(aggregated_contents);
             if (verbose) {
               std::cout << "storing a block with name \"" << block_name << "\" and contents \"" << block_contents
                         << "\"" << std::endl;
@@ -152,10 +158,19 @@ bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<s
           } else {
             // TODO(cpalmer718): deal with entries extending across multiple
             // lines? aggregate the contents with some formatting
-            block_contents += "\n" + line;
+            if (aggregated_contents.empty() && block_contents.data() + block_contents.size() + 1 == line.data() &&
+                block_contents.data()[block_contents.size()] == '\n') {
+              // the next line follows directly in the file buffer: extend the view
+              block_contents = std::string_view(block_contents.data(), block_contents.size() + 1 + line.size());
+            } else {
+              if (aggregated_contents.empty()) aggregated_contents = block_contents;
+              aggregated_contents += '\n';
+              aggregated_contents += line;
+            }
           }
         }
         if (*current_line >= loaded_lines.size()) {
+          if (!aggregated_contents.empty()) block_contents = arena()->store(aggregated_contents);
           // catch dangling blocks at the end of files
           if (_named_blocks.empty() || _named_blocks.rbegin()->first.compare(block_name)) {
             if (verbose) {
@@ -182,23 +197,18 @@ bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<s
 }
 
 bool snakemake_unit_tests::rule_block::contains_include_directive() const {
-  // what is an include directive?
-  const boost::regex include_directive("^( *)include: *(.*[^ ]) *$");
+  // what is an include directive? see match_include_directive
   if (get_code_chunk().size() == 1) {
-    boost::smatch include_match;
-    return boost::regex_match(*get_code_chunk().begin(), include_match, include_directive);
+    return match_include_directive(*get_code_chunk().begin(), NULL);
   }
   return false;
 }
 
 std::string snakemake_unit_tests::rule_block::get_filename_expression() const {
-  // what is an include directive?
-  const boost::regex include_directive("^( *)include: *(.*[^ ]) *$");
-  if (get_code_chunk().size() == 1) {
-    boost::smatch include_match;
-    if (boost::regex_match(*get_code_chunk().begin(), include_match, include_directive)) {
-      return include_match[2].str();
-    }
+  // what is an include directive? see match_include_directive
+  std::string_view filename_expression;
+  if (get_code_chunk().size() == 1 && match_include_directive(*get_code_chunk().begin(), &filename_expression)) {
+    return std::string(filename_expression);
   }
   throw std::runtime_error(
       "get_filename_expression() called in code block "
@@ -217,8 +227,8 @@ bool snakemake_unit_tests::rule_block::report_python_logging_code(std::ostream &
           throw std::runtime_error("include statement printing error");
       }
       // report tag along with required expression for evaluation
-      if (!(out << indentation(get_code_chunk().rbegin()->find_first_not_of(" ")) << "print(\"tag"
-                << get_interpreter_tag() << ": {}\".format(" << get_filename_expression() << "))" << std::endl))
+      if (!(out << indentation(get_code_chunk().rbegin()->find_first_not_of(" ")) << "snakemake_unit_tests_report("
+                << get_interpreter_tag() << ", " << get_filename_expression() << ")" << std::endl))
         throw std::runtime_error("complex include printing error");
       // new: terminate immediately if this was an unresolved
       // include directive
@@ -227,14 +237,15 @@ bool snakemake_unit_tests::rule_block::report_python_logging_code(std::ostream &
       }
     } else {
       // regardless of resolution, print other code as-is
-      for (std::vector<std::string>::const_iterator iter = get_code_chunk().begin(); iter != get_code_chunk().end();
-           ++iter) {
+      for (std::vector<std::string_view>::const_iterator iter = get_code_chunk().begin();
+           iter != get_code_chunk().end(); ++iter) {
         if (!(out << *iter << std::endl)) throw std::runtime_error("code chunk printing error");
       }
     }
   } else if (!get_rule_name().empty()) {  // is a rule
     // new logic: must print tag each time, in case status changes later
-    if (!(out << indentation(get_local_indentation()) << "print(\"tag" << get_interpreter_tag() << "\")" << std::endl
+    if (!(out << indentation(get_local_indentation()) << "snakemake_unit_tests_report(" << get_interpreter_tag() << ")"
+              << std::endl
               << std::endl
               << std::endl))
       throw std::runtime_error("rule interpreter code printing failure");
@@ -242,7 +253,8 @@ bool snakemake_unit_tests::rule_block::report_python_logging_code(std::ostream &
     // rule name is empty but blocks are not.
     // switching to direct snakemake interpretation, in which case these
     // need to be included
-    for (std::vector<std::pair<std::string, std::string> >::const_iterator iter = get_named_blocks().begin();
+    for (std::vector<std::pair<std::string_view, std::string_view> >::const_iterator iter =
+             get_named_blocks().begin();
          iter != get_named_blocks().end(); ++iter) {
       if (!(out << indentation(get_local_indentation()) << iter->first << ":" << iter->second << std::endl))
         throw std::runtime_error("snakemake directive printing failure");
@@ -251,8 +263,37 @@ bool snakemake_unit_tests::rule_block::report_python_logging_code(std::ostream &
   return false;
 }
 
+bool snakemake_unit_tests::rule_block::reportable_after_unresolved_include() const {
+  if (get_code_chunk().empty()) return !get_rule_name().empty();
+  if (!contains_include_directive() || _resolution == RESOLVED_INCLUDED) return false;
+  return match_string_literal(get_filename_expression(), NULL);
+}
+
+bool snakemake_unit_tests::rule_block::resolvable_statically() const {
+  if (get_code_chunk().empty()) return get_rule_name().empty() || !get_local_indentation();
+  if (!contains_include_directive()) return true;
+  // the directive line is the only line of the block
+  std::string_view filename_expression;
+  return match_include_directive(get_code_chunk().front(), &filename_expression) &&
+         get_code_chunk().front()[0] != ' ' && match_string_literal(filename_expression, NULL);
+}
+
+void snakemake_unit_tests::rule_block::resolve_statically() {
+  if (!resolvable_statically()) throw std::logic_error("resolve_statically called on block that needs python");
+  set_resolution(RESOLVED_INCLUDED);
+  if (contains_include_directive()) {
+    std::string expression = get_filename_expression();
+    std::string_view filename;
+    match_string_literal(expression, &filename);
+    _resolved_included_filename = std::string(filename);
+  }
+  _queried_by_python = true;
+}
+
 bool snakemake_unit_tests::rule_block::update_resolution(const std::map<std::string, std::string> &tag_values) {
   std::map<std::string, std::string>::const_iterator finder;
+  // python cannot disagree with a static resolution, and may not have reached the block this pass
+  if (resolved() && resolvable_statically()) return true;
   // tag==0 entries are python code that doesn't require inclusion tracking
   if (get_interpreter_tag()) {
     finder = tag_values.find("tag" + std::to_string(get_interpreter_tag()));
@@ -284,68 +325,202 @@ bool snakemake_unit_tests::rule_block::update_resolution(const std::map<std::str
 
 void snakemake_unit_tests::rule_block::print_contents(std::ostream &out) const {
   // report contents. may eventually be used for printing to custom snakefile
+  std::string formatted;
+  render_contents(&formatted);
+  if (!(out << formatted)) throw std::runtime_error("rule block printing failure");
+}
+
+void snakemake_unit_tests::rule_block::render_contents(std::string *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to render_contents");
   if (!get_code_chunk().empty()) {  // python code
-    for (std::vector<std::string>::const_iterator iter = get_code_chunk().begin(); iter != get_code_chunk().end();
+    for (std::vector<std::string_view>::const_iterator iter = get_code_chunk().begin(); iter != get_code_chunk().end();
          ++iter) {
-      if (!(out << *iter << std::endl)) throw std::runtime_error("code chunk printing error");
+      target->append(*iter);
+      target->push_back('\n');
     }
   } else if (!get_rule_name().empty()) {  // rule
+    target->append(get_local_indentation(), ' ');
     if (!get_base_rule_name().empty()) {
-      if (!(out << indentation(get_local_indentation()) << "use rule " << get_base_rule_name() << " as "
-                << get_rule_name() << " with:" << std::endl))
-        throw std::runtime_error("base rule name printing failure");
-    } else if (!(out << indentation(get_local_indentation()) << (is_checkpoint() ? "checkpoint " : "rule ")
-                     << get_rule_name() << ":" << std::endl)) {
-      throw std::runtime_error("rule name printing failure");
+      target->append("use rule ").append(get_base_rule_name()).append(" as ");
+      target->append(get_rule_name()).append(" with:\n");
+    } else {
+      target->append(is_checkpoint() ? "checkpoint " : "rule ").append(get_rule_name()).append(":\n");
     }
     // if docstring is present, report it
     if (!_docstring.empty()) {
-      if (!(out << _docstring << std::endl)) {
-        throw std::runtime_error("docstring printing failure");
-      }
+      target->append(_docstring);
+      target->push_back('\n');
     }
     // report all blocks in the order they were encountered
-    std::map<std::string, bool> forbidden_blocks;
-    /*
-      new: in snakemake 6.15.0, support for a 'default_target' rule block entry
-      was added, to override the behavior of snakemake running the first rule it encounters
-      when no additional information is provided in the snakemake invocation. this functionality
-      seems to largely have no impact on the unit tester, but it's also antithetical to how
-      this testing regime is structured. as such, it is the inaugural member of a named block exclusion
-      list, against which the output is filtered.
-     */
-    forbidden_blocks["default_target"] = true;
-    for (std::vector<std::pair<std::string, std::string> >::const_iterator iter = get_named_blocks().begin();
+    for (std::vector<std::pair<std::string_view, std::string_view> >::const_iterator iter =
+             get_named_blocks().begin();
          iter != get_named_blocks().end(); ++iter) {
-      if (forbidden_blocks.find(iter->first) == forbidden_blocks.end()) {
-        if (!(out << indentation(get_local_indentation() + 4) << iter->first << ":" << iter->second << std::endl))
-          throw std::runtime_error("named block printing failure");
-      }
+      /*
+        new: in snakemake 6.15.0, support for a 'default_target' rule block entry
+        was added, to override the behavior of snakemake running the first rule it encounters
+        when no additional information is provided in the snakemake invocation. this functionality
+        seems to largely have no impact on the unit tester, but it's also antithetical to how
+        this testing regime is structured. as such, it is the inaugural member of a named block exclusion
+        list, against which the output is filtered.
+       */
+      if (!iter->first.compare("default_target")) continue;
+      target->append(get_local_indentation() + 4, ' ');
+      target->append(iter->first);
+      target->push_back(':');
+      target->append(iter->second);
+      target->push_back('\n');
     }
     // for snakefmt compatibility: emit two empty lines at the end of a rule
-    if (!(out << std::endl << std::endl)) throw std::runtime_error("rule padding printing error");
+    target->append("\n\n");
   } else {
     // snakemake metacontent block
-    for (std::vector<std::pair<std::string, std::string> >::const_iterator iter = get_named_blocks().begin();
+    for (std::vector<std::pair<std::string_view, std::string_view> >::const_iterator iter =
+             get_named_blocks().begin();
          iter != get_named_blocks().end(); ++iter) {
-      if (!(out << indentation(get_local_indentation()) << iter->first << ":" << iter->second << std::endl))
-        throw std::runtime_error("named block printing failure");
+      target->append(get_local_indentation(), ' ');
+      target->append(iter->first);
+      target->push_back(':');
+      target->append(iter->second);
+      target->push_back('\n');
     }
   }
 }
 
+void snakemake_unit_tests::rule_block::render_placeholder(std::string *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to render_placeholder");
+  target->append(get_local_indentation(), ' ');
+  target->append("pass\n\n\n");
+}
+
+void snakemake_unit_tests::rule_block::render() {
+  std::string formatted;
+  render_contents(&formatted);
+  _rendered_contents = arena()->store(formatted);
+  formatted.clear();
+  render_placeholder(&formatted);
+  _rendered_placeholder = arena()->store(formatted);
+  _rendered = true;
+}
+
+void snakemake_unit_tests::rule_block::add_code_chunk(const std::string &s) {
+  _code_chunk.push_back(arena()->store(s));
+  _rendered = false;
+}
+
+/*
+  a cache record is a header line, "block <indentation> <checkpoint> <named blocks> <code lines>",
+  followed by the rule name, base rule name, docstring, each named block's name and contents,
+  and each code line, each written by write_cache_string.
+ */
+void snakemake_unit_tests::rule_block::write_cache_record(std::ostream &out) const {
+  out << "block " << _local_indentation << ' ' << (_rule_is_checkpoint ? 1 : 0) << ' ' << _named_blocks.size() << ' '
+      << _code_chunk.size() << '\n';
+  write_cache_string(out, _rule_name);
+  write_cache_string(out, _base_rule_name);
+  write_cache_string(out, _docstring);
+  for (std::vector<std::pair<std::string_view, std::string_view> >::const_iterator iter = _named_blocks.begin();
+       iter != _named_blocks.end(); ++iter) {
+    write_cache_string(out, iter->first);
+    write_cache_string(out, iter->second);
+  }
+  for (std::vector<std::string_view>::const_iterator iter = _code_chunk.begin(); iter != _code_chunk.end(); ++iter) {
+    write_cache_string(out, *iter);
+  }
+  if (!out) throw std::runtime_error("parse cache record writing failure");
+}
+
+void snakemake_unit_tests::rule_block::read_cache_record(std::string_view *record) {
+  if (!record) throw std::runtime_error("null pointer provided to read_cache_record");
+  if (record->substr(0, 6).compare("block ")) throw std::runtime_error("missing parse cache record header");
+  record->remove_prefix(6);
+  clear();
+  _local_indentation = read_cache_number(record, ' ');
+  uint64_t checkpoint = read_cache_number(record, ' ');
+  if (checkpoint > 1) throw std::runtime_error("invalid checkpoint flag in parse cache record");
+  _rule_is_checkpoint = checkpoint == 1;
+  uint64_t n_named_blocks = read_cache_number(record, ' ');
+  uint64_t n_code_lines = read_cache_number(record, '\n');
+  // every string takes at least two bytes, so larger counts cannot be genuine
+  if (n_named_blocks > record->size() || n_code_lines > record->size())
+    throw std::runtime_error("invalid element count in parse cache record");
+  _rule_name = std::string(read_cache_string(record));
+  _base_rule_name = std::string(read_cache_string(record));
+  _docstring = read_cache_string(record);
+  _named_blocks.reserve(n_named_blocks);
+  for (uint64_t i = 0; i < n_named_blocks; ++i) {
+    std::string_view name = read_cache_string(record);
+    _named_blocks.push_back(std::make_pair(name, read_cache_string(record)));
+  }
+  _code_chunk.reserve(n_code_lines);
+  for (uint64_t i = 0; i < n_code_lines; ++i) {
+    _code_chunk.push_back(read_cache_string(record));
+  }
+}
+
+void snakemake_unit_tests::rule_block::write_resolution_record(std::ostream &out) const {
+  out << "resolution " << static_cast<unsigned>(_resolution) << ' ' << (_queried_by_python ? 1 : 0) << '\n';
+  write_cache_string(out, _resolved_included_filename.string());
+  if (!out) throw std::runtime_error("resolution record writing failure");
+}
+
+void snakemake_unit_tests::rule_block::read_resolution_record(std::string_view *record) {
+  if (!record) throw std::runtime_error("null pointer provided to read_resolution_record");
+  if (record->substr(0, 11).compare("resolution ")) throw std::runtime_error("missing resolution record header");
+  record->remove_prefix(11);
+  uint64_t status = read_cache_number(record, ' ');
+  if (status > RESOLVED_EXCLUDED) throw std::runtime_error("invalid status in resolution record");
+  uint64_t queried = read_cache_number(record, '\n');
+  if (queried > 1) throw std::runtime_error("invalid query flag in resolution record");
+  _resolved_included_filename = std::string(read_cache_string(record));
+  _resolution = static_cast<block_status>(status);
+  _queried_by_python = queried == 1;
+}
+
+void snakemake_unit_tests::rule_block::append_python_signature(std::string *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to append_python_signature");
+  // mirrors report_python_logging_code; fields are separated by a byte that cannot occur in a lexed line
+  if (!get_code_chunk().empty()) {
+    target->append("code");
+    for (std::vector<std::string_view>::const_iterator iter = get_code_chunk().begin();
+         iter != get_code_chunk().end(); ++iter) {
+      target->push_back('\0');
+      target->append(*iter);
+    }
+  } else if (!get_rule_name().empty()) {
+    target->append("rule");
+    target->push_back('\0');
+    target->append(std::to_string(get_local_indentation()));
+  } else {
+    target->append("directives");
+    target->push_back('\0');
+    target->append(std::to_string(get_local_indentation()));
+    for (std::vector<std::pair<std::string_view, std::string_view> >::const_iterator iter =
+             get_named_blocks().begin();
+         iter != get_named_blocks().end(); ++iter) {
+      target->push_back('\0');
+      target->append(iter->first);
+      target->push_back('\0');
+      target->append(iter->second);
+    }
+  }
+  target->push_back('\n');
+}
+
+snakemake_unit_tests::string_arena *snakemake_unit_tests::rule_block::arena() {
+  // blocks that are not loaded from a file get their own small arena
+  if (!_arena) _arena = boost::shared_ptr<string_arena>(new string_arena(256));
+  return _arena.get();
+}
+
 void snakemake_unit_tests::rule_block::clear() {
   _rule_name = _base_rule_name = "";
   _named_blocks.clear();
   _code_chunk.clear();
+  _rendered = false;
 }
 
 std::string snakemake_unit_tests::rule_block::indentation(unsigned count) const {
-  std::ostringstream o;
-  for (unsigned i = 0; i < count; ++i) {
-    o << ' ';
-  }
-  return o.str();
+  return std::string(count, ' ');
 }
 
 std::string snakemake_unit_tests::rule_block::apply_indentation(const std::string &s, unsigned count) const {
@@ -15,11 +15,15 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "boost/filesystem.hpp"
 #include "boost/regex.hpp"
+#include "boost/shared_ptr.hpp"
+#include "snakemake_unit_tests/arena.h"
+#include "snakemake_unit_tests/recognizers.h"
 #include "snakemake_unit_tests/utilities.h"
 
 namespace snakemake_unit_tests {
@@ -55,9 +59,10 @@ class rule_block {
     @return whether a rule was successfully loaded
 
     this function will parse out a single rule from a snakemake file.
-    it is designed to be called until it returns false.
+    it is designed to be called until it returns false. the block keeps
+    views into loaded_lines, so their storage must outlive it; see set_arena.
    */
-  bool load_content_block(const std::vector<std::string> &loaded_lines, bool verbose, unsigned *current_line);
+  bool load_content_block(const std::vector<std::string_view> &loaded_lines, bool verbose, unsigned *current_line);
 
   /*!
     @brief having found a rule declaration, load its blocks
@@ -66,7 +71,15 @@ class rule_block {
     @param current_line currently probed line tracker
     @return whether a rule was successfully loaded
    */
-  bool consume_rule_contents(const std::vector<std::string> &loaded_lines, bool verbose, unsigned *current_line);
+  bool consume_rule_contents(const std::vector<std::string_view> &loaded_lines, bool verbose, unsigned *current_line);
+
+  /*!
+    @brief share storage with the file from which this block is loaded
+    @param arena arena that owns the file buffer and its derived text
+
+    holding the arena keeps every view in this block valid
+   */
+  void set_arena(const boost::shared_ptr<string_arena> &arena) { _arena = arena; }
 
   /*!
     @brief set the name of the rule
@@ -116,17 +129,57 @@ class rule_block {
    */
   void print_contents(std::ostream &out) const;
 
+  /*!
+    @brief append the contents print_contents would report to a buffer
+    @param target buffer to which to append formatted contents
+   */
+  void render_contents(std::string *target) const;
+
+  /*!
+    @brief append the placeholder that stands in for a rule that is not emitted
+    @param target buffer to which to append the placeholder
+   */
+  void render_placeholder(std::string *target) const;
+
+  /*!
+    @brief format this block once, for repeated emission
+
+    the formatted contents, and the placeholder that stands in for the
+    block when it is not emitted, are stored in the block's arena and
+    remain valid until the block's contents next change
+   */
+  void render();
+
+  /*!
+    @brief whether render has been called since contents last changed
+    @return whether rendered contents are current
+   */
+  bool rendered() const { return _rendered; }
+
+  /*!
+    @brief get contents as formatted by the last call to render
+    @return formatted contents
+   */
+  std::string_view get_rendered_contents() const { return _rendered_contents; }
+
+  /*!
+    @brief get the placeholder for a rule that is not emitted, as formatted
+    by the last call to render
+    @return "pass" at the block's indentation, followed by rule padding
+   */
+  std::string_view get_rendered_placeholder() const { return _rendered_placeholder; }
+
   /*!
     @brief get internal storage of code chunk as const reference
     @return code chunk as const reference
   */
-  const std::vector<std::string> &get_code_chunk() const { return _code_chunk; }
+  const std::vector<std::string_view> &get_code_chunk() const { return _code_chunk; }
 
   /*!
     @brief get named blocks of rule body
     @return named blocks of rule body, or empty vector
    */
-  const std::vector<std::pair<std::string, std::string> > &get_named_blocks() const { return _named_blocks; }
+  const std::vector<std::pair<std::string_view, std::string_view> > &get_named_blocks() const { return _named_blocks; }
 
   /*!
     @brief get local indentation of rule block
@@ -140,7 +193,7 @@ class rule_block {
 
     required for the redesign of the parser
    */
-  void add_code_chunk(const std::string &s) { _code_chunk.push_back(s); }
+  void add_code_chunk(const std::string &s);
 
   /*!
     @brief test equality
@@ -207,6 +260,32 @@ class rule_block {
     of an unresolved include directive
    */
   bool report_python_logging_code(std::ostream &out);
+  /*!
+    @brief determine whether this block can still be reported after
+    an unresolved include directive in the same file
+    @return whether this block's python equivalent is independent of
+    anything an earlier include would have loaded
+
+    rules only report their tags. include directives qualify if they
+    are not yet included and their filename is a plain string literal,
+    so only their tags are printed and evaluating them cannot fail.
+    all other python code might depend on the skipped include.
+   */
+  bool reportable_after_unresolved_include() const;
+  /*!
+    @brief determine whether this block can be resolved without python
+    @return whether the block is included whenever its file is
+
+    python code and snakemake directives are always reported as-is.
+    rules at the top level of a file run whenever the file does, as
+    do top level include directives on plain string literals, whose
+    filename is then known as well.
+   */
+  bool resolvable_statically() const;
+  /*!
+    @brief resolve this block as included, without python
+   */
+  void resolve_statically();
   /*!
     @brief using python tag output, update resolution status
     @param tag_values loaded key(:value) pairs from python output
@@ -231,12 +310,59 @@ class rule_block {
 
     uninterpretable if not a rule
    */
-  void set_checkpoint(bool b) { _rule_is_checkpoint = b; }
+  void set_checkpoint(bool b) {
+    _rule_is_checkpoint = b;
+    _rendered = false;
+  }
+
+  /*!
+    @brief write the parsed contents of this block as a parse cache record
+    @param out open output stream to which to write the record
+
+    only what the parser produces is recorded; resolution status
+    and interpreter tags belong to a particular run
+   */
+  void write_cache_record(std::ostream &out) const;
+  /*!
+    @brief restore parsed contents from a parse cache record
+    @param record cache contents starting at this block's record;
+    advanced past the record on return
+
+    restored text is viewed rather than copied, so the record must live
+    in this block's arena. malformed records throw std::runtime_error.
+   */
+  void read_cache_record(std::string_view *record);
+  /*!
+    @brief write the python resolution state of this block
+    @param out open output stream to which to write the record
+
+    the record holds resolution status, whether python has queried
+    the block, and any resolved include filename
+   */
+  void write_resolution_record(std::ostream &out) const;
+  /*!
+    @brief restore python resolution state written by write_resolution_record
+    @param record resolution contents starting at this block's record;
+    advanced past the record on return
+
+    malformed records throw std::runtime_error
+   */
+  void read_resolution_record(std::string_view *record);
+  /*!
+    @brief describe what this block contributes to a python resolution pass
+    @param target where to append the description
+
+    rule bodies never reach the interpreter, so only a rule's indentation
+    is described. two blocks with equal descriptions resolve identically
+    given the same preceding code.
+   */
+  void append_python_signature(std::string *target) const;
 
  private:
   friend class rule_blockTest;
   friend class snakemake_fileTest;
   friend class solved_rulesTest;
+  friend class rule_registryTest;
   /*!
     @brief return a string containing some number of whitespaces
     @param count total whitespace indentation to apply
@@ -255,6 +381,12 @@ class rule_block {
    */
   std::string apply_indentation(const std::string &s, unsigned count) const;
 
+  /*!
+    @brief get storage for text that is not in the loaded lines
+    @return this block's arena, created if the block has none
+   */
+  string_arena *arena();
+
   /*!
     @brief clear out internal storage
    */
@@ -284,7 +416,7 @@ class rule_block {
 
     allow the rule to have an arbitrary docstring (or series of docstrings)
    */
-  std::string _docstring;
+  std::string_view _docstring;
   /*!
     @brief arbitrary named blocks and their contents
 
@@ -292,7 +424,7 @@ class rule_block {
     with intrinsic ordering requirements in snakemake and new snakemake
     features upstream
    */
-  std::vector<std::pair<std::string, std::string> > _named_blocks;
+  std::vector<std::pair<std::string_view, std::string_view> > _named_blocks;
   /*!
     @brief arbitrary python code chunk that can exist between rules
 
@@ -301,7 +433,7 @@ class rule_block {
     follow the same logic as rule blocks, they can just be stored in their
     own copy of this class
    */
-  std::vector<std::string> _code_chunk;
+  std::vector<std::string_view> _code_chunk;
   /*!
     @brief allow for local indentation of conditionally included rules
 
@@ -319,7 +451,8 @@ class rule_block {
     @brief whether the block has been queried by python at least once
 
     the idea is: resolution status can only be known for certain if the
-    tag has been emitted at least one time
+    tag has been emitted at least one time. blocks resolved statically
+    count as queried.
   */
   bool _queried_by_python;
   /*!
@@ -333,6 +466,24 @@ class rule_block {
     @brief for include directives: resolved name of included file
    */
   boost::filesystem::path _resolved_included_filename;
+  /*!
+    @brief owner of the text viewed by this block
+
+    shared with every other block loaded from the same file
+   */
+  boost::shared_ptr<string_arena> _arena;
+  /*!
+    @brief whether the rendered views reflect current contents
+   */
+  bool _rendered;
+  /*!
+    @brief formatted contents, stored in the arena
+   */
+  std::string_view _rendered_contents;
+  /*!
+    @brief formatted placeholder, stored in the arena
+   */
+  std::string_view _rendered_placeholder;
 };
 }  // namespace snakemake_unit_tests
 
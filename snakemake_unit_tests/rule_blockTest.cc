@@ -67,6 +67,7 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_copy_constructor() {
   b1._queried_by_python = true;
   b1._python_tag = 333;
   b1._resolved_included_filename = "thing1/thing2/thing3";
+  b1._arena = boost::shared_ptr<string_arena>(new string_arena);
   rule_block b2(b1);
   CPPUNIT_ASSERT(!b2._rule_name.compare("rulename"));
   CPPUNIT_ASSERT(!b2._base_rule_name.compare("baserulename"));
@@ -85,6 +86,7 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_copy_constructor() {
   CPPUNIT_ASSERT(b2._queried_by_python);
   CPPUNIT_ASSERT_EQUAL(333u, b2._python_tag);
   CPPUNIT_ASSERT(!b2._resolved_included_filename.compare("thing1/thing2/thing3"));
+  CPPUNIT_ASSERT(b2._arena == b1._arena);
 }
 void snakemake_unit_tests::rule_blockTest::test_rule_block_load_content_block() {
   rule_block standard_rule, derived_rule, localrules, python_if, checkpoint, configfile;
@@ -195,6 +197,38 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_consume_rule_contents
   rule_block b;
   b.consume_rule_contents(_snakefile_lines, false, NULL);
 }
+void snakemake_unit_tests::rule_blockTest::test_rule_block_set_arena() {
+  boost::shared_ptr<string_arena> arena(new string_arena);
+  std::string source =
+      "rule myrule:\n    input: 'a.txt',\n    output:\n        'b.txt',\n"
+      "    params:\n        a=1,  # note\n        b=2,\n";
+  std::string_view contents = arena->adopt(&source);
+  std::vector<std::string_view> lines = lexical_parse(contents.data(), contents.size(), arena.get());
+  rule_block b;
+  b.set_arena(arena);
+  CPPUNIT_ASSERT(b._arena == arena);
+  unsigned current_line = 0;
+  CPPUNIT_ASSERT(b.load_content_block(lines, false, &current_line));
+  CPPUNIT_ASSERT(b._named_blocks.size() == 3u);
+  // contents found verbatim in the file are views into the adopted buffer
+  CPPUNIT_ASSERT(!b._named_blocks.at(0).second.compare(" 'a.txt',"));
+  CPPUNIT_ASSERT(b._named_blocks.at(0).second.data() >= contents.data() &&
+                 b._named_blocks.at(0).second.data() < contents.data() + contents.size());
+  CPPUNIT_ASSERT(!b._named_blocks.at(1).second.compare("\n        'b.txt',"));
+  CPPUNIT_ASSERT(b._named_blocks.at(1).second.data() >= contents.data() &&
+                 b._named_blocks.at(1).second.data() < contents.data() + contents.size());
+  // contents with pruned comments are copied into the shared arena
+  CPPUNIT_ASSERT(!b._named_blocks.at(2).second.compare("\n        a=1,\n        b=2,"));
+  CPPUNIT_ASSERT(b._named_blocks.at(2).second.data() < contents.data() ||
+                 b._named_blocks.at(2).second.data() >= contents.data() + contents.size());
+  CPPUNIT_ASSERT(arena->allocation_count() == 2u);
+  // copies share the arena, so views remain valid after the original is gone
+  rule_block *original = new rule_block(b);
+  rule_block copy(*original);
+  delete original;
+  arena.reset();
+  CPPUNIT_ASSERT(!copy._named_blocks.at(2).second.compare("\n        a=1,\n        b=2,"));
+}
 void snakemake_unit_tests::rule_blockTest::test_rule_block_set_rule_name() {
   rule_block b;
   b.set_rule_name("dothething");
@@ -322,10 +356,58 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_print_contents() {
       "  shell:\n          'cat {input} > {output}'\n";
   CPPUNIT_ASSERT(!o4.str().compare(expected));
 }
+void snakemake_unit_tests::rule_blockTest::test_rule_block_render_contents() {
+  // same formatting as print_contents, appended to existing content
+  rule_block b;
+  b._rule_name = "myrulename";
+  b._rule_is_checkpoint = true;
+  b._named_blocks.push_back(std::make_pair("default_target", " True"));
+  b._named_blocks.push_back(std::make_pair("output", " 'filename3',"));
+  std::string target = "prefix\n";
+  b.render_contents(&target);
+  // default_target is never reported
+  CPPUNIT_ASSERT(!target.compare("prefix\ncheckpoint myrulename:\n    output: 'filename3',\n\n\n"));
+  std::ostringstream o;
+  b.print_contents(o);
+  CPPUNIT_ASSERT(!o.str().compare(target.substr(7)));
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_render_contents_null_pointer() {
+  rule_block b;
+  b.render_contents(NULL);
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_render_placeholder() {
+  rule_block b;
+  b._rule_name = "myrulename";
+  b._local_indentation = 4;
+  std::string target;
+  b.render_placeholder(&target);
+  CPPUNIT_ASSERT(!target.compare("    pass\n\n\n"));
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_render() {
+  rule_block b;
+  CPPUNIT_ASSERT(!b.rendered());
+  b._rule_name = "myrulename";
+  b._local_indentation = 2;
+  b.render();
+  CPPUNIT_ASSERT(b.rendered());
+  CPPUNIT_ASSERT(!b.get_rendered_contents().compare("  rule myrulename:\n\n\n"));
+  CPPUNIT_ASSERT(!b.get_rendered_placeholder().compare("  pass\n\n\n"));
+  // copies share the rendered text
+  rule_block copy(b);
+  CPPUNIT_ASSERT(copy.rendered());
+  CPPUNIT_ASSERT(copy.get_rendered_contents().data() == b.get_rendered_contents().data());
+  // changing contents invalidates the rendering
+  b.set_checkpoint(true);
+  CPPUNIT_ASSERT(!b.rendered());
+  b.render();
+  CPPUNIT_ASSERT(!b.get_rendered_contents().compare("  checkpoint myrulename:\n\n\n"));
+  b.add_code_chunk("x = 1");
+  CPPUNIT_ASSERT(!b.rendered());
+}
 
 void snakemake_unit_tests::rule_blockTest::test_rule_block_get_code_chunk() {
   rule_block b;
-  std::vector<std::string> data, result;
+  std::vector<std::string_view> data, result;
   data.push_back("line1");
   data.push_back("line2");
   data.push_back("line3");
@@ -341,7 +423,7 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_get_code_chunk() {
 }
 void snakemake_unit_tests::rule_blockTest::test_rule_block_get_named_blocks() {
   rule_block b;
-  std::vector<std::pair<std::string, std::string> > result;
+  std::vector<std::pair<std::string_view, std::string_view> > result;
   b._named_blocks.push_back(std::make_pair("input", "  name1\n  name2"));
   b._named_blocks.push_back(std::make_pair("output", "  name3"));
   result = b.get_named_blocks();
@@ -363,7 +445,10 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_get_local_indentation
 }
 void snakemake_unit_tests::rule_blockTest::test_rule_block_add_code_chunk() {
   rule_block b;
+  CPPUNIT_ASSERT(!b._arena);
   b.add_code_chunk("  thing1;\n");
+  // blocks without a file get their own storage for injected code
+  CPPUNIT_ASSERT(b._arena);
   CPPUNIT_ASSERT(b._code_chunk.size() == 1);
   CPPUNIT_ASSERT(!b._code_chunk.at(0).compare("  thing1;\n"));
   b.add_code_chunk("  thing2;\n");
@@ -520,15 +605,15 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_report_python_logging
   b._code_chunk.clear();
   b._code_chunk.push_back("    include: \"myname.smk\"");
   CPPUNIT_ASSERT(b.report_python_logging_code(o2));
-  expected = "    print(\"tag22: {}\".format(\"myname.smk\"))\n";
+  expected = "    snakemake_unit_tests_report(22, \"myname.smk\")\n";
   CPPUNIT_ASSERT(!o2.str().compare(expected));
   b._resolution = RESOLVED_INCLUDED;
   CPPUNIT_ASSERT(!b.report_python_logging_code(o3));
-  expected = "    include: \"myname.smk\"\n    print(\"tag22: {}\".format(\"myname.smk\"))\n";
+  expected = "    include: \"myname.smk\"\n    snakemake_unit_tests_report(22, \"myname.smk\")\n";
   CPPUNIT_ASSERT(!o3.str().compare(expected));
   b._code_chunk.clear();
   CPPUNIT_ASSERT(!b.report_python_logging_code(o4));
-  expected = "  print(\"tag22\")\n\n\n";
+  expected = "  snakemake_unit_tests_report(22)\n\n\n";
   CPPUNIT_ASSERT(!o4.str().compare(expected));
   b._rule_name = "";
   CPPUNIT_ASSERT(!b.report_python_logging_code(o5));
@@ -538,6 +623,86 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_report_python_logging
       "  shell:\n          'cat {input} > {output}'\n";
   CPPUNIT_ASSERT(!o5.str().compare(expected));
 }
+void snakemake_unit_tests::rule_blockTest::test_rule_block_reportable_after_unresolved_include() {
+  /*
+    only blocks whose python equivalent is a bare tag report can follow
+    an unresolved include: rules, and includes of string literals that
+    are not yet included
+   */
+  rule_block b;
+  // metacontent blocks are snakemake directives
+  CPPUNIT_ASSERT(!b.reportable_after_unresolved_include());
+  b._rule_name = "myrule";
+  CPPUNIT_ASSERT(b.reportable_after_unresolved_include());
+  b._rule_name = "";
+  b._code_chunk.push_back("x = 1");
+  CPPUNIT_ASSERT(!b.reportable_after_unresolved_include());
+  b._code_chunk.front() = "include: \"rules/a.smk\"";
+  CPPUNIT_ASSERT(b.reportable_after_unresolved_include());
+  b._resolution = RESOLVED_EXCLUDED;
+  CPPUNIT_ASSERT(b.reportable_after_unresolved_include());
+  // an included file would be executed, and might need what came before
+  b._resolution = RESOLVED_INCLUDED;
+  CPPUNIT_ASSERT(!b.reportable_after_unresolved_include());
+  b._resolution = UNRESOLVED;
+  b._code_chunk.front() = "    include: 'rules/a.smk'";
+  CPPUNIT_ASSERT(b.reportable_after_unresolved_include());
+  b._code_chunk.front() = "include: config[\"rules\"]";
+  CPPUNIT_ASSERT(!b.reportable_after_unresolved_include());
+  b._code_chunk.front() = "include: f\"rules/{name}.smk\"";
+  CPPUNIT_ASSERT(!b.reportable_after_unresolved_include());
+  b._code_chunk.front() = "include: \"rules/\" + name + \".smk\"";
+  CPPUNIT_ASSERT(!b.reportable_after_unresolved_include());
+  b._code_chunk.front() = "include: \"rules/\\\"a.smk\"";
+  CPPUNIT_ASSERT(!b.reportable_after_unresolved_include());
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_resolvable_statically() {
+  rule_block b;
+  // snakemake directives and python code are always reported as-is
+  CPPUNIT_ASSERT(b.resolvable_statically());
+  b._code_chunk.push_back("if x:");
+  CPPUNIT_ASSERT(b.resolvable_statically());
+  // top level rules always run; nested ones depend on control flow
+  b._code_chunk.clear();
+  b._rule_name = "myrule";
+  CPPUNIT_ASSERT(b.resolvable_statically());
+  b._local_indentation = 4;
+  CPPUNIT_ASSERT(!b.resolvable_statically());
+  b._rule_name = "";
+  b._code_chunk.push_back("include: \"rules/a.smk\"");
+  CPPUNIT_ASSERT(b.resolvable_statically());
+  b._code_chunk.front() = "    include: \"rules/a.smk\"";
+  CPPUNIT_ASSERT(!b.resolvable_statically());
+  b._code_chunk.front() = "include: config[\"rules\"]";
+  CPPUNIT_ASSERT(!b.resolvable_statically());
+  b._code_chunk.front() = "include: f\"rules/{x}.smk\"";
+  CPPUNIT_ASSERT(!b.resolvable_statically());
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_resolve_statically() {
+  rule_block b;
+  b._code_chunk.push_back("include: 'rules/a.smk'");
+  b._python_tag = 3;
+  b.resolve_statically();
+  CPPUNIT_ASSERT(b.resolved());
+  CPPUNIT_ASSERT(b.included());
+  CPPUNIT_ASSERT_EQUAL(std::string("rules/a.smk"), b.get_resolved_included_filename().string());
+  // a python pass that did not reach the block leaves it alone
+  std::map<std::string, std::string> tag_values;
+  CPPUNIT_ASSERT(b.update_resolution(tag_values));
+  CPPUNIT_ASSERT(b.included());
+  b._code_chunk.clear();
+  b._rule_name = "myrule";
+  b._resolution = UNRESOLVED;
+  b._queried_by_python = false;
+  b.resolve_statically();
+  CPPUNIT_ASSERT(b.resolved());
+  CPPUNIT_ASSERT(b.included());
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_resolve_statically_dynamic() {
+  rule_block b;
+  b._code_chunk.push_back("include: config[\"rules\"]");
+  b.resolve_statically();
+}
 void snakemake_unit_tests::rule_blockTest::test_rule_block_update_resolution() {
   /*
     rule_block objects scan the results of a python logging pass and
@@ -592,6 +757,116 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_set_checkpoint() {
   b.set_checkpoint(false);
   CPPUNIT_ASSERT(!b._rule_is_checkpoint);
 }
+void snakemake_unit_tests::rule_blockTest::test_rule_block_write_cache_record() {
+  rule_block b;
+  b._rule_name = "rulename";
+  b._rule_is_checkpoint = true;
+  b._named_blocks.push_back(std::make_pair("input", " \"a\nb\","));
+  b._code_chunk.push_back("x = 1");
+  b._local_indentation = 4;
+  b._python_tag = 12;
+  std::ostringstream o;
+  b.write_cache_record(o);
+  std::string expected = "block 4 1 1 1\n8\nrulename\n0\n\n0\n\n5\ninput\n7\n \"a\nb\",\n5\nx = 1\n";
+  CPPUNIT_ASSERT_EQUAL(expected, o.str());
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_read_cache_record() {
+  rule_block b1, b2;
+  b1._rule_name = "rulename";
+  b1._base_rule_name = "baserulename";
+  b1._docstring = "\"\"\"docstring\"\"\"";
+  b1._named_blocks.push_back(std::make_pair("output", " \"out.txt\","));
+  b1._named_blocks.push_back(std::make_pair("shell", " \"echo\n\""));
+  b1._local_indentation = 8;
+  std::ostringstream o;
+  b1.write_cache_record(o);
+  b1.write_cache_record(o);
+  std::string record = o.str();
+  std::string_view remaining = record;
+  b2._python_tag = 5;
+  b2.read_cache_record(&remaining);
+  CPPUNIT_ASSERT(b1 == b2);
+  CPPUNIT_ASSERT(b2._docstring == b1._docstring);
+  CPPUNIT_ASSERT(b2._local_indentation == 8);
+  CPPUNIT_ASSERT(!b2._rule_is_checkpoint);
+  // run-specific state is left alone
+  CPPUNIT_ASSERT(b2._python_tag == 5);
+  // restored text is viewed in place
+  CPPUNIT_ASSERT(b2._named_blocks.at(1).second.data() > record.data());
+  CPPUNIT_ASSERT(b2._named_blocks.at(1).second.data() < record.data() + record.size());
+  // the second record follows immediately
+  CPPUNIT_ASSERT(remaining.size() == record.size() / 2);
+  b2.read_cache_record(&remaining);
+  CPPUNIT_ASSERT(remaining.empty());
+  CPPUNIT_ASSERT(b1 == b2);
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_read_cache_record_truncated() {
+  rule_block b;
+  std::string record = "block 0 0 1 0\n4\nrule\n0\n\n0\n\n5\ninput\n10\nshort\n";
+  std::string_view remaining = record;
+  b.read_cache_record(&remaining);
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_write_resolution_record() {
+  rule_block b;
+  b._resolution = RESOLVED_EXCLUDED;
+  b._queried_by_python = true;
+  b._resolved_included_filename = "rules/file.smk";
+  std::ostringstream o;
+  b.write_resolution_record(o);
+  CPPUNIT_ASSERT_EQUAL(std::string("resolution 2 1\n14\nrules/file.smk\n"), o.str());
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_read_resolution_record() {
+  rule_block b1, b2;
+  b1._resolution = RESOLVED_INCLUDED;
+  b1._queried_by_python = true;
+  b1._resolved_included_filename = "rules/file.smk";
+  b1._rule_name = "rulename";
+  std::ostringstream o;
+  b1.write_resolution_record(o);
+  b1.write_resolution_record(o);
+  std::string record = o.str();
+  std::string_view remaining = record;
+  b2.read_resolution_record(&remaining);
+  CPPUNIT_ASSERT(b2._resolution == RESOLVED_INCLUDED);
+  CPPUNIT_ASSERT(b2._queried_by_python);
+  CPPUNIT_ASSERT(b2._resolved_included_filename == boost::filesystem::path("rules/file.smk"));
+  // parsed contents are left alone
+  CPPUNIT_ASSERT(b2._rule_name.empty());
+  CPPUNIT_ASSERT(remaining.size() == record.size() / 2);
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_read_resolution_record_invalid() {
+  rule_block b;
+  std::string record = "resolution 3 1\n0\n\n";
+  std::string_view remaining = record;
+  b.read_resolution_record(&remaining);
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_append_python_signature() {
+  rule_block rule1, rule2, code1, code2, directives;
+  rule1._rule_name = "rule1";
+  rule1._named_blocks.push_back(std::make_pair("output", " \"a.txt\","));
+  rule2._rule_name = "rule2";
+  rule2._named_blocks.push_back(std::make_pair("output", " \"b.txt\","));
+  code1._code_chunk.push_back("x = 1");
+  code2._code_chunk.push_back("x = 2");
+  directives._named_blocks.push_back(std::make_pair("configfile", " \"config.yaml\""));
+  std::string s1, s2, s3, s4;
+  // rule bodies do not reach python, but their indentation does
+  rule1.append_python_signature(&s1);
+  rule2.append_python_signature(&s2);
+  CPPUNIT_ASSERT(!s1.compare(s2));
+  rule2._local_indentation = 4;
+  s2.clear();
+  rule2.append_python_signature(&s2);
+  CPPUNIT_ASSERT(s1.compare(s2));
+  code1.append_python_signature(&s3);
+  code2.append_python_signature(&s4);
+  CPPUNIT_ASSERT(s3.compare(s4));
+  CPPUNIT_ASSERT(s1.compare(s3));
+  // appended, not replaced
+  directives.append_python_signature(&s3);
+  CPPUNIT_ASSERT(s3.find("configfile") != std::string::npos);
+  CPPUNIT_ASSERT(!s3.find("code"));
+}
 void snakemake_unit_tests::rule_blockTest::test_rule_block_indentation() {
   rule_block b;
   CPPUNIT_ASSERT(!b.indentation(10u).compare("          "));
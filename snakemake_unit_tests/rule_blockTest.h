@@ -17,6 +17,7 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -32,6 +33,7 @@ class rule_blockTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_rule_block_load_content_block);
   CPPUNIT_TEST_EXCEPTION(test_rule_block_load_content_block_null_pointer, std::runtime_error);
   CPPUNIT_TEST_EXCEPTION(test_rule_block_consume_rule_contents_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_rule_block_set_arena);
   CPPUNIT_TEST(test_rule_block_set_rule_name);
   CPPUNIT_TEST(test_rule_block_get_rule_name);
   CPPUNIT_TEST(test_rule_block_set_base_rule_name);
@@ -40,6 +42,10 @@ class rule_blockTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_EXCEPTION(test_rule_block_get_filename_expression_invalid_statement, std::runtime_error);
   CPPUNIT_TEST(test_rule_block_get_filename_expression);
   CPPUNIT_TEST(test_rule_block_print_contents);
+  CPPUNIT_TEST(test_rule_block_render_contents);
+  CPPUNIT_TEST_EXCEPTION(test_rule_block_render_contents_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_rule_block_render_placeholder);
+  CPPUNIT_TEST(test_rule_block_render);
   CPPUNIT_TEST(test_rule_block_get_code_chunk);
   CPPUNIT_TEST(test_rule_block_get_named_blocks);
   CPPUNIT_TEST(test_rule_block_get_local_indentation);
@@ -53,10 +59,21 @@ class rule_blockTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_rule_block_set_interpreter_tag);
   CPPUNIT_TEST(test_rule_block_get_interpreter_tag);
   CPPUNIT_TEST(test_rule_block_report_python_logging_code);
+  CPPUNIT_TEST(test_rule_block_reportable_after_unresolved_include);
+  CPPUNIT_TEST(test_rule_block_resolvable_statically);
+  CPPUNIT_TEST(test_rule_block_resolve_statically);
+  CPPUNIT_TEST_EXCEPTION(test_rule_block_resolve_statically_dynamic, std::logic_error);
   CPPUNIT_TEST(test_rule_block_update_resolution);
   CPPUNIT_TEST(test_rule_block_get_resolved_included_filename);
   CPPUNIT_TEST(test_rule_block_is_checkpoint);
   CPPUNIT_TEST(test_rule_block_set_checkpoint);
+  CPPUNIT_TEST(test_rule_block_write_cache_record);
+  CPPUNIT_TEST(test_rule_block_read_cache_record);
+  CPPUNIT_TEST_EXCEPTION(test_rule_block_read_cache_record_truncated, std::runtime_error);
+  CPPUNIT_TEST(test_rule_block_write_resolution_record);
+  CPPUNIT_TEST(test_rule_block_read_resolution_record);
+  CPPUNIT_TEST_EXCEPTION(test_rule_block_read_resolution_record_invalid, std::runtime_error);
+  CPPUNIT_TEST(test_rule_block_append_python_signature);
   CPPUNIT_TEST(test_rule_block_indentation);
   CPPUNIT_TEST(test_rule_block_apply_indentation);
   CPPUNIT_TEST(test_rule_block_clear);
@@ -72,6 +89,7 @@ class rule_blockTest : public CppUnit::TestFixture {
   void test_rule_block_load_content_block();
   void test_rule_block_load_content_block_null_pointer();
   void test_rule_block_consume_rule_contents_null_pointer();
+  void test_rule_block_set_arena();
   void test_rule_block_set_rule_name();
   void test_rule_block_get_rule_name();
   void test_rule_block_set_base_rule_name();
@@ -80,6 +98,10 @@ class rule_blockTest : public CppUnit::TestFixture {
   void test_rule_block_get_filename_expression();
   void test_rule_block_get_filename_expression_invalid_statement();
   void test_rule_block_print_contents();
+  void test_rule_block_render_contents();
+  void test_rule_block_render_contents_null_pointer();
+  void test_rule_block_render_placeholder();
+  void test_rule_block_render();
   void test_rule_block_get_code_chunk();
   void test_rule_block_get_named_blocks();
   void test_rule_block_get_local_indentation();
@@ -93,16 +115,27 @@ class rule_blockTest : public CppUnit::TestFixture {
   void test_rule_block_set_interpreter_tag();
   void test_rule_block_get_interpreter_tag();
   void test_rule_block_report_python_logging_code();
+  void test_rule_block_reportable_after_unresolved_include();
+  void test_rule_block_resolvable_statically();
+  void test_rule_block_resolve_statically();
+  void test_rule_block_resolve_statically_dynamic();
   void test_rule_block_update_resolution();
   void test_rule_block_get_resolved_included_filename();
   void test_rule_block_is_checkpoint();
   void test_rule_block_set_checkpoint();
+  void test_rule_block_write_cache_record();
+  void test_rule_block_read_cache_record();
+  void test_rule_block_read_cache_record_truncated();
+  void test_rule_block_write_resolution_record();
+  void test_rule_block_read_resolution_record();
+  void test_rule_block_read_resolution_record_invalid();
+  void test_rule_block_append_python_signature();
   void test_rule_block_indentation();
   void test_rule_block_apply_indentation();
   void test_rule_block_clear();
 
  private:
-  std::vector<std::string> _snakefile_lines;
+  std::vector<std::string_view> _snakefile_lines;
 };
 }  // namespace snakemake_unit_tests
 
@@ -0,0 +1,90 @@
+/*!
+  @file rule_registry.cc
+  @brief implementation of rule_registry class
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/rule_registry.h"
+
+#include "snakemake_unit_tests/snakemake_file.h"
+
+snakemake_unit_tests::rule_registry::rule_registry(const snakemake_file &sf) { index(sf); }
+
+void snakemake_unit_tests::rule_registry::index(const snakemake_file &sf) {
+  // same order as snakemake_file::get_base_rule_name: this file's blocks, then its includes
+  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = sf.get_blocks().begin();
+       iter != sf.get_blocks().end(); ++iter) {
+    if (!(*iter)->included() || (*iter)->get_rule_name().empty()) continue;
+    unsigned id = intern((*iter)->get_rule_name());
+    _block_ids[iter->get()] = id;
+    if (!_blocks.at(id)) {
+      _blocks.at(id) = iter->get();
+      _owners.at(id) = &sf;
+      if (!(*iter)->get_base_rule_name().empty()) {
+        // interning may reallocate, so look the base up before storing it
+        unsigned base = intern((*iter)->get_base_rule_name());
+        _bases.at(id) = base;
+      }
+    }
+  }
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator iter =
+           sf.loaded_files().begin();
+       iter != sf.loaded_files().end(); ++iter) {
+    index(*iter->second);
+  }
+}
+
+unsigned snakemake_unit_tests::rule_registry::intern(const std::string &name) {
+  std::unordered_map<std::string, unsigned>::const_iterator finder = _ids.find(name);
+  if (finder != _ids.end()) return finder->second;
+  unsigned id = _names.size();
+  _ids[name] = id;
+  _names.push_back(name);
+  _blocks.push_back(NULL);
+  _owners.push_back(NULL);
+  _bases.push_back(id);
+  return id;
+}
+
+bool snakemake_unit_tests::rule_registry::find(const std::string &name, unsigned *id) const {
+  if (!id) throw std::runtime_error("null pointer provided to rule_registry::find");
+  std::unordered_map<std::string, unsigned>::const_iterator finder = _ids.find(name);
+  if (finder == _ids.end()) return false;
+  *id = finder->second;
+  return true;
+}
+
+bool snakemake_unit_tests::rule_registry::find(const rule_block *block, unsigned *id) const {
+  if (!id) throw std::runtime_error("null pointer provided to rule_registry::find");
+  std::unordered_map<const rule_block *, unsigned>::const_iterator finder = _block_ids.find(block);
+  if (finder == _block_ids.end()) return false;
+  *id = finder->second;
+  return true;
+}
+
+bool snakemake_unit_tests::rule_registry::get_base_rule(unsigned id, unsigned *base) const {
+  if (!base) throw std::runtime_error("null pointer provided to rule_registry::get_base_rule");
+  if (_bases.at(id) == id) return false;
+  *base = _bases.at(id);
+  return true;
+}
+
+snakemake_unit_tests::rule_set snakemake_unit_tests::rule_registry::select(
+    const std::map<std::string, bool> &include_rules, const std::map<std::string, bool> &exclude_rules) const {
+  rule_set res = empty_set();
+  unsigned id = 0;
+  if (include_rules.empty()) {
+    res.set();
+  } else {
+    for (std::map<std::string, bool>::const_iterator iter = include_rules.begin(); iter != include_rules.end();
+         ++iter) {
+      if (find(iter->first, &id)) res.set(id);
+    }
+  }
+  for (std::map<std::string, bool>::const_iterator iter = exclude_rules.begin(); iter != exclude_rules.end(); ++iter) {
+    if (find(iter->first, &id)) res.reset(id);
+  }
+  return res;
+}
@@ -0,0 +1,153 @@
+/*!
+  @file rule_registry.h
+  @brief dense integer identifiers for rule names, and an index from
+  identifier to defining block
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  test emission repeatedly asks the same questions of every loaded rule:
+  is it selected, is it a dependency of the current test, what is its base
+  rule. the registry answers each in constant time, and sets of rules are
+  bitsets over identifiers.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_RULE_REGISTRY_H_
+#define SNAKEMAKE_UNIT_TESTS_RULE_REGISTRY_H_
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "boost/dynamic_bitset.hpp"
+
+namespace snakemake_unit_tests {
+class rule_block;
+class snakemake_file;
+/*!
+  @brief a set of rules, as a bitset over registry identifiers
+ */
+typedef boost::dynamic_bitset<> rule_set;
+/*!
+  @class rule_registry
+  @brief assign every rule name a dense identifier
+ */
+class rule_registry {
+ public:
+  /*!
+    @brief constructor
+   */
+  rule_registry() {}
+  /*!
+    @brief constructor: index a snakefile and everything it includes
+    @param sf top-level snakefile, after python resolution
+   */
+  explicit rule_registry(const snakemake_file &sf);
+  /*!
+    @brief destructor
+   */
+  ~rule_registry() throw() {}
+  /*!
+    @brief register the rules defined in a snakefile and everything it includes
+    @param sf snakefile to index
+
+    only blocks that are included after python resolution are registered.
+    if a rule is defined more than once, the first definition found
+    is indexed, matching snakemake_file::get_base_rule_name
+   */
+  void index(const snakemake_file &sf);
+  /*!
+    @brief get the identifier for a rule name, registering it if needed
+    @param name name of rule
+    @return identifier of rule
+
+    rules known only from the log, or from configuration, get identifiers
+    without a defining block
+   */
+  unsigned intern(const std::string &name);
+  /*!
+    @brief look up the identifier for a rule name
+    @param name name of rule
+    @param id where to store the identifier, if found
+    @return whether the name is registered
+   */
+  bool find(const std::string &name, unsigned *id) const;
+  /*!
+    @brief look up the identifier of the rule a block defines
+    @param block loaded block
+    @param id where to store the identifier, if found
+    @return whether the block defines a registered rule
+   */
+  bool find(const rule_block *block, unsigned *id) const;
+  /*!
+    @brief get the name of a rule
+    @param id identifier of rule
+    @return name of rule
+   */
+  const std::string &get_name(unsigned id) const { return _names.at(id); }
+  /*!
+    @brief get the block that defines a rule
+    @param id identifier of rule
+    @return defining block, or null if no loaded snakefile defines the rule
+   */
+  const rule_block *get_block(unsigned id) const { return _blocks.at(id); }
+  /*!
+    @brief get the snakefile that defines a rule
+    @param id identifier of rule
+    @return defining snakefile, or null if no loaded snakefile defines the rule
+   */
+  const snakemake_file *get_owner(unsigned id) const { return _owners.at(id); }
+  /*!
+    @brief get the base rule of a derived rule
+    @param id identifier of rule
+    @param base where to store the identifier of the base rule
+    @return whether the rule is defined and derived from another rule
+   */
+  bool get_base_rule(unsigned id, unsigned *base) const;
+  /*!
+    @brief get the number of registered rules
+    @return the number of registered rules
+   */
+  unsigned size() const { return _names.size(); }
+  /*!
+    @brief create an empty set sized for every registered rule
+    @return empty rule set
+   */
+  rule_set empty_set() const { return rule_set(size()); }
+  /*!
+    @brief compute the rules selected by configuration
+    @param include_rules rules to include; empty means all rules
+    @param exclude_rules rules to skip
+    @return set of every registered rule that is not excluded and,
+    if any are listed, is included
+   */
+  rule_set select(const std::map<std::string, bool> &include_rules,
+                  const std::map<std::string, bool> &exclude_rules) const;
+  /*!
+    @brief test set membership, treating rules registered after the set was made as absent
+    @param rules rule set
+    @param id identifier of rule
+    @return whether the rule is in the set
+   */
+  static bool contains(const rule_set &rules, unsigned id) { return id < rules.size() && rules.test(id); }
+
+ private:
+  friend class rule_registryTest;
+  /*!
+    @brief copy constructor
+    @param obj existing rule_registry object
+    @warning disabled: registries are built once and passed by reference
+   */
+  rule_registry(const rule_registry &obj) { throw std::domain_error("rule_registry: do not use copy constructor"); }
+  std::unordered_map<std::string, unsigned> _ids;              //!< name -> identifier
+  std::unordered_map<const rule_block *, unsigned> _block_ids;  //!< defining block -> identifier
+  std::vector<std::string> _names;                              //!< identifier -> name
+  std::vector<const rule_block *> _blocks;                      //!< identifier -> first defining block
+  std::vector<const snakemake_file *> _owners;                  //!< identifier -> file of first defining block
+  std::vector<unsigned> _bases;                                 //!< identifier -> base rule, or itself if none
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_RULE_REGISTRY_H_
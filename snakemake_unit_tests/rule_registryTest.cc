@@ -0,0 +1,173 @@
+/*!
+  \file rule_registryTest.cc
+  \brief implementation of rule_registry unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/rule_registryTest.h"
+
+void snakemake_unit_tests::rule_registryTest::setUp() {}
+
+void snakemake_unit_tests::rule_registryTest::tearDown() {}
+
+boost::shared_ptr<snakemake_unit_tests::rule_block> snakemake_unit_tests::rule_registryTest::make_block(
+    const std::string &rule_name, bool included) const {
+  boost::shared_ptr<rule_block> b(new rule_block);
+  b->_rule_name = rule_name;
+  b->_queried_by_python = true;
+  b->_resolution = included ? RESOLVED_INCLUDED : RESOLVED_EXCLUDED;
+  return b;
+}
+
+boost::shared_ptr<snakemake_unit_tests::snakemake_file> snakemake_unit_tests::rule_registryTest::make_snakefile()
+    const {
+  boost::shared_ptr<snakemake_file> sf1(new snakemake_file), sf2(new snakemake_file);
+  sf1->_blocks.push_back(make_block("a", true));
+  sf1->_blocks.push_back(make_block("b", false));
+  sf1->_blocks.push_back(make_block("", true));
+  sf2->_blocks.push_back(make_block("b", true));
+  sf2->_blocks.push_back(make_block("c", true));
+  sf2->_blocks.back()->_base_rule_name = "a";
+  sf2->_blocks.push_back(make_block("a", true));
+  sf1->_included_files["rules/file2.smk"] = sf2;
+  return sf1;
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_default_constructor() {
+  rule_registry r;
+  CPPUNIT_ASSERT(!r.size());
+  CPPUNIT_ASSERT(r._ids.empty());
+  CPPUNIT_ASSERT(r._block_ids.empty());
+  CPPUNIT_ASSERT(!r.empty_set().size());
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_snakefile_constructor() {
+  boost::shared_ptr<snakemake_file> sf = make_snakefile();
+  rule_registry r(*sf);
+  CPPUNIT_ASSERT(r.size() == 3);
+  CPPUNIT_ASSERT(r.empty_set().size() == 3);
+  CPPUNIT_ASSERT(r.empty_set().none());
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_index() {
+  boost::shared_ptr<snakemake_file> sf = make_snakefile();
+  const snakemake_file &sf2 = *sf->loaded_files().begin()->second;
+  rule_registry r;
+  r.index(*sf);
+  unsigned id = 0;
+  // first definitions win, and excluded blocks are skipped
+  CPPUNIT_ASSERT(r.find("a", &id));
+  CPPUNIT_ASSERT(r.get_block(id) == sf->get_blocks().front().get());
+  CPPUNIT_ASSERT(r.get_owner(id) == sf.get());
+  CPPUNIT_ASSERT(r.find("b", &id));
+  CPPUNIT_ASSERT(r.get_block(id) == sf2.get_blocks().front().get());
+  CPPUNIT_ASSERT(r.get_owner(id) == &sf2);
+  CPPUNIT_ASSERT(r.find("c", &id));
+  CPPUNIT_ASSERT(!r.get_name(id).compare("c"));
+  // every included named block is mapped, including redundant definitions
+  CPPUNIT_ASSERT(r._block_ids.size() == 4);
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_intern() {
+  rule_registry r;
+  CPPUNIT_ASSERT(!r.intern("x"));
+  CPPUNIT_ASSERT(r.intern("y") == 1);
+  CPPUNIT_ASSERT(!r.intern("x"));
+  CPPUNIT_ASSERT(r.size() == 2);
+  CPPUNIT_ASSERT(!r.get_block(1));
+  CPPUNIT_ASSERT(!r.get_owner(1));
+  unsigned base = 0;
+  CPPUNIT_ASSERT(!r.get_base_rule(1, &base));
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_find_name() {
+  rule_registry r;
+  r.intern("x");
+  unsigned id = 5;
+  CPPUNIT_ASSERT(r.find("x", &id));
+  CPPUNIT_ASSERT(!id);
+  id = 5;
+  CPPUNIT_ASSERT(!r.find("y", &id));
+  CPPUNIT_ASSERT(id == 5);
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_find_name_null_pointer() {
+  rule_registry r;
+  r.find("x", NULL);
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_find_block() {
+  boost::shared_ptr<snakemake_file> sf = make_snakefile();
+  const snakemake_file &sf2 = *sf->loaded_files().begin()->second;
+  rule_registry r(*sf);
+  unsigned id = 0, expected = 0;
+  CPPUNIT_ASSERT(r.find("a", &expected));
+  CPPUNIT_ASSERT(r.find(sf2.get_blocks().back().get(), &id));
+  CPPUNIT_ASSERT(id == expected);
+  // excluded blocks and python code are not registered
+  std::list<boost::shared_ptr<rule_block> >::const_iterator iter = sf->get_blocks().begin();
+  CPPUNIT_ASSERT(!r.find((++iter)->get(), &id));
+  CPPUNIT_ASSERT(!r.find((++iter)->get(), &id));
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_find_block_null_pointer() {
+  rule_registry r;
+  rule_block b;
+  r.find(&b, NULL);
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_get_base_rule() {
+  boost::shared_ptr<snakemake_file> sf = make_snakefile();
+  rule_registry r(*sf);
+  unsigned a = 0, c = 0, base = 0;
+  CPPUNIT_ASSERT(r.find("a", &a));
+  CPPUNIT_ASSERT(r.find("c", &c));
+  CPPUNIT_ASSERT(r.get_base_rule(c, &base));
+  CPPUNIT_ASSERT(base == a);
+  CPPUNIT_ASSERT(!r.get_base_rule(a, &base));
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_get_base_rule_null_pointer() {
+  rule_registry r;
+  r.intern("x");
+  r.get_base_rule(0, NULL);
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_select() {
+  boost::shared_ptr<snakemake_file> sf = make_snakefile();
+  rule_registry r(*sf);
+  unsigned a = 0, b = 0, c = 0;
+  r.find("a", &a);
+  r.find("b", &b);
+  r.find("c", &c);
+  std::map<std::string, bool> include_rules, exclude_rules;
+  // empty include list means everything
+  rule_set selected = r.select(include_rules, exclude_rules);
+  CPPUNIT_ASSERT(selected.count() == 3);
+  exclude_rules["b"] = true;
+  selected = r.select(include_rules, exclude_rules);
+  CPPUNIT_ASSERT(selected.count() == 2);
+  CPPUNIT_ASSERT(!selected.test(b));
+  // unknown names are ignored
+  include_rules["c"] = true;
+  include_rules["b"] = true;
+  include_rules["unknown"] = true;
+  selected = r.select(include_rules, exclude_rules);
+  CPPUNIT_ASSERT(selected.count() == 1);
+  CPPUNIT_ASSERT(selected.test(c));
+}
+
+void snakemake_unit_tests::rule_registryTest::test_rule_registry_contains() {
+  rule_registry r;
+  r.intern("x");
+  rule_set s = r.empty_set();
+  CPPUNIT_ASSERT(!rule_registry::contains(s, 0));
+  s.set(0);
+  CPPUNIT_ASSERT(rule_registry::contains(s, 0));
+  // rules registered after the set was made are absent
+  unsigned y = r.intern("y");
+  CPPUNIT_ASSERT(!rule_registry::contains(s, y));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::rule_registryTest);
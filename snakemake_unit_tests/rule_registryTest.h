@@ -0,0 +1,80 @@
+/*!
+  \file rule_registryTest.h
+  \brief rule_registry test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_RULE_REGISTRYTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_RULE_REGISTRYTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/rule_block.h"
+#include "snakemake_unit_tests/rule_registry.h"
+#include "snakemake_unit_tests/snakemake_file.h"
+
+namespace snakemake_unit_tests {
+class rule_registryTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(rule_registryTest);
+  CPPUNIT_TEST(test_rule_registry_default_constructor);
+  CPPUNIT_TEST(test_rule_registry_snakefile_constructor);
+  CPPUNIT_TEST(test_rule_registry_index);
+  CPPUNIT_TEST(test_rule_registry_intern);
+  CPPUNIT_TEST(test_rule_registry_find_name);
+  CPPUNIT_TEST_EXCEPTION(test_rule_registry_find_name_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_rule_registry_find_block);
+  CPPUNIT_TEST_EXCEPTION(test_rule_registry_find_block_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_rule_registry_get_base_rule);
+  CPPUNIT_TEST_EXCEPTION(test_rule_registry_get_base_rule_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_rule_registry_select);
+  CPPUNIT_TEST(test_rule_registry_contains);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_rule_registry_default_constructor();
+  void test_rule_registry_snakefile_constructor();
+  void test_rule_registry_index();
+  void test_rule_registry_intern();
+  void test_rule_registry_find_name();
+  void test_rule_registry_find_name_null_pointer();
+  void test_rule_registry_find_block();
+  void test_rule_registry_find_block_null_pointer();
+  void test_rule_registry_get_base_rule();
+  void test_rule_registry_get_base_rule_null_pointer();
+  void test_rule_registry_select();
+  void test_rule_registry_contains();
+
+ private:
+  /*!
+    @brief build a top-level snakefile with one include
+    @return top-level snakefile
+
+    the top level defines included rule "a", excluded rule "b", and
+    python code; the include defines "b" again, "c" derived from "a",
+    and a second definition of "a"
+   */
+  boost::shared_ptr<snakemake_file> make_snakefile() const;
+  /*!
+    @brief make a resolved block
+    @param rule_name name of rule, or empty for python code
+    @param included whether python resolution kept the block
+    @return new block
+   */
+  boost::shared_ptr<rule_block> make_block(const std::string &rule_name, bool included) const;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_RULE_REGISTRYTEST_H_
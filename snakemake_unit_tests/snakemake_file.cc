@@ -8,6 +8,10 @@
 
 #include "snakemake_unit_tests/snakemake_file.h"
 
+// the interpreter reports tags on this descriptor, named in this environment variable
+#define PYTHON_TAG_FD "3"
+#define PYTHON_TAG_FD_VARIABLE "SNAKEMAKE_UNIT_TESTS_TAG_FD"
+
 /*
   The parser reimplementation is structured as follows:
 
@@ -32,7 +36,8 @@
   ---- their locations in file are replaced with tracking statements
   ---- python code unrelated to snakemake or include directives is included
   as-is
-  -- run the python code, capture the screen output
+  -- run the python code, capture the tags it reports on a dedicated
+  file descriptor (see decode_python_tag_records)
   -- inspect queue of unresolved rules and include directives
   ---- if the next entry is a rule, determine whether the rule was evaluated and
   resolve, pop, continue
@@ -47,22 +52,84 @@
   Assorted comments:
   - the above logic is incredibly conservative, and designed to handle some
   additional issues not enumerated above (include directives on variables).
-  - the logic can be loosened for some types of includes that can be handled in
-  one pass, avoiding additional iterations of python evaluation. most notably,
-  include directives at the same depth with no intervening python code, and
-  0-depth includes in the currently parsed file.
+  - the logic is loosened for includes that can be handled in one pass,
+  avoiding additional iterations of python evaluation: after an unresolved
+  include, reporting continues through rules and include directives on
+  string literals, so consecutive includes with no intervening python code
+  are resolved together. reporting still stops at the first other block.
+  - 0-depth rules and include directives on string literals are resolved
+  before any python pass (see resolve_statically), up to the first include
+  in each file that python must evaluate.
 
  */
 
 void snakemake_unit_tests::snakemake_file::load_everything(const boost::filesystem::path &filename,
                                                            const boost::filesystem::path &base_dir, bool verbose) {
-  _snakefile_relative_path = filename;
-  std::vector<std::string> loaded_lines;
-  boost::filesystem::path recursive_path = base_dir / filename;
-  load_lines(recursive_path, &loaded_lines);
+  load_blocks(base_dir / filename, filename, verbose);
+  assign_interpreter_tags();
+}
+
+void snakemake_unit_tests::snakemake_file::load_blocks(const boost::filesystem::path &filename,
+                                                       const boost::filesystem::path &relative_path, bool verbose) {
+  _snakefile_relative_path = relative_path;
+  std::string loaded_buffer, cache_key;
+  load_buffer(filename, &loaded_buffer);
+  if (_parse_cache) {
+    // an unchanged file is restored from the cache instead, and its source is not kept
+    std::string payload;
+    cache_key = _parse_cache->key(loaded_buffer);
+    if (_parse_cache->find(cache_key, &payload) && restore_blocks(_arena->adopt(&payload))) {
+      if (verbose) std::cout << "\t\t\trestored cached parse of " << filename.string() << std::endl;
+      return;
+    }
+  }
+  // the arena owns the file contents from here on; lines and blocks are views into it
+  std::string_view contents = _arena->adopt(&loaded_buffer);
   // new: preprocess all lines with the improved lexical parser
-  loaded_lines = lexical_parse(loaded_lines);
-  parse_file(loaded_lines, filename, verbose);
+  std::vector<std::string_view> loaded_lines = lexical_parse(contents.data(), contents.size(), _arena.get(), verbose);
+  if (verbose) std::cout << "\t\t\tlexical parse successful" << std::endl;
+  parse_blocks(loaded_lines, relative_path, verbose);
+  if (_parse_cache) _parse_cache->store(cache_key, serialize_blocks());
+}
+
+std::string snakemake_unit_tests::snakemake_file::serialize_blocks() const {
+  std::ostringstream out;
+  out << _blocks.size() << '\n';
+  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+       ++iter) {
+    (*iter)->write_cache_record(out);
+  }
+  return out.str();
+}
+
+bool snakemake_unit_tests::snakemake_file::restore_blocks(std::string_view payload) {
+  std::string_view::size_type count_end = payload.find('\n');
+  if (!count_end || count_end == std::string_view::npos ||
+      payload.substr(0, count_end).find_first_not_of("0123456789") != std::string_view::npos || count_end > 9)
+    return false;
+  unsigned n_blocks = std::stoul(std::string(payload.substr(0, count_end)));
+  payload.remove_prefix(count_end + 1);
+  std::list<boost::shared_ptr<rule_block> > restored;
+  try {
+    for (unsigned i = 0; i < n_blocks; ++i) {
+      rule_block *block = _block_pool->allocate();
+      block->set_arena(_arena);
+      restored.push_back(boost::shared_ptr<rule_block>(_block_pool, block));
+      block->read_cache_record(&payload);
+      // resolution status is derived exactly as in parse_blocks
+      block->set_resolution(!block->get_rule_name().empty() || block->contains_include_directive() ? UNRESOLVED
+                                                                                                   : RESOLVED_INCLUDED);
+    }
+    if (!payload.empty()) throw std::runtime_error("trailing data in parse cache payload");
+  } catch (const std::runtime_error &) {
+    // discard the partial restore, leaving the pool as it was
+    for (; !restored.empty(); restored.pop_back()) {
+      _block_pool->release_last();
+    }
+    return false;
+  }
+  _blocks.splice(_blocks.end(), restored);
+  return true;
 }
 
 void snakemake_unit_tests::snakemake_file::postflight_checks(const std::map<std::string, bool> &include_rules,
@@ -156,57 +223,122 @@ void snakemake_unit_tests::snakemake_file::load_lines(const boost::filesystem::p
   }
 }
 
-void snakemake_unit_tests::snakemake_file::parse_file(const std::vector<std::string> &loaded_lines,
+void snakemake_unit_tests::snakemake_file::load_buffer(const boost::filesystem::path &filename,
+                                                       std::string *target) const {
+  if (!target) throw std::runtime_error("null pointer to load_buffer");
+  target->clear();
+  std::ifstream input;
+  try {
+    input.open(filename.string().c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!input.is_open()) throw std::runtime_error("cannot open snakemake file \"" + filename.string() + "\"");
+    input.seekg(0, std::ios_base::end);
+    std::streamoff file_size = input.tellg();
+    input.seekg(0, std::ios_base::beg);
+    if (file_size > 0) {
+      target->resize(file_size);
+      if (!input.read(&(*target)[0], file_size))
+        throw std::runtime_error("cannot read snakemake file \"" + filename.string() + "\"");
+    }
+    input.close();
+  } catch (...) {
+    if (input.is_open()) input.close();
+    throw;
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::parse_file(const std::vector<std::string_view> &loaded_lines,
                                                       const boost::filesystem::path &filename, bool verbose) {
+  parse_blocks(loaded_lines, filename, verbose);
+  assign_interpreter_tags();
+}
+
+void snakemake_unit_tests::snakemake_file::parse_blocks(const std::vector<std::string_view> &loaded_lines,
+                                                        const boost::filesystem::path &filename, bool verbose) {
   _snakefile_relative_path = filename;
   // track current line
   unsigned current_line = 0;
   while (current_line < loaded_lines.size()) {
-    boost::shared_ptr<rule_block> rb(new rule_block);
+    // blocks live in this file's pool; the shared pointers keep the whole pool alive
+    rule_block *block = _block_pool->allocate();
+    block->set_arena(_arena);
+    boost::shared_ptr<rule_block> rb(_block_pool, block);
     if (rb->load_content_block(loaded_lines, verbose, &current_line)) {
       // set python interpreter resolution status
       // rules should all be set to unresolved before first pass
       // and ambiguous include directives need a complicated resolution pass
       if (!rb->get_rule_name().empty() || rb->contains_include_directive()) {
         rb->set_resolution(UNRESOLVED);
-        rb->set_interpreter_tag(*_tag_counter);
-        ++*_tag_counter;
       } else {
         // all other contents are good to go, to be handled by interpreter later
         rb->set_resolution(RESOLVED_INCLUDED);
       }
       _blocks.push_back(rb);
+    } else {
+      rb.reset();
+      _block_pool->release_last();
+    }
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::assign_interpreter_tags() {
+  // the counter is shared by every file in the pipeline, so this is never run concurrently
+  for (std::list<boost::shared_ptr<rule_block> >::iterator iter = _blocks.begin(); iter != _blocks.end(); ++iter) {
+    if (!(*iter)->get_rule_name().empty() || (*iter)->contains_include_directive()) {
+      (*iter)->set_interpreter_tag(*_tag_counter);
+      ++*_tag_counter;
     }
   }
 }
 
-unsigned snakemake_unit_tests::snakemake_file::report_single_rule(const std::map<std::string, bool> &rule_names,
-                                                                  std::ostream &out) const {
+unsigned snakemake_unit_tests::snakemake_file::report_single_rule(const rule_registry &registry, const rule_set &rules,
+                                                                  string_arena *scratch,
+                                                                  std::vector<std::string_view> *slices) const {
+  if (!slices) throw std::runtime_error("null pointer provided to report_single_rule");
   // find the requested rule
   unsigned found_rule_count = 0;
+  unsigned id = 0;
+  std::string formatted;
   for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = get_blocks().begin();
        iter != get_blocks().end(); ++iter) {
     // if this is the rule, that's great
     bool is_target = false;
-    // allow multiple targets
-    if (rule_names.find((*iter)->get_rule_name()) != rule_names.end() && (*iter)->included()) {
+    // allow multiple targets. only included blocks are registered
+    if (registry.find(iter->get(), &id) && rule_registry::contains(rules, id)) {
       is_target = true;
       ++found_rule_count;
     }
     // if this is the rule or if it's not a rule at all,
     // report it to the synthetic snakefile
     // new: respect rule's inclusion status
-    if ((is_target && (*iter)->included()) || (*iter)->get_rule_name().empty()) {
-      (*iter)->print_contents(out);
+    bool report_contents = (is_target && (*iter)->included()) || (*iter)->get_rule_name().empty();
+    if ((*iter)->rendered()) {
+      slices->push_back(report_contents ? (*iter)->get_rendered_contents() : (*iter)->get_rendered_placeholder());
+    } else if (scratch) {
+      formatted.clear();
+      if (report_contents) {
+        (*iter)->render_contents(&formatted);
+      } else {
+        (*iter)->render_placeholder(&formatted);
+      }
+      slices->push_back(scratch->store(formatted));
     } else {
-      for (unsigned i = 0; i < (*iter)->get_local_indentation(); ++i) out << ' ';
-      out << "pass" << std::endl << std::endl << std::endl;
+      throw std::logic_error("report_single_rule: block has not been rendered");
     }
   }
   // return number of the target rules found
   return found_rule_count;
 }
 
+void snakemake_unit_tests::snakemake_file::render_blocks() {
+  for (std::list<boost::shared_ptr<rule_block> >::iterator iter = _blocks.begin(); iter != _blocks.end(); ++iter) {
+    (*iter)->render();
+  }
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator iter = _included_files.begin();
+       iter != _included_files.end(); ++iter) {
+    iter->second->render_blocks();
+  }
+}
+
 bool snakemake_unit_tests::snakemake_file::fully_resolved() const {
   for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
        ++iter) {
@@ -232,7 +364,9 @@ bool snakemake_unit_tests::snakemake_file::contains_blockers() const {
 bool snakemake_unit_tests::snakemake_file::resolve_with_python(const boost::filesystem::path &workspace,
                                                                const boost::filesystem::path &pipeline_top_dir,
                                                                const boost::filesystem::path &pipeline_run_dir,
-                                                               bool verbose, bool disable_resolution) {
+                                                               bool verbose, bool disable_resolution,
+                                                               unsigned n_threads, bool parse_only,
+                                                               const std::string &inputs_key) {
   // if this is the top-level call
   if (!disable_resolution) {
     // set this file and all its dependencies to no update
@@ -254,35 +388,96 @@ bool snakemake_unit_tests::snakemake_file::resolve_with_python(const boost::file
   output.open(output_name.string().c_str());
   if (!output.is_open())
     throw std::runtime_error("cannot write interpreter snakefile to file \"" + output_name.string() + "\"");
+  // only from the top-level call: define the reporter before anything can use it
+  if (!disable_resolution) {
+    /*
+      each evaluated tag is written as it executes: 'r' and the tag for rules,
+      'i', the tag, and the length-prefixed value for include directives.
+      integers are 4 bytes, little endian. writing as they execute needs no
+      exit hook, which snakemake does not reliably run.
+     */
+    if (!(output << "import os as snakemake_unit_tests_os" << std::endl
+                 << "import struct as snakemake_unit_tests_struct" << std::endl
+                 << "snakemake_unit_tests_tag_fd = int(snakemake_unit_tests_os.environ[\"" PYTHON_TAG_FD_VARIABLE
+                    "\"])"
+                 << std::endl
+                 << "def snakemake_unit_tests_report(tag, *value):" << std::endl
+                 << "    if not value:" << std::endl
+                 << "        record = snakemake_unit_tests_struct.pack(\"<cI\", b\"r\", tag)" << std::endl
+                 << "    else:" << std::endl
+                 << "        encoded = \"{}\".format(value[0]).encode(\"utf-8\", \"surrogateescape\")" << std::endl
+                 << "        record = snakemake_unit_tests_struct.pack(\"<cII\", b\"i\", tag, len(encoded)) + encoded"
+                 << std::endl
+                 << "    snakemake_unit_tests_os.write(snakemake_unit_tests_tag_fd, record)" << std::endl
+                 << std::endl))
+      throw std::runtime_error("cannot write tag reporter to python reporter");
+  }
   // write python reporting code
   bool reporting_terminated = false;
+  std::vector<boost::filesystem::path> printed_includes;
   for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = get_blocks().begin();
-       iter != get_blocks().end() && !reporting_terminated; ++iter) {
+       iter != get_blocks().end(); ++iter) {
     // ask the rule to report the python equivalent of its contents
     /* new: disable logging reporting after the first include statement
 
        in some cases, downstream python logic may depend on what was loaded
        from the first (unresolved) include statement. that will cause
        the interpreter to crash, and make for all kinds of problems.
-       so for the moment, be conservative and only report until
-       immediately after the first unresolved include statement
-       is reported.
+       so only keep reporting past it while the following blocks are
+       rules and literal include directives, which print nothing but
+       their tags. a run of sibling includes is then resolved in one pass.
     */
+    if (reporting_terminated && !(*iter)->reportable_after_unresolved_include()) {
+      break;
+    }
     // true return value means the reporter hit an unresolved include
     if ((*iter)->report_python_logging_code(output)) {
       reporting_terminated = true;
     }
+    // resolved include directives are printed as they are; keyed exactly as collect_included_files would
+    if ((*iter)->contains_include_directive() && (*iter)->included()) {
+      printed_includes.push_back(pipeline_top_dir / get_snakefile_relative_path().parent_path() /
+                                 (*iter)->get_resolved_included_filename());
+    }
   }
-  // handle recursive reporters
-  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator iter = _included_files.begin();
-       iter != _included_files.end() && !reporting_terminated; ++iter) {
+  /* handle recursive reporters, in the order in which python includes them
+
+     once an included file stops reporting early, the files included
+     after it are written as empty stubs. their include statements have
+     already been printed, so the files must exist, but their code may
+     depend on what the truncated file would have loaded. a later pass
+     reports them in full.
+   */
+  bool sibling_terminated = false;
+  std::map<boost::filesystem::path, bool> reported;
+  for (std::vector<boost::filesystem::path>::const_iterator iter = printed_includes.begin();
+       iter != printed_includes.end() && !sibling_terminated; ++iter) {
+    std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator file_finder =
+        _included_files.find(*iter);
+    if (file_finder == _included_files.end() || reported.find(*iter) != reported.end()) continue;
+    reported[*iter] = true;
     if (verbose) {
       std::cout << "\trecursing in python resolution" << std::endl;
     }
-    if (iter->second->resolve_with_python(workspace, pipeline_top_dir, pipeline_run_dir, verbose, true)) {
-      reporting_terminated = true;
+    sibling_terminated = file_finder->second->resolve_with_python(workspace, pipeline_top_dir, pipeline_run_dir,
+                                                                  verbose, true, n_threads, parse_only, inputs_key);
+  }
+  // files that python does not reach through a printed include this pass are written in full,
+  // unless a sibling stopped early
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator iter = _included_files.begin();
+       iter != _included_files.end(); ++iter) {
+    if (reported.find(iter->first) != reported.end()) continue;
+    if (sibling_terminated) {
+      iter->second->write_interpreter_stubs(workspace);
+    } else {
+      if (verbose) {
+        std::cout << "\trecursing in python resolution" << std::endl;
+      }
+      sibling_terminated = iter->second->resolve_with_python(workspace, pipeline_top_dir, pipeline_run_dir, verbose,
+                                                             true, n_threads, parse_only, inputs_key);
     }
   }
+  if (sibling_terminated) reporting_terminated = true;
   // only from the top-level call, so not during recursion
   if (!disable_resolution) {
     if (!(output << "rule tmp:" << std::endl << "    output: \"tmp.txt\"," << std::endl))
@@ -292,16 +487,41 @@ bool snakemake_unit_tests::snakemake_file::resolve_with_python(const boost::file
     boost::filesystem::path complete_snakefile_loc =
         boost::filesystem::canonical(pipeline_top_dir / get_snakefile_relative_path());
     std::string adjusted_snakefile = complete_snakefile_loc.string().substr(complete_run_directory.string().size() + 1);
-    // execute python script and capture output
-    if (verbose) {
-      std::cout << "\texecuting snakemake" << std::endl;
+    // a pass that python has already seen, with the same inputs, reports the same tags
+    std::string pass_key;
+    if (_parse_cache && !inputs_key.empty()) {
+      if (!output.flush())
+        throw std::runtime_error("cannot write interpreter snakefile \"" + output_name.string() + "\"");
+      std::ostringstream description;
+      write_cache_string(description, inputs_key);
+      write_cache_string(description, pipeline_run_dir.string());
+      describe_interpreter_files(workspace, description);
+      pass_key = "pass-" + _parse_cache->key(description.str());
+      _pass_keys.push_back(pass_key);
     }
-    std::vector<std::string> results =
-        exec("cd " + (workspace / pipeline_run_dir).string() + " && snakemake -nFs " + adjusted_snakefile, true);
-    // capture the resulting tags for updating completion status
     std::map<std::string, std::string> tag_values;
-    capture_python_tag_values(results, &tag_values);
-    process_python_results(workspace, pipeline_top_dir, verbose, tag_values, output_name);
+    if (!pass_key.empty() && restore_tag_values(pass_key, &tag_values)) {
+      if (verbose) std::cout << "\treused the report of an identical python pass" << std::endl;
+    } else {
+      // execute python script and capture output
+      if (verbose) {
+        std::cout << "\texecuting snakemake" << std::endl;
+      }
+      // listing rules evaluates every snakefile, reporting the tags, but stops before the DAG is built.
+      // screen output is only kept, bounded, for error logging; the tags arrive on their own descriptor
+      boost::filesystem::path tag_report = boost::filesystem::absolute(workspace / ".tag_report");
+      exec_streaming(
+          "cd " + (workspace / pipeline_run_dir).string() + " && " PYTHON_TAG_FD_VARIABLE "=" PYTHON_TAG_FD
+          " snakemake " + (parse_only ? "--list" : "-nF") + " -s " + adjusted_snakefile + " " PYTHON_TAG_FD ">" +
+              tag_report.string(),
+          [](const std::string &) { return true; }, true);
+      // decode the resulting tags for updating completion status
+      std::string records;
+      load_buffer(tag_report, &records);
+      decode_python_tag_records(records, &tag_values);
+      if (!pass_key.empty()) store_tag_values(pass_key, tag_values);
+    }
+    process_python_results(workspace, pipeline_top_dir, verbose, tag_values, output_name, n_threads);
   }
   output.close();
   if (verbose) {
@@ -314,8 +534,55 @@ bool snakemake_unit_tests::snakemake_file::process_python_results(const boost::f
                                                                   const boost::filesystem::path &pipeline_top_dir,
                                                                   bool verbose,
                                                                   const std::map<std::string, std::string> &tag_values,
-                                                                  const boost::filesystem::path &output_name) {
-  std::vector<std::string> loaded_lines;
+                                                                  const boost::filesystem::path &output_name,
+                                                                  unsigned n_threads) {
+  std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path> > discovered;
+  collect_included_files(workspace, pipeline_top_dir, verbose, tag_values, output_name, &discovered);
+  load_included_files(discovered, n_threads, verbose);
+  return !discovered.empty();
+}
+
+void snakemake_unit_tests::snakemake_file::load_included_files(
+    const std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path> > &discovered,
+    unsigned n_threads, bool verbose) {
+  if (discovered.empty()) return;
+  // new files are independent of one another until tags are assigned
+  unsigned n_workers = n_threads ? n_threads : std::thread::hardware_concurrency();
+  if (n_workers > discovered.size()) n_workers = discovered.size();
+  if (n_workers > 1 && !verbose) {
+    thread_pool pool(n_workers);
+    for (std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path> >::const_iterator iter =
+             discovered.begin();
+         iter != discovered.end(); ++iter) {
+      snakemake_file *target = iter->first.get();
+      boost::filesystem::path filename = iter->second;
+      boost::filesystem::path relative_path = target->get_snakefile_relative_path();
+      pool.submit([target, filename, relative_path]() { target->load_blocks(filename, relative_path, false); });
+    }
+    pool.wait();
+  } else {
+    for (std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path> >::const_iterator iter =
+             discovered.begin();
+         iter != discovered.end(); ++iter) {
+      if (verbose)
+        std::cout << "\t\tthe file has not been loaded before, loading it now: " << iter->second.string() << std::endl;
+      boost::filesystem::path relative_path = iter->first->get_snakefile_relative_path();
+      iter->first->load_blocks(iter->second, relative_path, verbose);
+    }
+  }
+  // tags are handed out in discovery order, exactly as a serial load would
+  for (std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path> >::const_iterator iter =
+           discovered.begin();
+       iter != discovered.end(); ++iter) {
+    iter->first->assign_interpreter_tags();
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::collect_included_files(
+    const boost::filesystem::path &workspace, const boost::filesystem::path &pipeline_top_dir, bool verbose,
+    const std::map<std::string, std::string> &tag_values, const boost::filesystem::path &output_name,
+    std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path> > *discovered) {
+  if (!discovered) throw std::runtime_error("null pointer provided to collect_included_files");
   // update rule block status based on python report
   for (std::list<boost::shared_ptr<rule_block> >::iterator iter = _blocks.begin(); iter != _blocks.end(); ++iter) {
     // if the block reports that it was an include directive
@@ -345,7 +612,8 @@ bool snakemake_unit_tests::snakemake_file::process_python_results(const boost::f
                     << "\" was already loaded, passing python "
                        "results along to it"
                     << std::endl;
-        file_finder->second->process_python_results(workspace, pipeline_top_dir, verbose, tag_values, recursive_path);
+        file_finder->second->collect_included_files(workspace, pipeline_top_dir, verbose, tag_values, recursive_path,
+                                                    discovered);
       } else {
         if (verbose) {
           std::cout << "cannot find tag " << boost::filesystem::path(input_name) << " in already included files"
@@ -366,39 +634,336 @@ bool snakemake_unit_tests::snakemake_file::process_python_results(const boost::f
                     << std::endl
                     << "\t\tresolved inclusion: \"" << (*iter)->get_resolved_included_filename() << "\"" << std::endl;
         }
-        load_lines(input_name, &loaded_lines);
-        if (verbose)
-          std::cout << "\t\tthe file has not been loaded before, loading it now: " << input_name << std::endl;
-        loaded_lines = lexical_parse(loaded_lines, verbose);
-        if (verbose) std::cout << "\t\t\tlexical parse successful" << std::endl;
+        // register the file now, so a repeated directive finds it; contents are loaded by the caller
         boost::shared_ptr<snakemake_file> ptr(new snakemake_file(_tag_counter));
-        ptr->parse_file(loaded_lines, computed_relative_suffix, verbose);
+        ptr->_snakefile_relative_path = computed_relative_suffix;
+        ptr->_parse_cache = _parse_cache;
         _included_files[boost::filesystem::path(input_name)] = ptr;
+        discovered->push_back(std::make_pair(ptr, boost::filesystem::path(input_name)));
         // always flag as updated when new file is loaded
         _updated_last_round = true;
       }
     }
   }
+}
+
+void snakemake_unit_tests::snakemake_file::resolve_statically(const boost::filesystem::path &pipeline_top_dir,
+                                                              bool verbose, unsigned n_threads) {
+  std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path> > discovered;
+  do {
+    discovered.clear();
+    collect_static_includes(pipeline_top_dir, verbose, &discovered);
+    load_included_files(discovered, n_threads, verbose);
+  } while (!discovered.empty());
+  // python has nothing to add about what was loaded here, beyond any blocks still unresolved
+  set_update_status(false);
+}
+
+void snakemake_unit_tests::snakemake_file::collect_static_includes(
+    const boost::filesystem::path &pipeline_top_dir, bool verbose,
+    std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path> > *discovered) {
+  if (!discovered) throw std::runtime_error("null pointer provided to collect_static_includes");
+  for (std::list<boost::shared_ptr<rule_block> >::iterator iter = _blocks.begin(); iter != _blocks.end(); ++iter) {
+    if (!(*iter)->resolvable_statically()) {
+      // python must report every include after this one, so the files it includes stay in order
+      if ((*iter)->contains_include_directive()) break;
+      continue;
+    }
+    (*iter)->resolve_statically();
+    if (!(*iter)->contains_include_directive()) continue;
+    // keyed exactly as collect_included_files would
+    boost::filesystem::path computed_relative_suffix =
+        get_snakefile_relative_path().parent_path() / (*iter)->get_resolved_included_filename();
+    boost::filesystem::path input_name = pipeline_top_dir / computed_relative_suffix;
+    std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator file_finder =
+        _included_files.find(input_name);
+    if (file_finder != _included_files.end()) {
+      file_finder->second->collect_static_includes(pipeline_top_dir, verbose, discovered);
+    } else {
+      if (verbose) {
+        std::cout << "\tresolved include of \"" << computed_relative_suffix.string() << "\" without python"
+                  << std::endl;
+      }
+      boost::shared_ptr<snakemake_file> ptr(new snakemake_file(_tag_counter));
+      ptr->_snakefile_relative_path = computed_relative_suffix;
+      ptr->_parse_cache = _parse_cache;
+      _included_files[input_name] = ptr;
+      discovered->push_back(std::make_pair(ptr, input_name));
+    }
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::write_interpreter_stubs(const boost::filesystem::path &workspace) const {
+  boost::filesystem::path output_name = workspace / get_snakefile_relative_path();
+  boost::filesystem::create_directories(output_name.parent_path());
+  std::ofstream output(output_name.string().c_str());
+  if (!output.is_open())
+    throw std::runtime_error("cannot write interpreter snakefile stub to file \"" + output_name.string() + "\"");
+  output.close();
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator iter =
+           _included_files.begin();
+       iter != _included_files.end(); ++iter) {
+    iter->second->write_interpreter_stubs(workspace);
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::describe_interpreter_files(const boost::filesystem::path &workspace,
+                                                                      std::ostream &out) const {
+  std::string contents;
+  load_buffer(workspace / get_snakefile_relative_path(), &contents);
+  write_cache_string(out, get_snakefile_relative_path().string());
+  write_cache_string(out, contents);
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator iter =
+           _included_files.begin();
+       iter != _included_files.end(); ++iter) {
+    iter->second->describe_interpreter_files(workspace, out);
+  }
+}
+
+/*
+  a pass record is "tags\n" followed by each tag and its value, as cache strings
+ */
+bool snakemake_unit_tests::snakemake_file::restore_tag_values(const std::string &pass_key,
+                                                              std::map<std::string, std::string> *tag_values) const {
+  if (!tag_values) throw std::runtime_error("null pointer provided to restore_tag_values");
+  std::string payload;
+  if (!_parse_cache || !_parse_cache->find(pass_key, &payload)) return false;
+  std::string_view record(payload);
+  std::map<std::string, std::string> restored;
+  try {
+    if (record.substr(0, 5).compare("tags\n")) return false;
+    record.remove_prefix(5);
+    while (!record.empty()) {
+      std::string tag(read_cache_string(&record));
+      restored[tag] = std::string(read_cache_string(&record));
+    }
+  } catch (const std::runtime_error &) {
+    return false;
+  }
+  tag_values->swap(restored);
   return true;
 }
 
-void snakemake_unit_tests::snakemake_file::capture_python_tag_values(const std::vector<std::string> &vec,
+void snakemake_unit_tests::snakemake_file::store_tag_values(
+    const std::string &pass_key, const std::map<std::string, std::string> &tag_values) const {
+  if (!_parse_cache) return;
+  std::ostringstream out;
+  out << "tags\n";
+  for (std::map<std::string, std::string>::const_iterator iter = tag_values.begin(); iter != tag_values.end();
+       ++iter) {
+    write_cache_string(out, iter->first);
+    write_cache_string(out, iter->second);
+  }
+  _parse_cache->store(pass_key, out.str());
+}
+
+std::string snakemake_unit_tests::snakemake_file::python_signature() const {
+  if (!_parse_cache) throw std::logic_error("python_signature called without a parse cache");
+  std::string description;
+  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+       ++iter) {
+    (*iter)->append_python_signature(&description);
+  }
+  return _parse_cache->key(description);
+}
+
+/*
+  a resolution record is a header line, "resolution", and the key of everything else python
+  read; then "passes <count>" and the cache key of each python pass behind the resolution;
+  then an entry for each file: "file <includes>", the file's relative path, its python
+  signature, and the resolution records of its blocks as a single string. the entries
+  of a file's includes follow it directly.
+ */
+void snakemake_unit_tests::snakemake_file::store_resolution(const std::string &inputs_key) const {
+  if (!_parse_cache) return;
+  std::ostringstream out;
+  out << "resolution\n";
+  write_cache_string(out, inputs_key);
+  out << "passes " << _pass_keys.size() << '\n';
+  for (std::vector<std::string>::const_iterator iter = _pass_keys.begin(); iter != _pass_keys.end(); ++iter) {
+    write_cache_string(out, *iter);
+  }
+  write_resolution_tree(out);
+  _parse_cache->store("resolution-" + _parse_cache->key(get_snakefile_relative_path().string()), out.str());
+}
+
+void snakemake_unit_tests::snakemake_file::write_resolution_tree(std::ostream &out) const {
+  std::ostringstream states;
+  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+       ++iter) {
+    (*iter)->write_resolution_record(states);
+  }
+  out << "file " << _included_files.size() << '\n';
+  write_cache_string(out, get_snakefile_relative_path().string());
+  write_cache_string(out, python_signature());
+  write_cache_string(out, states.str());
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator iter =
+           _included_files.begin();
+       iter != _included_files.end(); ++iter) {
+    iter->second->write_resolution_tree(out);
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::read_resolution_tree(
+    std::string_view *record, const boost::filesystem::path &pipeline_top_dir,
+    std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> > *included,
+    std::vector<std::pair<snakemake_file *, std::pair<std::string_view, std::string_view> > > *pending) {
+  if (!record || !included || !pending) throw std::runtime_error("null pointer provided to read_resolution_tree");
+  if (record->substr(0, 5).compare("file ")) throw std::runtime_error("missing resolution record file entry");
+  record->remove_prefix(5);
+  uint64_t n_included = read_cache_number(record, '\n');
+  if (n_included > record->size()) throw std::runtime_error("invalid include count in resolution record");
+  boost::filesystem::path recorded_path = std::string(read_cache_string(record));
+  // files registered from the record take the recorded path; the top-level file must match it
+  if (_snakefile_relative_path.empty()) {
+    _snakefile_relative_path = recorded_path;
+  } else if (_snakefile_relative_path.compare(recorded_path)) {
+    throw std::runtime_error("resolution record describes a different file");
+  }
+  std::string_view signature = read_cache_string(record);
+  pending->push_back(std::make_pair(this, std::make_pair(signature, read_cache_string(record))));
+  for (uint64_t i = 0; i < n_included; ++i) {
+    boost::shared_ptr<snakemake_file> ptr(new snakemake_file(_tag_counter));
+    ptr->_parse_cache = _parse_cache;
+    ptr->read_resolution_tree(record, pipeline_top_dir, &ptr->_included_files, pending);
+    // included files are keyed by their location on disk, exactly as collect_included_files does
+    (*included)[pipeline_top_dir / ptr->get_snakefile_relative_path()] = ptr;
+  }
+}
+
+bool snakemake_unit_tests::snakemake_file::restore_resolution(const std::string &inputs_key,
+                                                              const boost::filesystem::path &pipeline_top_dir,
+                                                              unsigned n_threads, bool verbose) {
+  if (!_parse_cache) return false;
+  std::string payload;
+  if (!_parse_cache->find("resolution-" + _parse_cache->key(get_snakefile_relative_path().string()), &payload))
+    return false;
+  std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> > included;
+  std::vector<std::pair<snakemake_file *, std::pair<std::string_view, std::string_view> > > pending;
+  // tags handed to previously included files are taken back if the record cannot be used,
+  // so files loaded afterwards are numbered, and their python passes keyed, as in a fresh run
+  unsigned first_tag = *_tag_counter;
+  bool valid = false;
+  try {
+    valid = check_resolution(payload, inputs_key, pipeline_top_dir, n_threads, verbose, &included, &pending);
+  } catch (const std::runtime_error &e) {
+    // a damaged record, or a previously included file that cannot be loaded
+    if (verbose) std::cout << "\tprevious python resolution cannot be used: " << e.what() << std::endl;
+  }
+  if (!valid) {
+    *_tag_counter = first_tag;
+    return false;
+  }
+  // everything is validated; apply it
+  for (unsigned i = 0; i < pending.size(); ++i) {
+    std::string_view states = pending.at(i).second.second;
+    for (std::list<boost::shared_ptr<rule_block> >::iterator iter = pending.at(i).first->_blocks.begin();
+         iter != pending.at(i).first->_blocks.end(); ++iter) {
+      (*iter)->read_resolution_record(&states);
+    }
+  }
+  _included_files.swap(included);
+  set_update_status(false);
+  // the passes behind this resolution are not looked up, but a later edit may need them again
+  for (std::vector<std::string>::const_iterator iter = _pass_keys.begin(); iter != _pass_keys.end(); ++iter) {
+    _parse_cache->retain(*iter);
+  }
+  if (verbose) std::cout << "\treused python resolution from the previous run" << std::endl;
+  return true;
+}
+
+bool snakemake_unit_tests::snakemake_file::check_resolution(
+    std::string_view record, const std::string &inputs_key, const boost::filesystem::path &pipeline_top_dir,
+    unsigned n_threads, bool verbose, std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> > *included,
+    std::vector<std::pair<snakemake_file *, std::pair<std::string_view, std::string_view> > > *pending) {
+  if (!included || !pending) throw std::runtime_error("null pointer provided to check_resolution");
+  if (record.substr(0, 11).compare("resolution\n")) return false;
+  record.remove_prefix(11);
+  if (read_cache_string(&record).compare(inputs_key)) {
+    if (verbose) std::cout << "\tpython resolution inputs have changed since the last run" << std::endl;
+    return false;
+  }
+  if (record.substr(0, 7).compare("passes ")) return false;
+  record.remove_prefix(7);
+  uint64_t n_passes = read_cache_number(&record, '\n');
+  if (n_passes > record.size()) throw std::runtime_error("invalid pass count in resolution record");
+  std::vector<std::string> pass_keys;
+  for (uint64_t i = 0; i < n_passes; ++i) {
+    pass_keys.push_back(std::string(read_cache_string(&record)));
+  }
+  read_resolution_tree(&record, pipeline_top_dir, included, pending);
+  if (!record.empty()) return false;
+  // load what was included last time, concurrently as in process_python_results
+  unsigned n_workers = n_threads ? n_threads : std::thread::hardware_concurrency();
+  if (n_workers > pending->size() - 1) n_workers = pending->size() - 1;
+  if (n_workers > 1 && !verbose) {
+    thread_pool pool(n_workers);
+    for (unsigned i = 1; i < pending->size(); ++i) {
+      snakemake_file *target = pending->at(i).first;
+      boost::filesystem::path filename = pipeline_top_dir / target->get_snakefile_relative_path();
+      boost::filesystem::path relative_path = target->get_snakefile_relative_path();
+      pool.submit([target, filename, relative_path]() { target->load_blocks(filename, relative_path, false); });
+    }
+    pool.wait();
+  } else {
+    for (unsigned i = 1; i < pending->size(); ++i) {
+      snakemake_file *target = pending->at(i).first;
+      target->load_blocks(pipeline_top_dir / target->get_snakefile_relative_path(),
+                          target->get_snakefile_relative_path(), verbose);
+    }
+  }
+  for (unsigned i = 1; i < pending->size(); ++i) {
+    pending->at(i).first->assign_interpreter_tags();
+  }
+  // every file must present python with exactly what it did last time
+  rule_block scratch;
+  for (unsigned i = 0; i < pending->size(); ++i) {
+    if (pending->at(i).first->python_signature().compare(pending->at(i).second.first)) {
+      if (verbose)
+        std::cout << "\tsnakefile \"" << pending->at(i).first->get_snakefile_relative_path().string()
+                  << "\" has changed what python resolution sees" << std::endl;
+      return false;
+    }
+    std::string_view states = pending->at(i).second.second;
+    for (unsigned j = 0; j < pending->at(i).first->get_blocks().size(); ++j) {
+      scratch.read_resolution_record(&states);
+    }
+    if (!states.empty()) return false;
+  }
+  _pass_keys.swap(pass_keys);
+  return true;
+}
+
+/*
+  records are written by snakemake_unit_tests_report in the interpreter
+  snakefile; see resolve_with_python for the format
+ */
+static uint32_t read_tag_record_integer(std::string_view *records) {
+  if (records->size() < 4) throw std::runtime_error("truncated tag record reported by python");
+  uint32_t res = 0;
+  for (unsigned i = 0; i < 4; ++i) {
+    res |= static_cast<uint32_t>(static_cast<unsigned char>((*records)[i])) << (8 * i);
+  }
+  records->remove_prefix(4);
+  return res;
+}
+
+void snakemake_unit_tests::snakemake_file::decode_python_tag_records(std::string_view records,
                                                                      std::map<std::string, std::string> *target) const {
-  const boost::regex tag_value_pair("^(tag[0-9]+): *(.*) *[\r\n]+$");
-  const boost::regex tag_alone("^(tag[0-9]+) *[\r\n]+$");
-  boost::smatch tag_match;
-  if (!target) throw std::runtime_error("null pointer provided to capture_python_tag_values");
-  // for each line of output
-  for (std::vector<std::string>::const_iterator iter = vec.begin(); iter != vec.end(); ++iter) {
-    // match format "tag#: value"
-    if (boost::regex_match(*iter, tag_match, tag_value_pair)) {
-      (*target)[tag_match[1].str()] = tag_match[2].str();
-    } else if (boost::regex_match(*iter, tag_match, tag_alone)) {
-      // match format "tag#"
-      (*target)[tag_match[1].str()] = "";
+  if (!target) throw std::runtime_error("null pointer provided to decode_python_tag_records");
+  while (!records.empty()) {
+    char kind = records[0];
+    records.remove_prefix(1);
+    std::string tag = "tag" + std::to_string(read_tag_record_integer(&records));
+    if (kind == 'r') {
+      (*target)[tag] = "";
+    } else if (kind == 'i') {
+      uint32_t length = read_tag_record_integer(&records);
+      if (records.size() < length) throw std::runtime_error("truncated tag record reported by python");
+      (*target)[tag] = std::string(records.substr(0, length));
+      records.remove_prefix(length);
     } else {
-      // in snakemake interpreter mode, just ignore this
-      continue;
+      throw std::runtime_error("unrecognized tag record reported by python");
     }
   }
 }
@@ -16,12 +16,18 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "boost/filesystem.hpp"
 #include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/arena.h"
+#include "snakemake_unit_tests/parse_cache.h"
 #include "snakemake_unit_tests/rule_block.h"
+#include "snakemake_unit_tests/rule_registry.h"
+#include "snakemake_unit_tests/thread_pool.h"
 
 namespace snakemake_unit_tests {
 /*!
@@ -34,7 +40,11 @@ class snakemake_file {
   /*!
   @brief default constructor
  */
-  snakemake_file() : _tag_counter(0), _updated_last_round(true) {
+  snakemake_file()
+      : _arena(new string_arena),
+        _block_pool(new object_pool<rule_block>),
+        _tag_counter(0),
+        _updated_last_round(true) {
     _tag_counter.reset(new unsigned);
     *_tag_counter = 1;
   }
@@ -43,16 +53,24 @@ class snakemake_file {
   an initialized counter
   @param ptr pre-initialized counter, from root file
  */
-  explicit snakemake_file(boost::shared_ptr<unsigned> ptr) : _tag_counter(ptr), _updated_last_round(true) {}
+  explicit snakemake_file(boost::shared_ptr<unsigned> ptr)
+      : _arena(new string_arena),
+        _block_pool(new object_pool<rule_block>),
+        _tag_counter(ptr),
+        _updated_last_round(true) {}
   /*!
   @brief copy constructor
   @param obj existing snakemake_file object
  */
   snakemake_file(const snakemake_file &obj)
-      : _blocks(obj._blocks),
+      : _arena(obj._arena),
+        _block_pool(obj._block_pool),
+        _blocks(obj._blocks),
         _snakefile_relative_path(obj._snakefile_relative_path),
         _included_files(obj._included_files),
         _tag_counter(obj._tag_counter),
+        _parse_cache(obj._parse_cache),
+        _pass_keys(obj._pass_keys),
         _updated_last_round(obj._updated_last_round) {}
   /*!
   @brief destructor
@@ -69,12 +87,40 @@ class snakemake_file {
 
   /*!
  @brief parse a snakemake file
- @param loaded_lines lines of file to parse
+ @param loaded_lines lines of file to parse, as views into storage that
+ outlives this object; normally the buffer adopted by get_arena()
  @param filename name of file for informative errors
  @param verbose whether to emit verbose
  logging output
 */
-  void parse_file(const std::vector<std::string> &loaded_lines, const boost::filesystem::path &filename, bool verbose);
+  void parse_file(const std::vector<std::string_view> &loaded_lines, const boost::filesystem::path &filename,
+                  bool verbose);
+
+  /*!
+  @brief get the storage that owns this file's contents
+  @return shared pointer to this file's arena
+ */
+  const boost::shared_ptr<string_arena> &get_arena() const { return _arena; }
+
+  /*!
+  @brief get the storage that holds this file's blocks
+  @return shared pointer to this file's block pool
+ */
+  const boost::shared_ptr<object_pool<rule_block>> &get_block_pool() const { return _block_pool; }
+
+  /*!
+  @brief restore unchanged files from a parse cache, and record new parses in it
+  @param cache shared cache; null disables caching
+
+  files included later inherit this object's cache
+ */
+  void set_parse_cache(const boost::shared_ptr<parse_cache> &cache) { _parse_cache = cache; }
+
+  /*!
+  @brief get the parse cache used by this file
+  @return shared pointer to the parse cache, or null if caching is disabled
+ */
+  const boost::shared_ptr<parse_cache> &get_parse_cache() const { return _parse_cache; }
 
   /*!
   @brief load all lines from a file into memory
@@ -83,6 +129,13 @@ class snakemake_file {
  */
   void load_lines(const boost::filesystem::path &filename, std::vector<std::string> *target) const;
 
+  /*!
+  @brief load an entire file into memory with a single read
+  @param filename name of file to load
+  @param target where to store the file contents
+ */
+  void load_buffer(const boost::filesystem::path &filename, std::string *target) const;
+
   /*!
   @brief report on internal discrepancies in the snakefile load results
   @param include_rules included rule set, for helpful logging
@@ -107,12 +160,28 @@ class snakemake_file {
   std::list<boost::shared_ptr<rule_block>> &get_blocks() { return _blocks; }
 
   /*!
-  @brief report all code blocks but a single requested rule to file
-  @param rule_names string names of requested rules
-  @param out open output stream to which to write data
+  @brief collect the contents of a synthetic snakefile reporting all code
+  blocks but the requested rules
+  @param registry index of the rules loaded from this file
+  @param rules identifiers of requested rules
+  @param scratch storage for blocks that have not been rendered, or null
+  if every block is known to be rendered
+  @param slices where to append views of the file contents, in order
   @return how many target rules are present in this file
+
+  the views refer to rendered blocks (see render_blocks) or to scratch,
+  and are valid as long as both are
+ */
+  unsigned report_single_rule(const rule_registry &registry, const rule_set &rules, string_arena *scratch,
+                              std::vector<std::string_view> *slices) const;
+
+  /*!
+  @brief format every block of this file and its loaded includes once,
+  for emission into many synthetic snakefiles
+
+  call this once python resolution is complete
  */
-  unsigned report_single_rule(const std::map<std::string, bool> &rule_names, std::ostream &out) const;
+  void render_blocks();
 
   /*!
   @brief whether the object's rules are unambiguously resolved
@@ -138,15 +207,28 @@ class snakemake_file {
   @param verbose whether to provide verbose logging output
   @param disable_resolution deactivate downstream processing on recursive
   calls
-  @return whether the reporting terminated just after the first
+  @param n_threads number of threads for parsing newly included files;
+  0 means one per available core
+  @param parse_only whether snakemake only lists the workflow's rules,
+  which evaluates every snakefile without building the DAG, instead
+  of running a complete dry run
+  @param inputs_key cache key of everything else that python reads;
+  if not empty, and parse caching is enabled, the report of a pass is
+  reused whenever the same interpreter snakefiles meet the same inputs
+  @return whether the reporting terminated after the first
   instance of an unresolved include directive. used to control
   recursive behavior.
 
+  rules and literal include directives that directly follow an
+  unresolved include are still reported, so they resolve in the
+  same pass.
+
   this is the top level entry point for a recursion pass through python
   reporting. this should only be called from the primary caller.
  */
   bool resolve_with_python(const boost::filesystem::path &workspace, const boost::filesystem::path &pipeline_top_dir,
-                           const boost::filesystem::path &pipeline_run_dir, bool verbose, bool disable_resolution);
+                           const boost::filesystem::path &pipeline_run_dir, bool verbose, bool disable_resolution,
+                           unsigned n_threads, bool parse_only, const std::string &inputs_key);
 
   /*!
   @brief run the current rule set through python once
@@ -156,23 +238,74 @@ class snakemake_file {
   @param verbose whether to provide verbose logging output
   @param tag_values reporter data from python pass
   @param output_name full output path of snakefile
-  @return processing status; deprecated, flagged for removal
+  @param n_threads number of threads for parsing newly included files;
+  0 means one per available core
+  @return whether any newly included files were loaded
 
-  this is the recursive entry point for a recursion pass through python
-  reporting. this should be called for each file in turn.
+  this applies the python report to this file and everything it already
+  includes. include directives that resolve to files not yet loaded are
+  collected first, then loaded and parsed concurrently; interpreter tags
+  are assigned to the new files afterwards, in the order in which they
+  were found, so the result matches a serial load. verbose runs load
+  serially, to keep logging output readable.
  */
   bool process_python_results(const boost::filesystem::path &workspace, const boost::filesystem::path &pipeline_run_dir,
                               bool verbose, const std::map<std::string, std::string> &tag_values,
-                              const boost::filesystem::path &output_name);
+                              const boost::filesystem::path &output_name, unsigned n_threads);
+
+  /*!
+  @brief resolve what can be known without python, in this file and everything it includes
+  @param pipeline_top_dir top directory of pipeline installation
+  @param verbose whether to provide verbose logging output
+  @param n_threads number of threads for parsing newly included files;
+  0 means one per available core
+
+  top level rules, and top level include directives on string literals,
+  are resolved as included; the files they include are loaded and
+  resolved in turn. in each file, this stops at the first include
+  directive that needs python. if nothing needs python, nothing is left
+  for resolve_with_python to do.
+ */
+  void resolve_statically(const boost::filesystem::path &pipeline_top_dir, bool verbose, unsigned n_threads);
 
   /*!
-  @brief parse python reporting output to tags or tags and values
-  @param vec captured lines from python output
+  @brief record the python resolution of this file and everything it includes
+  @param inputs_key cache key of everything else that python resolution read
+
+  nothing is recorded if parse caching is disabled
+ */
+  void store_resolution(const std::string &inputs_key) const;
+
+  /*!
+  @brief reuse the python resolution of a previous run, if nothing it read has changed
+  @param inputs_key cache key of everything else that python resolution reads
+  @param pipeline_top_dir top directory of pipeline installation
+  @param n_threads number of threads for parsing included files;
+  0 means one per available core
+  @param verbose whether to provide verbose logging output
+  @return whether the previous resolution was applied
+
+  call this on a freshly loaded top-level file, before any python pass.
+  python sees only code chunks, include directives, and the position and
+  indentation of rules, so edits to rule bodies keep the previous resolution.
+  the files included last time are loaded, and if each still presents python
+  with the same content, resolution status and included files are restored
+  without running python, and the records of the python passes behind them
+  are kept for later runs. otherwise, nothing is changed, and the tags
+  handed out while checking are returned.
+ */
+  bool restore_resolution(const std::string &inputs_key, const boost::filesystem::path &pipeline_top_dir,
+                          unsigned n_threads, bool verbose);
+
+  /*!
+  @brief decode the records python reported on the tag descriptor
+  @param records complete contents written to the tag descriptor
   @param target results collector
 
-  null strings in map value corresponds to rule tags
+  null strings in map value corresponds to rule tags. truncated or
+  unrecognized records throw
  */
-  void capture_python_tag_values(const std::vector<std::string> &vec, std::map<std::string, std::string> *target) const;
+  void decode_python_tag_records(std::string_view records, std::map<std::string, std::string> *target) const;
   /*!
   @brief resolve derived rules and check for sanity
   @param include_rules flagged rules to be included
@@ -224,6 +357,162 @@ class snakemake_file {
  private:
   friend class snakemake_fileTest;
   friend class solved_rulesTest;
+  friend class rule_registryTest;
+  /*!
+  @brief apply a python report to this file and its loaded includes
+  @param workspace top level directory with added files and directories
+  installed
+  @param pipeline_top_dir top directory of pipeline installation
+  @param verbose whether to provide verbose logging output
+  @param tag_values reporter data from python pass
+  @param output_name full output path of snakefile
+  @param discovered newly included files, in discovery order, paired
+  with their locations on disk; files are registered but not yet loaded
+
+  this is the recursive part of process_python_results
+ */
+  void collect_included_files(
+      const boost::filesystem::path &workspace, const boost::filesystem::path &pipeline_top_dir, bool verbose,
+      const std::map<std::string, std::string> &tag_values, const boost::filesystem::path &output_name,
+      std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path>> *discovered);
+  /*!
+  @brief resolve blocks of this file and its loaded includes without python
+  @param pipeline_top_dir top directory of pipeline installation
+  @param verbose whether to provide verbose logging output
+  @param discovered newly included files, in discovery order, paired
+  with their locations on disk; files are registered but not yet loaded
+
+  this is the recursive part of resolve_statically
+ */
+  void collect_static_includes(
+      const boost::filesystem::path &pipeline_top_dir, bool verbose,
+      std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path>> *discovered);
+  /*!
+  @brief load newly included files, then assign their interpreter tags
+  @param discovered newly included files, in discovery order, paired
+  with their locations on disk
+  @param n_threads number of threads for parsing; 0 means one per available core
+  @param verbose whether to provide verbose logging output
+
+  files are loaded concurrently unless verbose; tags are assigned
+  afterwards in discovery order, so the result matches a serial load
+ */
+  void load_included_files(
+      const std::vector<std::pair<boost::shared_ptr<snakemake_file>, boost::filesystem::path>> &discovered,
+      unsigned n_threads, bool verbose);
+  /*!
+  @brief load and parse a snakemake file without assigning interpreter tags
+  @param filename location of file on disk
+  @param relative_path name of file relative to pipeline top level
+  @param verbose whether to emit verbose logging output
+
+  touches no state shared with other files, so different files
+  can be loaded concurrently
+ */
+  void load_blocks(const boost::filesystem::path &filename, const boost::filesystem::path &relative_path,
+                   bool verbose);
+  /*!
+  @brief parse a snakemake file without assigning interpreter tags
+  @param loaded_lines lines of file to parse
+  @param filename name of file for informative errors
+  @param verbose whether to emit verbose logging output
+ */
+  void parse_blocks(const std::vector<std::string_view> &loaded_lines, const boost::filesystem::path &filename,
+                    bool verbose);
+  /*!
+  @brief give each rule and include directive the next interpreter tag
+ */
+  void assign_interpreter_tags();
+  /*!
+  @brief record parsed blocks as a parse cache payload
+  @return payload describing every block in this file
+ */
+  std::string serialize_blocks() const;
+  /*!
+  @brief replace this file's blocks with those in a parse cache payload
+  @param payload cached payload, stored in this file's arena
+  @return whether the payload could be restored; if not, no blocks are added
+ */
+  bool restore_blocks(std::string_view payload);
+  /*!
+  @brief describe everything in this file that reaches a python resolution pass
+  @return cache key of the description
+ */
+  std::string python_signature() const;
+  /*!
+  @brief write empty interpreter snakefiles for this file and everything it includes
+  @param workspace directory to which interpreter snakefiles are written
+
+  an empty file keeps an include statement valid without running any
+  of the included code
+ */
+  void write_interpreter_stubs(const boost::filesystem::path &workspace) const;
+  /*!
+  @brief describe the interpreter snakefiles of a python pass
+  @param workspace directory to which interpreter snakefiles were written
+  @param out stream to which to write the relative path and contents
+  of the interpreter snakefile of this file and each of its includes
+ */
+  void describe_interpreter_files(const boost::filesystem::path &workspace, std::ostream &out) const;
+  /*!
+  @brief look up the report of an identical earlier python pass
+  @param pass_key cache key of the pass
+  @param tag_values where to store the report, if found
+  @return whether a valid report was found
+ */
+  bool restore_tag_values(const std::string &pass_key, std::map<std::string, std::string> *tag_values) const;
+  /*!
+  @brief record the report of a python pass for later runs
+  @param pass_key cache key of the pass
+  @param tag_values report to record
+ */
+  void store_tag_values(const std::string &pass_key, const std::map<std::string, std::string> &tag_values) const;
+  /*!
+  @brief record resolution state of this file and its includes
+  @param out open output stream to which to write the record
+ */
+  void write_resolution_tree(std::ostream &out) const;
+  /*!
+  @brief check a stored resolution record against the snakefiles on disk
+  @param record complete resolution record
+  @param inputs_key key of everything else python read
+  @param pipeline_top_dir top directory of pipeline installation
+  @param n_threads number of threads for parsing included files
+  @param verbose whether to provide verbose logging output
+  @param included where to register this file's includes
+  @param pending every file in the record, in order, with its expected signature
+  and block states; included files are loaded and tagged
+  @return whether the record can be applied; if so, this file takes the
+  record's python pass keys
+ */
+  bool check_resolution(
+      std::string_view record, const std::string &inputs_key, const boost::filesystem::path &pipeline_top_dir,
+      unsigned n_threads, bool verbose, std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> > *included,
+      std::vector<std::pair<snakemake_file *, std::pair<std::string_view, std::string_view> > > *pending);
+  /*!
+  @brief register included files listed in a resolution record, without loading them
+  @param record resolution record starting at this file's entry; advanced past
+  the entries of this file and its includes
+  @param pipeline_top_dir top directory of pipeline installation
+  @param included where to register this file's includes
+  @param pending every file in the record, in order, with its expected signature
+  and block states; files other than this one are registered but not loaded
+ */
+  void read_resolution_tree(
+      std::string_view *record, const boost::filesystem::path &pipeline_top_dir,
+      std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file>> *included,
+      std::vector<std::pair<snakemake_file *, std::pair<std::string_view, std::string_view>>> *pending);
+  /*!
+  @brief owner of the file buffer and all text viewed by its blocks
+ */
+  boost::shared_ptr<string_arena> _arena;
+  /*!
+  @brief contiguous storage for this file's blocks
+
+  entries of _blocks share ownership of the pool rather than owning
+  their blocks individually
+ */
+  boost::shared_ptr<object_pool<rule_block>> _block_pool;
   /*!
   @brief minimal contents of snakemake file as blocks of code
  */
@@ -241,6 +530,17 @@ class snakemake_file {
  */
   boost::shared_ptr<unsigned> _tag_counter;
   /*!
+  @brief optional cache of previously parsed files
+ */
+  boost::shared_ptr<parse_cache> _parse_cache;
+  /*!
+  @brief cache keys of the python passes run from this file, in order
+
+  recorded with the resolution, so a later run that restores the
+  resolution keeps the pass records the cache would otherwise prune
+ */
+  std::vector<std::string> _pass_keys;
+  /*!
   @brief whether any contained block updated its inclusion status last update
  */
   bool _updated_last_round;
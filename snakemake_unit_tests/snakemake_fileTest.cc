@@ -32,6 +32,9 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_default_const
   CPPUNIT_ASSERT(sf._tag_counter.get());
   CPPUNIT_ASSERT_EQUAL(1u, *sf._tag_counter);
   CPPUNIT_ASSERT(sf._updated_last_round);
+  CPPUNIT_ASSERT(sf._arena);
+  CPPUNIT_ASSERT(sf._block_pool);
+  CPPUNIT_ASSERT(!sf._parse_cache);
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_pointer_constructor() {
   boost::shared_ptr<unsigned> ptr(new unsigned);
@@ -43,6 +46,8 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_pointer_const
   CPPUNIT_ASSERT(sf._tag_counter.get());
   CPPUNIT_ASSERT_EQUAL(20u, *sf._tag_counter);
   CPPUNIT_ASSERT(sf._updated_last_round);
+  CPPUNIT_ASSERT(sf._arena);
+  CPPUNIT_ASSERT(sf._block_pool);
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_copy_constructor() {
   snakemake_file sf1;
@@ -62,10 +67,52 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_copy_construc
   CPPUNIT_ASSERT(sf2._included_files["/other/path"] == ptr_sf);
   CPPUNIT_ASSERT_EQUAL(55u, *sf2._tag_counter);
   CPPUNIT_ASSERT(!sf2._updated_last_round);
+  CPPUNIT_ASSERT(sf2._arena == sf1._arena);
+  CPPUNIT_ASSERT(sf2._block_pool == sf1._block_pool);
+  CPPUNIT_ASSERT(sf2._parse_cache == sf1._parse_cache);
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_load_everything() {}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_load_everything_cached() {
+  boost::filesystem::path base_dir = boost::filesystem::path(std::string(_tmp_dir));
+  std::ofstream output((base_dir / "Snakefile").string().c_str());
+  if (!(output << "x = [1,\n     2]  # comment\n\nrule rule1:\n    \"\"\"doc\"\"\"\n    input: \"a.txt\",\n"
+                  "    shell: \"echo \\\n    b\"\n\ncheckpoint rule2:\n    output: \"b.txt\",\n\n"
+                  "include: \"rules/other.smk\"\n"))
+    throw std::runtime_error("cannot write snakefile for cached load_everything test");
+  output.close();
+  boost::shared_ptr<parse_cache> cache(new parse_cache(base_dir / "cache", false));
+  snakemake_file parsed, restored;
+  parsed.set_parse_cache(cache);
+  restored.set_parse_cache(cache);
+  parsed.load_everything("Snakefile", base_dir, false);
+  CPPUNIT_ASSERT(cache->misses() == 1);
+  CPPUNIT_ASSERT(!cache->hits());
+  restored.load_everything("Snakefile", base_dir, false);
+  CPPUNIT_ASSERT(cache->hits() == 1);
+  CPPUNIT_ASSERT(restored._snakefile_relative_path == boost::filesystem::path("Snakefile"));
+  CPPUNIT_ASSERT(restored._blocks.size() == 5);
+  CPPUNIT_ASSERT(restored._blocks.size() == parsed._blocks.size());
+  std::list<boost::shared_ptr<rule_block> >::const_iterator expected = parsed._blocks.begin();
+  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = restored._blocks.begin();
+       iter != restored._blocks.end(); ++iter, ++expected) {
+    std::ostringstream o1, o2;
+    (*expected)->print_contents(o1);
+    (*iter)->print_contents(o2);
+    CPPUNIT_ASSERT_EQUAL(o1.str(), o2.str());
+    CPPUNIT_ASSERT(**iter == **expected);
+    CPPUNIT_ASSERT((*iter)->is_checkpoint() == (*expected)->is_checkpoint());
+    CPPUNIT_ASSERT((*iter)->get_local_indentation() == (*expected)->get_local_indentation());
+    CPPUNIT_ASSERT((*iter)->get_resolution_status() == (*expected)->get_resolution_status());
+    CPPUNIT_ASSERT((*iter)->get_interpreter_tag() == (*expected)->get_interpreter_tag());
+    CPPUNIT_ASSERT((*iter)->_arena == restored._arena);
+  }
+  CPPUNIT_ASSERT(restored._blocks.back()->contains_include_directive());
+  CPPUNIT_ASSERT(restored._blocks.back()->get_interpreter_tag() == 3);
+  // only the cache entry is kept, not the source text
+  CPPUNIT_ASSERT(restored._arena->allocation_count() == 1);
+}
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_parse_file() {
-  std::vector<std::string> loaded_lines;
+  std::vector<std::string_view> loaded_lines;
   loaded_lines.push_back("rule rule1:");
   loaded_lines.push_back("    input: 'filename',");
   loaded_lines.push_back("include: 'filename'");
@@ -92,6 +139,129 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_parse_file()
   CPPUNIT_ASSERT((*iter)->_python_tag == 0);
   CPPUNIT_ASSERT((*iter)->_resolution == RESOLVED_INCLUDED);
   CPPUNIT_ASSERT(*sf._tag_counter == 3);
+  // blocks are held in the file's pool and share its arena
+  CPPUNIT_ASSERT(sf._block_pool->size() == 3u);
+  CPPUNIT_ASSERT((*iter)->_arena == sf._arena);
+  CPPUNIT_ASSERT(iter->use_count() == sf._block_pool.use_count());
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_set_parse_cache() {
+  boost::shared_ptr<parse_cache> cache(new parse_cache(boost::filesystem::path(std::string(_tmp_dir)), true));
+  snakemake_file sf;
+  sf.set_parse_cache(cache);
+  CPPUNIT_ASSERT(sf._parse_cache == cache);
+  CPPUNIT_ASSERT(sf.get_parse_cache() == cache);
+  sf.set_parse_cache(boost::shared_ptr<parse_cache>());
+  CPPUNIT_ASSERT(!sf.get_parse_cache());
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_restore_blocks_damaged() {
+  snakemake_file sf;
+  std::string payload = "2\nblock 0 0 0 1\n0\n\n0\n\n0\n\n4\npass\nblock 0 0 0 1\n0\n\n0\n\n0\n\n9\npass\n";
+  CPPUNIT_ASSERT(!sf.restore_blocks(payload));
+  CPPUNIT_ASSERT(!sf.restore_blocks("3\nblock"));
+  CPPUNIT_ASSERT(!sf.restore_blocks("x\n"));
+  CPPUNIT_ASSERT(!sf.restore_blocks(""));
+  // a failed restore leaves nothing behind
+  CPPUNIT_ASSERT(sf._blocks.empty());
+  CPPUNIT_ASSERT(!sf._block_pool->size());
+  payload = "1\nblock 0 0 0 1\n0\n\n0\n\n0\n\n4\npass\n";
+  CPPUNIT_ASSERT(sf.restore_blocks(payload));
+  CPPUNIT_ASSERT(sf._blocks.size() == 1);
+  CPPUNIT_ASSERT(sf._blocks.front()->get_resolution_status() == RESOLVED_INCLUDED);
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_restore_resolution() {
+  boost::filesystem::path base_dir = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::create_directories(base_dir / "rules");
+  std::ofstream output((base_dir / "Snakefile").string().c_str());
+  if (!(output << "include: \"rules/other.smk\"\nrule rule1:\n    output: \"a.txt\",\n"))
+    throw std::runtime_error("cannot write snakefile for restore_resolution test");
+  output.close();
+  output.open((base_dir / "rules" / "other.smk").string().c_str());
+  if (!(output << "if False:\n    rule rule2:\n        output: \"b.txt\",\n"))
+    throw std::runtime_error("cannot write snakefile for restore_resolution test");
+  output.close();
+  boost::shared_ptr<parse_cache> cache(new parse_cache(base_dir / "cache", false));
+  // resolve by hand what python would report
+  snakemake_file resolved;
+  resolved.set_parse_cache(cache);
+  resolved.load_everything("Snakefile", base_dir, false);
+  boost::shared_ptr<snakemake_file> other(new snakemake_file(resolved._tag_counter));
+  other->set_parse_cache(cache);
+  other->load_everything("rules/other.smk", base_dir, false);
+  resolved._included_files[base_dir / "rules/other.smk"] = other;
+  for (std::list<boost::shared_ptr<rule_block> >::iterator iter = resolved._blocks.begin();
+       iter != resolved._blocks.end(); ++iter) {
+    (*iter)->_queried_by_python = true;
+    (*iter)->set_resolution(RESOLVED_INCLUDED);
+  }
+  resolved._blocks.front()->_resolved_included_filename = "rules/other.smk";
+  other->_blocks.front()->_queried_by_python = true;
+  other->_blocks.back()->_queried_by_python = true;
+  other->_blocks.back()->set_resolution(RESOLVED_EXCLUDED);
+  resolved.set_update_status(false);
+  CPPUNIT_ASSERT(!resolved.contains_blockers());
+  resolved.store_resolution("inputs");
+
+  // different inputs to python: nothing is restored
+  snakemake_file sf1;
+  sf1.set_parse_cache(cache);
+  sf1.load_everything("Snakefile", base_dir, false);
+  CPPUNIT_ASSERT(!sf1.restore_resolution("other inputs", base_dir, 1, false));
+  CPPUNIT_ASSERT(sf1._included_files.empty());
+  CPPUNIT_ASSERT(sf1.contains_blockers());
+  // same inputs: the previous resolution is applied
+  CPPUNIT_ASSERT(sf1.restore_resolution("inputs", base_dir, 1, false));
+  CPPUNIT_ASSERT(!sf1.contains_blockers());
+  CPPUNIT_ASSERT(sf1._included_files.size() == 1);
+  CPPUNIT_ASSERT(sf1._included_files.find(base_dir / "rules/other.smk") != sf1._included_files.end());
+  CPPUNIT_ASSERT(sf1._blocks.front()->get_resolved_included_filename() == boost::filesystem::path("rules/other.smk"));
+  boost::shared_ptr<snakemake_file> restored_other = sf1._included_files.begin()->second;
+  CPPUNIT_ASSERT(restored_other->_blocks.size() == 2);
+  CPPUNIT_ASSERT(restored_other->_blocks.back()->get_resolution_status() == RESOLVED_EXCLUDED);
+  CPPUNIT_ASSERT(restored_other->_blocks.back()->get_interpreter_tag());
+
+  // editing a rule body does not change what python sees
+  output.open((base_dir / "rules" / "other.smk").string().c_str());
+  if (!(output << "if False:\n    rule rule2:\n        output: \"c.txt\",\n"))
+    throw std::runtime_error("cannot write snakefile for restore_resolution test");
+  output.close();
+  snakemake_file sf2;
+  sf2.set_parse_cache(cache);
+  sf2.load_everything("Snakefile", base_dir, false);
+  CPPUNIT_ASSERT(sf2.restore_resolution("inputs", base_dir, 1, false));
+  // editing python code does
+  output.open((base_dir / "rules" / "other.smk").string().c_str());
+  if (!(output << "if True:\n    rule rule2:\n        output: \"c.txt\",\n"))
+    throw std::runtime_error("cannot write snakefile for restore_resolution test");
+  output.close();
+  snakemake_file sf3;
+  sf3.set_parse_cache(cache);
+  sf3.load_everything("Snakefile", base_dir, false);
+  CPPUNIT_ASSERT(!sf3.restore_resolution("inputs", base_dir, 1, false));
+  CPPUNIT_ASSERT(sf3._included_files.empty());
+  CPPUNIT_ASSERT(sf3._blocks.front()->get_resolution_status() == UNRESOLVED);
+  // and the failed check hands out no tags, so the next pass is described, and keyed, as in a fresh run
+  snakemake_file fresh;
+  fresh.set_parse_cache(cache);
+  fresh.load_everything("Snakefile", base_dir, false);
+  CPPUNIT_ASSERT_EQUAL(*fresh._tag_counter, *sf3._tag_counter);
+  std::ostringstream restored_pass, fresh_pass;
+  sf3.resolve_statically(base_dir, false, 1);
+  sf3.resolve_with_python(base_dir / "workspace_restored", base_dir, ".", false, true, 1, false, "");
+  sf3.describe_interpreter_files(base_dir / "workspace_restored", restored_pass);
+  fresh.resolve_statically(base_dir, false, 1);
+  fresh.resolve_with_python(base_dir / "workspace_fresh", base_dir, ".", false, true, 1, false, "");
+  fresh.describe_interpreter_files(base_dir / "workspace_fresh", fresh_pass);
+  CPPUNIT_ASSERT(sf3._included_files.size() == 1);
+  CPPUNIT_ASSERT_EQUAL(fresh_pass.str(), restored_pass.str());
+  // so does removing an included file
+  boost::filesystem::remove(base_dir / "rules" / "other.smk");
+  snakemake_file sf4;
+  sf4.set_parse_cache(cache);
+  sf4.load_everything("Snakefile", base_dir, false);
+  CPPUNIT_ASSERT(!sf4.restore_resolution("inputs", base_dir, 1, false));
+  // without a cache, there is nothing to restore
+  snakemake_file sf5;
+  CPPUNIT_ASSERT(!sf5.restore_resolution("inputs", base_dir, 1, false));
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_load_lines() {
   // create a dummy snakefile and ensure it's loaded as anticipated
@@ -117,6 +287,31 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_load_lines()
   CPPUNIT_ASSERT(target.at(4).empty());
   CPPUNIT_ASSERT(target.at(5).empty());
 }
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_load_buffer() {
+  // the buffer holds the file byte for byte, including any final newline
+  std::ofstream output;
+  boost::filesystem::path filename = boost::filesystem::path(std::string(_tmp_dir)) / "test_snakefile";
+  output.open(filename.string().c_str(), std::ios_base::out | std::ios_base::binary);
+  std::string content = "/usr/bin/env snakemake\n\nrule all:\r\n    input: TARGETS,\n\n";
+  if (!output.is_open()) {
+    throw std::runtime_error("cannot write test snakefile for load_buffer");
+  }
+  if (!(output << content)) {
+    throw std::runtime_error("cannot write to disk for snakefile for load_buffer");
+  }
+  output.close();
+  std::string target = "previous content";
+  snakemake_file sf;
+  sf.load_buffer(filename, &target);
+  CPPUNIT_ASSERT(!target.compare(content));
+  // empty files give empty buffers
+  output.open(filename.string().c_str());
+  output.close();
+  sf.load_buffer(filename, &target);
+  CPPUNIT_ASSERT(target.empty());
+  CPPUNIT_ASSERT_THROW(sf.load_buffer(filename, NULL), std::runtime_error);
+  CPPUNIT_ASSERT_THROW(sf.load_buffer(filename.string() + "_missing", &target), std::runtime_error);
+}
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_detect_known_issues() {
   std::map<std::string, bool> include_rules, exclude_rules;
   boost::shared_ptr<snakemake_file> sf1(new snakemake_file), sf2(new snakemake_file);
@@ -221,16 +416,66 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_single
   sf._blocks.push_back(b4);
   sf._blocks.push_back(b5);
 
-  std::map<std::string, bool> ruleset;
-  ruleset["myrule"] = true;
-  ruleset["otherrule"] = true;
-  std::ostringstream out;
-  unsigned result = sf.report_single_rule(ruleset, out);
-  CPPUNIT_ASSERT(result == 2);
+  rule_registry registry(sf);
+  std::map<std::string, bool> include_rules, exclude_rules;
+  include_rules["myrule"] = true;
+  include_rules["otherrule"] = true;
+  rule_set ruleset = registry.select(include_rules, exclude_rules);
   std::string expected =
       "if True:\n    rule myrule:\n        input:\n            file1,\n\n\n"
       "else:\n    pass\n\n\nrule otherrule:\n    input:\n        file2,\n\n\n";
-  CPPUNIT_ASSERT(!out.str().compare(expected));
+  // unrendered blocks are formatted into scratch storage
+  string_arena scratch;
+  std::vector<std::string_view> slices;
+  unsigned result = sf.report_single_rule(registry, ruleset, &scratch, &slices);
+  CPPUNIT_ASSERT(result == 2);
+  CPPUNIT_ASSERT(slices.size() == 5U);
+  std::string observed;
+  for (std::vector<std::string_view>::const_iterator iter = slices.begin(); iter != slices.end(); ++iter) {
+    observed += *iter;
+  }
+  CPPUNIT_ASSERT(!observed.compare(expected));
+  // rendered blocks are reported without copies
+  sf.render_blocks();
+  slices.clear();
+  CPPUNIT_ASSERT(sf.report_single_rule(registry, ruleset, NULL, &slices) == 2);
+  CPPUNIT_ASSERT(slices.at(1).data() == b2->get_rendered_contents().data());
+  CPPUNIT_ASSERT(slices.at(3).data() == b4->get_rendered_placeholder().data());
+  observed.clear();
+  for (std::vector<std::string_view>::const_iterator iter = slices.begin(); iter != slices.end(); ++iter) {
+    observed += *iter;
+  }
+  CPPUNIT_ASSERT(!observed.compare(expected));
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_single_rule_unrendered() {
+  snakemake_file sf;
+  boost::shared_ptr<rule_block> b(new rule_block);
+  b->_code_chunk.push_back("x = 1");
+  sf._blocks.push_back(b);
+  rule_registry registry(sf);
+  std::vector<std::string_view> slices;
+  sf.report_single_rule(registry, registry.empty_set(), NULL, &slices);
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_single_rule_null_pointer() {
+  snakemake_file sf;
+  rule_registry registry(sf);
+  sf.report_single_rule(registry, registry.empty_set(), NULL, NULL);
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_render_blocks() {
+  snakemake_file sf;
+  boost::shared_ptr<snakemake_file> sf2(new snakemake_file);
+  boost::shared_ptr<rule_block> b1(new rule_block), b2(new rule_block);
+  b1->_code_chunk.push_back("x = 1");
+  b2->_rule_name = "myrule";
+  sf._blocks.push_back(b1);
+  sf2->_blocks.push_back(b2);
+  sf._included_files["rules/file2.smk"] = sf2;
+  sf.render_blocks();
+  // includes are rendered as well
+  CPPUNIT_ASSERT(b1->rendered());
+  CPPUNIT_ASSERT(b2->rendered());
+  CPPUNIT_ASSERT(!b1->get_rendered_contents().compare("x = 1\n"));
+  CPPUNIT_ASSERT(!b2->get_rendered_contents().compare("rule myrule:\n\n\n"));
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_fully_resolved() {
   snakemake_file sf;
@@ -385,7 +630,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_
 
   // actually call the thing
   try {
-    sf1->resolve_with_python(workspace, pipeline_top, pipeline_run, verbose, disable_reporting);
+    sf1->resolve_with_python(workspace, pipeline_top, pipeline_run, verbose, disable_reporting, 1, false, "");
   } catch (...) {
     std::cout.rdbuf(previous_buffer);
     throw;
@@ -408,9 +653,10 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_
   CPPUNIT_ASSERT((*iter)->_queried_by_python);
   CPPUNIT_ASSERT((*iter)->_resolution == RESOLVED_INCLUDED);
   CPPUNIT_ASSERT(!(*iter)->_resolved_included_filename.string().compare("future.smk"));
+  // rules after an unresolved include are still reported
   ++iter;
-  CPPUNIT_ASSERT(!(*iter)->_queried_by_python);
-  CPPUNIT_ASSERT((*iter)->_resolution == RESOLVED_EXCLUDED);
+  CPPUNIT_ASSERT((*iter)->_queried_by_python);
+  CPPUNIT_ASSERT((*iter)->_resolution == RESOLVED_INCLUDED);
   CPPUNIT_ASSERT(sf2->_included_files.size() == 1);
   CPPUNIT_ASSERT(sf2->_included_files.begin()->second->_blocks.size() == 1);
   iter = sf2->_included_files.begin()->second->_blocks.begin();
@@ -418,6 +664,328 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_
   CPPUNIT_ASSERT((*iter)->_resolution == UNRESOLVED);
   CPPUNIT_ASSERT(!(*iter)->_queried_by_python);
 }
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_python_batched_includes() {
+  /*
+    after an unresolved include, reporting continues through rules and
+    literal include directives, and stops before anything else. recursive
+    calls only write the interpreter snakefile, so no python is needed.
+   */
+  boost::filesystem::path workspace = boost::filesystem::path(std::string(_tmp_dir)) / "rwpbi_workspace";
+  boost::filesystem::path pipeline_run = boost::filesystem::path(".");
+  snakemake_file sf;
+  sf._snakefile_relative_path = "workflow/Snakefile";
+  const char *lines[] = {"include: \"rules/a.smk\"", NULL, "include: 'rules/b.smk'", "include: config[\"c\"]", NULL};
+  for (unsigned i = 0; i < 5; ++i) {
+    boost::shared_ptr<rule_block> rb(new rule_block);
+    if (lines[i]) {
+      rb->_code_chunk.push_back(lines[i]);
+    } else {
+      rb->_rule_name = "rule" + std::to_string(i + 1);
+    }
+    rb->_python_tag = i + 1;
+    sf._blocks.push_back(rb);
+  }
+  CPPUNIT_ASSERT(sf.resolve_with_python(workspace, workspace, pipeline_run, false, true, 1, false, ""));
+  std::ifstream input((workspace / "workflow/Snakefile").string().c_str());
+  std::ostringstream contents;
+  contents << input.rdbuf();
+  std::string expected =
+      "snakemake_unit_tests_report(1, \"rules/a.smk\")\n"
+      "snakemake_unit_tests_report(2)\n\n\n"
+      "snakemake_unit_tests_report(3, 'rules/b.smk')\n";
+  CPPUNIT_ASSERT_EQUAL(expected, contents.str());
+  std::list<boost::shared_ptr<rule_block> >::const_iterator iter = sf._blocks.begin();
+  for (unsigned i = 0; i < 5; ++i, ++iter) {
+    CPPUNIT_ASSERT_EQUAL(i < 3, (*iter)->_queried_by_python);
+  }
+  // code after the first unresolved include ends reporting immediately
+  (*++sf._blocks.begin())->_rule_name = "";
+  (*++sf._blocks.begin())->_code_chunk.push_back("x = 1");
+  CPPUNIT_ASSERT(sf.resolve_with_python(workspace, workspace, pipeline_run, false, true, 1, false, ""));
+  input.close();
+  input.open((workspace / "workflow/Snakefile").string().c_str());
+  contents.str("");
+  contents << input.rdbuf();
+  CPPUNIT_ASSERT_EQUAL(std::string("snakemake_unit_tests_report(1, \"rules/a.smk\")\n"), contents.str());
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_python_stubbed_siblings() {
+  /*
+    once an included file stops reporting early, files included after it
+    are written empty, so their printed include statements stay valid
+   */
+  boost::filesystem::path workspace = boost::filesystem::path(std::string(_tmp_dir)) / "rwpss_workspace";
+  snakemake_file sf;
+  sf._snakefile_relative_path = "workflow/Snakefile";
+  const char *names[] = {"rules/a.smk", "rules/b.smk"};
+  const char *lines[] = {"include: \"rules/a.smk\"", "include: \"rules/b.smk\""};
+  boost::shared_ptr<snakemake_file> children[2];
+  for (unsigned i = 0; i < 2; ++i) {
+    boost::shared_ptr<rule_block> rb(new rule_block);
+    rb->_code_chunk.push_back(lines[i]);
+    rb->_python_tag = i + 1;
+    rb->_resolved_included_filename = names[i];
+    rb->set_resolution(RESOLVED_INCLUDED);
+    sf._blocks.push_back(rb);
+    children[i] = boost::shared_ptr<snakemake_file>(new snakemake_file);
+    children[i]->_snakefile_relative_path = boost::filesystem::path("workflow") / names[i];
+    sf._included_files[workspace / "workflow" / names[i]] = children[i];
+  }
+  boost::shared_ptr<rule_block> unresolved(new rule_block), rule(new rule_block);
+  unresolved->_code_chunk.push_back("include: config[\"c\"]");
+  unresolved->_python_tag = 3;
+  children[0]->_blocks.push_back(unresolved);
+  rule->_rule_name = "rule1";
+  rule->_python_tag = 4;
+  children[1]->_blocks.push_back(rule);
+  CPPUNIT_ASSERT(sf.resolve_with_python(workspace, workspace, ".", false, true, 1, false, ""));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(workspace / "workflow/rules/b.smk"));
+  CPPUNIT_ASSERT_EQUAL(boost::uintmax_t(0), boost::filesystem::file_size(workspace / "workflow/rules/b.smk"));
+  CPPUNIT_ASSERT(!rule->_queried_by_python);
+  // without an early stop, every included file is written in full
+  unresolved->_code_chunk.clear();
+  unresolved->_rule_name = "rule2";
+  CPPUNIT_ASSERT(!sf.resolve_with_python(workspace, workspace, ".", false, true, 1, false, ""));
+  CPPUNIT_ASSERT(boost::filesystem::file_size(workspace / "workflow/rules/b.smk") > 0);
+  CPPUNIT_ASSERT(rule->_queried_by_python);
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_python_parse_only() {
+  /*
+    the parse harness asks snakemake to list rules instead of running a dry run.
+    a stand-in snakemake earlier on PATH records its arguments and reports one tag
+    on the tag descriptor. a tag it prints to the screen is ignored.
+   */
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path workspace = tmp_parent / "rwppo_workspace";
+  boost::filesystem::path bin_dir = tmp_parent / "rwppo_bin";
+  boost::filesystem::create_directories(workspace / "workflow");
+  boost::filesystem::create_directories(bin_dir);
+  std::ofstream output((bin_dir / "snakemake").string().c_str());
+  if (!(output << "#!/usr/bin/env bash\necho \"$@\" > " << (tmp_parent / "rwppo_args").string()
+               << "\necho tag2\nprintf 'r\\001\\000\\000\\000' >&$SNAKEMAKE_UNIT_TESTS_TAG_FD\n"))
+    throw std::runtime_error("cannot write stand-in snakemake for parse_only test");
+  output.close();
+  boost::filesystem::permissions(bin_dir / "snakemake", boost::filesystem::owner_all);
+  snakemake_file sf;
+  sf._snakefile_relative_path = "workflow/Snakefile";
+  boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block), rb3(new rule_block);
+  rb1->_rule_name = "rule1";
+  rb1->_python_tag = 1;
+  rb2->_code_chunk.push_back("if False:");
+  rb2->set_resolution(RESOLVED_INCLUDED);
+  rb3->_rule_name = "rule2";
+  rb3->_local_indentation = 4;
+  rb3->_python_tag = 2;
+  sf._blocks.push_back(rb1);
+  sf._blocks.push_back(rb2);
+  sf._blocks.push_back(rb3);
+  std::string previous_path = getenv("PATH") ? getenv("PATH") : "";
+  setenv("PATH", (bin_dir.string() + ":" + previous_path).c_str(), 1);
+  try {
+    sf.resolve_with_python(workspace, workspace, ".", false, false, 1, true, "");
+  } catch (...) {
+    setenv("PATH", previous_path.c_str(), 1);
+    throw;
+  }
+  setenv("PATH", previous_path.c_str(), 1);
+  std::ifstream input((tmp_parent / "rwppo_args").string().c_str());
+  std::string args;
+  std::getline(input, args);
+  CPPUNIT_ASSERT_EQUAL(std::string("--list -s workflow/Snakefile"), args);
+  CPPUNIT_ASSERT(rb1->resolved() && rb1->included());
+  CPPUNIT_ASSERT(rb3->resolved() && !rb3->included());
+  CPPUNIT_ASSERT(!sf.contains_blockers());
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_python_cached_pass() {
+  /*
+    a second run with the same inputs, and an identical interpreter snakefile,
+    takes its tags from the cache. the stand-in snakemake logs every call.
+   */
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path workspace = tmp_parent / "rwpcp_workspace";
+  boost::filesystem::path bin_dir = tmp_parent / "rwpcp_bin";
+  boost::filesystem::path calls = tmp_parent / "rwpcp_calls";
+  boost::filesystem::create_directories(workspace / "workflow");
+  boost::filesystem::create_directories(bin_dir);
+  std::ofstream output((bin_dir / "snakemake").string().c_str());
+  if (!(output << "#!/usr/bin/env bash\necho \"$@\" >> " << calls.string()
+               << "\nprintf 'r\\001\\000\\000\\000' >&$SNAKEMAKE_UNIT_TESTS_TAG_FD\n"))
+    throw std::runtime_error("cannot write stand-in snakemake for cached_pass test");
+  output.close();
+  boost::filesystem::permissions(bin_dir / "snakemake", boost::filesystem::owner_all);
+  boost::shared_ptr<parse_cache> cache(new parse_cache(tmp_parent / "rwpcp_cache", false));
+  std::string previous_path = getenv("PATH") ? getenv("PATH") : "";
+  setenv("PATH", (bin_dir.string() + ":" + previous_path).c_str(), 1);
+  try {
+    for (unsigned run = 0; run < 2; ++run) {
+      snakemake_file sf;
+      sf.set_parse_cache(cache);
+      sf._snakefile_relative_path = "workflow/Snakefile";
+      boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block);
+      rb1->_rule_name = "rule1";
+      rb1->_local_indentation = 4;
+      rb1->_python_tag = 1;
+      rb2->_rule_name = "rule2";
+      rb2->_local_indentation = 4;
+      rb2->_python_tag = 2;
+      sf._blocks.push_back(rb1);
+      sf._blocks.push_back(rb2);
+      sf.resolve_with_python(workspace, workspace, ".", false, false, 1, false, "inputs");
+      CPPUNIT_ASSERT(rb1->resolved() && rb1->included());
+      CPPUNIT_ASSERT(rb2->resolved() && !rb2->included());
+    }
+  } catch (...) {
+    setenv("PATH", previous_path.c_str(), 1);
+    throw;
+  }
+  setenv("PATH", previous_path.c_str(), 1);
+  std::ifstream input(calls.string().c_str());
+  unsigned n_calls = 0;
+  std::string line;
+  while (std::getline(input, line)) ++n_calls;
+  CPPUNIT_ASSERT_EQUAL(1u, n_calls);
+  CPPUNIT_ASSERT_EQUAL(1u, cache->hits());
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_restore_resolution_keeps_passes() {
+  /*
+    generate, rerun unchanged, then rerun after an edit. the unchanged run
+    restores the whole resolution without looking up any pass, and must still
+    keep the pass record, so the run after the edit can reuse it. each run
+    has its own cache object and prunes it, as separate invocations do.
+   */
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path workspace = tmp_parent / "rrkp_workspace";
+  boost::filesystem::path bin_dir = tmp_parent / "rrkp_bin";
+  boost::filesystem::path calls = tmp_parent / "rrkp_calls";
+  boost::filesystem::path cache_dir = tmp_parent / "rrkp_cache";
+  boost::filesystem::create_directories(workspace / "workflow");
+  boost::filesystem::create_directories(bin_dir);
+  std::ofstream output((bin_dir / "snakemake").string().c_str());
+  if (!(output << "#!/usr/bin/env bash\necho \"$@\" >> " << calls.string()
+               << "\nprintf 'r\\001\\000\\000\\000' >&$SNAKEMAKE_UNIT_TESTS_TAG_FD\n"))
+    throw std::runtime_error("cannot write stand-in snakemake for keeps_passes test");
+  output.close();
+  boost::filesystem::permissions(bin_dir / "snakemake", boost::filesystem::owner_all);
+  std::string previous_path = getenv("PATH") ? getenv("PATH") : "";
+  setenv("PATH", (bin_dir.string() + ":" + previous_path).c_str(), 1);
+  try {
+    for (unsigned run = 0; run < 3; ++run) {
+      boost::shared_ptr<parse_cache> cache(new parse_cache(cache_dir, false));
+      if (run == 2) {
+        // an edit that changes what python sees after the pass that was recorded
+        boost::filesystem::remove(cache->get_cache_dir() /
+                                  ("resolution-" + cache->key("workflow/Snakefile") + ".blocks"));
+      }
+      snakemake_file sf;
+      sf.set_parse_cache(cache);
+      sf._snakefile_relative_path = "workflow/Snakefile";
+      boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block);
+      rb1->_rule_name = "rule1";
+      rb1->_local_indentation = 4;
+      rb1->_python_tag = 1;
+      rb2->_rule_name = "rule2";
+      rb2->_local_indentation = 4;
+      rb2->_python_tag = 2;
+      sf._blocks.push_back(rb1);
+      sf._blocks.push_back(rb2);
+      CPPUNIT_ASSERT_EQUAL(run == 1, sf.restore_resolution("inputs", workspace, 1, false));
+      if (run != 1) {
+        sf.resolve_with_python(workspace, workspace, ".", false, false, 1, false, "inputs");
+        sf.store_resolution("inputs");
+      }
+      CPPUNIT_ASSERT(rb1->resolved() && rb1->included());
+      CPPUNIT_ASSERT(rb2->resolved() && !rb2->included());
+      cache->prune();
+      if (run == 2) CPPUNIT_ASSERT_EQUAL(1u, cache->hits());
+    }
+  } catch (...) {
+    setenv("PATH", previous_path.c_str(), 1);
+    throw;
+  }
+  setenv("PATH", previous_path.c_str(), 1);
+  std::ifstream input(calls.string().c_str());
+  unsigned n_calls = 0;
+  std::string line;
+  while (std::getline(input, line)) ++n_calls;
+  CPPUNIT_ASSERT_EQUAL(1u, n_calls);
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_restore_tag_values() {
+  /*
+    stored tag reports come back unchanged; missing and malformed records are misses
+   */
+  boost::shared_ptr<parse_cache> cache(
+      new parse_cache(boost::filesystem::path(std::string(_tmp_dir)) / "rtv_cache", false));
+  snakemake_file sf;
+  std::map<std::string, std::string> tag_values, restored;
+  CPPUNIT_ASSERT(!sf.restore_tag_values("pass-1", &restored));
+  sf.set_parse_cache(cache);
+  CPPUNIT_ASSERT(!sf.restore_tag_values("pass-1", &restored));
+  tag_values["tag1"] = "";
+  tag_values["tag2"] = "rules/a\nb.smk";
+  sf.store_tag_values("pass-1", tag_values);
+  CPPUNIT_ASSERT(sf.restore_tag_values("pass-1", &restored));
+  CPPUNIT_ASSERT(restored == tag_values);
+  cache->store("pass-2", "tags\n4\ntag");
+  restored.clear();
+  CPPUNIT_ASSERT(!sf.restore_tag_values("pass-2", &restored));
+  CPPUNIT_ASSERT(restored.empty());
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_statically() {
+  /*
+    literal includes and top level rules resolve without python, recursively.
+    a pipeline made only of those has no blockers left afterwards.
+   */
+  boost::filesystem::path base_dir = boost::filesystem::path(std::string(_tmp_dir)) / "static";
+  boost::filesystem::create_directories(base_dir / "workflow/rules");
+  std::ofstream output;
+  output.open((base_dir / "workflow/Snakefile").string().c_str());
+  if (!(output << "x = 1\ninclude: \"rules/a.smk\"\n\nrule rule1:\n    output: \"a.txt\",\n"))
+    throw std::runtime_error("cannot write snakefile for resolve_statically test");
+  output.close();
+  output.open((base_dir / "workflow/rules/a.smk").string().c_str());
+  if (!(output << "include: 'b.smk'\n\nrule rule2:\n    output: \"b.txt\",\n"))
+    throw std::runtime_error("cannot write snakefile for resolve_statically test");
+  output.close();
+  output.open((base_dir / "workflow/rules/b.smk").string().c_str());
+  if (!(output << "rule rule3:\n    output: \"c.txt\",\n"))
+    throw std::runtime_error("cannot write snakefile for resolve_statically test");
+  output.close();
+  snakemake_file sf;
+  sf.load_everything("workflow/Snakefile", base_dir, false);
+  sf.resolve_statically(base_dir, false, 1);
+  CPPUNIT_ASSERT(!sf.contains_blockers());
+  CPPUNIT_ASSERT(sf._included_files.size() == 1);
+  snakemake_file *a = sf._included_files[base_dir / "workflow/rules/a.smk"].get();
+  CPPUNIT_ASSERT(a);
+  CPPUNIT_ASSERT(a->_included_files.size() == 1);
+  snakemake_file *b = a->_included_files[base_dir / "workflow/rules/b.smk"].get();
+  CPPUNIT_ASSERT(b);
+  CPPUNIT_ASSERT(b->_blocks.size() == 1);
+  CPPUNIT_ASSERT(b->_blocks.front()->included());
+  // tags are handed out in discovery order
+  CPPUNIT_ASSERT_EQUAL(5u, b->_blocks.front()->get_interpreter_tag());
+
+  // nested rules, and everything from a computed include on, are left for python
+  output.open((base_dir / "workflow/rules/b.smk").string().c_str());
+  if (!(output << "if x:\n    rule rule3:\n        output: \"c.txt\",\ninclude: config[\"c\"]\n"
+                  "include: \"d.smk\"\nrule rule4:\n    output: \"d.txt\",\n"))
+    throw std::runtime_error("cannot write snakefile for resolve_statically test");
+  output.close();
+  snakemake_file partial;
+  partial.load_everything("workflow/Snakefile", base_dir, false);
+  partial.resolve_statically(base_dir, false, 1);
+  CPPUNIT_ASSERT(partial.contains_blockers());
+  b = partial._included_files[base_dir / "workflow/rules/a.smk"]->_included_files[base_dir / "workflow/rules/b.smk"]
+          .get();
+  CPPUNIT_ASSERT(b);
+  CPPUNIT_ASSERT(b->_included_files.empty());
+  std::list<boost::shared_ptr<rule_block> >::const_iterator iter = b->_blocks.begin();
+  CPPUNIT_ASSERT((*iter)->resolved());
+  ++iter;
+  CPPUNIT_ASSERT(!(*iter)->resolved());
+  for (++iter; iter != b->_blocks.end(); ++iter) {
+    CPPUNIT_ASSERT(!(*iter)->resolved());
+  }
+}
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_python_results() {
   /*
     this function handles the process of finding new files to include. if a snakefile has already
@@ -505,9 +1073,11 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_pytho
   std::ostringstream endless_void;
   std::streambuf *previous_buffer(std::cout.rdbuf(endless_void.rdbuf()));
 
-  // actually call the thing
+  // actually call the thing; the first pass loads include.smk, and a second has nothing new to load
+  bool first_loaded = false, second_loaded = true;
   try {
-    sf1->process_python_results(workspace, pipeline_top, verbose, tag_values, snakefile_path);
+    first_loaded = sf1->process_python_results(workspace, pipeline_top, verbose, tag_values, snakefile_path, 1);
+    second_loaded = sf1->process_python_results(workspace, pipeline_top, verbose, tag_values, snakefile_path, 1);
   } catch (...) {
     std::cout.rdbuf(previous_buffer);
     throw;
@@ -522,6 +1092,8 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_pytho
     - it should understand that sf2 is already loaded, and iterate across it
     - it should trigger the load of sf3
    */
+  CPPUNIT_ASSERT(first_loaded);
+  CPPUNIT_ASSERT(!second_loaded);
   CPPUNIT_ASSERT(sf2->_blocks.size() == 3);
   CPPUNIT_ASSERT(sf1->_included_files.size() == 2);
   CPPUNIT_ASSERT(sf1->_included_files.begin()->second == sf2);
@@ -529,19 +1101,82 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_pytho
   std::list<boost::shared_ptr<rule_block> >::iterator iter = sf1->_included_files.rbegin()->second->_blocks.begin();
   CPPUNIT_ASSERT(!(*iter)->_rule_name.compare("rule5"));
 }
-void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_capture_python_tag_values() {
-  std::vector<std::string> input;
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_python_results_concurrent() {
+  // includes found in the same pass are parsed concurrently, but must end up tagged as a serial load would be
+  boost::filesystem::path workspace = boost::filesystem::path(std::string(_tmp_dir)) / "ppr_concurrent_workspace";
+  boost::filesystem::path snakefile_path = workspace / "workflow/Snakefile";
+  boost::filesystem::create_directories(workspace / "workflow/rules");
+  std::map<std::string, std::string> tag_values;
+  std::string top_contents;
+  for (unsigned i = 0; i < 8; ++i) {
+    std::string name = "file" + std::to_string(i);
+    std::ofstream output((workspace / "workflow/rules" / (name + ".smk")).string().c_str());
+    if (!(output << "rule " << name << "_a:\n    input: \"a.txt\",\n\nx = 1\n\nrule " << name
+                 << "_b:\n    output: \"b.txt\",\n"))
+      throw std::runtime_error("cannot write include for concurrent python results processing test");
+    output.close();
+    top_contents += "include: \"rules/" + name + ".smk\"\n";
+    tag_values["tag" + std::to_string(i + 1)] = "rules/" + name + ".smk";
+  }
+  string_arena arena;
+  std::vector<std::string_view> lines = lexical_parse(top_contents.data(), top_contents.size(), &arena);
+  snakemake_file serial, concurrent;
+  serial.parse_file(lines, "workflow/Snakefile", false);
+  concurrent.parse_file(lines, "workflow/Snakefile", false);
+  CPPUNIT_ASSERT_EQUAL(9u, *concurrent._tag_counter);
+
+  serial.process_python_results(workspace, workspace, false, tag_values, snakefile_path, 1);
+  concurrent.process_python_results(workspace, workspace, false, tag_values, snakefile_path, 4);
+
+  CPPUNIT_ASSERT_EQUAL(25u, *serial._tag_counter);
+  CPPUNIT_ASSERT_EQUAL(25u, *concurrent._tag_counter);
+  CPPUNIT_ASSERT(concurrent._updated_last_round);
+  CPPUNIT_ASSERT(concurrent._included_files.size() == 8);
+  CPPUNIT_ASSERT(serial._included_files.size() == 8);
+  std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator expected =
+      serial._included_files.begin();
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator iter =
+           concurrent._included_files.begin();
+       iter != concurrent._included_files.end(); ++iter, ++expected) {
+    CPPUNIT_ASSERT(iter->first == expected->first);
+    CPPUNIT_ASSERT(iter->second->_snakefile_relative_path == expected->second->_snakefile_relative_path);
+    CPPUNIT_ASSERT(iter->second->_blocks.size() == 3);
+    CPPUNIT_ASSERT(expected->second->_blocks.size() == 3);
+    std::list<boost::shared_ptr<rule_block> >::const_iterator expected_block = expected->second->_blocks.begin();
+    for (std::list<boost::shared_ptr<rule_block> >::const_iterator block = iter->second->_blocks.begin();
+         block != iter->second->_blocks.end(); ++block, ++expected_block) {
+      CPPUNIT_ASSERT(!(*block)->get_rule_name().compare((*expected_block)->get_rule_name()));
+      CPPUNIT_ASSERT_EQUAL((*expected_block)->get_interpreter_tag(), (*block)->get_interpreter_tag());
+    }
+  }
+  // tags follow the order of the include directives, not the order in which loads finished
+  boost::shared_ptr<snakemake_file> first = concurrent._included_files[workspace / "workflow/rules/file0.smk"];
+  boost::shared_ptr<snakemake_file> last = concurrent._included_files[workspace / "workflow/rules/file7.smk"];
+  CPPUNIT_ASSERT(first->_snakefile_relative_path == boost::filesystem::path("workflow/rules/file0.smk"));
+  CPPUNIT_ASSERT_EQUAL(9u, first->_blocks.front()->get_interpreter_tag());
+  CPPUNIT_ASSERT_EQUAL(24u, last->_blocks.back()->get_interpreter_tag());
+  CPPUNIT_ASSERT(!last->_blocks.back()->get_rule_name().compare("file7_b"));
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_decode_python_tag_records() {
+  // a rule tag, then an include tag whose value holds what a screen scrape could not
+  const char records[] = "r\x0e\x64\x01\x00i\x05\x00\x00\x00\x0c\x00\x00\x00tag1\nvalue 2";
   std::map<std::string, std::string> output;
-  input.push_back("some sort of infrastructure\n");
-  input.push_back("tag111222\n");
-  input.push_back("tag222333: valuevaluevalue\n");
   snakemake_file sf;
-  sf.capture_python_tag_values(input, &output);
+  sf.decode_python_tag_records(std::string_view(records, sizeof(records) - 1), &output);
   CPPUNIT_ASSERT(output.size() == 2);
-  CPPUNIT_ASSERT(output.find("tag111222") != output.end());
-  CPPUNIT_ASSERT(output["tag1111222"].empty());
-  CPPUNIT_ASSERT(output.find("tag222333") != output.end());
-  CPPUNIT_ASSERT(!output["tag222333"].compare("valuevaluevalue"));
+  CPPUNIT_ASSERT(output.find("tag91150") != output.end());
+  CPPUNIT_ASSERT(output["tag91150"].empty());
+  CPPUNIT_ASSERT_EQUAL(std::string("tag1\nvalue 2"), output["tag5"]);
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_decode_python_tag_records_truncated() {
+  std::map<std::string, std::string> output;
+  snakemake_file sf;
+  sf.decode_python_tag_records(std::string_view("i\x05\x00\x00\x00\x0b\x00\x00\x00tag1", 13), &output);
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_decode_python_tag_records_unrecognized() {
+  std::map<std::string, std::string> output;
+  snakemake_file sf;
+  sf.decode_python_tag_records("tag1\n", &output);
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_postflight_checks() {
   // for the moment, this is just a dispatch to detect_known_issues
@@ -18,6 +18,7 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -31,16 +32,34 @@ class snakemake_fileTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_snakemake_file_pointer_constructor);
   CPPUNIT_TEST(test_snakemake_file_copy_constructor);
   CPPUNIT_TEST(test_snakemake_file_load_everything);
+  CPPUNIT_TEST(test_snakemake_file_load_everything_cached);
   CPPUNIT_TEST(test_snakemake_file_parse_file);
+  CPPUNIT_TEST(test_snakemake_file_set_parse_cache);
+  CPPUNIT_TEST(test_snakemake_file_restore_blocks_damaged);
+  CPPUNIT_TEST(test_snakemake_file_restore_resolution);
   CPPUNIT_TEST(test_snakemake_file_load_lines);
+  CPPUNIT_TEST(test_snakemake_file_load_buffer);
   CPPUNIT_TEST(test_snakemake_file_detect_known_issues);
   CPPUNIT_TEST(test_snakemake_file_get_blocks);
   CPPUNIT_TEST(test_snakemake_file_report_single_rule);
+  CPPUNIT_TEST_EXCEPTION(test_snakemake_file_report_single_rule_unrendered, std::logic_error);
+  CPPUNIT_TEST_EXCEPTION(test_snakemake_file_report_single_rule_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_snakemake_file_render_blocks);
   CPPUNIT_TEST(test_snakemake_file_fully_resolved);
   CPPUNIT_TEST(test_snakemake_file_contains_blockers);
   CPPUNIT_TEST(test_snakemake_file_resolve_with_python);
+  CPPUNIT_TEST(test_snakemake_file_resolve_with_python_batched_includes);
+  CPPUNIT_TEST(test_snakemake_file_resolve_with_python_stubbed_siblings);
+  CPPUNIT_TEST(test_snakemake_file_resolve_with_python_parse_only);
+  CPPUNIT_TEST(test_snakemake_file_resolve_with_python_cached_pass);
+  CPPUNIT_TEST(test_snakemake_file_restore_resolution_keeps_passes);
+  CPPUNIT_TEST(test_snakemake_file_restore_tag_values);
+  CPPUNIT_TEST(test_snakemake_file_resolve_statically);
   CPPUNIT_TEST(test_snakemake_file_process_python_results);
-  CPPUNIT_TEST(test_snakemake_file_capture_python_tag_values);
+  CPPUNIT_TEST(test_snakemake_file_process_python_results_concurrent);
+  CPPUNIT_TEST(test_snakemake_file_decode_python_tag_records);
+  CPPUNIT_TEST_EXCEPTION(test_snakemake_file_decode_python_tag_records_truncated, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_snakemake_file_decode_python_tag_records_unrecognized, std::runtime_error);
   CPPUNIT_TEST(test_snakemake_file_postflight_checks);
   CPPUNIT_TEST(test_snakemake_file_get_snakefile_relative_path);
   CPPUNIT_TEST(test_snakemake_file_loaded_files);
@@ -59,16 +78,34 @@ class snakemake_fileTest : public CppUnit::TestFixture {
   void test_snakemake_file_pointer_constructor();
   void test_snakemake_file_copy_constructor();
   void test_snakemake_file_load_everything();
+  void test_snakemake_file_load_everything_cached();
   void test_snakemake_file_parse_file();
+  void test_snakemake_file_set_parse_cache();
+  void test_snakemake_file_restore_blocks_damaged();
+  void test_snakemake_file_restore_resolution();
   void test_snakemake_file_load_lines();
+  void test_snakemake_file_load_buffer();
   void test_snakemake_file_detect_known_issues();
   void test_snakemake_file_get_blocks();
   void test_snakemake_file_report_single_rule();
+  void test_snakemake_file_report_single_rule_unrendered();
+  void test_snakemake_file_report_single_rule_null_pointer();
+  void test_snakemake_file_render_blocks();
   void test_snakemake_file_fully_resolved();
   void test_snakemake_file_contains_blockers();
   void test_snakemake_file_resolve_with_python();
+  void test_snakemake_file_resolve_with_python_batched_includes();
+  void test_snakemake_file_resolve_with_python_stubbed_siblings();
+  void test_snakemake_file_resolve_with_python_parse_only();
+  void test_snakemake_file_resolve_with_python_cached_pass();
+  void test_snakemake_file_restore_resolution_keeps_passes();
+  void test_snakemake_file_restore_tag_values();
+  void test_snakemake_file_resolve_statically();
   void test_snakemake_file_process_python_results();
-  void test_snakemake_file_capture_python_tag_values();
+  void test_snakemake_file_process_python_results_concurrent();
+  void test_snakemake_file_decode_python_tag_records();
+  void test_snakemake_file_decode_python_tag_records_truncated();
+  void test_snakemake_file_decode_python_tag_records_unrecognized();
   void test_snakemake_file_postflight_checks();
   void test_snakemake_file_get_snakefile_relative_path();
   void test_snakemake_file_loaded_files();
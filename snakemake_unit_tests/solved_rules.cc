@@ -8,9 +8,58 @@
 
 #include "snakemake_unit_tests/solved_rules.h"
 
-snakemake_unit_tests::recipe::recipe() : _rule_name(""), _log("") {}
+// most recent lines of a failed dry run that are reported
+#define DRYRUN_LOGGED_LINES 500
+
+// callers register every recipe before creating workspaces
+static unsigned registered_rule_id(const snakemake_unit_tests::rule_registry &registry, const std::string &name) {
+  unsigned id = 0;
+  if (!registry.find(name, &id)) throw std::logic_error("rule \"" + name + "\" is not registered");
+  return id;
+}
+
+/*!
+  @brief interpret a count reported in the snakemake log
+  @param value reported value, e.g. '4' or '<TBD>'
+  @param target where to store the count
+  @return whether the value was a count that fits in an unsigned
+ */
+static bool parse_log_count(const std::string &value, unsigned *target) {
+  if (!target) throw std::runtime_error("null pointer provided to parse_log_count");
+  if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos) return false;
+  *target = std::stoul(value);
+  return true;
+}
+
+/*!
+  @brief give copied files the modification times of their originals
+  @param source directory that was copied
+  @param target copy of source
+
+  the manifest of expected output records the mtime of each expected
+  file, so copies that carry the manifest along must keep those mtimes
+ */
+static void copy_write_times(const boost::filesystem::path &source, const boost::filesystem::path &target) {
+  boost::filesystem::recursive_directory_iterator rec_iter(source), rec_end;
+  for (; rec_iter != rec_end; ++rec_iter) {
+    if (boost::filesystem::is_regular_file(rec_iter->symlink_status())) {
+      boost::filesystem::last_write_time(target / boost::filesystem::relative(rec_iter->path(), source),
+                                         boost::filesystem::last_write_time(rec_iter->path()));
+    }
+  }
+}
+
+snakemake_unit_tests::recipe::recipe()
+    : _rule_name(""), _log(""), _benchmark(""), _threads(1), _memory_mb(0), _runtime(0) {}
 snakemake_unit_tests::recipe::recipe(const recipe &obj)
-    : _rule_name(obj._rule_name), _inputs(obj._inputs), _outputs(obj._outputs), _log(obj._log) {}
+    : _rule_name(obj._rule_name),
+      _inputs(obj._inputs),
+      _outputs(obj._outputs),
+      _log(obj._log),
+      _benchmark(obj._benchmark),
+      _threads(obj._threads),
+      _memory_mb(obj._memory_mb),
+      _runtime(obj._runtime) {}
 snakemake_unit_tests::recipe::~recipe() throw() {}
 const std::string &snakemake_unit_tests::recipe::get_rule_name() const { return _rule_name; }
 void snakemake_unit_tests::recipe::set_rule_name(const std::string &s) { _rule_name = s; }
@@ -20,10 +69,40 @@ const std::vector<boost::filesystem::path> &snakemake_unit_tests::recipe::get_ou
 void snakemake_unit_tests::recipe::add_output(const std::string &s) { _outputs.push_back(s); }
 const std::string &snakemake_unit_tests::recipe::get_log() const { return _log; }
 void snakemake_unit_tests::recipe::set_log(const std::string &s) { _log = s; }
+const std::string &snakemake_unit_tests::recipe::get_benchmark() const { return _benchmark; }
+void snakemake_unit_tests::recipe::set_benchmark(const std::string &s) { _benchmark = s; }
+unsigned snakemake_unit_tests::recipe::get_threads() const { return _threads; }
+void snakemake_unit_tests::recipe::set_threads(unsigned n) { _threads = n; }
+unsigned snakemake_unit_tests::recipe::get_memory_mb() const { return _memory_mb; }
+void snakemake_unit_tests::recipe::set_memory_mb(unsigned n) { _memory_mb = n; }
+unsigned snakemake_unit_tests::recipe::get_runtime() const { return _runtime; }
+void snakemake_unit_tests::recipe::set_runtime(unsigned n) { _runtime = n; }
+void snakemake_unit_tests::recipe::set_resources(const std::string &s) {
+  std::vector<std::string> resources;
+  split_comma_list(s, &resources);
+  std::map<std::string, unsigned> counts;
+  for (std::vector<std::string>::const_iterator iter = resources.begin(); iter != resources.end(); ++iter) {
+    std::string::size_type loc = iter->find('=');
+    unsigned value = 0;
+    if (loc != std::string::npos && parse_log_count(iter->substr(loc + 1), &value))
+      counts[iter->substr(0, loc)] = value;
+  }
+  if (counts.find("mem_mb") != counts.end()) {
+    _memory_mb = counts["mem_mb"];
+  } else if (counts.find("mem_mib") != counts.end()) {
+    // 1 MiB is 1.048576 MB; round up, so the job is not short of memory
+    _memory_mb = static_cast<unsigned>((static_cast<uint64_t>(counts["mem_mib"]) * 1048576 + 999999) / 1000000);
+  } else if (counts.find("mem_gb") != counts.end()) {
+    _memory_mb = counts["mem_gb"] * 1000;
+  }
+  if (counts.find("runtime") != counts.end()) _runtime = counts["runtime"];
+}
 void snakemake_unit_tests::recipe::clear() {
-  _rule_name = _log = "";
+  _rule_name = _log = _benchmark = "";
   _inputs.clear();
   _outputs.clear();
+  _threads = 1;
+  _memory_mb = _runtime = 0;
 }
 
 void snakemake_unit_tests::solved_rules::load_file(const std::string &filename) {
@@ -80,10 +159,18 @@ void snakemake_unit_tests::solved_rules::load_file(const std::string &filename)
             // log files get created. may need to add this to
             // an exclusion list.
             rep->set_log(line.substr(9));
+          } else if (line.find("    benchmark:") == 0) {
+            // benchmark timings differ by run; excluded from comparisons
+            rep->set_benchmark(line.substr(15));
+          } else if (line.find("    threads:") == 0) {
+            // threads and resources are what the job was scheduled with,
+            // and are passed on to the emitted test for scheduling
+            unsigned threads = 0;
+            if (parse_log_count(line.substr(13), &threads) && threads) rep->set_threads(threads);
+          } else if (line.find("    resources:") == 0) {
+            rep->set_resources(line.substr(15));
           } else if (line.find("    jobid:") == 0 || line.find("    wildcards:") == 0 ||
-                     line.find("    benchmark:") == 0 || line.find("    resources:") == 0 ||
-                     line.find("    threads:") == 0 || line.find("    priority:") == 0 ||
-                     line.find("    reason:") == 0) {
+                     line.find("    priority:") == 0 || line.find("    reason:") == 0) {
             // other recognized solution annotations;
             // for the moment, do nothing with them
           } else {
@@ -148,8 +235,12 @@ void snakemake_unit_tests::solved_rules::emit_tests(
     const boost::filesystem::path &inst_dir, const std::map<std::string, bool> &include_rules,
     const std::map<std::string, bool> &exclude_rules, const std::vector<boost::filesystem::path> &added_files,
     const std::vector<boost::filesystem::path> &added_directories, bool update_snakefiles, bool update_added_content,
-    bool update_inputs, bool update_outputs, bool update_pytest, bool include_entire_dag,
+    bool update_inputs, bool update_outputs, bool update_pytest, bool include_entire_dag, bool archive_output,
+    bool shared_includes, unsigned n_threads,
     std::map<std::string, std::vector<std::string>> *files_outside_workspace) const {
+  if (shared_includes && archive_output) {
+    throw std::logic_error("shared include files are not supported for archive output");
+  }
   // create unit test output directory
   // by default, this looks like `.tests/unit`
   // but will be overridden as `output_test_dir/unit`
@@ -169,31 +260,118 @@ void snakemake_unit_tests::solved_rules::emit_tests(
         inst_dir.string() + "\"");
   }
 
+  // archive mode: rule trees are staged as loose files, then packed into a new
+  // archive that replaces the old one once all rules have been handled
+  bool update_content = update_snakefiles || update_added_content || update_inputs || update_outputs;
+  bool update_all_content = update_snakefiles && update_added_content && update_inputs && update_outputs;
+  boost::filesystem::path archive_path = test_parent_path / "unit_tests.zip";
+  boost::filesystem::path archive_tmp_path = test_parent_path / "unit_tests.zip.tmp";
+  archive_reader existing_archive;
+  archive_writer updated_archive;
+  std::map<std::string, bool> archived_rules;
+  if (archive_output) {
+    if (boost::filesystem::is_regular_file(archive_path)) {
+      existing_archive.open(archive_path);
+    }
+    updated_archive.open(archive_tmp_path);
+  }
+  // each rule's content is built in a staging area on the same filesystem and
+  // swapped into place once complete, so that anything reading the tests
+  // during regeneration (e.g. a concurrent pytest run) never sees a partial rule
+  boost::filesystem::path staging_parent_path = test_parent_path / ".staging";
+  boost::filesystem::create_directories(staging_parent_path);
+  // staged expected output is hashed on worker threads;
+  // the pool is declared last so queued hashes finish before the manifest goes away
+  manifest expected_manifest;
+  thread_pool pool(n_threads);
+
+  // every rule named by the log gets an identifier, whether or not a loaded snakefile defines it
+  rule_registry registry(sf);
+  register_recipes(&registry);
+  rule_set selected_rules = registry.select(include_rules, exclude_rules);
+
+  // shared mode: include files without target rules are written once and linked from each
+  // workspace. they go in a new version alongside the old one, which no link refers to until
+  // each rule is swapped in. staging gets its own link to the shared directory, so the same
+  // relative links resolve from both staged and final workspaces
+  std::string shared_dir_name;
+  if (shared_includes && update_snakefiles) {
+    shared_dir_name = next_shared_version(test_parent_path);
+    boost::filesystem::path shared_staging_path = staging_parent_path / (shared_dir_name + ".staged");
+    discard_tree(shared_staging_path);
+    boost::filesystem::create_directories(shared_staging_path);
+    emit_shared_snakefiles(sf, shared_staging_path, registry);
+    boost::filesystem::rename(shared_staging_path, test_parent_path / shared_dir_name);
+    boost::filesystem::remove(staging_parent_path / shared_dir_name);
+    boost::filesystem::create_symlink(boost::filesystem::path("..") / shared_dir_name,
+                                      staging_parent_path / shared_dir_name);
+  }
+
   // iterate across loaded recipes, creating tests as you go
-  std::map<std::string, bool> test_history;
+  rule_set test_history = registry.empty_set();
+  unsigned rule_id = 0;
   for (std::vector<boost::shared_ptr<recipe>>::const_iterator iter = _recipes.begin(); iter != _recipes.end(); ++iter) {
-    if (test_history.find((*iter)->get_rule_name()) == test_history.end()) {
+    registry.find((*iter)->get_rule_name(), &rule_id);
+    if (!test_history.test(rule_id)) {
+      boost::filesystem::path rule_parent_path = test_parent_path / (*iter)->get_rule_name();
+      boost::filesystem::path rule_staging_path = staging_parent_path / (*iter)->get_rule_name();
+      bool rule_included = selected_rules.test(rule_id);
+      // clear out anything left behind by an interrupted run
+      discard_tree(rule_staging_path);
+      // partial updates layer on top of the rule's existing content, so
+      // that content needs to be staged before anything is changed
+      if (rule_included && update_content && !update_all_content) {
+        if (archive_output && existing_archive.entries().size()) {
+          existing_archive.extract_prefix((*iter)->get_rule_name() + "/", staging_parent_path);
+        } else if (!archive_output && boost::filesystem::is_directory(rule_parent_path)) {
+          // only the test's own content is carried over, not anything else left in the rule directory
+          boost::filesystem::create_directories(rule_staging_path);
+          if (boost::filesystem::is_directory(rule_parent_path / "workspace")) {
+            boost::filesystem::copy(rule_parent_path / "workspace", rule_staging_path / "workspace",
+                                    boost::filesystem::copy_options::recursive |
+                                        boost::filesystem::copy_options::copy_symlinks);
+          }
+          if (boost::filesystem::is_directory(rule_parent_path / "expected")) {
+            boost::filesystem::copy(rule_parent_path / "expected", rule_staging_path / "expected",
+                                    boost::filesystem::copy_options::recursive |
+                                        boost::filesystem::copy_options::copy_symlinks);
+            copy_write_times(rule_parent_path / "expected", rule_staging_path / "expected");
+          }
+          if (boost::filesystem::is_regular_file(rule_parent_path / "expected.manifest")) {
+            boost::filesystem::copy_file(rule_parent_path / "expected.manifest",
+                                         rule_staging_path / "expected.manifest");
+          }
+        }
+      }
       bool deployment_successful = false;
       std::map<std::string, bool> missing_rules;
       std::map<boost::shared_ptr<recipe>, bool> missing_recipes;
       do {
-        create_workspace(*iter, sf, output_test_dir, test_parent_path, pipeline_top_dir, pipeline_run_dir, inst_test_py,
-                         missing_recipes, include_rules, exclude_rules, added_files, added_directories,
+        create_workspace(*iter, sf, output_test_dir, staging_parent_path, pipeline_top_dir, pipeline_run_dir,
+                         inst_test_py, missing_recipes, registry, selected_rules, added_files, added_directories,
                          update_snakefiles, update_added_content, update_inputs, update_outputs, update_pytest,
-                         include_entire_dag, files_outside_workspace);
+                         include_entire_dag, shared_dir_name, files_outside_workspace);
         // new: deal with the fact that certain kinds of rule relationships (e.g. rulesdot) cannot be
         // reliably detected with this program's approach to querying snakefiles
-        if (exclude_rules.find((*iter)->get_rule_name()) == exclude_rules.end() &&
-            (include_rules.empty() || include_rules.find((*iter)->get_rule_name()) != include_rules.end()) &&
-            (update_snakefiles || update_added_content || update_inputs || update_outputs)) {
-          std::vector<std::string> snakemake_exec;
-          snakemake_exec =
-              exec("cd " + (test_parent_path / (*iter)->get_rule_name() / "workspace").string() + " && snakemake -nFs" +
-                       sf.get_snakefile_relative_path().string() + " --directory " + pipeline_run_dir.string(),
-                   false);
-          // try to find snakemake errors that report rules missing from dag
+        if (rule_included && update_content) {
+          // try to find snakemake errors that report rules missing from dag. the first one
+          // is all a retry needs, so the dry run is stopped there rather than left to finish
+          std::deque<std::string> recent_output;
+          bool found_error = false, found_permitted_error = false;
           unsigned initial_missing_count = missing_rules.size();
-          find_missing_rules(snakemake_exec, &missing_rules);
+          exec_streaming(
+              "cd " + (rule_staging_path / "workspace").string() + " && snakemake -nFs" +
+                  sf.get_snakefile_relative_path().string() + " --directory " + pipeline_run_dir.string(),
+              [&](const std::string &line) {
+                recent_output.push_back(line);
+                if (recent_output.size() > DRYRUN_LOGGED_LINES) recent_output.pop_front();
+                found_permitted_error = find_missing_rule(line, &missing_rules, &found_error);
+                return !found_permitted_error;
+              },
+              false);
+          if (found_error && !found_permitted_error) {
+            report_unhandled_dryrun_error(recent_output);
+          }
           if (missing_rules.size() == initial_missing_count) {
             deployment_successful = true;
           } else {
@@ -212,52 +390,317 @@ void snakemake_unit_tests::solved_rules::emit_tests(
           std::cout << "\truleset has been adjusted for rules./checkpoint features; trying again..." << std::endl;
         }
       } while (!deployment_successful);
-      test_history[(*iter)->get_rule_name()] = true;
+      test_history.set(rule_id);
       // remove evidence of having run snakemake in-place
-      boost::filesystem::remove_all(test_parent_path / (*iter)->get_rule_name() / "workspace/.snakemake");
+      boost::filesystem::remove_all(rule_staging_path / "workspace/.snakemake");
+      // the staged copies are hashed, rather than the pipeline outputs they came from,
+      // so the manifest describes exactly what ships. partial updates without outputs
+      // keep the manifest seeded from the existing rule
+      if (rule_included && update_outputs) {
+        expected_manifest.clear();
+        expected_manifest.add_tree(rule_staging_path / "expected", "", &pool);
+        pool.wait();
+        expected_manifest.save(rule_staging_path / "expected.manifest");
+      }
+      if (archive_output) {
+        // pack the rule's content; rules without content updates keep their existing entries
+        if (update_content && boost::filesystem::is_directory(rule_staging_path)) {
+          if (boost::filesystem::is_directory(rule_staging_path / "workspace")) {
+            updated_archive.add_tree(rule_staging_path / "workspace", (*iter)->get_rule_name() + "/workspace");
+          }
+          if (boost::filesystem::is_directory(rule_staging_path / "expected")) {
+            updated_archive.add_tree(rule_staging_path / "expected", (*iter)->get_rule_name() + "/expected");
+          }
+          if (boost::filesystem::is_regular_file(rule_staging_path / "expected.manifest")) {
+            updated_archive.add_file(rule_staging_path / "expected.manifest",
+                                     (*iter)->get_rule_name() + "/expected.manifest");
+          }
+          archived_rules[(*iter)->get_rule_name()] = true;
+        }
+      } else if (boost::filesystem::is_directory(rule_staging_path) &&
+                 (update_content || !boost::filesystem::exists(rule_parent_path))) {
+        // swap the complete new version in; the old version ends up in staging
+        exchange_paths(rule_staging_path, rule_parent_path);
+      }
+      discard_tree(rule_staging_path);
+      // the test runner is likewise written in staging and renamed into place
+      boost::filesystem::path staged_test_script = staging_parent_path / ("test_" + (*iter)->get_rule_name() + ".py");
+      if (boost::filesystem::is_regular_file(staged_test_script)) {
+        boost::filesystem::rename(staged_test_script,
+                                  test_parent_path / ("test_" + (*iter)->get_rule_name() + ".py"));
+      }
     }
   }
+  if (archive_output) {
+    // carry over untouched rules without recompressing them
+    for (std::vector<archive_entry>::const_iterator iter = existing_archive.entries().begin();
+         iter != existing_archive.entries().end(); ++iter) {
+      if (archived_rules.find(iter->name.substr(0, iter->name.find('/'))) == archived_rules.end()) {
+        updated_archive.copy_entry(existing_archive, *iter);
+      }
+    }
+    existing_archive.close();
+    updated_archive.close();
+    boost::filesystem::rename(archive_tmp_path, archive_path);
+  }
   // emit common.py in the test_parent_path; no modifications needed
   if (update_pytest) {
     boost::filesystem::copy(
-        inst_common_py, test_parent_path,
+        inst_common_py, staging_parent_path / "common.py",
         boost::filesystem::copy_options::overwrite_existing | boost::filesystem::copy_options::recursive);
-    report_modified_launcher_script(test_parent_path, output_test_dir, inst_launcher_bash);
+    boost::filesystem::rename(staging_parent_path / "common.py", test_parent_path / "common.py");
+    report_modified_launcher_script(staging_parent_path, output_test_dir, inst_launcher_bash);
+    boost::filesystem::rename(staging_parent_path / "pytest_runner.bash", test_parent_path / "pytest_runner.bash");
+  }
+  boost::filesystem::remove_all(staging_parent_path);
+  // every swapped rule now links to the new shared includes; rules left alone keep theirs
+  if (!archive_output) remove_unused_shared_versions(test_parent_path);
+}
+
+void snakemake_unit_tests::solved_rules::report_plan(
+    const snakemake_file &sf, const boost::filesystem::path &pipeline_top_dir,
+    const boost::filesystem::path &pipeline_run_dir, const std::map<std::string, bool> &include_rules,
+    const std::map<std::string, bool> &exclude_rules, const std::vector<boost::filesystem::path> &added_files,
+    const std::vector<boost::filesystem::path> &added_directories, bool update_snakefiles, bool update_added_content,
+    bool update_inputs, bool update_outputs, bool include_entire_dag, bool json_output, std::ostream &out) const {
+  bool update_content = update_snakefiles || update_added_content || update_inputs || update_outputs;
+  // count snakefiles that would be emitted per rule, and the deepest chain of files with
+  // include directives that were not resolved statically. sibling includes are resolved
+  // together, so each file along such a chain adds about one python resolution pass
+  unsigned n_snakefiles = 0, include_depth = 0;
+  std::deque<std::pair<const snakemake_file *, unsigned>> pending_files;
+  pending_files.push_back(std::make_pair(&sf, 0u));
+  while (!pending_files.empty()) {
+    const snakemake_file *current = pending_files.front().first;
+    unsigned depth = pending_files.front().second;
+    pending_files.pop_front();
+    ++n_snakefiles;
+    for (std::list<boost::shared_ptr<rule_block>>::const_iterator iter = current->get_blocks().begin();
+         iter != current->get_blocks().end(); ++iter) {
+      if ((*iter)->contains_include_directive() && !(*iter)->resolved()) {
+        ++depth;
+        break;
+      }
+    }
+    if (depth > include_depth) include_depth = depth;
+    for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file>>::const_iterator iter =
+             current->loaded_files().begin();
+         iter != current->loaded_files().end(); ++iter) {
+      pending_files.push_back(std::make_pair(iter->second.get(), depth));
+    }
+  }
+
+  // resolve the fixtures of every rule before touching the filesystem,
+  // so that each distinct source is only measured once
+  std::vector<std::string> planned_rules;
+  std::map<std::string, std::map<boost::filesystem::path, bool>> rule_sources;
+  std::map<std::string, std::vector<std::string>> files_outside_workspace;
+  rule_registry registry(sf);
+  register_recipes(&registry);
+  rule_set selected_rules = registry.select(include_rules, exclude_rules);
+  rule_set test_history = registry.empty_set();
+  unsigned rule_id = 0;
+  for (std::vector<boost::shared_ptr<recipe>>::const_iterator iter = _recipes.begin(); iter != _recipes.end(); ++iter) {
+    const std::string &rule_name = (*iter)->get_rule_name();
+    registry.find(rule_name, &rule_id);
+    if (test_history.test(rule_id)) continue;
+    test_history.set(rule_id);
+    if (!selected_rules.test(rule_id)) continue;
+    planned_rules.push_back(rule_name);
+    std::map<boost::filesystem::path, bool> &sources = rule_sources[rule_name];
+    std::map<boost::shared_ptr<recipe>, bool> dependent_recipes;
+    dependent_recipes[*iter] = true;
+    if (include_entire_dag) {
+      add_dag_from_leaf(*iter, include_entire_dag, &dependent_recipes);
+    }
+    if (update_outputs) {
+      plan_contents((*iter)->get_outputs(), pipeline_top_dir / pipeline_run_dir, rule_name, &sources,
+                    &files_outside_workspace);
+    }
+    if (update_inputs) {
+      for (std::map<boost::shared_ptr<recipe>, bool>::const_iterator dep_iter = dependent_recipes.begin();
+           dep_iter != dependent_recipes.end(); ++dep_iter) {
+        plan_contents(!dep_iter->first->get_rule_name().compare(rule_name) ? dep_iter->first->get_inputs()
+                                                                           : dep_iter->first->get_outputs(),
+                      pipeline_top_dir / pipeline_run_dir, rule_name, &sources, &files_outside_workspace);
+      }
+    }
+    if (update_added_content) {
+      plan_contents(added_files, pipeline_top_dir, "added files", &sources, &files_outside_workspace);
+      plan_contents(added_directories, pipeline_top_dir, "added directories", &sources, &files_outside_workspace);
+    }
+  }
+
+  // bulk stat: measure each distinct source once
+  std::map<boost::filesystem::path, unsigned> source_rule_counts;
+  for (std::map<std::string, std::map<boost::filesystem::path, bool>>::const_iterator iter = rule_sources.begin();
+       iter != rule_sources.end(); ++iter) {
+    for (std::map<boost::filesystem::path, bool>::const_iterator source_iter = iter->second.begin();
+         source_iter != iter->second.end(); ++source_iter) {
+      ++source_rule_counts[source_iter->first];
+    }
+  }
+  std::map<boost::filesystem::path, std::pair<uint64_t, uint64_t>> source_sizes;
+  std::vector<boost::filesystem::path> missing_sources;
+  uint64_t unique_bytes = 0, unique_files = 0;
+  for (std::map<boost::filesystem::path, unsigned>::const_iterator iter = source_rule_counts.begin();
+       iter != source_rule_counts.end(); ++iter) {
+    uint64_t bytes = 0, files = 0;
+    if (measure_contents(iter->first, &bytes, &files)) {
+      source_sizes[iter->first] = std::make_pair(bytes, files);
+      unique_bytes += bytes;
+      unique_files += files;
+    } else {
+      missing_sources.push_back(iter->first);
+    }
+  }
+  // sources copied into more than one rule, most wasteful first
+  std::multimap<uint64_t, boost::filesystem::path, std::greater<uint64_t>> duplicated_sources;
+  for (std::map<boost::filesystem::path, unsigned>::const_iterator iter = source_rule_counts.begin();
+       iter != source_rule_counts.end(); ++iter) {
+    std::map<boost::filesystem::path, std::pair<uint64_t, uint64_t>>::const_iterator size_finder =
+        source_sizes.find(iter->first);
+    if (iter->second > 1 && size_finder != source_sizes.end()) {
+      duplicated_sources.insert(std::make_pair(size_finder->second.first * (iter->second - 1), iter->first));
+    }
+  }
+
+  // per-rule and total counts
+  std::vector<std::pair<uint64_t, uint64_t>> rule_totals;
+  uint64_t total_bytes = 0, total_files = 0;
+  unsigned rule_snakefiles = update_snakefiles ? n_snakefiles : 0;
+  unsigned rule_dry_runs = update_content ? 1 : 0;
+  for (std::vector<std::string>::const_iterator iter = planned_rules.begin(); iter != planned_rules.end(); ++iter) {
+    uint64_t bytes = 0, files = 0;
+    const std::map<boost::filesystem::path, bool> &sources = rule_sources[*iter];
+    for (std::map<boost::filesystem::path, bool>::const_iterator source_iter = sources.begin();
+         source_iter != sources.end(); ++source_iter) {
+      std::map<boost::filesystem::path, std::pair<uint64_t, uint64_t>>::const_iterator size_finder =
+          source_sizes.find(source_iter->first);
+      if (size_finder != source_sizes.end()) {
+        bytes += size_finder->second.first;
+        files += size_finder->second.second;
+      }
+    }
+    rule_totals.push_back(std::make_pair(bytes, files));
+    total_bytes += bytes;
+    total_files += files;
+  }
+  unsigned resolution_passes = sf.contains_blockers() ? 1 + include_depth : 0;
+  unsigned total_dry_runs = rule_dry_runs * planned_rules.size();
+
+  if (json_output) {
+    out << "{" << std::endl << "  \"rules\": [";
+    for (unsigned i = 0; i < planned_rules.size(); ++i) {
+      out << (i ? "," : "") << std::endl
+          << "    {\"name\": " << json_escape(planned_rules.at(i)) << ", \"files\": " << rule_totals.at(i).second
+          << ", \"bytes\": " << rule_totals.at(i).first << ", \"snakefiles\": " << rule_snakefiles
+          << ", \"snakemake_runs\": " << rule_dry_runs << "}";
+    }
+    out << std::endl << "  ]," << std::endl;
+    out << "  \"total\": {\"rules\": " << planned_rules.size() << ", \"files\": " << total_files
+        << ", \"bytes\": " << total_bytes << ", \"unique_files\": " << unique_files
+        << ", \"unique_bytes\": " << unique_bytes << ", \"duplicated_bytes\": " << (total_bytes - unique_bytes)
+        << ", \"snakefiles\": " << rule_snakefiles * planned_rules.size()
+        << ", \"estimated_resolution_passes\": " << resolution_passes << ", \"snakemake_runs\": " << total_dry_runs
+        << ", \"estimated_subprocesses\": " << resolution_passes + total_dry_runs << "}," << std::endl;
+    out << "  \"duplicated_sources\": [";
+    for (std::multimap<uint64_t, boost::filesystem::path, std::greater<uint64_t>>::const_iterator iter =
+             duplicated_sources.begin();
+         iter != duplicated_sources.end(); ++iter) {
+      out << (iter == duplicated_sources.begin() ? "" : ",") << std::endl
+          << "    {\"path\": " << json_escape(iter->second.string())
+          << ", \"rules\": " << source_rule_counts[iter->second]
+          << ", \"bytes\": " << source_sizes[iter->second].first << "}";
+    }
+    out << (duplicated_sources.empty() ? "" : "\n  ") << "]," << std::endl;
+    out << "  \"missing_sources\": [";
+    for (unsigned i = 0; i < missing_sources.size(); ++i) {
+      out << (i ? ", " : "") << json_escape(missing_sources.at(i).string());
+    }
+    out << "]," << std::endl << "  \"outside_workspace\": [";
+    for (std::map<std::string, std::vector<std::string>>::const_iterator iter = files_outside_workspace.begin();
+         iter != files_outside_workspace.end(); ++iter) {
+      out << (iter == files_outside_workspace.begin() ? "" : ", ") << json_escape(iter->first);
+    }
+    out << "]" << std::endl << "}" << std::endl;
+  } else {
+    out << "planned test emission (nothing has been written):" << std::endl;
+    for (unsigned i = 0; i < planned_rules.size(); ++i) {
+      out << "  rule \"" << planned_rules.at(i) << "\": " << rule_totals.at(i).second << " files, "
+          << rule_totals.at(i).first << " bytes, " << rule_snakefiles << " snakefiles, " << rule_dry_runs
+          << " snakemake runs" << std::endl;
+    }
+    out << "total: " << planned_rules.size() << " rules, " << total_files << " files, " << total_bytes << " bytes"
+        << std::endl;
+    out << "  distinct sources: " << unique_files << " files, " << unique_bytes << " bytes; "
+        << (total_bytes - unique_bytes) << " bytes duplicated across rules" << std::endl;
+    out << "  snakemake subprocesses, estimated: " << resolution_passes + total_dry_runs << " (" << resolution_passes
+        << " python resolution passes, " << total_dry_runs << " test dry runs)" << std::endl;
+    for (std::multimap<uint64_t, boost::filesystem::path, std::greater<uint64_t>>::const_iterator iter =
+             duplicated_sources.begin();
+         iter != duplicated_sources.end(); ++iter) {
+      out << "  duplicated: \"" << iter->second.string() << "\" is copied into " << source_rule_counts[iter->second]
+          << " rules (" << source_sizes[iter->second].first << " bytes each)" << std::endl;
+    }
+    for (std::vector<boost::filesystem::path>::const_iterator iter = missing_sources.begin();
+         iter != missing_sources.end(); ++iter) {
+      out << "  missing: \"" << iter->string() << "\" does not exist, and test emission will fail" << std::endl;
+    }
+    for (std::map<std::string, std::vector<std::string>>::const_iterator iter = files_outside_workspace.begin();
+         iter != files_outside_workspace.end(); ++iter) {
+      out << "  outside workspace: \"" << iter->first << "\" will not be copied" << std::endl;
+    }
   }
 }
 
 void snakemake_unit_tests::solved_rules::find_missing_rules(const std::vector<std::string> &snakemake_exec,
                                                             std::map<std::string, bool> *target) const {
   if (!target) throw std::runtime_error("null pointer to solved_rules::find_missing_rules");
-  // target error pattern is: "'(Rules|Checkpoints)' object has no attribute 'RULENAME'"
-  const boost::regex rule_missing("^.*'Rules' object has no attribute '([^']+)'.*\n$");
-  const boost::regex checkpoint_missing("^.*'Checkpoints' object has no attribute '([^']+)'.*\n$");
-  const boost::regex any_error("^.*[eE][xX][cC][eE][pP][tT][iI][oO][nN].*\n?$");
   bool found_error = false, found_permitted_error = false;
   for (std::vector<std::string>::const_iterator iter = snakemake_exec.begin(); iter != snakemake_exec.end(); ++iter) {
-    boost::smatch regex_result;
-    if (boost::regex_match(*iter, regex_result, rule_missing) ||
-        boost::regex_match(*iter, regex_result, checkpoint_missing)) {
-      target->insert(std::make_pair(regex_result[1].str(), true));
+    if (find_missing_rule(*iter, target, &found_error)) {
       found_permitted_error = true;
     }
-    if (boost::regex_match(*iter, regex_result, any_error)) {
-      found_error = true;
-    }
   }
   if (found_error && !found_permitted_error) {
-    for (std::vector<std::string>::const_iterator iter = snakemake_exec.begin(); iter != snakemake_exec.end(); ++iter) {
-      std::cerr << *iter;
-    }
-    throw std::runtime_error(
-        "snakemake dryrun found unhandled error, indicating something wrong with either "
-        "the configuration of this run or the internal logic of snakemake_unit_tests; "
-        "please inspect the logging information above to determine which. in particular, "
-        "any message about missing infrastructure files from this workflow (e.g. config.yaml) "
-        "may indicate that you need to add more things to added-files or added-directories, "
-        "for files that are necessary for pipeline functionality but that exist outside "
-        "of the DAG.");
+    report_unhandled_dryrun_error(std::deque<std::string>(snakemake_exec.begin(), snakemake_exec.end()));
+  }
+}
+
+bool snakemake_unit_tests::solved_rules::find_missing_rule(const std::string &line, std::map<std::string, bool> *target,
+                                                           bool *found_error) const {
+  if (!target || !found_error) throw std::runtime_error("null pointer to solved_rules::find_missing_rule");
+  // target error pattern is: "'(Rules|Checkpoints)' object has no attribute 'RULENAME'"
+  static const boost::regex rule_missing("^.*'Rules' object has no attribute '([^']+)'.*\n$");
+  static const boost::regex checkpoint_missing("^.*'Checkpoints' object has no attribute '([^']+)'.*\n$");
+  static const boost::regex any_error("^.*[eE][xX][cC][eE][pP][tT][iI][oO][nN].*\n?$");
+  boost::smatch regex_result;
+  bool found_missing = false;
+  if (boost::regex_match(line, regex_result, rule_missing) ||
+      boost::regex_match(line, regex_result, checkpoint_missing)) {
+    target->insert(std::make_pair(regex_result[1].str(), true));
+    found_missing = true;
+  }
+  if (boost::regex_match(line, regex_result, any_error)) {
+    *found_error = true;
+  }
+  return found_missing;
+}
+
+void snakemake_unit_tests::solved_rules::report_unhandled_dryrun_error(
+    const std::deque<std::string> &snakemake_exec) const {
+  for (std::deque<std::string>::const_iterator iter = snakemake_exec.begin(); iter != snakemake_exec.end(); ++iter) {
+    std::cerr << *iter;
   }
+  throw std::runtime_error(
+      "snakemake dryrun found unhandled error, indicating something wrong with either "
+      "the configuration of this run or the internal logic of snakemake_unit_tests; "
+      "please inspect the logging information above to determine which. in particular, "
+      "any message about missing infrastructure files from this workflow (e.g. config.yaml) "
+      "may indicate that you need to add more things to added-files or added-directories, "
+      "for files that are necessary for pipeline functionality but that exist outside "
+      "of the DAG.");
 }
 
 void snakemake_unit_tests::solved_rules::add_dag_from_leaf(const boost::shared_ptr<recipe> &rec,
@@ -277,35 +720,43 @@ void snakemake_unit_tests::solved_rules::add_dag_from_leaf(const boost::shared_p
   }
 }
 
+void snakemake_unit_tests::solved_rules::register_recipes(rule_registry *registry) const {
+  if (!registry) throw std::runtime_error("null pointer to register_recipes");
+  for (std::vector<boost::shared_ptr<recipe>>::const_iterator iter = _recipes.begin(); iter != _recipes.end(); ++iter) {
+    registry->intern((*iter)->get_rule_name());
+  }
+}
+
 void snakemake_unit_tests::solved_rules::create_workspace(
     const boost::shared_ptr<recipe> &rec, const snakemake_file &sf, const boost::filesystem::path &output_test_dir,
     const boost::filesystem::path &test_parent_path, const boost::filesystem::path &pipeline_top_dir,
     const boost::filesystem::path &pipeline_run_dir, const boost::filesystem::path &inst_test_py,
     const std::map<boost::shared_ptr<recipe>, bool> &extra_required_recipes,
-    const std::map<std::string, bool> &include_rules, const std::map<std::string, bool> &exclude_rules,
+    const rule_registry &registry, const rule_set &selected_rules,
     const std::vector<boost::filesystem::path> &added_files,
     const std::vector<boost::filesystem::path> &added_directories, bool update_snakefiles, bool update_added_content,
     bool update_inputs, bool update_outputs, bool update_pytest, bool include_entire_dag,
+    const std::string &shared_dir_name,
     std::map<std::string, std::vector<std::string>> *files_outside_workspace) const {
   // new: deal with rule structures that drag a certain number of upstream
   // recipes with them:
   //  - scattergather
   // formerly, this was supposed to handle rules. and checkpoints; that has been migrated elsewhere
   std::map<boost::shared_ptr<recipe>, bool> dependent_recipes = extra_required_recipes;
-  std::map<std::string, bool> dependent_rulenames;
+  rule_set dependent_rules = registry.empty_set();
   std::vector<boost::filesystem::path> extra_comparison_exclusions;
+  if (!rec->get_benchmark().empty()) extra_comparison_exclusions.push_back(rec->get_benchmark());
   dependent_recipes[rec] = true;
   if (include_entire_dag) {
     add_dag_from_leaf(rec, include_entire_dag, &dependent_recipes);
   }
   for (std::map<boost::shared_ptr<recipe>, bool>::const_iterator iter = dependent_recipes.begin();
        iter != dependent_recipes.end(); ++iter) {
-    dependent_rulenames[iter->first->get_rule_name()] = true;
+    dependent_rules.set(registered_rule_id(registry, iter->first->get_rule_name()));
   }
   // only create output if the rule has not already been hit,
   // and if the user didn't want this rule disabled
-  if (exclude_rules.find(rec->get_rule_name()) == exclude_rules.end() &&
-      (include_rules.empty() || include_rules.find(rec->get_rule_name()) != include_rules.end())) {
+  if (rule_registry::contains(selected_rules, registered_rule_id(registry, rec->get_rule_name()))) {
     std::cout << "emitting test for rule \"" << rec->get_rule_name() << "\"" << std::endl;
 
     bool update_any = update_snakefiles || update_added_content || update_inputs || update_outputs || update_pytest;
@@ -346,27 +797,29 @@ void snakemake_unit_tests::solved_rules::create_workspace(
     }
     if (update_snakefiles) {
       // new: aggregate all possible parent rules to required derived rules
-      std::deque<std::string> possible_children;
-      for (std::map<std::string, bool>::const_iterator iter = dependent_rulenames.begin();
-           iter != dependent_rulenames.end(); ++iter) {
-        possible_children.push_back(iter->first);
+      std::deque<unsigned> possible_children;
+      for (rule_set::size_type id = dependent_rules.find_first(); id != rule_set::npos;
+           id = dependent_rules.find_next(id)) {
+        possible_children.push_back(id);
       }
-      std::string parent_candidate = "";
+      unsigned parent_candidate = 0;
       while (!possible_children.empty()) {
-        if (sf.get_base_rule_name(possible_children.front(), &parent_candidate)) {
-          if (!parent_candidate.empty()) {
-            possible_children.push_back(parent_candidate);
-            dependent_rulenames[parent_candidate] = true;
-          }
-          possible_children.pop_front();
-        } else {
-          throw std::runtime_error("unable to locate required rule \"" + possible_children.front() + "\"");
+        if (!registry.get_block(possible_children.front())) {
+          throw std::runtime_error("unable to locate required rule \"" + registry.get_name(possible_children.front()) +
+                                   "\"");
+        }
+        if (registry.get_base_rule(possible_children.front(), &parent_candidate) &&
+            !dependent_rules.test(parent_candidate)) {
+          possible_children.push_back(parent_candidate);
+          dependent_rules.set(parent_candidate);
         }
+        possible_children.pop_front();
       }
       // enforce success across possibly many files by checking the sum
       // of found rules. logic only works because the postflight checker
       // enforces lack of redundant rulenames.
-      if (emit_snakefile(sf, workspace_path, rec, dependent_rulenames, true) != dependent_rulenames.size()) {
+      if (emit_snakefile(sf, workspace_path, rec, registry, dependent_rules, true, shared_dir_name) !=
+          dependent_rules.count()) {
         throw std::runtime_error("cannot find rule for requested log content \"" + rec->get_rule_name() + "\"");
       }
     }
@@ -374,7 +827,7 @@ void snakemake_unit_tests::solved_rules::create_workspace(
     if (update_pytest) {
       report_modified_test_script(test_parent_path, output_test_dir, rec->get_rule_name(),
                                   sf.get_snakefile_relative_path(), pipeline_run_dir, extra_comparison_exclusions,
-                                  inst_test_py);
+                                  rec->get_threads(), rec->get_memory_mb(), rec->get_runtime(), inst_test_py);
     }
   }
 }
@@ -382,30 +835,68 @@ void snakemake_unit_tests::solved_rules::create_workspace(
 unsigned snakemake_unit_tests::solved_rules::emit_snakefile(const snakemake_file &sf,
                                                             const boost::filesystem::path &workspace_path,
                                                             const boost::shared_ptr<recipe> &rec,
-                                                            const std::map<std::string, bool> &dependent_rulenames,
-                                                            bool requires_phony_all) const {
+                                                            const rule_registry &registry,
+                                                            const rule_set &dependent_rules, bool requires_phony_all,
+                                                            const std::string &shared_dir_name) const {
   // create parent directories for synthetic snakefile
   boost::filesystem::create_directories((workspace_path / sf.get_snakefile_relative_path()).parent_path());
-  // create the synthetic snakefile in workspace
-  std::string output_filename = (workspace_path / sf.get_snakefile_relative_path()).string();
-  std::ofstream output;
-  output.open(output_filename.c_str());
-  if (!output.is_open()) throw std::runtime_error("cannot create synthetic snakemake file \"" + output_filename + "\"");
+  // assemble the synthetic snakefile from rendered blocks, without copying them
+  std::vector<std::string_view> slices;
+  string_arena scratch;
   // before adding anything else: add a single 'all' rule that points at
   // solved rule output files
   // note: only do this at top level
-  if (requires_phony_all) report_phony_all_target(output, rec->get_outputs());
+  std::string phony_all_target;
+  if (requires_phony_all) {
+    std::ostringstream o;
+    report_phony_all_target(o, rec->get_outputs());
+    phony_all_target = o.str();
+    slices.push_back(phony_all_target);
+  }
   // find the rule from the parsed snakefile(s) and report it to file
-  unsigned res = sf.report_single_rule(dependent_rulenames, output);
-  output.close();
+  unsigned res = sf.report_single_rule(registry, dependent_rules, &scratch, &slices);
+  boost::filesystem::path output_path = workspace_path / sf.get_snakefile_relative_path();
+  // content seeded from an earlier run may be a link to shared content; never write through it
+  if (boost::filesystem::is_symlink(output_path)) boost::filesystem::remove(output_path);
+  // from workspace/<relative path>, the shared copy is up through the workspace and rule directories
+  boost::filesystem::path link_target = "..";
+  bool can_link = !shared_dir_name.empty() && !requires_phony_all && !res;
+  for (boost::filesystem::path::const_iterator iter = sf.get_snakefile_relative_path().begin();
+       can_link && iter != sf.get_snakefile_relative_path().end(); ++iter) {
+    can_link = iter->compare(".") && iter->compare("..") && iter->compare("/");
+    link_target /= "..";
+  }
+  if (can_link) {
+    boost::filesystem::create_symlink(link_target / shared_dir_name / sf.get_snakefile_relative_path(), output_path);
+  } else {
+    write_slices(output_path, slices);
+  }
   for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file>>::const_iterator mapper =
            sf.loaded_files().begin();
        mapper != sf.loaded_files().end(); ++mapper) {
-    res += emit_snakefile(*mapper->second, workspace_path, rec, dependent_rulenames, false);
+    res += emit_snakefile(*mapper->second, workspace_path, rec, registry, dependent_rules, false, shared_dir_name);
   }
   return res;
 }
 
+void snakemake_unit_tests::solved_rules::emit_shared_snakefiles(const snakemake_file &sf,
+                                                                const boost::filesystem::path &shared_path,
+                                                                const rule_registry &registry) const {
+  string_arena scratch;
+  std::vector<std::string_view> slices;
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file>>::const_iterator mapper =
+           sf.loaded_files().begin();
+       mapper != sf.loaded_files().end(); ++mapper) {
+    boost::filesystem::path output_path = shared_path / mapper->second->get_snakefile_relative_path();
+    boost::filesystem::create_directories(output_path.parent_path());
+    slices.clear();
+    // no rule is a target, so every rule is replaced by its placeholder
+    mapper->second->report_single_rule(registry, registry.empty_set(), &scratch, &slices);
+    write_slices(output_path, slices);
+    emit_shared_snakefiles(*mapper->second, shared_path, registry);
+  }
+}
+
 void snakemake_unit_tests::solved_rules::create_empty_workspace(
     const boost::filesystem::path &output_test_dir, const boost::filesystem::path &pipeline_dir,
     const std::vector<boost::filesystem::path> &added_files,
@@ -485,6 +976,121 @@ void snakemake_unit_tests::solved_rules::copy_contents(
   }
 }
 
+void snakemake_unit_tests::solved_rules::plan_contents(
+    const std::vector<boost::filesystem::path> &contents, const boost::filesystem::path &source_prefix,
+    const std::string &rule_name, std::map<boost::filesystem::path, bool> *sources,
+    std::map<std::string, std::vector<std::string>> *files_outside_workspace) const {
+  if (!sources) throw std::runtime_error("null pointer provided to plan_contents");
+  for (std::vector<boost::filesystem::path>::const_iterator iter = contents.begin(); iter != contents.end(); ++iter) {
+    boost::filesystem::path source_file = source_prefix / *iter;
+    // mirror copy_contents' handling of absolute paths
+    if (boost::filesystem::absolute(*iter) == *iter) {
+      if (!boost::filesystem::exists(*iter) ||
+          boost::filesystem::canonical(*iter).string().find(
+              boost::filesystem::canonical(boost::filesystem::absolute(source_prefix)).string()) == 0) {
+        source_file = *iter;
+      } else {
+        if (files_outside_workspace) {
+          (*files_outside_workspace)[iter->string()].push_back(rule_name);
+        }
+        continue;
+      }
+    }
+    (*sources)[source_file] = true;
+  }
+}
+
+bool snakemake_unit_tests::solved_rules::measure_contents(const boost::filesystem::path &source, uint64_t *bytes,
+                                                          uint64_t *files) const {
+  if (!bytes || !files) throw std::runtime_error("null pointer provided to measure_contents");
+  boost::system::error_code ec;
+  boost::filesystem::file_status status = boost::filesystem::status(source, ec);
+  if (boost::filesystem::is_regular_file(status)) {
+    *bytes += boost::filesystem::file_size(source);
+    ++*files;
+    return true;
+  }
+  if (boost::filesystem::is_directory(status)) {
+    boost::filesystem::recursive_directory_iterator rec_iter(source), rec_end;
+    for (; rec_iter != rec_end; ++rec_iter) {
+      if (boost::filesystem::is_regular_file(rec_iter->status())) {
+        *bytes += boost::filesystem::file_size(rec_iter->path());
+        ++*files;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+void snakemake_unit_tests::solved_rules::discard_tree(const boost::filesystem::path &target) const {
+  if (!boost::filesystem::exists(boost::filesystem::symlink_status(target))) return;
+  // emitted content may have been copied from read-only pipeline output
+  if (boost::filesystem::is_directory(boost::filesystem::symlink_status(target))) {
+    boost::filesystem::permissions(target, boost::filesystem::owner_all | boost::filesystem::add_perms);
+    boost::filesystem::recursive_directory_iterator rec_iter(target), rec_end;
+    for (; rec_iter != rec_end; ++rec_iter) {
+      if (!boost::filesystem::is_symlink(rec_iter->symlink_status())) {
+        boost::filesystem::permissions(*rec_iter, boost::filesystem::owner_all | boost::filesystem::add_perms);
+      }
+    }
+  }
+  boost::filesystem::remove_all(target);
+}
+
+std::string snakemake_unit_tests::solved_rules::next_shared_version(
+    const boost::filesystem::path &test_parent_path) const {
+  unsigned latest = 0;
+  if (boost::filesystem::is_directory(test_parent_path)) {
+    for (boost::filesystem::directory_iterator iter(test_parent_path); iter != boost::filesystem::directory_iterator();
+         ++iter) {
+      std::string name = iter->path().filename().string();
+      if (name.size() > 8 && !name.compare(0, 8, ".shared.") && name.size() - 8 < 10 &&
+          name.find_first_not_of("0123456789", 8) == std::string::npos) {
+        latest = std::max(latest, static_cast<unsigned>(std::stoul(name.substr(8))));
+      }
+    }
+  }
+  return ".shared." + std::to_string(latest + 1);
+}
+
+void snakemake_unit_tests::solved_rules::remove_unused_shared_versions(
+    const boost::filesystem::path &test_parent_path) const {
+  if (!boost::filesystem::is_directory(test_parent_path)) return;
+  // versions, including the unversioned directory written by earlier releases
+  std::vector<boost::filesystem::path> versions;
+  std::vector<boost::filesystem::path> workspaces;
+  for (boost::filesystem::directory_iterator iter(test_parent_path); iter != boost::filesystem::directory_iterator();
+       ++iter) {
+    std::string name = iter->path().filename().string();
+    if (!name.compare(".shared") || !name.compare(0, 8, ".shared.")) {
+      versions.push_back(iter->path());
+    } else if (name.compare(0, 1, ".") && boost::filesystem::is_directory(iter->path() / "workspace")) {
+      workspaces.push_back(iter->path() / "workspace");
+    }
+  }
+  if (versions.empty()) return;
+  // links point up out of the workspace and into one version
+  std::map<std::string, bool> linked;
+  for (std::vector<boost::filesystem::path>::const_iterator iter = workspaces.begin(); iter != workspaces.end();
+       ++iter) {
+    for (boost::filesystem::recursive_directory_iterator walker(*iter);
+         walker != boost::filesystem::recursive_directory_iterator(); ++walker) {
+      if (!boost::filesystem::is_symlink(walker->symlink_status())) continue;
+      boost::filesystem::path target = boost::filesystem::read_symlink(walker->path());
+      for (boost::filesystem::path::const_iterator part = target.begin(); part != target.end(); ++part) {
+        if (part->compare("..")) {
+          linked[part->string()] = true;
+          break;
+        }
+      }
+    }
+  }
+  for (std::vector<boost::filesystem::path>::const_iterator iter = versions.begin(); iter != versions.end(); ++iter) {
+    if (linked.find(iter->filename().string()) == linked.end()) discard_tree(*iter);
+  }
+}
+
 void snakemake_unit_tests::solved_rules::report_phony_all_target(
     std::ostream &out, const std::vector<boost::filesystem::path> &targets) const {
   if (!(out << "rule all:\n    input:" << std::endl))
@@ -504,8 +1110,8 @@ void snakemake_unit_tests::solved_rules::report_phony_all_target(
 void snakemake_unit_tests::solved_rules::report_modified_test_script(
     const boost::filesystem::path &parent_dir, const boost::filesystem::path &test_dir, const std::string &rule_name,
     const boost::filesystem::path &snakefile_relative_path, const boost::filesystem::path &pipeline_run_dir,
-    const std::vector<boost::filesystem::path> &extra_comparison_exclusions,
-    const boost::filesystem::path &inst_test_py) const {
+    const std::vector<boost::filesystem::path> &extra_comparison_exclusions, unsigned threads, unsigned memory_mb,
+    unsigned runtime, const boost::filesystem::path &inst_test_py) const {
   std::ifstream input;
   std::ofstream output;
   std::string test_python_file = (parent_dir / ("test_" + rule_name + ".py")).string();
@@ -526,6 +1132,10 @@ void snakemake_unit_tests::solved_rules::report_modified_test_script(
   if (!(output << "]" << std::endl))
     throw std::runtime_error("cannot close extra comparison exclusions in test python file \"" + test_python_file +
                              "\"");
+  if (!(output << "threads=" << threads << std::endl
+               << "mem_mb=" << memory_mb << std::endl
+               << "runtime=" << runtime << std::endl))
+    throw std::runtime_error("cannot write job resources to test python file \"" + test_python_file + "\"");
   input.open(inst_test_py.string().c_str());
   if (!input.is_open()) throw std::runtime_error("cannot read installed file \"" + inst_test_py.string() + "\"");
   if (!(output << input.rdbuf()))
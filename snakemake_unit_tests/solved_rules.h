@@ -10,9 +10,12 @@
 #define SNAKEMAKE_UNIT_TESTS_SOLVED_RULES_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <list>
 #include <map>
 #include <stdexcept>
 #include <string>
@@ -21,6 +24,9 @@
 
 #include "boost/regex.hpp"
 #include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/archive.h"
+#include "snakemake_unit_tests/manifest.h"
+#include "snakemake_unit_tests/rule_registry.h"
 #include "snakemake_unit_tests/snakemake_file.h"
 #include "snakemake_unit_tests/utilities.h"
 
@@ -86,6 +92,55 @@ class recipe {
     @param s new log filename
    */
   void set_log(const std::string &s);
+  /*!
+    @brief access benchmark filename
+    @return benchmark filename, if given; else empty string
+   */
+  const std::string &get_benchmark() const;
+  /*!
+    @brief set benchmark filename
+    @param s new benchmark filename
+   */
+  void set_benchmark(const std::string &s);
+  /*!
+    @brief access number of threads the job was scheduled with
+    @return number of threads; 1 if not reported
+   */
+  unsigned get_threads() const;
+  /*!
+    @brief set number of threads the job was scheduled with
+    @param n new number of threads
+   */
+  void set_threads(unsigned n);
+  /*!
+    @brief access memory the job was scheduled with
+    @return memory in megabytes; 0 if not reported
+   */
+  unsigned get_memory_mb() const;
+  /*!
+    @brief set memory the job was scheduled with
+    @param n new memory in megabytes
+   */
+  void set_memory_mb(unsigned n);
+  /*!
+    @brief access runtime the job was scheduled with
+    @return runtime in minutes; 0 if not reported
+   */
+  unsigned get_runtime() const;
+  /*!
+    @brief set runtime the job was scheduled with
+    @param n new runtime in minutes
+   */
+  void set_runtime(unsigned n);
+  /*!
+    @brief set memory and runtime from a log 'resources:' annotation
+    @param s ", " delimited list of name=value resources
+
+    memory is taken from mem_mb, or else converted from mem_mib or
+    mem_gb. resources that are missing or not yet evaluated (e.g.
+    '<TBD>' in dry runs) leave the stored values unchanged
+   */
+  void set_resources(const std::string &s);
   /*!
     @brief clear all stored contents
    */
@@ -116,6 +171,27 @@ class recipe {
     currently done with this information even if present
    */
   std::string _log;
+  /*!
+    @brief snakemake solved benchmark file for rule
+
+    only exists if rule has benchmark block; benchmark
+    timings differ by run, so the file is not compared
+   */
+  std::string _benchmark;
+  /*!
+    @brief threads snakemake scheduled the job with
+   */
+  unsigned _threads;
+  /*!
+    @brief memory in megabytes snakemake scheduled the job with;
+    0 if not reported
+   */
+  unsigned _memory_mb;
+  /*!
+    @brief runtime in minutes snakemake scheduled the job with;
+    0 if not reported
+   */
+  unsigned _runtime;
 };
 /*!
   @class solved_rules
@@ -171,9 +247,28 @@ class solved_rules {
     @param update_pytest controls whether to copy pytest infrastructure
     @param include_entire_dag controls whether to override default
     behavior and emit all rules, instead of just the target
+    @param archive_output whether to pack each rule's workspace and
+    expected trees into output_test_dir/unit/unit_tests.zip, instead of
+    leaving them as loose files under output_test_dir/unit/rulename
+    @param shared_includes whether included snakefiles that contain none
+    of a rule's targets are written once, under output_test_dir/unit/.shared.N,
+    and symlinked into each workspace. not supported with archive_output
+    @param n_threads number of threads for hashing expected output;
+    0 means one per available core
     @param files_outside_workspace for logging, a collector for
     files that exist outside of the self-contained workspace, which
     will not be copied into the self-contained unit tests
+
+    each rule's content is built under output_test_dir/unit/.staging and
+    then swapped into place, so readers always see a complete version of
+    any rule. rules that are only partially updated are seeded with their
+    existing content before updating; full updates start from scratch.
+    in archive mode, rules that are not regenerated in this run keep
+    their existing archive entries.
+
+    when outputs are updated, each rule's expected/ tree is described by a
+    sibling expected.manifest (see manifest.h). the staged expected copies
+    are hashed on worker threads once the workspace is complete.
   */
   void emit_tests(const snakemake_file &sf, const boost::filesystem::path &output_test_dir,
                   const boost::filesystem::path &pipeline_top_dir, const boost::filesystem::path &pipeline_run_dir,
@@ -182,24 +277,79 @@ class solved_rules {
                   const std::vector<boost::filesystem::path> &added_files,
                   const std::vector<boost::filesystem::path> &added_directories, bool update_snakefiles,
                   bool update_added_content, bool update_inputs, bool update_outputs, bool update_pytest,
-                  bool include_entire_dag,
+                  bool include_entire_dag, bool archive_output, bool shared_includes, unsigned n_threads,
                   std::map<std::string, std::vector<std::string> > *files_outside_workspace) const;
+  /*!
+    @brief report the work that emit_tests would perform, without
+    writing anything to disk or launching snakemake
+    @param sf snakemake_file object with rule definitions corresponding
+    to loaded log data
+    @param pipeline_top_dir parent directory of snakemake pipeline used to
+    generate corresponding log file (e.g.: X for X/workflow/Snakefile)
+    @param pipeline_run_dir directory in which pipeline was run, relative to
+    pipeline_top_dir
+    @param include_rules map of rules to include tests for; note that
+    an empty map is taken to imply that all rules are to be included except
+    for those explicitly in the exclude list
+    @param exclude_rules map of rules to skip tests for
+    @param added_files vector of additional files to add to test workspaces
+    @param added_directories vector of additional directories to add to test
+    workspaces
+    @param update_snakefiles controls whether snakefiles would be printed
+    @param update_added_content controls whether added files and
+    directories would be copied
+    @param update_inputs controls whether rule inputs would be copied
+    @param update_outputs controls whether rule outputs would be copied
+    @param include_entire_dag controls whether to override default
+    behavior and emit all rules, instead of just the target
+    @param json_output whether to report json instead of plain text
+    @param out stream to which to write report
+
+    every distinct fixture is measured exactly once, after the fixtures
+    for all rules have been resolved. sources that would be copied into
+    more than one rule's workspace are reported as duplicated. subprocess
+    counts are estimates: sibling includes share a python resolution pass,
+    but includes found in files that are not loaded yet may add passes,
+    and rules that use `rules.` notation may need more than one dry run.
+   */
+  void report_plan(const snakemake_file &sf, const boost::filesystem::path &pipeline_top_dir,
+                   const boost::filesystem::path &pipeline_run_dir, const std::map<std::string, bool> &include_rules,
+                   const std::map<std::string, bool> &exclude_rules,
+                   const std::vector<boost::filesystem::path> &added_files,
+                   const std::vector<boost::filesystem::path> &added_directories, bool update_snakefiles,
+                   bool update_added_content, bool update_inputs, bool update_outputs, bool include_entire_dag,
+                   bool json_output, std::ostream &out) const;
   /*!
     @brief emit snakefile from parsed snakemake information
     @param sf snakemake_file object with rule definitions corresponding
     to loaded log data
     @param workspace_path top level of emitted workspace
     @param rec target rule for emission
-    @param dependent_rulenames all rule names that should be included in
-    the output
+    @param registry index of loaded rules, including every rule in the log
+    @param dependent_rules all rules that should be included in the output
     @param requires_phony_all whether the file needs an all target injected.
     this should only be included at top level
+    @param shared_dir_name name of the directory holding the copies written
+    by emit_shared_snakefiles, to which included files without targets are
+    linked; empty to write every file. the workspace must be workspace_path =
+    test_parent_path/rulename/workspace, with the shared copies in
+    test_parent_path/shared_dir_name
     @return how many of the targets were found in the snakefile or its
     dependencies
   */
   unsigned emit_snakefile(const snakemake_file &sf, const boost::filesystem::path &workspace_path,
-                          const boost::shared_ptr<recipe> &rec, const std::map<std::string, bool> &dependent_rulenames,
-                          bool requires_phony_all) const;
+                          const boost::shared_ptr<recipe> &rec, const rule_registry &registry,
+                          const rule_set &dependent_rules, bool requires_phony_all,
+                          const std::string &shared_dir_name) const;
+  /*!
+    @brief write every included snakefile with all of its rules replaced by
+    placeholders, for sharing between workspaces
+    @param sf snakemake_file whose loaded includes should be written
+    @param shared_path directory in which to mirror the pipeline layout
+    @param registry index of loaded rules
+  */
+  void emit_shared_snakefiles(const snakemake_file &sf, const boost::filesystem::path &shared_path,
+                              const rule_registry &registry) const;
   /*!
     @brief create a test directory
     @param rec recipe/rule entry for which a workspace should be created
@@ -218,10 +368,10 @@ class solved_rules {
     @param extra_required_recipes map of recipes to spike into the snakefile
     in addition to target rule. this is the intended injection point for
     ad hoc `rules.`-style rule handling
-    @param include_rules map of rules to include tests for; note that an
-    empty map implies that all rules are to be included, except for those
-    explicitly flagged in the exclude set
-    @param exclude_rules map of rules to skip tests for
+    @param registry index of loaded rules, including every rule in the log
+    (see register_recipes)
+    @param selected_rules rules to emit tests for, after applying the
+    include and exclude configuration
     @param added_files vector of additional files to add to test workspaces
     @param added_directories vector of additional directories to add to test
     workspaces
@@ -233,6 +383,9 @@ class solved_rules {
     @param update_pytest controls whether to copy pytest infrastructure
     @param include_entire_dag controls whether to override default
     behavior and emit all rules, instead of just the target
+    @param shared_dir_name name of the directory under test_parent_path
+    from which included snakefiles without target rules are symlinked;
+    empty to write them instead
     @param files_outside_workspace for logging, a collector for
     files that exist outside of the self-contained workspace, which
     will not be copied into the self-contained unit tests
@@ -242,12 +395,11 @@ class solved_rules {
                         const boost::filesystem::path &pipeline_top_dir,
                         const boost::filesystem::path &pipeline_run_dir, const boost::filesystem::path &test_inst_py,
                         const std::map<boost::shared_ptr<recipe>, bool> &extra_required_recipes,
-                        const std::map<std::string, bool> &include_rules,
-                        const std::map<std::string, bool> &exclude_rules,
+                        const rule_registry &registry, const rule_set &selected_rules,
                         const std::vector<boost::filesystem::path> &added_files,
                         const std::vector<boost::filesystem::path> &added_directories, bool update_snakefiles,
                         bool update_added_content, bool update_inputs, bool update_outputs, bool update_pytest,
-                        bool include_entire_dag,
+                        bool include_entire_dag, const std::string &shared_dir_name,
                         std::map<std::string, std::vector<std::string> > *files_outside_workspace) const;
   /*!
     @brief create an empty workspace for python testing
@@ -288,6 +440,50 @@ class solved_rules {
                      const boost::filesystem::path &target_prefix, const std::string &rule_name,
                      std::map<std::string, std::vector<std::string> > *files_outside_workspace) const;
 
+  /*!
+    @brief resolve the files/folders that copy_contents would copy, without copying them
+    @param contents files or folders to be copied
+    @param source_prefix parent directory of source files/folders
+    @param rule_name label for outside workspace reporting
+    @param sources collector for resolved source paths
+    @param files_outside_workspace for logging, a collector for
+    files that exist outside of the self-contained workspace
+   */
+  void plan_contents(const std::vector<boost::filesystem::path> &contents, const boost::filesystem::path &source_prefix,
+                     const std::string &rule_name, std::map<boost::filesystem::path, bool> *sources,
+                     std::map<std::string, std::vector<std::string> > *files_outside_workspace) const;
+  /*!
+    @brief measure the regular files in a file or directory tree
+    @param source file or directory to measure
+    @param bytes total size of regular files found
+    @param files number of regular files found
+    @return whether the source exists as a file or directory
+   */
+  bool measure_contents(const boost::filesystem::path &source, uint64_t *bytes, uint64_t *files) const;
+
+  /*!
+    @brief recursively remove a file or directory, including read-only content
+    @param target file or directory to remove; need not exist
+   */
+  void discard_tree(const boost::filesystem::path &target) const;
+
+  /*!
+    @brief choose the name of a new version of the shared includes
+    @param test_parent_path directory holding the rule directories
+    @return '.shared.N', with N one more than any version already present
+
+    each regeneration writes a new version, and a rule's links only move
+    to it when the rule itself is swapped into place, so a test never sees
+    old rule snakefiles with new shared includes, or the reverse
+   */
+  std::string next_shared_version(const boost::filesystem::path &test_parent_path) const;
+
+  /*!
+    @brief remove versions of the shared includes that no workspace links to
+    @param test_parent_path directory holding the rule directories
+   */
+  void remove_unused_shared_versions(const boost::filesystem::path &test_parent_path) const;
+
   /*!
     @brief report phony all target controlling test snakemake run
     @param out stream to which to write data
@@ -303,12 +499,18 @@ class solved_rules {
     @param pipeline_run_dir relative path of snakemake execution within pipeline
     @param extra_comparison_exclusions vector of files to exclude from pytest
     comparisons
+    @param threads threads the rule's job was scheduled with
+    @param memory_mb memory in megabytes the rule's job was scheduled with;
+    0 if not reported
+    @param runtime runtime in minutes the rule's job was scheduled with;
+    0 if not reported
     @param inst_test_py snakemake_unit_tests test.py script location
    */
   void report_modified_test_script(const boost::filesystem::path &parent_dir, const boost::filesystem::path &test_dir,
                                    const std::string &rule_name, const boost::filesystem::path &snakefile_relative_path,
                                    const boost::filesystem::path &pipeline_run_dir,
                                    const std::vector<boost::filesystem::path> &extra_comparison_exclusions,
+                                   unsigned threads, unsigned memory_mb, unsigned runtime,
                                    const boost::filesystem::path &inst_test_py) const;
   /*!
     @brief copy over helper launcher with certain additions
@@ -327,6 +529,19 @@ class solved_rules {
     this fallback method is designed specifically to handle toxic uses of snakemake `rules.` notation
    */
   void find_missing_rules(const std::vector<std::string> &snakemake_exec, std::map<std::string, bool> *target) const;
+  /*!
+    @brief inspect one line of test snakemake output for a rule missing from dag
+    @param line line of snakemake output, including its newline
+    @param target where to add the rule name, if the line reports a missing rule
+    @param found_error set if the line reports any exception
+    @return whether the line reports a missing rule
+   */
+  bool find_missing_rule(const std::string &line, std::map<std::string, bool> *target, bool *found_error) const;
+  /*!
+    @brief report output of a test snakemake run that failed for an unhandled reason
+    @param snakemake_exec stored output of test snakemake execution, or its most recent lines
+   */
+  void report_unhandled_dryrun_error(const std::deque<std::string> &snakemake_exec) const;
   /*!
     @brief add rules and all dependencies starting from a particular leaf
     @param rec leaf to start adding things from
@@ -336,6 +551,12 @@ class solved_rules {
    */
   void add_dag_from_leaf(const boost::shared_ptr<recipe> &rec, bool include_entire_dag,
                          std::map<boost::shared_ptr<recipe>, bool> *target) const;
+  /*!
+    @brief give every rule named in the log an identifier
+    @param registry registry to extend; rules the loaded snakefiles
+    do not define are registered without a defining block
+   */
+  void register_recipes(rule_registry *registry) const;
 
  private:
   friend class solved_rulesTest;
@@ -30,6 +30,10 @@ void snakemake_unit_tests::solved_rulesTest::test_recipe_default_constructor() {
   CPPUNIT_ASSERT(r._inputs.empty());
   CPPUNIT_ASSERT(r._outputs.empty());
   CPPUNIT_ASSERT(r._log.empty());
+  CPPUNIT_ASSERT(r._benchmark.empty());
+  CPPUNIT_ASSERT(r._threads == 1);
+  CPPUNIT_ASSERT(r._memory_mb == 0);
+  CPPUNIT_ASSERT(r._runtime == 0);
 }
 void snakemake_unit_tests::solved_rulesTest::test_recipe_copy_constructor() {
   recipe r;
@@ -39,6 +43,10 @@ void snakemake_unit_tests::solved_rulesTest::test_recipe_copy_constructor() {
   r._outputs.push_back("output1");
   r._outputs.push_back("output2");
   r._log = "logname";
+  r._benchmark = "benchname";
+  r._threads = 4;
+  r._memory_mb = 2000;
+  r._runtime = 30;
   recipe s(r);
   CPPUNIT_ASSERT(!s._rule_name.compare("rulename"));
   CPPUNIT_ASSERT(s._inputs.size() == 2);
@@ -47,6 +55,10 @@ void snakemake_unit_tests::solved_rulesTest::test_recipe_copy_constructor() {
   CPPUNIT_ASSERT(!s._outputs.at(0).string().compare("output1"));
   CPPUNIT_ASSERT(!s._outputs.at(1).string().compare("output2"));
   CPPUNIT_ASSERT(!s._log.compare("logname"));
+  CPPUNIT_ASSERT(!s._benchmark.compare("benchname"));
+  CPPUNIT_ASSERT(s._threads == 4);
+  CPPUNIT_ASSERT(s._memory_mb == 2000);
+  CPPUNIT_ASSERT(s._runtime == 30);
 }
 void snakemake_unit_tests::solved_rulesTest::test_recipe_get_rule_name() {
   recipe r;
@@ -119,6 +131,69 @@ void snakemake_unit_tests::solved_rulesTest::test_recipe_set_log() {
   r.set_log("othername");
   CPPUNIT_ASSERT(!r._log.compare("othername"));
 }
+void snakemake_unit_tests::solved_rulesTest::test_recipe_get_benchmark() {
+  recipe r;
+  CPPUNIT_ASSERT(r.get_benchmark().empty());
+  r._benchmark = "benchname";
+  CPPUNIT_ASSERT(!r.get_benchmark().compare("benchname"));
+}
+void snakemake_unit_tests::solved_rulesTest::test_recipe_set_benchmark() {
+  recipe r;
+  r.set_benchmark("benchname");
+  CPPUNIT_ASSERT(!r._benchmark.compare("benchname"));
+}
+void snakemake_unit_tests::solved_rulesTest::test_recipe_get_threads() {
+  recipe r;
+  CPPUNIT_ASSERT(r.get_threads() == 1);
+  r._threads = 8;
+  CPPUNIT_ASSERT(r.get_threads() == 8);
+}
+void snakemake_unit_tests::solved_rulesTest::test_recipe_set_threads() {
+  recipe r;
+  r.set_threads(8);
+  CPPUNIT_ASSERT(r._threads == 8);
+}
+void snakemake_unit_tests::solved_rulesTest::test_recipe_get_memory_mb() {
+  recipe r;
+  CPPUNIT_ASSERT(!r.get_memory_mb());
+  r._memory_mb = 4000;
+  CPPUNIT_ASSERT(r.get_memory_mb() == 4000);
+}
+void snakemake_unit_tests::solved_rulesTest::test_recipe_set_memory_mb() {
+  recipe r;
+  r.set_memory_mb(4000);
+  CPPUNIT_ASSERT(r._memory_mb == 4000);
+}
+void snakemake_unit_tests::solved_rulesTest::test_recipe_get_runtime() {
+  recipe r;
+  CPPUNIT_ASSERT(!r.get_runtime());
+  r._runtime = 90;
+  CPPUNIT_ASSERT(r.get_runtime() == 90);
+}
+void snakemake_unit_tests::solved_rulesTest::test_recipe_set_runtime() {
+  recipe r;
+  r.set_runtime(90);
+  CPPUNIT_ASSERT(r._runtime == 90);
+}
+void snakemake_unit_tests::solved_rulesTest::test_recipe_set_resources() {
+  recipe r;
+  r.set_resources("tmpdir=/tmp, mem_mb=2000, mem_mib=1908, disk_mb=1000, runtime=30");
+  CPPUNIT_ASSERT(r._memory_mb == 2000);
+  CPPUNIT_ASSERT(r._runtime == 30);
+  // memory in other units is converted to megabytes, rounding up
+  r.set_resources("mem_mib=954");
+  CPPUNIT_ASSERT(r._memory_mb == 1001);
+  r.set_resources("mem_gb=3");
+  CPPUNIT_ASSERT(r._memory_mb == 3000);
+  CPPUNIT_ASSERT(r._runtime == 30);
+  // unevaluated or missing resources leave stored values unchanged
+  r.set_resources("tmpdir=<TBD>, mem_mb=<TBD>, runtime=<TBD>");
+  CPPUNIT_ASSERT(r._memory_mb == 3000);
+  CPPUNIT_ASSERT(r._runtime == 30);
+  r.set_resources("whatever");
+  CPPUNIT_ASSERT(r._memory_mb == 3000);
+  CPPUNIT_ASSERT(r._runtime == 30);
+}
 void snakemake_unit_tests::solved_rulesTest::test_recipe_clear() {
   recipe r;
   r._rule_name = "rulename";
@@ -127,11 +202,19 @@ void snakemake_unit_tests::solved_rulesTest::test_recipe_clear() {
   r._outputs.push_back("output1");
   r._outputs.push_back("output2");
   r._log = "logname";
+  r._benchmark = "benchname";
+  r._threads = 4;
+  r._memory_mb = 2000;
+  r._runtime = 30;
   r.clear();
   CPPUNIT_ASSERT(r._rule_name.empty());
   CPPUNIT_ASSERT(r._inputs.empty());
   CPPUNIT_ASSERT(r._outputs.empty());
   CPPUNIT_ASSERT(r._log.empty());
+  CPPUNIT_ASSERT(r._benchmark.empty());
+  CPPUNIT_ASSERT(r._threads == 1);
+  CPPUNIT_ASSERT(r._memory_mb == 0);
+  CPPUNIT_ASSERT(r._runtime == 0);
 }
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_default_constructor() {
   solved_rules sr;
@@ -158,6 +241,9 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file() {
       "    input: input1, input2\n"
       "    output: output.tsv\n"
       "    log: logfile\n"
+      "    benchmark: benchmarks/rulename1.tsv\n"
+      "    threads: 4\n"
+      "    resources: tmpdir=/tmp, mem_mb=2000, mem_mib=1908, disk_mb=1000, disk_mib=954, runtime=30\n"
       "[Mon Jun 50 14:65:01 2022]\n"
       "checkpoint checkpointname:\n"
       "    input: input3\n"
@@ -192,12 +278,19 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file() {
   CPPUNIT_ASSERT(sr._recipes.at(0)->_outputs.size() == 1);
   CPPUNIT_ASSERT(!sr._recipes.at(0)->_outputs.at(0).string().compare("output.tsv"));
   CPPUNIT_ASSERT(!sr._recipes.at(0)->_log.compare("logfile"));
+  CPPUNIT_ASSERT(!sr._recipes.at(0)->_benchmark.compare("benchmarks/rulename1.tsv"));
+  CPPUNIT_ASSERT(sr._recipes.at(0)->_threads == 4);
+  CPPUNIT_ASSERT(sr._recipes.at(0)->_memory_mb == 2000);
+  CPPUNIT_ASSERT(sr._recipes.at(0)->_runtime == 30);
   CPPUNIT_ASSERT(!sr._recipes.at(1)->_rule_name.compare("checkpointname"));
   CPPUNIT_ASSERT(sr._recipes.at(1)->_inputs.size() == 1);
   CPPUNIT_ASSERT(!sr._recipes.at(1)->_inputs.at(0).string().compare("input3"));
   CPPUNIT_ASSERT(sr._recipes.at(1)->_outputs.size() == 1);
   CPPUNIT_ASSERT(!sr._recipes.at(1)->_outputs.at(0).string().compare("output2.tsv"));
   CPPUNIT_ASSERT(sr._recipes.at(1)->_log.empty());
+  CPPUNIT_ASSERT(sr._recipes.at(1)->_threads == 1);
+  CPPUNIT_ASSERT(sr._recipes.at(1)->_memory_mb == 0);
+  CPPUNIT_ASSERT(sr._recipes.at(1)->_runtime == 0);
   CPPUNIT_ASSERT(sr._output_lookup.size() == 2);
   CPPUNIT_ASSERT(sr._output_lookup.find("output.tsv") != sr._output_lookup.end());
   CPPUNIT_ASSERT(sr._output_lookup["output.tsv"] == sr._recipes.at(0));
@@ -412,7 +505,7 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_tests() {
   try {
     sr.emit_tests(*sf1, testdir, pipeline_top_dir, pipeline_run_dir, tmp_parent / "inst", include_rules, exclude_rules,
                   added_files, added_directories, update_snakefiles, update_added_content, update_inputs,
-                  update_outputs, update_pytest, include_entire_dag, &files_outside_workspace);
+                  update_outputs, update_pytest, include_entire_dag, false, false, 1, &files_outside_workspace);
   } catch (...) {
     std::cout.rdbuf(previous_buffer);
     throw;
@@ -436,6 +529,16 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_tests() {
   CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / "myrule1" / "workspace" / "extra_stuff"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule1" / "workspace" / "extra_stuff" / "file1.tsv"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule1.py"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule1" / "expected.manifest"));
+  manifest m;
+  m.load(unitdir / "myrule1" / "expected.manifest");
+  CPPUNIT_ASSERT(m.entries().size() == 1U);
+  CPPUNIT_ASSERT(m.entries().find("workflow/results/output1.tsv") != m.entries().end());
+  CPPUNIT_ASSERT(m.entries().find("workflow/results/output1.tsv")->second.size == 0U);
+  // the manifest describes the staged expected copy, not the pipeline output it came from
+  CPPUNIT_ASSERT(m.entries().find("workflow/results/output1.tsv")->second.mtime ==
+                 boost::filesystem::last_write_time(unitdir / "myrule1" / "expected" / "workflow" / "results" /
+                                                    "output1.tsv"));
   CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / "myrule2"));
   CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / "myrule2" / "workspace"));
   CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / "myrule2" / "expected"));
@@ -452,7 +555,314 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_tests() {
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule2.py"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "common.py"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "pytest_runner.bash"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / ".staging"));
+
+  // a partial update is staged on top of the existing content before being swapped in,
+  // so content that is not being updated survives; a full update starts from scratch
+  output.open((unitdir / "myrule1" / "workspace" / "marker.txt").string().c_str());
+  output.close();
+  output.clear();
+  // an expected file changed after generation no longer matches its manifest entry,
+  // and carrying it through a partial update must not make it match again
+  boost::filesystem::last_write_time(unitdir / "myrule1" / "expected" / "workflow" / "results" / "output1.tsv",
+                                     1600000000);
+  // output of an earlier run inside the rule directory is not carried over, while
+  // a test running from unit/.run is outside the swapped tree and left alone
+  boost::filesystem::create_directories(unitdir / "myrule1" / "output");
+  boost::filesystem::create_directories(unitdir / ".run" / "myrule1" / "output");
+  include_rules["myrule1"] = true;
+  previous_buffer = std::cout.rdbuf(observed.rdbuf());
+  try {
+    sr.emit_tests(*sf1, testdir, pipeline_top_dir, pipeline_run_dir, tmp_parent / "inst", include_rules, exclude_rules,
+                  added_files, added_directories, true, false, false, false, false, include_entire_dag, false, false, 1,
+                  &files_outside_workspace);
+    CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule1" / "workspace" / "marker.txt"));
+    CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule1" / "expected.manifest"));
+    CPPUNIT_ASSERT(boost::filesystem::last_write_time(unitdir / "myrule1" / "expected" / "workflow" / "results" /
+                                                      "output1.tsv") == 1600000000);
+    m.load(unitdir / "myrule1" / "expected.manifest");
+    CPPUNIT_ASSERT(m.entries().find("workflow/results/output1.tsv")->second.mtime != 1600000000);
+    CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / "myrule1" / "output"));
+    CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / ".run" / "myrule1" / "output"));
+    CPPUNIT_ASSERT(
+        boost::filesystem::is_regular_file(unitdir / "myrule1" / "workspace" / "workflow" / "results" / "input1.tsv"));
+    CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule1" / "workspace" / "workflow" / "Snakefile"));
+    CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule1.py"));
+    CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / ".staging"));
+    sr.emit_tests(*sf1, testdir, pipeline_top_dir, pipeline_run_dir, tmp_parent / "inst", include_rules, exclude_rules,
+                  added_files, added_directories, update_snakefiles, update_added_content, update_inputs,
+                  update_outputs, update_pytest, include_entire_dag, false, false, 1, &files_outside_workspace);
+  } catch (...) {
+    std::cout.rdbuf(previous_buffer);
+    throw;
+  }
+  std::cout.rdbuf(previous_buffer);
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / "myrule1" / "workspace" / "marker.txt"));
+  CPPUNIT_ASSERT(
+      boost::filesystem::is_regular_file(unitdir / "myrule1" / "expected" / "workflow" / "results" / "output1.tsv"));
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / "myrule2"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / ".staging"));
+  // shared includes are published next to the rule directories, and staging is still cleaned up
+  previous_buffer = std::cout.rdbuf(observed.rdbuf());
+  try {
+    sr.emit_tests(*sf1, testdir, pipeline_top_dir, pipeline_run_dir, tmp_parent / "inst", include_rules, exclude_rules,
+                  added_files, added_directories, true, false, false, false, false, include_entire_dag, false, true, 1,
+                  &files_outside_workspace);
+  } catch (...) {
+    std::cout.rdbuf(previous_buffer);
+    throw;
+  }
+  std::cout.rdbuf(previous_buffer);
+  // with no included snakefiles, nothing links to the new version of the shared includes, so it is not kept
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / ".shared.1"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / ".shared.1.staged"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule1" / "workspace" / "workflow" / "Snakefile"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / ".staging"));
+}
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_tests_archive() {
+  /*
+    archive mode runs the same logic as directory mode, but packs each rule's
+    trees into unit/unit_tests.zip and removes the loose copies. a second,
+    partial run restricted to one rule should leave the other rule's entries
+    untouched.
+   */
+  boost::shared_ptr<recipe> rec1(new recipe), rec2(new recipe);
+  rec1->_rule_name = "myrule1";
+  rec1->_inputs.push_back("results/input1.tsv");
+  rec1->_outputs.push_back("results/output1.tsv");
+  rec2->_rule_name = "myrule2";
+  rec2->_inputs.push_back("results/output1.tsv");
+  rec2->_outputs.push_back("results/output2.tsv");
+  boost::shared_ptr<snakemake_file> sf1(new snakemake_file);
+  boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block);
+  rb1->_rule_name = "myrule1";
+  rb1->_named_blocks.push_back(std::make_pair("input", " \"results/input1.tsv\","));
+  rb1->_named_blocks.push_back(std::make_pair("output", " \"results/output1.tsv\","));
+  rb1->_queried_by_python = true;
+  rb1->_resolution = RESOLVED_INCLUDED;
+  rb2->_rule_name = "myrule2";
+  rb2->_named_blocks.push_back(std::make_pair("input", " \"results/output1.tsv\","));
+  rb2->_named_blocks.push_back(std::make_pair("output", " \"results/output2.tsv\","));
+  rb2->_queried_by_python = true;
+  rb2->_resolution = RESOLVED_INCLUDED;
+  sf1->_blocks.push_back(rb1);
+  sf1->_blocks.push_back(rb2);
+  sf1->_snakefile_relative_path = "workflow/Snakefile";
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path testdir = tmp_parent / ".tests";
+  boost::filesystem::path unitdir = testdir / "unit";
+  boost::filesystem::path pipeline_top_dir = tmp_parent / "pipeline";
+  boost::filesystem::path pipeline_run_dir = "workflow";
+  boost::filesystem::path inst_test_py = tmp_parent / "inst" / "test.py";
+  std::map<boost::shared_ptr<recipe>, bool> extra_required_recipes;
+  std::map<std::string, bool> include_rules, exclude_rules;
+  std::vector<boost::filesystem::path> added_files, added_directories;
+  bool update_snakefiles = true, update_added_content = true, update_inputs = true, update_outputs = true,
+       update_pytest = true, include_entire_dag = false;
+  std::map<std::string, std::vector<std::string> > files_outside_workspace;
+
+  added_files.push_back("file2.tsv");
+  added_directories.push_back("extra_stuff");
+
+  boost::filesystem::create_directories(pipeline_top_dir / pipeline_run_dir / "results");
+  boost::filesystem::create_directories(tmp_parent / "inst");
+  boost::filesystem::create_directories(pipeline_top_dir / "extra_stuff");
+
+  std::ofstream output;
+  output.open(inst_test_py.string().c_str());
+  output << "inst test py content goes here" << std::endl;
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / pipeline_run_dir / "results" / "input1.tsv").string().c_str());
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / pipeline_run_dir / "results" / "output1.tsv").string().c_str());
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / pipeline_run_dir / "results" / "output2.tsv").string().c_str());
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / "extra_stuff" / "file1.tsv").string().c_str());
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / "file2.tsv").string().c_str());
+  output.close();
+  output.clear();
+  output.open((tmp_parent / "inst" / "pytest_runner.bash").string().c_str());
+  output << "pytest runner content goes here" << std::endl;
+  output.close();
+  output.clear();
+  output.open((tmp_parent / "inst" / "common.py").string().c_str());
+  output << "common py content goes here" << std::endl;
+  output.close();
+  output.clear();
+
+  solved_rules sr;
+  sr._recipes.push_back(rec1);
+  sr._recipes.push_back(rec2);
+  sr._output_lookup["output1.tsv"] = rec1;
+  sr._output_lookup["output2.tsv"] = rec2;
+
+  std::ostringstream observed;
+  std::streambuf *previous_buffer(std::cout.rdbuf(observed.rdbuf()));
+
+  try {
+    sr.emit_tests(*sf1, testdir, pipeline_top_dir, pipeline_run_dir, tmp_parent / "inst", include_rules, exclude_rules,
+                  added_files, added_directories, update_snakefiles, update_added_content, update_inputs,
+                  update_outputs, update_pytest, include_entire_dag, true, false, 1, &files_outside_workspace);
+    // rerun for just one rule, and only update its snakefile
+    include_rules["myrule1"] = true;
+    sr.emit_tests(*sf1, testdir, pipeline_top_dir, pipeline_run_dir, tmp_parent / "inst", include_rules, exclude_rules,
+                  added_files, added_directories, true, false, false, false, false, include_entire_dag, true, false, 1,
+                  &files_outside_workspace);
+  } catch (...) {
+    std::cout.rdbuf(previous_buffer);
+    throw;
+  }
+  std::cout.rdbuf(previous_buffer);
+
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "unit_tests.zip"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / "unit_tests.zip.tmp"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / "myrule1"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / "myrule2"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule1.py"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule2.py"));
+  archive_reader ar(unitdir / "unit_tests.zip");
+  CPPUNIT_ASSERT(ar.find_prefix("myrule1/workspace/workflow/results/input1.tsv").size() == 1);
+  CPPUNIT_ASSERT(ar.find_prefix("myrule1/workspace/workflow/Snakefile").size() == 1);
+  CPPUNIT_ASSERT(ar.find_prefix("myrule1/expected/workflow/results/output1.tsv").size() == 1);
+  CPPUNIT_ASSERT(ar.find_prefix("myrule1/expected.manifest").size() == 1);
+  CPPUNIT_ASSERT(ar.find_prefix("myrule1/workspace/extra_stuff/file1.tsv").size() == 1);
+  CPPUNIT_ASSERT(ar.find_prefix("myrule2/workspace/workflow/results/output1.tsv").size() == 1);
+  CPPUNIT_ASSERT(ar.find_prefix("myrule2/expected/workflow/results/output2.tsv").size() == 1);
+  CPPUNIT_ASSERT(ar.find_prefix("myrule2/workspace/file2.tsv").size() == 1);
+  // lazily expand only one rule
+  CPPUNIT_ASSERT(ar.extract_prefix("myrule2/", tmp_parent / "extracted") == ar.find_prefix("myrule2/").size());
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(tmp_parent / "extracted" / "myrule2" / "workspace" / "workflow" /
+                                                    "Snakefile"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(tmp_parent / "extracted" / "myrule1"));
+}
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_plan() {
+  /*
+    plan mode should measure everything that emit_tests would copy,
+    report the totals and duplication, and leave the filesystem alone
+   */
+  boost::shared_ptr<recipe> rec1(new recipe), rec2(new recipe);
+  rec1->_rule_name = "myrule1";
+  rec1->_inputs.push_back("results/input1.tsv");
+  rec1->_outputs.push_back("results/output1.tsv");
+  rec2->_rule_name = "myrule2";
+  rec2->_inputs.push_back("results/output1.tsv");
+  rec2->_inputs.push_back("results/missing.tsv");
+  rec2->_outputs.push_back("results/output2.tsv");
+  snakemake_file sf;
+  sf._snakefile_relative_path = "workflow/Snakefile";
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path pipeline_top_dir = tmp_parent / "pipeline";
+  boost::filesystem::path pipeline_run_dir = "workflow";
+  std::map<std::string, bool> include_rules, exclude_rules;
+  std::vector<boost::filesystem::path> added_files, added_directories;
+  exclude_rules["all"] = true;
+  added_files.push_back("file2.tsv");
+
+  boost::filesystem::create_directories(pipeline_top_dir / pipeline_run_dir / "results");
+  std::ofstream output;
+  output.open((pipeline_top_dir / pipeline_run_dir / "results" / "input1.tsv").string().c_str());
+  output << "123456789" << std::endl;
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / pipeline_run_dir / "results" / "output1.tsv").string().c_str());
+  output << "1234567890123456789" << std::endl;
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / pipeline_run_dir / "results" / "output2.tsv").string().c_str());
+  output << "12345678901234567890123456789" << std::endl;
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / "file2.tsv").string().c_str());
+  output << "1234" << std::endl;
+  output.close();
+  output.clear();
+
+  solved_rules sr;
+  sr._recipes.push_back(rec1);
+  sr._recipes.push_back(rec2);
+  std::ostringstream text, json;
+  sr.report_plan(sf, pipeline_top_dir, pipeline_run_dir, include_rules, exclude_rules, added_files, added_directories,
+                 true, true, true, true, false, false, text);
+  CPPUNIT_ASSERT(text.str().find("rule \"myrule1\": 3 files, 35 bytes, 1 snakefiles, 1 snakemake runs") !=
+                 std::string::npos);
+  CPPUNIT_ASSERT(text.str().find("rule \"myrule2\": 3 files, 55 bytes, 1 snakefiles, 1 snakemake runs") !=
+                 std::string::npos);
+  CPPUNIT_ASSERT(text.str().find("total: 2 rules, 6 files, 90 bytes") != std::string::npos);
+  CPPUNIT_ASSERT(text.str().find("4 files, 65 bytes; 25 bytes duplicated across rules") != std::string::npos);
+  CPPUNIT_ASSERT(text.str().find("estimated: 3 (1 python resolution passes, 2 test dry runs)") != std::string::npos);
+  CPPUNIT_ASSERT(text.str().find("missing.tsv\" does not exist") != std::string::npos);
+  // most wasteful duplicate is reported first
+  CPPUNIT_ASSERT(text.str().find("output1.tsv\" is copied into 2 rules (20 bytes each)") <
+                 text.str().find("file2.tsv\" is copied into 2 rules (5 bytes each)"));
+
+  exclude_rules["myrule1"] = true;
+  sr.report_plan(sf, pipeline_top_dir, pipeline_run_dir, include_rules, exclude_rules, added_files, added_directories,
+                 false, false, true, false, false, true, json);
+  CPPUNIT_ASSERT(json.str().find("{\"name\": \"myrule2\", \"files\": 1, \"bytes\": 20, \"snakefiles\": 0, "
+                                 "\"snakemake_runs\": 1}") != std::string::npos);
+  CPPUNIT_ASSERT(json.str().find("\"myrule1\"") == std::string::npos);
+  CPPUNIT_ASSERT(json.str().find("\"duplicated_bytes\": 0") != std::string::npos);
+  CPPUNIT_ASSERT(json.str().find("\"estimated_subprocesses\": 2") != std::string::npos);
+  // a pipeline resolved without python needs no resolution pass
+  std::ostringstream resolved;
+  sf.set_update_status(false);
+  sr.report_plan(sf, pipeline_top_dir, pipeline_run_dir, include_rules, exclude_rules, added_files, added_directories,
+                 false, false, true, false, false, true, resolved);
+  CPPUNIT_ASSERT(resolved.str().find("\"estimated_resolution_passes\": 0") != std::string::npos);
+  CPPUNIT_ASSERT(json.str().find("\"missing_sources\": [\"" +
+                                 (pipeline_top_dir / pipeline_run_dir / "results/missing.tsv").string() + "\"]") !=
+                 std::string::npos);
+
+  // nothing should have been written anywhere
+  unsigned n_entries = 0;
+  boost::filesystem::recursive_directory_iterator rec_iter(tmp_parent), rec_end;
+  for (; rec_iter != rec_end; ++rec_iter) {
+    ++n_entries;
+  }
+  CPPUNIT_ASSERT(n_entries == 7);
 }
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_plan_sibling_includes() {
+  /*
+    unresolved sibling includes share a python resolution pass;
+    an unresolved include in an included file needs another
+   */
+  snakemake_file sf;
+  sf._snakefile_relative_path = "workflow/Snakefile";
+  const char *lines[] = {"include: config[\"a\"]", "include: config[\"b\"]"};
+  for (unsigned i = 0; i < 2; ++i) {
+    boost::shared_ptr<rule_block> rb(new rule_block);
+    rb->_code_chunk.push_back(lines[i]);
+    sf._blocks.push_back(rb);
+  }
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  std::map<std::string, bool> include_rules, exclude_rules;
+  std::vector<boost::filesystem::path> added_files, added_directories;
+  solved_rules sr;
+  std::ostringstream siblings;
+  sr.report_plan(sf, tmp_parent, ".", include_rules, exclude_rules, added_files, added_directories, false, false,
+                 false, false, false, false, siblings);
+  CPPUNIT_ASSERT(siblings.str().find("estimated: 2 (2 python resolution passes, 0 test dry runs)") !=
+                 std::string::npos);
+  boost::shared_ptr<snakemake_file> nested(new snakemake_file(sf._tag_counter));
+  nested->_snakefile_relative_path = "workflow/rules/a.smk";
+  boost::shared_ptr<rule_block> rb(new rule_block);
+  rb->_code_chunk.push_back("include: config[\"c\"]");
+  nested->_blocks.push_back(rb);
+  sf._included_files[tmp_parent / "workflow/rules/a.smk"] = nested;
+  std::ostringstream json;
+  sr.report_plan(sf, tmp_parent, ".", include_rules, exclude_rules, added_files, added_directories, false, false,
+                 false, false, false, true, json);
+  CPPUNIT_ASSERT(json.str().find("\"estimated_resolution_passes\": 3") != std::string::npos);
+}
+
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_snakefile() {
   boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
   boost::filesystem::path workspace = tmp_parent / "workspace";
@@ -485,12 +895,14 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_snakefile()
 
   sf1->_included_files["workflow/rules/file2.smk"] = sf2;
 
-  std::map<std::string, bool> dependent_rulenames;
-  dependent_rulenames["myrule1"] = true;
-  dependent_rulenames["myrule2"] = true;
+  rule_registry registry(*sf1);
+  std::map<std::string, bool> include_rules, exclude_rules;
+  include_rules["myrule1"] = true;
+  include_rules["myrule2"] = true;
+  rule_set dependent_rules = registry.select(include_rules, exclude_rules);
 
   solved_rules sr;
-  sr.emit_snakefile(*sf1, workspace, rec, dependent_rulenames, true);
+  CPPUNIT_ASSERT(sr.emit_snakefile(*sf1, workspace, rec, registry, dependent_rules, true, "") == 2);
 
   CPPUNIT_ASSERT(boost::filesystem::is_directory(workspace));
   CPPUNIT_ASSERT(boost::filesystem::is_directory(workspace / "workflow"));
@@ -555,6 +967,123 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_snakefile()
   CPPUNIT_ASSERT(line.empty());
   CPPUNIT_ASSERT(input.peek() == EOF);
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_snakefile_shared_includes() {
+  /*
+    an included file without target rules is linked to the shared copy;
+    the top level file, and any file with a target rule, is written in place
+   */
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path workspace = tmp_parent / "myrule1" / "workspace";
+
+  boost::shared_ptr<snakemake_file> sf1(new snakemake_file), sf2(new snakemake_file);
+  boost::shared_ptr<recipe> rec(new recipe);
+  rec->_rule_name = "myrule1";
+  rec->_outputs.push_back("output1.tsv");
+
+  boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block), rb3(new rule_block);
+  rb1->_rule_name = "myrule1";
+  rb1->_named_blocks.push_back(std::make_pair("output", " \"output1.tsv\","));
+  rb1->_queried_by_python = true;
+  rb1->_resolution = RESOLVED_INCLUDED;
+  rb2->_code_chunk.push_back("include: \"rules/file2.smk\"");
+  rb2->_queried_by_python = true;
+  rb2->_resolution = RESOLVED_INCLUDED;
+  rb3->_rule_name = "myrule2";
+  rb3->_named_blocks.push_back(std::make_pair("output", " \"output2.tsv\","));
+  rb3->_queried_by_python = true;
+  rb3->_resolution = RESOLVED_INCLUDED;
+  sf1->_blocks.push_back(rb1);
+  sf1->_blocks.push_back(rb2);
+  sf2->_blocks.push_back(rb3);
+  sf1->_snakefile_relative_path = "workflow/file1.smk";
+  sf2->_snakefile_relative_path = "workflow/rules/file2.smk";
+  sf1->_included_files["workflow/rules/file2.smk"] = sf2;
+
+  rule_registry registry(*sf1);
+  std::map<std::string, bool> include_rules, exclude_rules;
+  include_rules["myrule1"] = true;
+  rule_set dependent_rules = registry.select(include_rules, exclude_rules);
+
+  solved_rules sr;
+  CPPUNIT_ASSERT(sr.emit_snakefile(*sf1, workspace, rec, registry, dependent_rules, true, ".shared.3") == 1);
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(workspace / "workflow" / "file1.smk"));
+  CPPUNIT_ASSERT(!boost::filesystem::is_symlink(workspace / "workflow" / "file1.smk"));
+  CPPUNIT_ASSERT(boost::filesystem::is_symlink(workspace / "workflow" / "rules" / "file2.smk"));
+  CPPUNIT_ASSERT(boost::filesystem::read_symlink(workspace / "workflow" / "rules" / "file2.smk") ==
+                 boost::filesystem::path("../../../../.shared.3/workflow/rules/file2.smk"));
+  // the link resolves once the shared copy exists
+  sr.emit_shared_snakefiles(*sf1, tmp_parent / ".shared.3", registry);
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(workspace / "workflow" / "rules" / "file2.smk"));
+
+  // if the included file gains a target rule, the link is replaced without touching the shared copy
+  include_rules["myrule2"] = true;
+  dependent_rules = registry.select(include_rules, exclude_rules);
+  CPPUNIT_ASSERT(sr.emit_snakefile(*sf1, workspace, rec, registry, dependent_rules, true, ".shared.3") == 2);
+  CPPUNIT_ASSERT(!boost::filesystem::is_symlink(workspace / "workflow" / "rules" / "file2.smk"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(workspace / "workflow" / "rules" / "file2.smk"));
+  std::ifstream input;
+  std::string line = "";
+  input.open((tmp_parent / ".shared.3" / "workflow" / "rules" / "file2.smk").string().c_str());
+  CPPUNIT_ASSERT(input.is_open());
+  getline(input, line);
+  CPPUNIT_ASSERT(!line.compare("pass"));
+  input.close();
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_shared_snakefiles() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path shared_path = tmp_parent / ".shared";
+
+  boost::shared_ptr<snakemake_file> sf1(new snakemake_file), sf2(new snakemake_file), sf3(new snakemake_file);
+  boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block), rb3(new rule_block),
+      rb4(new rule_block);
+  rb1->_rule_name = "myrule1";
+  rb1->_named_blocks.push_back(std::make_pair("output", " \"output1.tsv\","));
+  rb1->_queried_by_python = true;
+  rb1->_resolution = RESOLVED_INCLUDED;
+  rb2->_code_chunk.push_back("include: \"rules/file2.smk\"");
+  rb2->_queried_by_python = true;
+  rb2->_resolution = RESOLVED_INCLUDED;
+  rb3->_code_chunk.push_back("include: \"file3.smk\"");
+  rb3->_queried_by_python = true;
+  rb3->_resolution = RESOLVED_INCLUDED;
+  rb4->_rule_name = "myrule2";
+  rb4->_named_blocks.push_back(std::make_pair("output", " \"output2.tsv\","));
+  rb4->_queried_by_python = true;
+  rb4->_resolution = RESOLVED_INCLUDED;
+  sf1->_blocks.push_back(rb1);
+  sf1->_blocks.push_back(rb2);
+  sf2->_blocks.push_back(rb3);
+  sf3->_blocks.push_back(rb4);
+  sf1->_snakefile_relative_path = "workflow/file1.smk";
+  sf2->_snakefile_relative_path = "workflow/rules/file2.smk";
+  sf3->_snakefile_relative_path = "workflow/rules/file3.smk";
+  sf1->_included_files["workflow/rules/file2.smk"] = sf2;
+  sf2->_included_files["workflow/rules/file3.smk"] = sf3;
+
+  rule_registry registry(*sf1);
+  solved_rules sr;
+  sr.emit_shared_snakefiles(*sf1, shared_path, registry);
+  // the top level file always contains a target, so it is never shared
+  CPPUNIT_ASSERT(!boost::filesystem::exists(shared_path / "workflow" / "file1.smk"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(shared_path / "workflow" / "rules" / "file2.smk"));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(shared_path / "workflow" / "rules" / "file3.smk"));
+
+  std::ifstream input;
+  std::string line = "";
+  input.open((shared_path / "workflow" / "rules" / "file2.smk").string().c_str());
+  CPPUNIT_ASSERT(input.is_open());
+  getline(input, line);
+  CPPUNIT_ASSERT(!line.compare("include: \"file3.smk\""));
+  input.close();
+  input.clear();
+  input.open((shared_path / "workflow" / "rules" / "file3.smk").string().c_str());
+  CPPUNIT_ASSERT(input.is_open());
+  getline(input, line);
+  CPPUNIT_ASSERT(!line.compare("pass"));
+  input.close();
+}
+
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_workspace() {
   /*
     need:
@@ -584,6 +1113,8 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_workspace(
   rec1->_rule_name = "myrule1";
   rec1->_inputs.push_back("results/input1.tsv");
   rec1->_outputs.push_back("results/output1.tsv");
+  rec1->_benchmark = "benchmarks/myrule1.tsv";
+  rec1->_threads = 2;
   boost::shared_ptr<snakemake_file> sf1(new snakemake_file);
   boost::shared_ptr<rule_block> rb1(new rule_block);
   rb1->_rule_name = "myrule1";
@@ -639,11 +1170,15 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_workspace(
   std::ostringstream observed;
   std::streambuf *previous_buffer(std::cout.rdbuf(observed.rdbuf()));
 
+  rule_registry registry(*sf1);
+  sr.register_recipes(&registry);
+  rule_set selected_rules = registry.select(include_rules, exclude_rules);
+
   try {
     sr.create_workspace(rec1, *sf1, testdir, unitdir, pipeline_top_dir, pipeline_run_dir, inst_test_py,
-                        extra_required_recipes, include_rules, exclude_rules, added_files, added_directories,
+                        extra_required_recipes, registry, selected_rules, added_files, added_directories,
                         update_snakefiles, update_added_content, update_inputs, update_outputs, update_pytest,
-                        include_entire_dag, &files_outside_workspace);
+                        include_entire_dag, "", &files_outside_workspace);
   } catch (...) {
     std::cout.rdbuf(previous_buffer);
     throw;
@@ -667,6 +1202,17 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_workspace(
   CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / "myrule1" / "workspace" / "extra_stuff"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule1" / "workspace" / "extra_stuff" / "file1.tsv"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule1.py"));
+  std::ifstream input((unitdir / "test_myrule1.py").string().c_str());
+  std::string line = "";
+  bool found_extra_exclusions = false, found_threads = false;
+  while (input.peek() != EOF) {
+    getline(input, line);
+    if (!line.compare("extra_comparison_exclusions=['benchmarks/myrule1.tsv', ]")) found_extra_exclusions = true;
+    if (!line.compare("threads=2")) found_threads = true;
+  }
+  input.close();
+  CPPUNIT_ASSERT(found_extra_exclusions);
+  CPPUNIT_ASSERT(found_threads);
 }
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_empty_workspace() {
   boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
@@ -781,6 +1327,127 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_copy_contents() {
   CPPUNIT_ASSERT(files_outside_workspace[file3.string()].size() == 1);
   CPPUNIT_ASSERT(!files_outside_workspace[file3.string()].at(0).compare("myrule"));
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_plan_contents() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path workspace = tmp_parent / "workspace";
+  boost::filesystem::path outside = tmp_parent / "outside";
+  boost::filesystem::create_directories(workspace);
+  boost::filesystem::create_directories(outside);
+  std::ofstream output;
+  output.open((workspace / "test1.tsv").string().c_str());
+  output.close();
+  output.clear();
+  output.open((outside / "test3.tsv").string().c_str());
+  output.close();
+  output.clear();
+  std::vector<boost::filesystem::path> contents;
+  contents.push_back("test1.tsv");
+  contents.push_back("test1.tsv");
+  contents.push_back("test2.tsv");
+  contents.push_back(workspace / "test1.tsv");
+  contents.push_back(outside / "test3.tsv");
+  std::map<boost::filesystem::path, bool> sources;
+  std::map<std::string, std::vector<std::string> > files_outside_workspace;
+  solved_rules sr;
+  sr.plan_contents(contents, workspace, "myrule", &sources, &files_outside_workspace);
+  // relative and in-workspace absolute paths are resolved to the same source;
+  // missing sources are still reported so they can be flagged
+  CPPUNIT_ASSERT(sources.size() == 2);
+  CPPUNIT_ASSERT(sources.find(workspace / "test1.tsv") != sources.end());
+  CPPUNIT_ASSERT(sources.find(workspace / "test2.tsv") != sources.end());
+  CPPUNIT_ASSERT(files_outside_workspace.size() == 1);
+  CPPUNIT_ASSERT(files_outside_workspace[(outside / "test3.tsv").string()].size() == 1);
+  CPPUNIT_ASSERT(!files_outside_workspace[(outside / "test3.tsv").string()].at(0).compare("myrule"));
+  // and nothing is copied
+  CPPUNIT_ASSERT(!boost::filesystem::exists(workspace / "test2.tsv"));
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_measure_contents() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path subdir = tmp_parent / "dir1" / "dir2";
+  boost::filesystem::create_directories(subdir);
+  std::ofstream output;
+  output.open((tmp_parent / "dir1" / "file1.txt").string().c_str());
+  output << "abc" << std::endl;
+  output.close();
+  output.clear();
+  output.open((subdir / "file2.txt").string().c_str());
+  output << "abcdefg" << std::endl;
+  output.close();
+  output.clear();
+  solved_rules sr;
+  uint64_t bytes = 0, files = 0;
+  CPPUNIT_ASSERT(sr.measure_contents(subdir / "file2.txt", &bytes, &files));
+  CPPUNIT_ASSERT(bytes == 8 && files == 1);
+  bytes = files = 0;
+  CPPUNIT_ASSERT(sr.measure_contents(tmp_parent / "dir1", &bytes, &files));
+  CPPUNIT_ASSERT(bytes == 12 && files == 2);
+  bytes = files = 0;
+  CPPUNIT_ASSERT(!sr.measure_contents(tmp_parent / "nothing", &bytes, &files));
+  CPPUNIT_ASSERT(!bytes && !files);
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_discard_tree() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path tree = tmp_parent / "tree";
+  boost::filesystem::create_directories(tree / "locked");
+  std::ofstream output;
+  output.open((tree / "locked" / "file.txt").string().c_str());
+  output.close();
+  output.clear();
+  // read-only content, as can be copied over from pipeline output
+  boost::filesystem::permissions(tree / "locked" / "file.txt", boost::filesystem::owner_read);
+  boost::filesystem::permissions(tree / "locked", boost::filesystem::owner_read | boost::filesystem::owner_exe);
+  solved_rules sr;
+  sr.discard_tree(tree);
+  CPPUNIT_ASSERT(!boost::filesystem::exists(tree));
+  // absent targets are fine
+  sr.discard_tree(tree);
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_next_shared_version() {
+  boost::filesystem::path unitdir = boost::filesystem::path(std::string(_tmp_dir)) / "unit";
+  solved_rules sr;
+  CPPUNIT_ASSERT_EQUAL(std::string(".shared.1"), sr.next_shared_version(unitdir));
+  boost::filesystem::create_directories(unitdir / ".shared");
+  boost::filesystem::create_directories(unitdir / ".shared.2");
+  boost::filesystem::create_directories(unitdir / ".shared.10");
+  boost::filesystem::create_directories(unitdir / ".shared.x");
+  boost::filesystem::create_directories(unitdir / "rule.shared.40");
+  CPPUNIT_ASSERT_EQUAL(std::string(".shared.11"), sr.next_shared_version(unitdir));
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_remove_unused_shared_versions() {
+  boost::filesystem::path unitdir = boost::filesystem::path(std::string(_tmp_dir)) / "unit";
+  solved_rules sr;
+  // nothing to do without a test directory
+  sr.remove_unused_shared_versions(unitdir);
+  boost::filesystem::create_directories(unitdir / ".shared" / "workflow");
+  boost::filesystem::create_directories(unitdir / ".shared.2" / "workflow");
+  boost::filesystem::create_directories(unitdir / ".shared.3" / "workflow" / "rules");
+  boost::filesystem::create_directories(unitdir / "rule_a" / "workspace" / "workflow" / "rules");
+  boost::filesystem::create_directories(unitdir / "rule_b" / "workspace");
+  boost::filesystem::create_directories(unitdir / ".run" / "rule_a" / "output");
+  // rule_a has been regenerated against version 3; rule_b links to nothing shared
+  boost::filesystem::create_symlink("../../../../.shared.3/workflow/rules/file2.smk",
+                                    unitdir / "rule_a" / "workspace" / "workflow" / "rules" / "file2.smk");
+  boost::filesystem::create_symlink("data.tsv", unitdir / "rule_b" / "workspace" / "linked.tsv");
+  sr.remove_unused_shared_versions(unitdir);
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / ".shared.3"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / ".shared.2"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / ".shared"));
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / ".run" / "rule_a" / "output"));
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / "rule_b" / "workspace"));
+  // a rule that has not been regenerated keeps the version it links to
+  boost::filesystem::create_directories(unitdir / ".shared.4" / "workflow" / "rules");
+  boost::filesystem::create_directories(unitdir / "rule_c" / "workspace" / "workflow" / "rules");
+  boost::filesystem::create_symlink("../../../../.shared.4/workflow/rules/file2.smk",
+                                    unitdir / "rule_c" / "workspace" / "workflow" / "rules" / "file2.smk");
+  sr.remove_unused_shared_versions(unitdir);
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / ".shared.3"));
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(unitdir / ".shared.4"));
+}
+
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_phony_all_target() {
   std::ofstream output;
   std::vector<boost::filesystem::path> targets;
@@ -862,15 +1529,16 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_t
   output.close();
 
   solved_rules sr;
-  sr.report_modified_test_script(unitdir, testdir, rulename, snakefile_relative_path, rundir, extra_exclusions,
-                                 inst_test_py);
+  sr.report_modified_test_script(unitdir, testdir, rulename, snakefile_relative_path, rundir, extra_exclusions, 4,
+                                 2000, 30, inst_test_py);
 
   boost::filesystem::path expected = unitdir / ("test_" + rulename + ".py");
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(expected));
   std::ifstream input;
   input.open(expected.string().c_str());
   bool found_shebang = false, found_testdir = false, found_rulename = false, found_relative_path = false,
-       found_exec_path = false, found_extra_exclusions = false, found_inst_contents = false, firstline = true;
+       found_exec_path = false, found_extra_exclusions = false, found_threads = false, found_memory = false,
+       found_runtime = false, found_inst_contents = false, firstline = true;
   std::string line = "";
   while (input.peek() != EOF) {
     getline(input, line);
@@ -893,6 +1561,15 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_t
     } else if (!line.compare("extra_comparison_exclusions=['.docx', '.eps', ]")) {
       CPPUNIT_ASSERT(!found_extra_exclusions);
       found_extra_exclusions = true;
+    } else if (!line.compare("threads=4")) {
+      CPPUNIT_ASSERT(!found_threads);
+      found_threads = true;
+    } else if (!line.compare("mem_mb=2000")) {
+      CPPUNIT_ASSERT(!found_memory);
+      found_memory = true;
+    } else if (!line.compare("runtime=30")) {
+      CPPUNIT_ASSERT(!found_runtime);
+      found_runtime = true;
     } else if (!line.compare("interesting stuff goes here")) {
       CPPUNIT_ASSERT(!found_inst_contents);
       found_inst_contents = true;
@@ -906,6 +1583,9 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_t
   CPPUNIT_ASSERT(found_relative_path);
   CPPUNIT_ASSERT(found_exec_path);
   CPPUNIT_ASSERT(found_extra_exclusions);
+  CPPUNIT_ASSERT(found_threads);
+  CPPUNIT_ASSERT(found_memory);
+  CPPUNIT_ASSERT(found_runtime);
   CPPUNIT_ASSERT(found_inst_contents);
 }
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_launcher_script() {
@@ -1029,6 +1709,37 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_find_missing_rule
   // reset std::cerr
   std::cout.rdbuf(previous_buffer);
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_find_missing_rule() {
+  std::map<std::string, bool> missing_rules;
+  bool found_error = false;
+  solved_rules sr;
+  CPPUNIT_ASSERT(!sr.find_missing_rule("Building DAG of jobs...\n", &missing_rules, &found_error));
+  CPPUNIT_ASSERT(!found_error);
+  CPPUNIT_ASSERT(!sr.find_missing_rule("WorkflowError: Exception in input function\n", &missing_rules, &found_error));
+  CPPUNIT_ASSERT(found_error);
+  CPPUNIT_ASSERT(missing_rules.empty());
+  found_error = false;
+  CPPUNIT_ASSERT(sr.find_missing_rule("AttributeError: 'Checkpoints' object has no attribute 'check1'\n",
+                                      &missing_rules, &found_error));
+  CPPUNIT_ASSERT(!found_error);
+  CPPUNIT_ASSERT(missing_rules.size() == 1);
+  CPPUNIT_ASSERT(missing_rules.find("check1") != missing_rules.end());
+}
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_unhandled_dryrun_error() {
+  std::deque<std::string> recent_output;
+  recent_output.push_back("Exception: the last thing that went wrong\n");
+  std::ostringstream observed;
+  std::streambuf *previous_buffer(std::cerr.rdbuf(observed.rdbuf()));
+  solved_rules sr;
+  try {
+    sr.report_unhandled_dryrun_error(recent_output);
+  } catch (...) {
+    std::cerr.rdbuf(previous_buffer);
+    CPPUNIT_ASSERT(observed.str().find("the last thing that went wrong") != std::string::npos);
+    throw;
+  }
+  std::cerr.rdbuf(previous_buffer);
+}
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_add_dag_from_leaf() {
   std::map<boost::shared_ptr<recipe>, bool> included_rules;
   boost::shared_ptr<recipe> rec1(new recipe), rec2(new recipe), rec3(new recipe);
@@ -1081,5 +1792,33 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_add_dag_from_leaf
   solved_rules sr;
   sr.add_dag_from_leaf(rec, true, NULL);
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_register_recipes() {
+  snakemake_file sf;
+  boost::shared_ptr<rule_block> b(new rule_block);
+  b->_rule_name = "myrule1";
+  b->_queried_by_python = true;
+  b->_resolution = RESOLVED_INCLUDED;
+  sf._blocks.push_back(b);
+  boost::shared_ptr<recipe> rec1(new recipe), rec2(new recipe), rec3(new recipe);
+  rec1->_rule_name = "myrule1";
+  rec2->_rule_name = "myrule2";
+  rec3->_rule_name = "myrule1";
+  solved_rules sr;
+  sr._recipes.push_back(rec1);
+  sr._recipes.push_back(rec2);
+  sr._recipes.push_back(rec3);
+  rule_registry registry(sf);
+  sr.register_recipes(&registry);
+  CPPUNIT_ASSERT(registry.size() == 2);
+  unsigned id = 0;
+  CPPUNIT_ASSERT(registry.find("myrule1", &id));
+  CPPUNIT_ASSERT(registry.get_block(id) == b.get());
+  CPPUNIT_ASSERT(registry.find("myrule2", &id));
+  CPPUNIT_ASSERT(!registry.get_block(id));
+}
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_register_recipes_null_pointer() {
+  solved_rules sr;
+  sr.register_recipes(NULL);
+}
 
 CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::solved_rulesTest);
@@ -36,6 +36,15 @@ class solved_rulesTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_recipe_add_output);
   CPPUNIT_TEST(test_recipe_get_log);
   CPPUNIT_TEST(test_recipe_set_log);
+  CPPUNIT_TEST(test_recipe_get_benchmark);
+  CPPUNIT_TEST(test_recipe_set_benchmark);
+  CPPUNIT_TEST(test_recipe_get_threads);
+  CPPUNIT_TEST(test_recipe_set_threads);
+  CPPUNIT_TEST(test_recipe_get_memory_mb);
+  CPPUNIT_TEST(test_recipe_set_memory_mb);
+  CPPUNIT_TEST(test_recipe_get_runtime);
+  CPPUNIT_TEST(test_recipe_set_runtime);
+  CPPUNIT_TEST(test_recipe_set_resources);
   CPPUNIT_TEST(test_recipe_clear);
   CPPUNIT_TEST(test_solved_rules_default_constructor);
   CPPUNIT_TEST(test_solved_rules_copy_constructor);
@@ -44,11 +53,21 @@ class solved_rulesTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_solved_rules_load_file_toxic_output_files);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_load_file_unrecognized_block, std::logic_error);
   CPPUNIT_TEST(test_solved_rules_emit_tests);
+  CPPUNIT_TEST(test_solved_rules_emit_tests_archive);
+  CPPUNIT_TEST(test_solved_rules_report_plan);
+  CPPUNIT_TEST(test_solved_rules_report_plan_sibling_includes);
   CPPUNIT_TEST(test_solved_rules_emit_snakefile);
+  CPPUNIT_TEST(test_solved_rules_emit_snakefile_shared_includes);
+  CPPUNIT_TEST(test_solved_rules_emit_shared_snakefiles);
   CPPUNIT_TEST(test_solved_rules_create_workspace);
   CPPUNIT_TEST(test_solved_rules_create_empty_workspace);
   CPPUNIT_TEST(test_solved_rules_remove_empty_workspace);
   CPPUNIT_TEST(test_solved_rules_copy_contents);
+  CPPUNIT_TEST(test_solved_rules_plan_contents);
+  CPPUNIT_TEST(test_solved_rules_measure_contents);
+  CPPUNIT_TEST(test_solved_rules_discard_tree);
+  CPPUNIT_TEST(test_solved_rules_next_shared_version);
+  CPPUNIT_TEST(test_solved_rules_remove_unused_shared_versions);
   CPPUNIT_TEST(test_solved_rules_report_phony_all_target);
   CPPUNIT_TEST(test_solved_rules_report_modified_test_script);
   CPPUNIT_TEST(test_solved_rules_report_modified_launcher_script);
@@ -57,9 +76,13 @@ class solved_rulesTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_solved_rules_find_missing_rules);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_find_missing_rules_null_pointer, std::runtime_error);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_find_missing_rules_unexpected_error, std::runtime_error);
+  CPPUNIT_TEST(test_solved_rules_find_missing_rule);
+  CPPUNIT_TEST_EXCEPTION(test_solved_rules_report_unhandled_dryrun_error, std::runtime_error);
   CPPUNIT_TEST(test_solved_rules_add_dag_from_leaf);
   CPPUNIT_TEST(test_solved_rules_add_dag_from_leaf_entire);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_add_dag_from_leaf_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_solved_rules_register_recipes);
+  CPPUNIT_TEST_EXCEPTION(test_solved_rules_register_recipes_null_pointer, std::runtime_error);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -77,6 +100,15 @@ class solved_rulesTest : public CppUnit::TestFixture {
   void test_recipe_add_output();
   void test_recipe_get_log();
   void test_recipe_set_log();
+  void test_recipe_get_benchmark();
+  void test_recipe_set_benchmark();
+  void test_recipe_get_threads();
+  void test_recipe_set_threads();
+  void test_recipe_get_memory_mb();
+  void test_recipe_set_memory_mb();
+  void test_recipe_get_runtime();
+  void test_recipe_set_runtime();
+  void test_recipe_set_resources();
   void test_recipe_clear();
   void test_solved_rules_default_constructor();
   void test_solved_rules_copy_constructor();
@@ -85,11 +117,21 @@ class solved_rulesTest : public CppUnit::TestFixture {
   void test_solved_rules_load_file_toxic_output_files();
   void test_solved_rules_load_file_unrecognized_block();
   void test_solved_rules_emit_tests();
+  void test_solved_rules_emit_tests_archive();
+  void test_solved_rules_report_plan();
+  void test_solved_rules_report_plan_sibling_includes();
   void test_solved_rules_emit_snakefile();
+  void test_solved_rules_emit_snakefile_shared_includes();
+  void test_solved_rules_emit_shared_snakefiles();
   void test_solved_rules_create_workspace();
   void test_solved_rules_create_empty_workspace();
   void test_solved_rules_remove_empty_workspace();
   void test_solved_rules_copy_contents();
+  void test_solved_rules_plan_contents();
+  void test_solved_rules_measure_contents();
+  void test_solved_rules_discard_tree();
+  void test_solved_rules_next_shared_version();
+  void test_solved_rules_remove_unused_shared_versions();
   void test_solved_rules_report_phony_all_target();
   void test_solved_rules_report_modified_test_script();
   void test_solved_rules_report_modified_launcher_script();
@@ -98,9 +140,13 @@ class solved_rulesTest : public CppUnit::TestFixture {
   void test_solved_rules_find_missing_rules();
   void test_solved_rules_find_missing_rules_null_pointer();
   void test_solved_rules_find_missing_rules_unexpected_error();
+  void test_solved_rules_find_missing_rule();
+  void test_solved_rules_report_unhandled_dryrun_error();
   void test_solved_rules_add_dag_from_leaf();
   void test_solved_rules_add_dag_from_leaf_entire();
   void test_solved_rules_add_dag_from_leaf_null_pointer();
+  void test_solved_rules_register_recipes();
+  void test_solved_rules_register_recipes_null_pointer();
 
  private:
   char *_tmp_dir;
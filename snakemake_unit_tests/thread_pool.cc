@@ -0,0 +1,76 @@
+/*!
+  @file thread_pool.cc
+  @brief implementation of thread_pool class
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/thread_pool.h"
+
+snakemake_unit_tests::thread_pool::thread_pool(unsigned n_threads) : _active(0), _shutdown(false) {
+  if (!n_threads) {
+    n_threads = std::thread::hardware_concurrency();
+  }
+  if (!n_threads) {
+    n_threads = 1;
+  }
+  for (unsigned i = 0; i < n_threads; ++i) {
+    _workers.push_back(std::thread(&thread_pool::run, this));
+  }
+}
+
+snakemake_unit_tests::thread_pool::~thread_pool() throw() {
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _shutdown = true;
+  }
+  _task_available.notify_all();
+  for (std::vector<std::thread>::iterator iter = _workers.begin(); iter != _workers.end(); ++iter) {
+    iter->join();
+  }
+}
+
+void snakemake_unit_tests::thread_pool::submit(const std::function<void()> &task) {
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _tasks.push_back(task);
+  }
+  _task_available.notify_one();
+}
+
+void snakemake_unit_tests::thread_pool::wait() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _tasks_complete.wait(lock, [this] { return _tasks.empty() && !_active; });
+  if (_error) {
+    std::exception_ptr error = _error;
+    _error = std::exception_ptr();
+    std::rethrow_exception(error);
+  }
+}
+
+void snakemake_unit_tests::thread_pool::run() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _task_available.wait(lock, [this] { return _shutdown || !_tasks.empty(); });
+      // finish any queued work before exiting
+      if (_tasks.empty()) return;
+      task = _tasks.front();
+      _tasks.pop_front();
+      ++_active;
+    }
+    try {
+      task();
+    } catch (...) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (!_error) _error = std::current_exception();
+    }
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      --_active;
+      if (_tasks.empty() && !_active) _tasks_complete.notify_all();
+    }
+  }
+}
@@ -0,0 +1,82 @@
+/*!
+  @file thread_pool.h
+  @brief fixed-size pool of worker threads for independent tasks
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_THREAD_POOL_H_
+#define SNAKEMAKE_UNIT_TESTS_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace snakemake_unit_tests {
+/*!
+  @class thread_pool
+  @brief run submitted tasks on a fixed set of worker threads
+
+  tasks are started in submission order. an exception thrown by a task
+  is captured, and the first such exception is rethrown from wait().
+ */
+class thread_pool {
+ public:
+  /*!
+    @brief constructor
+    @param n_threads number of worker threads; 0 means one per available core
+   */
+  explicit thread_pool(unsigned n_threads);
+  /*!
+    @brief destructor: finish all queued tasks, then stop the workers
+   */
+  ~thread_pool() throw();
+  /*!
+    @brief queue a task for execution
+    @param task function to run on a worker thread
+   */
+  void submit(const std::function<void()> &task);
+  /*!
+    @brief block until all submitted tasks have completed
+   */
+  void wait();
+  /*!
+    @brief get the number of worker threads
+    @return number of worker threads
+   */
+  unsigned size() const { return _workers.size(); }
+
+ private:
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  thread_pool() { throw std::domain_error("thread_pool: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing thread_pool object
+    @warning disabled
+   */
+  thread_pool(const thread_pool &obj) { throw std::domain_error("thread_pool: do not use copy constructor"); }
+  /*!
+    @brief worker loop: take tasks from the queue until shutdown
+   */
+  void run();
+  std::vector<std::thread> _workers;               //!< worker threads
+  std::deque<std::function<void()> > _tasks;       //!< tasks not yet started
+  std::mutex _mutex;                               //!< guards all members below
+  std::condition_variable _task_available;         //!< signals workers
+  std::condition_variable _tasks_complete;         //!< signals wait()
+  unsigned _active;                                //!< number of tasks currently running
+  bool _shutdown;                                  //!< whether workers should exit
+  std::exception_ptr _error;                       //!< first exception thrown by a task
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_THREAD_POOL_H_
@@ -0,0 +1,78 @@
+/*!
+  \file thread_poolTest.cc
+  \brief implementation of thread_pool unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/thread_poolTest.h"
+
+void snakemake_unit_tests::thread_poolTest::setUp() {}
+
+void snakemake_unit_tests::thread_poolTest::tearDown() {}
+
+void snakemake_unit_tests::thread_poolTest::test_thread_pool_constructor() {
+  thread_pool pool(3);
+  CPPUNIT_ASSERT(pool.size() == 3U);
+  // zero requests one thread per core, but always at least one
+  thread_pool automatic(0);
+  CPPUNIT_ASSERT(automatic.size() >= 1U);
+}
+
+void snakemake_unit_tests::thread_poolTest::test_thread_pool_destructor() {
+  // queued tasks are completed before the workers exit
+  std::atomic<unsigned> counter(0);
+  {
+    thread_pool pool(1);
+    for (unsigned i = 0; i < 20; ++i) {
+      pool.submit([&counter]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++counter;
+      });
+    }
+  }
+  CPPUNIT_ASSERT(counter == 20U);
+}
+
+void snakemake_unit_tests::thread_poolTest::test_thread_pool_submit() {
+  std::atomic<unsigned> counter(0);
+  thread_pool pool(4);
+  for (unsigned i = 0; i < 1000; ++i) {
+    pool.submit([&counter]() { ++counter; });
+  }
+  pool.wait();
+  CPPUNIT_ASSERT(counter == 1000U);
+}
+
+void snakemake_unit_tests::thread_poolTest::test_thread_pool_wait() {
+  thread_pool pool(2);
+  // waiting on an idle pool returns immediately
+  pool.wait();
+  std::atomic<unsigned> counter(0);
+  pool.submit([&counter]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ++counter;
+  });
+  pool.wait();
+  CPPUNIT_ASSERT(counter == 1U);
+  // a captured exception is only reported once
+  pool.submit([]() { throw std::runtime_error("task failure"); });
+  CPPUNIT_ASSERT_THROW(pool.wait(), std::runtime_error);
+  pool.wait();
+}
+
+void snakemake_unit_tests::thread_poolTest::test_thread_pool_wait_task_exception() {
+  thread_pool pool(2);
+  std::atomic<unsigned> counter(0);
+  pool.submit([]() { throw std::runtime_error("task failure"); });
+  // other tasks still run
+  pool.submit([&counter]() { ++counter; });
+  try {
+    pool.wait();
+  } catch (...) {
+    CPPUNIT_ASSERT(counter == 1U);
+    throw;
+  }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::thread_poolTest);
@@ -0,0 +1,46 @@
+/*!
+  \file thread_poolTest.h
+  \brief thread_pool test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_THREAD_POOLTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_THREAD_POOLTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "snakemake_unit_tests/thread_pool.h"
+
+namespace snakemake_unit_tests {
+class thread_poolTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(thread_poolTest);
+  CPPUNIT_TEST(test_thread_pool_constructor);
+  CPPUNIT_TEST(test_thread_pool_destructor);
+  CPPUNIT_TEST(test_thread_pool_submit);
+  CPPUNIT_TEST(test_thread_pool_wait);
+  CPPUNIT_TEST_EXCEPTION(test_thread_pool_wait_task_exception, std::runtime_error);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_thread_pool_constructor();
+  void test_thread_pool_destructor();
+  void test_thread_pool_submit();
+  void test_thread_pool_wait();
+  void test_thread_pool_wait_task_exception();
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_THREAD_POOLTEST_H_
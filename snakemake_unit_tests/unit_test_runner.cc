@@ -0,0 +1,391 @@
+/*!
+  @file unit_test_runner.cc
+  @brief implementation of unit_test_runner and supporting classes
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+ */
+
+#include "snakemake_unit_tests/unit_test_runner.h"
+
+// how much of a failed step's output is kept for the report
+#define RUNNER_LOGGED_LINES 20
+
+/*!
+  @brief remove the quotes around a python string literal
+  @param value literal as written in a test script
+  @return contents of the literal, or value unchanged if it is not quoted
+ */
+static std::string unquote(const std::string &value) {
+  if (value.size() >= 2 && (value.at(0) == '\'' || value.at(0) == '"') && value.at(value.size() - 1) == value.at(0))
+    return value.substr(1, value.size() - 2);
+  return value;
+}
+
+/*!
+  @brief interpret a resource setting of a test script
+  @param value setting as written in the test script
+  @param name name of the setting, for error messages
+  @param script test script, for error messages
+  @return value of the setting
+ */
+static unsigned parse_resource(const std::string &value, const std::string &name,
+                               const boost::filesystem::path &script) {
+  if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos)
+    throw std::runtime_error("test script \"" + script.string() + "\" sets \"" + name + "\" to \"" + value +
+                             "\", which is not a nonnegative integer");
+  return std::stoul(value);
+}
+
+/*!
+  @brief escape text for use in xml content or attribute values
+  @param s raw text
+  @return escaped text
+ */
+static std::string xml_escape(const std::string &s) {
+  std::string res;
+  for (std::string::const_iterator iter = s.begin(); iter != s.end(); ++iter) {
+    if (*iter == '&') {
+      res += "&amp;";
+    } else if (*iter == '<') {
+      res += "&lt;";
+    } else if (*iter == '>') {
+      res += "&gt;";
+    } else if (*iter == '"') {
+      res += "&quot;";
+    } else if (static_cast<unsigned char>(*iter) < 0x20 && *iter != '\n' && *iter != '\t' && *iter != '\r') {
+      // not permitted in xml 1.0 at all, even escaped
+      res += '?';
+    } else {
+      res += *iter;
+    }
+  }
+  return res;
+}
+
+snakemake_unit_tests::rule_test::rule_test() : cores(1), memory_mb(0), runtime(0) {}
+
+snakemake_unit_tests::rule_test::rule_test(const rule_test &obj)
+    : rule_name(obj.rule_name),
+      script(obj.script),
+      snakefile_relative_path(obj.snakefile_relative_path),
+      snakemake_exec_path(obj.snakemake_exec_path),
+      extra_comparison_exclusions(obj.extra_comparison_exclusions),
+      cores(obj.cores),
+      memory_mb(obj.memory_mb),
+      runtime(obj.runtime) {}
+
+snakemake_unit_tests::rule_test::~rule_test() throw() {}
+
+snakemake_unit_tests::rule_test_result::rule_test_result() : passed(false), seconds(0.0) {}
+
+snakemake_unit_tests::rule_test_result::rule_test_result(const rule_test_result &obj)
+    : rule_name(obj.rule_name), passed(obj.passed), message(obj.message), log(obj.log), seconds(obj.seconds) {}
+
+snakemake_unit_tests::rule_test_result::~rule_test_result() throw() {}
+
+snakemake_unit_tests::resource_budget::resource_budget(unsigned cores, unsigned memory_mb)
+    : _total_cores(cores), _total_memory_mb(memory_mb), _free_cores(cores), _free_memory_mb(memory_mb) {
+  if (!cores) throw std::logic_error("resource_budget requires at least one core");
+}
+
+std::pair<unsigned, unsigned> snakemake_unit_tests::resource_budget::clamp(unsigned cores, unsigned memory_mb) const {
+  // every test gets at least one core, so it can always be counted against the budget
+  cores = std::min(std::max(cores, 1u), _total_cores);
+  memory_mb = _total_memory_mb ? std::min(memory_mb, _total_memory_mb) : 0;
+  return std::make_pair(cores, memory_mb);
+}
+
+void snakemake_unit_tests::resource_budget::acquire(unsigned cores, unsigned memory_mb) {
+  if (!_total_memory_mb) memory_mb = 0;
+  if (cores > _total_cores || memory_mb > _total_memory_mb)
+    throw std::logic_error("resource_budget::acquire: request exceeds the whole budget");
+  std::unique_lock<std::mutex> lock(_mutex);
+  // all or nothing, so two large tests cannot each hold half of what the other needs
+  _released.wait(lock, [this, cores, memory_mb]() { return _free_cores >= cores && _free_memory_mb >= memory_mb; });
+  _free_cores -= cores;
+  _free_memory_mb -= memory_mb;
+}
+
+void snakemake_unit_tests::resource_budget::release(unsigned cores, unsigned memory_mb) {
+  if (!_total_memory_mb) memory_mb = 0;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _free_cores += cores;
+    _free_memory_mb += memory_mb;
+  }
+  _released.notify_all();
+}
+
+snakemake_unit_tests::unit_test_runner::unit_test_runner(const boost::filesystem::path &output_test_dir)
+    : _unit_dir(boost::filesystem::absolute(output_test_dir / "unit")) {
+  if (!boost::filesystem::is_directory(_unit_dir))
+    throw std::runtime_error("output test directory \"" + output_test_dir.string() +
+                             "\" does not contain generated tests under \"unit\"");
+}
+
+snakemake_unit_tests::rule_test snakemake_unit_tests::unit_test_runner::read_test_script(
+    const boost::filesystem::path &script) {
+  std::ifstream input(script.string().c_str());
+  if (!input.is_open()) throw std::runtime_error("cannot open test script \"" + script.string() + "\"");
+  rule_test res;
+  res.script = script;
+  std::map<std::string, std::string> settings;
+  std::string line;
+  const boost::regex assignment("^([A-Za-z_][A-Za-z0-9_]*)=(.*)$");
+  // the settings precede the body copied from inst/test.py, which starts with its imports
+  while (std::getline(input, line) && line.compare(0, 7, "import ") && line.compare(0, 5, "from ")) {
+    boost::smatch match;
+    if (boost::regex_match(line, match, assignment)) settings[match[1].str()] = match[2].str();
+  }
+  input.close();
+  const std::vector<std::string> required = {"rulename", "snakefile_relative_path", "snakemake_exec_path"};
+  for (std::vector<std::string>::const_iterator iter = required.begin(); iter != required.end(); ++iter) {
+    if (settings.find(*iter) == settings.end())
+      throw std::runtime_error("test script \"" + script.string() + "\" does not set \"" + *iter + "\"");
+  }
+  res.rule_name = unquote(settings["rulename"]);
+  res.snakefile_relative_path = unquote(settings["snakefile_relative_path"]);
+  res.snakemake_exec_path = unquote(settings["snakemake_exec_path"]);
+  if (settings.find("extra_comparison_exclusions") != settings.end()) {
+    const std::string &value = settings["extra_comparison_exclusions"];
+    const boost::regex item("'([^']*)'|\"([^\"]*)\"");
+    for (boost::sregex_iterator iter(value.begin(), value.end(), item), end; iter != end; ++iter) {
+      res.extra_comparison_exclusions.push_back((*iter)[1].matched ? (*iter)[1].str() : (*iter)[2].str());
+    }
+  }
+  if (settings.find("threads") != settings.end()) res.cores = parse_resource(settings["threads"], "threads", script);
+  if (settings.find("mem_mb") != settings.end())
+    res.memory_mb = parse_resource(settings["mem_mb"], "mem_mb", script);
+  if (settings.find("runtime") != settings.end())
+    res.runtime = parse_resource(settings["runtime"], "runtime", script);
+  return res;
+}
+
+std::vector<snakemake_unit_tests::rule_test> snakemake_unit_tests::unit_test_runner::discover(
+    const std::map<std::string, bool> &include_rules, const std::map<std::string, bool> &exclude_rules) const {
+  std::vector<boost::filesystem::path> scripts;
+  for (boost::filesystem::directory_iterator iter(_unit_dir), end; iter != end; ++iter) {
+    std::string filename = iter->path().filename().string();
+    if (boost::filesystem::is_regular_file(iter->status()) && filename.size() > 8 &&
+        !filename.compare(0, 5, "test_") && !filename.compare(filename.size() - 3, 3, ".py"))
+      scripts.push_back(iter->path());
+  }
+  std::sort(scripts.begin(), scripts.end());
+  std::vector<rule_test> res;
+  for (std::vector<boost::filesystem::path>::const_iterator iter = scripts.begin(); iter != scripts.end(); ++iter) {
+    rule_test test = read_test_script(*iter);
+    if (!include_rules.empty() && include_rules.find(test.rule_name) == include_rules.end()) continue;
+    if (exclude_rules.find(test.rule_name) != exclude_rules.end()) continue;
+    res.push_back(test);
+  }
+  return res;
+}
+
+std::vector<snakemake_unit_tests::rule_test_result> snakemake_unit_tests::unit_test_runner::run(
+    const std::vector<rule_test> &tests, unsigned n_cores, unsigned memory_mb, std::ostream &out) const {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  unsigned total_cores = std::max(n_cores ? n_cores : std::thread::hardware_concurrency(), 1u);
+  resource_budget budget(total_cores, memory_mb);
+  // the largest tests first, so they are not left waiting for the whole budget at the end;
+  // among tests of the same size, the longest first, so they do not finish last
+  std::vector<unsigned> order;
+  for (unsigned i = 0; i < tests.size(); ++i) order.push_back(i);
+  std::stable_sort(order.begin(), order.end(), [&tests, &budget](unsigned a, unsigned b) {
+    std::pair<unsigned, unsigned> size_a = budget.clamp(tests.at(a).cores, tests.at(a).memory_mb);
+    std::pair<unsigned, unsigned> size_b = budget.clamp(tests.at(b).cores, tests.at(b).memory_mb);
+    if (size_a != size_b) return size_a > size_b;
+    return tests.at(a).runtime > tests.at(b).runtime;
+  });
+  std::vector<rule_test_result> results(tests.size());
+  std::mutex report_lock;
+  unsigned n_reported = 0, n_failed = 0;
+  out << "1.." << tests.size() << std::endl;
+  if (!tests.empty()) {
+    thread_pool pool(std::min(total_cores, static_cast<unsigned>(tests.size())));
+    for (std::vector<unsigned>::const_iterator iter = order.begin(); iter != order.end(); ++iter) {
+      unsigned index = *iter;
+      // reserved here rather than by the workers, so tests start strictly in order;
+      // every running test holds a core, so a worker is always free to take it
+      std::pair<unsigned, unsigned> request = budget.clamp(tests.at(index).cores, tests.at(index).memory_mb);
+      budget.acquire(request.first, request.second);
+      pool.submit([this, index, request, &tests, &budget, &results, &report_lock, &n_reported, &n_failed, &out]() {
+        rule_test_result result = run_one(tests.at(index), request.first);
+        budget.release(request.first, request.second);
+        // tests are numbered as they finish, so progress is visible while others run
+        std::lock_guard<std::mutex> lock(report_lock);
+        results.at(index) = result;
+        ++n_reported;
+        if (!result.passed) ++n_failed;
+        out << (result.passed ? "ok " : "not ok ") << n_reported << " - " << result.rule_name << " ("
+            << std::fixed << std::setprecision(1) << result.seconds << " s)" << std::endl;
+        if (!result.passed) {
+          out << "# " << result.message << std::endl;
+          std::istringstream log(result.log);
+          std::string line;
+          while (std::getline(log, line)) out << "#   " << line << std::endl;
+        }
+      });
+    }
+    pool.wait();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  out << "# " << tests.size() - n_failed << " of " << tests.size() << " rule tests passed in " << std::fixed
+      << std::setprecision(1) << seconds << " s" << std::endl;
+  return results;
+}
+
+snakemake_unit_tests::rule_test_result snakemake_unit_tests::unit_test_runner::run_one(const rule_test &test,
+                                                                                       unsigned cores) const {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  rule_test_result result;
+  result.rule_name = test.rule_name;
+  boost::filesystem::path rule_dir = _unit_dir / test.rule_name;
+  // the test runs outside the rule directory, which regeneration swaps out from under it
+  boost::filesystem::path run_dir = _unit_dir / ".run" / test.rule_name;
+  boost::filesystem::path rundir = run_dir / "output";
+  boost::filesystem::path extracted = run_dir / "extracted";
+  boost::filesystem::path base = rule_dir;
+  try {
+    // with --output-format archive, only expand the rule under test
+    boost::filesystem::path archive_path = _unit_dir / "unit_tests.zip";
+    if (!boost::filesystem::is_directory(rule_dir / "workspace") && boost::filesystem::is_regular_file(archive_path)) {
+      remove_tree(extracted);
+      archive_reader archive(archive_path);
+      archive.extract_prefix(test.rule_name + "/", extracted);
+      base = extracted / test.rule_name;
+    }
+    if (!boost::filesystem::is_directory(base / "workspace"))
+      throw std::runtime_error("rule \"" + test.rule_name + "\" does not seem to have a unit test installed under \"" +
+                               _unit_dir.string() + "\"");
+    // remove any output from a failed prior run
+    remove_tree(rundir);
+    copy_workspace(base / "workspace", rundir);
+    // launched through the interpreter, as test.py does, so that snakemake and common.py share a python
+    int status = run_step("python3 -m snakemake all -f -j" + std::to_string(cores) +
+                              " --notemp --keep-target-files --use-conda --conda-frontend mamba --snakefile " +
+                              shell_quote((rundir / test.snakefile_relative_path).string()) + " --allowed-rules " +
+                              shell_quote(test.rule_name) + " --directory " +
+                              shell_quote((rundir / test.snakemake_exec_path).string()) + " 2>&1",
+                          &result.log);
+    if (status) {
+      result.message = "snakemake exited with status " + std::to_string(status);
+    } else {
+      std::string cmd = "python3 " + shell_quote((_unit_dir / "common.py").string()) + " --config " +
+                        shell_quote((_unit_dir / "config.yaml").string()) + " --workspace " +
+                        shell_quote((base / "workspace").string()) + " --expected " +
+                        shell_quote((base / "expected").string()) + " --manifest " +
+                        shell_quote((base / "expected.manifest").string()) + " --workdir " +
+                        shell_quote(rundir.string());
+      for (std::vector<std::string>::const_iterator iter = test.extra_comparison_exclusions.begin();
+           iter != test.extra_comparison_exclusions.end(); ++iter) {
+        cmd += " --extra-exclusion " + shell_quote(*iter);
+      }
+      status = run_step(cmd + " 2>&1", &result.log);
+      if (status) {
+        result.message = "output comparison exited with status " + std::to_string(status);
+      } else {
+        result.passed = true;
+        result.log.clear();
+      }
+    }
+    remove_tree(extracted);
+    // only a passing test's output is removed; a failing one is kept for inspection
+    if (result.passed) {
+      remove_tree(rundir);
+      if (boost::filesystem::is_empty(run_dir)) boost::filesystem::remove(run_dir);
+    }
+  } catch (const std::exception &e) {
+    result.passed = false;
+    result.message = e.what();
+    // an expanded archive is never kept, whichever step failed; any output is kept for inspection
+    try {
+      remove_tree(extracted);
+      if (boost::filesystem::is_directory(run_dir) && boost::filesystem::is_empty(run_dir))
+        boost::filesystem::remove(run_dir);
+    } catch (const std::exception &) {
+      // the failure already recorded is the one to report
+    }
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+int snakemake_unit_tests::unit_test_runner::run_step(const std::string &cmd, std::string *log) {
+  if (!log) throw std::runtime_error("null pointer provided to unit_test_runner::run_step");
+  std::deque<std::string> recent;
+  int status = 0;
+  exec_streaming(
+      cmd,
+      [&recent](const std::string &line) {
+        recent.push_back(line);
+        if (recent.size() > RUNNER_LOGGED_LINES) recent.pop_front();
+        return true;
+      },
+      false, false, &status);
+  log->clear();
+  for (std::deque<std::string>::const_iterator iter = recent.begin(); iter != recent.end(); ++iter) {
+    *log += *iter;
+  }
+  return status;
+}
+
+void snakemake_unit_tests::unit_test_runner::copy_workspace(const boost::filesystem::path &source,
+                                                            const boost::filesystem::path &target) {
+  boost::filesystem::create_directories(target);
+  for (boost::filesystem::directory_iterator iter(source), end; iter != end; ++iter) {
+    boost::filesystem::path destination = target / iter->path().filename();
+    // status follows links; symlink_status does not
+    if (boost::filesystem::is_directory(iter->status())) {
+      copy_workspace(iter->path(), destination);
+    } else if (boost::filesystem::is_regular_file(iter->status())) {
+      boost::filesystem::copy_file(iter->path(), destination);
+    } else if (boost::filesystem::is_symlink(iter->symlink_status())) {
+      // a dangling link may be satisfied once the rule runs
+      boost::filesystem::copy_symlink(iter->path(), destination);
+    }
+  }
+}
+
+void snakemake_unit_tests::unit_test_runner::remove_tree(const boost::filesystem::path &target) {
+  if (!boost::filesystem::exists(boost::filesystem::symlink_status(target))) return;
+  // snakemake write-protects the output of rules marked protected()
+  if (boost::filesystem::is_directory(boost::filesystem::symlink_status(target))) {
+    boost::filesystem::permissions(target, boost::filesystem::owner_all | boost::filesystem::add_perms);
+    boost::filesystem::recursive_directory_iterator rec_iter(target), rec_end;
+    for (; rec_iter != rec_end; ++rec_iter) {
+      if (!boost::filesystem::is_symlink(rec_iter->symlink_status())) {
+        boost::filesystem::permissions(*rec_iter, boost::filesystem::owner_all | boost::filesystem::add_perms);
+      }
+    }
+  }
+  boost::filesystem::remove_all(target);
+}
+
+void snakemake_unit_tests::unit_test_runner::report_junit(const std::vector<rule_test_result> &results,
+                                                          double seconds, const boost::filesystem::path &filename) {
+  unsigned n_failed = 0;
+  for (std::vector<rule_test_result>::const_iterator iter = results.begin(); iter != results.end(); ++iter) {
+    if (!iter->passed) ++n_failed;
+  }
+  std::ofstream output(filename.string().c_str());
+  if (!output.is_open()) throw std::runtime_error("cannot open junit report \"" + filename.string() + "\"");
+  output << std::fixed << std::setprecision(3) << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         << "<testsuites tests=\"" << results.size() << "\" failures=\"" << n_failed << "\" time=\"" << seconds
+         << "\">\n"
+         << "  <testsuite name=\"snakemake_unit_tests\" tests=\"" << results.size() << "\" failures=\"" << n_failed
+         << "\" time=\"" << seconds << "\">\n";
+  for (std::vector<rule_test_result>::const_iterator iter = results.begin(); iter != results.end(); ++iter) {
+    output << "    <testcase classname=\"unit\" name=\"" << xml_escape(iter->rule_name) << "\" time=\""
+           << iter->seconds << "\"";
+    if (iter->passed) {
+      output << "/>\n";
+    } else {
+      output << ">\n      <failure message=\"" << xml_escape(iter->message) << "\">" << xml_escape(iter->log)
+             << "</failure>\n    </testcase>\n";
+    }
+  }
+  output << "  </testsuite>\n</testsuites>\n";
+  if (!output) throw std::runtime_error("cannot write to junit report \"" + filename.string() + "\"");
+  output.close();
+}
@@ -0,0 +1,302 @@
+/*!
+  @file unit_test_runner.h
+  @brief native runner for generated rule tests
+  @author Cameron Palmer
+  @copyright Released under the MIT License.
+  Copyright 2023 Cameron Palmer
+
+  inst/pytest_runner.bash collects every test_<rule>.py and runs them
+  in a single serial pytest session, though each test mostly waits on its
+  own snakemake subprocess. the runner here reads the same test scripts,
+  and runs the tests side by side, as many at once as fit within a budget
+  of cores and memory. each test is provisioned, run, and compared as the
+  test script would, and its output is removed if it passes.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_UNIT_TEST_RUNNER_H_
+#define SNAKEMAKE_UNIT_TESTS_UNIT_TEST_RUNNER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "boost/regex.hpp"
+#include "snakemake_unit_tests/archive.h"
+#include "snakemake_unit_tests/thread_pool.h"
+#include "snakemake_unit_tests/utilities.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @class rule_test
+  @brief one generated rule test, as described by its test script
+ */
+class rule_test {
+ public:
+  /*!
+    @brief constructor
+   */
+  rule_test();
+  /*!
+    @brief copy constructor
+    @param obj existing rule_test object
+   */
+  rule_test(const rule_test &obj);
+  /*!
+    @brief destructor
+   */
+  ~rule_test() throw();
+  /*!
+    @brief name of the rule under test
+   */
+  std::string rule_name;
+  /*!
+    @brief test script describing the test
+   */
+  boost::filesystem::path script;
+  /*!
+    @brief snakefile, relative to the test workspace
+   */
+  boost::filesystem::path snakefile_relative_path;
+  /*!
+    @brief directory snakemake runs from, relative to the test workspace
+   */
+  boost::filesystem::path snakemake_exec_path;
+  /*!
+    @brief path fragments of output files that are not compared
+   */
+  std::vector<std::string> extra_comparison_exclusions;
+  /*!
+    @brief cores the test reserves while it runs
+   */
+  unsigned cores;
+  /*!
+    @brief memory, in megabytes, the test reserves while it runs
+   */
+  unsigned memory_mb;
+  /*!
+    @brief expected runtime of the rule, in minutes; 0 if unknown
+   */
+  unsigned runtime;
+};
+
+/*!
+  @class rule_test_result
+  @brief outcome of running one rule test
+ */
+class rule_test_result {
+ public:
+  /*!
+    @brief constructor
+   */
+  rule_test_result();
+  /*!
+    @brief copy constructor
+    @param obj existing rule_test_result object
+   */
+  rule_test_result(const rule_test_result &obj);
+  /*!
+    @brief destructor
+   */
+  ~rule_test_result() throw();
+  /*!
+    @brief name of the rule under test
+   */
+  std::string rule_name;
+  /*!
+    @brief whether the rule ran and its output matched
+   */
+  bool passed;
+  /*!
+    @brief why the test failed, if it did
+   */
+  std::string message;
+  /*!
+    @brief most recent output of the failed step, if any
+   */
+  std::string log;
+  /*!
+    @brief wall time of the test, in seconds
+   */
+  double seconds;
+};
+
+/*!
+  @class resource_budget
+  @brief cores and memory shared by concurrently running tests
+ */
+class resource_budget {
+ public:
+  /*!
+    @brief constructor
+    @param cores total cores; must be at least 1
+    @param memory_mb total memory in megabytes; 0 means no limit
+   */
+  resource_budget(unsigned cores, unsigned memory_mb);
+  /*!
+    @brief destructor
+   */
+  ~resource_budget() throw() {}
+  /*!
+    @brief fit a request within the budget
+    @param cores requested cores
+    @param memory_mb requested memory in megabytes
+    @return the request, reduced to at most the whole budget
+   */
+  std::pair<unsigned, unsigned> clamp(unsigned cores, unsigned memory_mb) const;
+  /*!
+    @brief block until a request fits in what is free, then reserve it
+    @param cores requested cores, at most the whole budget
+    @param memory_mb requested memory in megabytes, at most the whole budget;
+    ignored if memory is not limited
+   */
+  void acquire(unsigned cores, unsigned memory_mb);
+  /*!
+    @brief return a reservation made with acquire
+    @param cores reserved cores
+    @param memory_mb reserved memory in megabytes
+   */
+  void release(unsigned cores, unsigned memory_mb);
+
+ private:
+  friend class unit_test_runnerTest;
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  resource_budget() { throw std::domain_error("resource_budget: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing resource_budget object
+    @warning disabled
+   */
+  resource_budget(const resource_budget &obj) {
+    throw std::domain_error("resource_budget: do not use copy constructor");
+  }
+  unsigned _total_cores;              //!< cores in the budget
+  unsigned _total_memory_mb;          //!< memory in the budget; 0 means no limit
+  unsigned _free_cores;               //!< cores not currently reserved
+  unsigned _free_memory_mb;           //!< memory not currently reserved
+  std::mutex _mutex;                  //!< guards the free resources
+  std::condition_variable _released;  //!< signals that resources were returned
+};
+
+/*!
+  @class unit_test_runner
+  @brief runner for the tests under one output test directory
+ */
+class unit_test_runner {
+ public:
+  /*!
+    @brief constructor
+    @param output_test_dir top-level output directory of the tests
+   */
+  explicit unit_test_runner(const boost::filesystem::path &output_test_dir);
+  /*!
+    @brief destructor
+   */
+  ~unit_test_runner() throw() {}
+  /*!
+    @brief read the description of a test from its test script
+    @param script test_<rule>.py emitted by snakemake_unit_tests
+    @return description of the test
+
+    the settings are the assignments at the top of the script. 'threads',
+    'mem_mb', and 'runtime' are optional, and default to one core, no
+    memory, and unknown runtime.
+   */
+  static rule_test read_test_script(const boost::filesystem::path &script);
+  /*!
+    @brief find the tests under the output test directory
+    @param include_rules rules to run; empty means every rule
+    @param exclude_rules rules not to run
+    @return description of each test, ordered by rule name
+   */
+  std::vector<rule_test> discover(const std::map<std::string, bool> &include_rules,
+                                  const std::map<std::string, bool> &exclude_rules) const;
+  /*!
+    @brief run tests concurrently
+    @param tests tests to run
+    @param n_cores total cores; 0 means one per available core
+    @param memory_mb total memory in megabytes; 0 means no limit
+    @param out where to report the results, as TAP
+    @return result of each test, in the order of tests
+
+    tests requesting the most resources are started first, and the
+    longest of those first. a test requesting more than the whole budget
+    runs with the whole budget.
+   */
+  std::vector<rule_test_result> run(const std::vector<rule_test> &tests, unsigned n_cores, unsigned memory_mb,
+                                    std::ostream &out) const;
+  /*!
+    @brief run one test
+    @param test test to run
+    @param cores cores that snakemake may use
+    @return result of the test
+
+    the test runs in unit/.run/<rule>/output, as the test script does,
+    so regenerating unit/<rule> while the test runs does not disturb it
+   */
+  rule_test_result run_one(const rule_test &test, unsigned cores) const;
+  /*!
+    @brief write test results as a junit xml report
+    @param results result of each test
+    @param seconds wall time of the whole run
+    @param filename where to write the report
+   */
+  static void report_junit(const std::vector<rule_test_result> &results, double seconds,
+                           const boost::filesystem::path &filename);
+
+ private:
+  friend class unit_test_runnerTest;
+  /*!
+    @brief default constructor
+    @warning disabled
+   */
+  unit_test_runner() { throw std::domain_error("unit_test_runner: do not use default constructor"); }
+  /*!
+    @brief copy constructor
+    @param obj existing unit_test_runner object
+    @warning disabled
+   */
+  unit_test_runner(const unit_test_runner &obj) {
+    throw std::domain_error("unit_test_runner: do not use copy constructor");
+  }
+  /*!
+    @brief run a step of a test, keeping its most recent output
+    @param cmd command to run
+    @param log where to store the most recent output
+    @return exit status of the command
+   */
+  static int run_step(const std::string &cmd, std::string *log);
+  /*!
+    @brief copy a test workspace to where the test runs
+    @param source workspace to copy
+    @param target directory to create
+
+    as with python's shutil.copytree, links are followed, so linked
+    content is copied rather than shared with other tests
+   */
+  static void copy_workspace(const boost::filesystem::path &source, const boost::filesystem::path &target);
+  /*!
+    @brief remove a directory tree, including any write-protected content
+    @param target tree to remove
+   */
+  static void remove_tree(const boost::filesystem::path &target);
+  boost::filesystem::path _unit_dir;  //!< unit/ directory of the tests
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_UNIT_TEST_RUNNER_H_
@@ -0,0 +1,433 @@
+/*!
+  \file unit_test_runnerTest.cc
+  \brief implementation of unit_test_runner unit tests for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#include "snakemake_unit_tests/unit_test_runnerTest.h"
+
+void snakemake_unit_tests::unit_test_runnerTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutUTRXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("unit_test_runnerTest mkdtemp failed");
+  }
+  _previous_path = getenv("PATH") ? getenv("PATH") : "";
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::tearDown() {
+  setenv("PATH", _previous_path.c_str(), 1);
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::write_file(const boost::filesystem::path &filename,
+                                                            const std::string &contents) const {
+  boost::filesystem::create_directories(filename.parent_path());
+  std::ofstream output(filename.string().c_str());
+  if (!(output << contents)) throw std::runtime_error("cannot write \"" + filename.string() + "\"");
+  output.close();
+}
+
+std::string snakemake_unit_tests::unit_test_runnerTest::read_file(const boost::filesystem::path &filename) const {
+  std::ifstream input(filename.string().c_str());
+  std::ostringstream contents;
+  contents << input.rdbuf();
+  return contents.str();
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::create_rule_test(const boost::filesystem::path &unit_dir,
+                                                                  const std::string &rule_name,
+                                                                  const std::string &extra_settings) const {
+  write_file(unit_dir / ("test_" + rule_name + ".py"),
+             "#!/usr/bin/env python3\ntestdir='" + unit_dir.parent_path().string() + "'\nrulename='" + rule_name +
+                 "'\nsnakefile_relative_path='workflow/Snakefile'\nsnakemake_exec_path='.'\n"
+                 "extra_comparison_exclusions=['logs/', ]\n" +
+                 extra_settings + "import os\nthreads=99\n");
+  write_file(unit_dir / rule_name / "workspace" / "workflow" / "Snakefile", "rule " + rule_name + ":\n");
+  write_file(unit_dir / rule_name / "expected" / "result.txt", "made\n");
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::install_stand_ins() const {
+  /*
+    a stand-in snakemake records its arguments and writes output into --directory;
+    a stand-in python3 runs it for "-m snakemake", and otherwise records its arguments.
+    either fails if the workspace says so. the stand-in snakemake is not on PATH,
+    so only the interpreter can launch it.
+   */
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path bin_dir = tmp_parent / "bin";
+  boost::filesystem::path module = tmp_parent / "snakemake_module";
+  write_file(module,
+             "#!/usr/bin/env bash\necho \"$@\" >> " + (tmp_parent / "snakemake_calls").string() +
+                 "\nwhile [[ $# -gt 0 ]] ; do\n  if [[ \"$1\" == \"--directory\" ]] ; then dir=\"$2\" ; fi\n"
+                 "  shift\ndone\necho made > \"$dir/result.txt\"\n"
+                 "if [[ -f \"$dir/fail_snakemake\" ]] ; then echo \"rule failed\" >&2 ; exit 1 ; fi\n");
+  write_file(bin_dir / "python3",
+             "#!/usr/bin/env bash\nif [[ \"$1\" == \"-m\" && \"$2\" == \"snakemake\" ]] ; then shift 2 ; exec " +
+                 module.string() + " \"$@\" ; fi\necho \"$@\" >> " + (tmp_parent / "python_calls").string() +
+                 "\nwhile [[ $# -gt 0 ]] ; do\n  if [[ \"$1\" == \"--workdir\" ]] ; then dir=\"$2\" ; fi\n"
+                 "  shift\ndone\n"
+                 "if [[ -f \"$dir/fail_comparison\" ]] ; then echo \"result.txt differs\" ; exit 1 ; fi\n");
+  boost::filesystem::permissions(module, boost::filesystem::owner_all);
+  boost::filesystem::permissions(bin_dir / "python3", boost::filesystem::owner_all);
+  setenv("PATH", (bin_dir.string() + ":" + _previous_path).c_str(), 1);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_rule_test_constructor() {
+  rule_test a;
+  CPPUNIT_ASSERT(a.rule_name.empty());
+  CPPUNIT_ASSERT_EQUAL(1u, a.cores);
+  CPPUNIT_ASSERT_EQUAL(0u, a.memory_mb);
+  CPPUNIT_ASSERT_EQUAL(0u, a.runtime);
+  a.rule_name = "rule_a";
+  a.script = "unit/test_rule_a.py";
+  a.snakefile_relative_path = "workflow/Snakefile";
+  a.snakemake_exec_path = ".";
+  a.extra_comparison_exclusions.push_back("logs/");
+  a.cores = 4;
+  a.memory_mb = 2000;
+  a.runtime = 30;
+  rule_test b(a);
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_a"), b.rule_name);
+  CPPUNIT_ASSERT(b.script == a.script);
+  CPPUNIT_ASSERT(b.snakefile_relative_path == a.snakefile_relative_path);
+  CPPUNIT_ASSERT(b.snakemake_exec_path == a.snakemake_exec_path);
+  CPPUNIT_ASSERT(b.extra_comparison_exclusions == a.extra_comparison_exclusions);
+  CPPUNIT_ASSERT_EQUAL(4u, b.cores);
+  CPPUNIT_ASSERT_EQUAL(2000u, b.memory_mb);
+  CPPUNIT_ASSERT_EQUAL(30u, b.runtime);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_rule_test_result_constructor() {
+  rule_test_result a;
+  CPPUNIT_ASSERT(!a.passed);
+  CPPUNIT_ASSERT(a.message.empty() && a.log.empty());
+  CPPUNIT_ASSERT_EQUAL(0.0, a.seconds);
+  a.rule_name = "rule_a";
+  a.message = "snakemake exited with status 1";
+  a.log = "rule failed\n";
+  a.seconds = 2.5;
+  rule_test_result b(a);
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_a"), b.rule_name);
+  CPPUNIT_ASSERT(!b.passed);
+  CPPUNIT_ASSERT_EQUAL(a.message, b.message);
+  CPPUNIT_ASSERT_EQUAL(a.log, b.log);
+  CPPUNIT_ASSERT_EQUAL(2.5, b.seconds);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_resource_budget_constructor_no_cores() {
+  resource_budget budget(0, 1000);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_resource_budget_clamp() {
+  resource_budget limited(4, 1000), unlimited(4, 0);
+  CPPUNIT_ASSERT(limited.clamp(2, 500) == std::make_pair(2u, 500u));
+  CPPUNIT_ASSERT(limited.clamp(0, 0) == std::make_pair(1u, 0u));
+  CPPUNIT_ASSERT(limited.clamp(16, 4000) == std::make_pair(4u, 1000u));
+  CPPUNIT_ASSERT(unlimited.clamp(2, 4000) == std::make_pair(2u, 0u));
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_resource_budget_acquire() {
+  // a request waits until both its cores and its memory are free
+  resource_budget budget(2, 100);
+  budget.acquire(1, 80);
+  std::atomic<bool> acquired(false);
+  std::thread waiter([&budget, &acquired]() {
+    budget.acquire(1, 30);
+    acquired = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CPPUNIT_ASSERT(!acquired);
+  budget.release(1, 80);
+  waiter.join();
+  CPPUNIT_ASSERT(acquired);
+  CPPUNIT_ASSERT_EQUAL(1u, budget._free_cores);
+  CPPUNIT_ASSERT_EQUAL(70u, budget._free_memory_mb);
+  budget.release(1, 30);
+  CPPUNIT_ASSERT_EQUAL(2u, budget._free_cores);
+  CPPUNIT_ASSERT_EQUAL(100u, budget._free_memory_mb);
+  // without a memory limit, only cores are counted
+  resource_budget unlimited(1, 0);
+  unlimited.acquire(1, 5000);
+  CPPUNIT_ASSERT_EQUAL(0u, unlimited._free_cores);
+  unlimited.release(1, 5000);
+  CPPUNIT_ASSERT_EQUAL(1u, unlimited._free_cores);
+  CPPUNIT_ASSERT_EQUAL(0u, unlimited._free_memory_mb);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_resource_budget_acquire_oversized() {
+  resource_budget budget(2, 100);
+  budget.acquire(3, 0);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_constructor_missing_tests() {
+  unit_test_runner runner(boost::filesystem::path(std::string(_tmp_dir)) / "missing");
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_read_test_script() {
+  boost::filesystem::path unit_dir = boost::filesystem::path(std::string(_tmp_dir)) / "unit";
+  create_rule_test(unit_dir, "rule_a", "threads=4\nmem_mb=2000\nruntime=30\n");
+  rule_test test = unit_test_runner::read_test_script(unit_dir / "test_rule_a.py");
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_a"), test.rule_name);
+  CPPUNIT_ASSERT(test.script == unit_dir / "test_rule_a.py");
+  CPPUNIT_ASSERT_EQUAL(std::string("workflow/Snakefile"), test.snakefile_relative_path.string());
+  CPPUNIT_ASSERT_EQUAL(std::string("."), test.snakemake_exec_path.string());
+  CPPUNIT_ASSERT(test.extra_comparison_exclusions.size() == 1);
+  CPPUNIT_ASSERT_EQUAL(std::string("logs/"), test.extra_comparison_exclusions.at(0));
+  CPPUNIT_ASSERT_EQUAL(4u, test.cores);
+  CPPUNIT_ASSERT_EQUAL(2000u, test.memory_mb);
+  CPPUNIT_ASSERT_EQUAL(30u, test.runtime);
+  // resources are optional, and assignments in the test body are not settings
+  create_rule_test(unit_dir, "rule_b", "");
+  test = unit_test_runner::read_test_script(unit_dir / "test_rule_b.py");
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_b"), test.rule_name);
+  CPPUNIT_ASSERT_EQUAL(1u, test.cores);
+  CPPUNIT_ASSERT_EQUAL(0u, test.memory_mb);
+  CPPUNIT_ASSERT_EQUAL(0u, test.runtime);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_read_test_script_missing_setting() {
+  boost::filesystem::path script = boost::filesystem::path(std::string(_tmp_dir)) / "test_rule_a.py";
+  write_file(script, "#!/usr/bin/env python3\nrulename='rule_a'\nsnakemake_exec_path='.'\nimport os\n");
+  unit_test_runner::read_test_script(script);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_read_test_script_invalid_resource() {
+  boost::filesystem::path unit_dir = boost::filesystem::path(std::string(_tmp_dir)) / "unit";
+  create_rule_test(unit_dir, "rule_a", "threads=-1\n");
+  unit_test_runner::read_test_script(unit_dir / "test_rule_a.py");
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_discover() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  create_rule_test(tmp_parent / "unit", "rule_b", "");
+  create_rule_test(tmp_parent / "unit", "rule_a", "");
+  create_rule_test(tmp_parent / "unit", "all", "");
+  write_file(tmp_parent / "unit" / "common.py", "");
+  write_file(tmp_parent / "unit" / "test_notes.txt", "");
+  unit_test_runner runner(tmp_parent);
+  std::map<std::string, bool> include_rules, exclude_rules;
+  exclude_rules["all"] = true;
+  std::vector<rule_test> tests = runner.discover(include_rules, exclude_rules);
+  CPPUNIT_ASSERT(tests.size() == 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_a"), tests.at(0).rule_name);
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_b"), tests.at(1).rule_name);
+  include_rules["rule_b"] = true;
+  tests = runner.discover(include_rules, exclude_rules);
+  CPPUNIT_ASSERT(tests.size() == 1);
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_b"), tests.at(0).rule_name);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_run() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  create_rule_test(tmp_parent / "unit", "rule_a", "");
+  create_rule_test(tmp_parent / "unit", "rule_b", "threads=8\n");
+  write_file(tmp_parent / "unit" / "rule_a" / "workspace" / "fail_snakemake", "");
+  install_stand_ins();
+  unit_test_runner runner(tmp_parent);
+  std::vector<rule_test> tests = runner.discover(std::map<std::string, bool>(), std::map<std::string, bool>());
+  std::ostringstream out;
+  std::vector<rule_test_result> results = runner.run(tests, 2, 0, out);
+  CPPUNIT_ASSERT(results.size() == 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_a"), results.at(0).rule_name);
+  CPPUNIT_ASSERT(!results.at(0).passed);
+  CPPUNIT_ASSERT_EQUAL(std::string("rule_b"), results.at(1).rule_name);
+  CPPUNIT_ASSERT(results.at(1).passed);
+  // the larger test starts first, with its request reduced to the whole budget
+  std::istringstream calls(read_file(tmp_parent / "snakemake_calls"));
+  std::string call;
+  std::getline(calls, call);
+  CPPUNIT_ASSERT(call.find("--allowed-rules rule_b") != std::string::npos);
+  CPPUNIT_ASSERT(call.find("-j2 ") != std::string::npos);
+  std::getline(calls, call);
+  CPPUNIT_ASSERT(call.find("--allowed-rules rule_a") != std::string::npos);
+  CPPUNIT_ASSERT(call.find("-j1 ") != std::string::npos);
+  // TAP, with the failed step's output as diagnostics
+  std::string report = out.str();
+  CPPUNIT_ASSERT(!report.compare(0, 5, "1..2\n"));
+  CPPUNIT_ASSERT(report.find("ok 1 - rule_b (") != std::string::npos);
+  CPPUNIT_ASSERT(report.find("not ok 2 - rule_a (") != std::string::npos);
+  CPPUNIT_ASSERT(report.find("# snakemake exited with status 1\n#   rule failed\n") != std::string::npos);
+  CPPUNIT_ASSERT(report.find("# 1 of 2 rule tests passed in ") != std::string::npos);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_run_longest_first() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  create_rule_test(tmp_parent / "unit", "rule_a", "runtime=5\n");
+  create_rule_test(tmp_parent / "unit", "rule_b", "threads=8\n");
+  create_rule_test(tmp_parent / "unit", "rule_c", "runtime=60\n");
+  install_stand_ins();
+  unit_test_runner runner(tmp_parent);
+  std::vector<rule_test> tests = runner.discover(std::map<std::string, bool>(), std::map<std::string, bool>());
+  std::ostringstream out;
+  // with one core, every test is the same size, and they run one at a time, longest first
+  std::vector<rule_test_result> results = runner.run(tests, 1, 0, out);
+  CPPUNIT_ASSERT(results.size() == 3);
+  std::istringstream calls(read_file(tmp_parent / "snakemake_calls"));
+  std::string call;
+  std::getline(calls, call);
+  CPPUNIT_ASSERT(call.find("--allowed-rules rule_c") != std::string::npos);
+  std::getline(calls, call);
+  CPPUNIT_ASSERT(call.find("--allowed-rules rule_a") != std::string::npos);
+  std::getline(calls, call);
+  CPPUNIT_ASSERT(call.find("--allowed-rules rule_b") != std::string::npos);
+  CPPUNIT_ASSERT(call.find("-j1 ") != std::string::npos);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_run_one() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path unit_dir = boost::filesystem::absolute(tmp_parent / "unit");
+  create_rule_test(unit_dir, "rule_a", "");
+  // output left by a failed prior run is replaced
+  write_file(unit_dir / ".run" / "rule_a" / "output" / "stale.txt", "");
+  install_stand_ins();
+  unit_test_runner runner(tmp_parent);
+  rule_test test = unit_test_runner::read_test_script(unit_dir / "test_rule_a.py");
+  // arguments reach the commands unchanged, whatever shell syntax they contain
+  test.extra_comparison_exclusions.push_back("it's a $name");
+  rule_test_result result = runner.run_one(test, 3);
+  CPPUNIT_ASSERT(result.passed);
+  CPPUNIT_ASSERT(result.message.empty() && result.log.empty());
+  CPPUNIT_ASSERT(result.seconds >= 0.0);
+  std::string expected_snakemake =
+      "all -f -j3 --notemp --keep-target-files --use-conda --conda-frontend mamba --snakefile " +
+      (unit_dir / ".run/rule_a/output/workflow/Snakefile").string() + " --allowed-rules rule_a --directory " +
+      (unit_dir / ".run/rule_a/output/.").string() + "\n";
+  CPPUNIT_ASSERT_EQUAL(expected_snakemake, read_file(tmp_parent / "snakemake_calls"));
+  std::string expected_python = (unit_dir / "common.py").string() + " --config " + (unit_dir / "config.yaml").string() +
+                                " --workspace " + (unit_dir / "rule_a/workspace").string() + " --expected " +
+                                (unit_dir / "rule_a/expected").string() + " --manifest " +
+                                (unit_dir / "rule_a/expected.manifest").string() + " --workdir " +
+                                (unit_dir / ".run/rule_a/output").string() +
+                                " --extra-exclusion logs/ --extra-exclusion it's a $name\n";
+  CPPUNIT_ASSERT_EQUAL(expected_python, read_file(tmp_parent / "python_calls"));
+  // a passing test's output is removed, but the test itself is kept
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unit_dir / ".run" / "rule_a"));
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(unit_dir / "rule_a" / "workspace"));
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_run_one_failure() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  create_rule_test(tmp_parent / "unit", "rule_a", "");
+  write_file(tmp_parent / "unit" / "rule_a" / "workspace" / "fail_comparison", "");
+  install_stand_ins();
+  unit_test_runner runner(tmp_parent);
+  rule_test test = unit_test_runner::read_test_script(tmp_parent / "unit" / "test_rule_a.py");
+  rule_test_result result = runner.run_one(test, 1);
+  CPPUNIT_ASSERT(!result.passed);
+  CPPUNIT_ASSERT_EQUAL(std::string("output comparison exited with status 1"), result.message);
+  CPPUNIT_ASSERT_EQUAL(std::string("result.txt differs\n"), result.log);
+  // a failing test's output is kept for inspection
+  CPPUNIT_ASSERT_EQUAL(std::string("made\n"),
+                       read_file(tmp_parent / "unit" / ".run" / "rule_a" / "output" / "result.txt"));
+  // a test without a workspace fails without running anything
+  boost::filesystem::remove_all(tmp_parent / "unit" / "rule_a");
+  result = runner.run_one(test, 1);
+  CPPUNIT_ASSERT(!result.passed);
+  CPPUNIT_ASSERT(result.message.find("does not seem to have a unit test installed") != std::string::npos);
+  std::string calls = read_file(tmp_parent / "snakemake_calls");
+  CPPUNIT_ASSERT_EQUAL(1l, std::count(calls.begin(), calls.end(), '\n'));
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_run_one_archive() {
+  // with --output-format archive, the rule is expanded from the archive for the run
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path unit_dir = boost::filesystem::absolute(tmp_parent / "unit");
+  create_rule_test(tmp_parent / "staging", "rule_a", "");
+  boost::filesystem::create_directories(unit_dir);
+  boost::filesystem::rename(tmp_parent / "staging" / "test_rule_a.py", unit_dir / "test_rule_a.py");
+  // rule_b is archived without a workspace
+  create_rule_test(tmp_parent / "staging", "rule_b", "");
+  boost::filesystem::rename(tmp_parent / "staging" / "test_rule_b.py", unit_dir / "test_rule_b.py");
+  boost::filesystem::remove_all(tmp_parent / "staging" / "rule_b" / "workspace");
+  archive_writer writer(unit_dir / "unit_tests.zip");
+  writer.add_tree(tmp_parent / "staging" / "rule_a", "rule_a");
+  writer.add_tree(tmp_parent / "staging" / "rule_b", "rule_b");
+  writer.close();
+  install_stand_ins();
+  unit_test_runner runner(tmp_parent);
+  rule_test_result result = runner.run_one(unit_test_runner::read_test_script(unit_dir / "test_rule_a.py"), 1);
+  CPPUNIT_ASSERT(result.passed);
+  std::string expected_path = (unit_dir / ".run/rule_a/extracted/rule_a/expected").string();
+  CPPUNIT_ASSERT(read_file(tmp_parent / "python_calls").find(" --expected " + expected_path + " ") !=
+                 std::string::npos);
+  // nothing is left behind once the test passes
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unit_dir / "rule_a"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unit_dir / ".run" / "rule_a"));
+  // nor when the expanded rule cannot be run
+  result = runner.run_one(unit_test_runner::read_test_script(unit_dir / "test_rule_b.py"), 1);
+  CPPUNIT_ASSERT(!result.passed);
+  CPPUNIT_ASSERT(result.message.find("does not seem to have a unit test installed") != std::string::npos);
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unit_dir / ".run" / "rule_b"));
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_copy_workspace() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path source = tmp_parent / "source";
+  write_file(source / "a.txt", "a\n");
+  write_file(source / "sub" / "b.txt", "b\n");
+  write_file(tmp_parent / "shared" / "c.txt", "c\n");
+  boost::filesystem::create_symlink(tmp_parent / "shared" / "c.txt", source / "c.txt");
+  boost::filesystem::create_directory_symlink(tmp_parent / "shared", source / "linked");
+  boost::filesystem::create_symlink("missing.txt", source / "dangling.txt");
+  unit_test_runner::copy_workspace(source, tmp_parent / "target");
+  CPPUNIT_ASSERT_EQUAL(std::string("a\n"), read_file(tmp_parent / "target" / "a.txt"));
+  CPPUNIT_ASSERT_EQUAL(std::string("b\n"), read_file(tmp_parent / "target" / "sub" / "b.txt"));
+  // linked content is copied, so a test cannot modify what other tests share
+  CPPUNIT_ASSERT(!boost::filesystem::is_symlink(tmp_parent / "target" / "c.txt"));
+  CPPUNIT_ASSERT_EQUAL(std::string("c\n"), read_file(tmp_parent / "target" / "c.txt"));
+  CPPUNIT_ASSERT(!boost::filesystem::is_symlink(tmp_parent / "target" / "linked"));
+  CPPUNIT_ASSERT_EQUAL(std::string("c\n"), read_file(tmp_parent / "target" / "linked" / "c.txt"));
+  CPPUNIT_ASSERT(boost::filesystem::is_symlink(tmp_parent / "target" / "dangling.txt"));
+  CPPUNIT_ASSERT_EQUAL(std::string("missing.txt"),
+                       boost::filesystem::read_symlink(tmp_parent / "target" / "dangling.txt").string());
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_remove_tree() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path target = tmp_parent / "output";
+  write_file(target / "protected" / "result.txt", "made\n");
+  write_file(tmp_parent / "outside.txt", "kept\n");
+  boost::filesystem::create_symlink(tmp_parent / "outside.txt", target / "link.txt");
+  boost::filesystem::permissions(target / "protected" / "result.txt", boost::filesystem::owner_read);
+  boost::filesystem::permissions(target / "protected", boost::filesystem::owner_read | boost::filesystem::owner_exe);
+  unit_test_runner::remove_tree(target);
+  CPPUNIT_ASSERT(!boost::filesystem::exists(target));
+  // links are removed, not followed
+  CPPUNIT_ASSERT_EQUAL(std::string("kept\n"), read_file(tmp_parent / "outside.txt"));
+  // a missing tree is not an error
+  unit_test_runner::remove_tree(target);
+}
+
+void snakemake_unit_tests::unit_test_runnerTest::test_unit_test_runner_report_junit() {
+  boost::filesystem::path report = boost::filesystem::path(std::string(_tmp_dir)) / "report.xml";
+  std::vector<rule_test_result> results(2);
+  results.at(0).rule_name = "rule_a";
+  results.at(0).passed = true;
+  results.at(0).seconds = 1.5;
+  results.at(1).rule_name = "rule_b";
+  results.at(1).message = "snakemake exited with status 1";
+  results.at(1).log = "MissingOutputException: <output> & more\n";
+  results.at(1).seconds = 0.25;
+  unit_test_runner::report_junit(results, 2.0, report);
+  std::string expected =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<testsuites tests=\"2\" failures=\"1\" time=\"2.000\">\n"
+      "  <testsuite name=\"snakemake_unit_tests\" tests=\"2\" failures=\"1\" time=\"2.000\">\n"
+      "    <testcase classname=\"unit\" name=\"rule_a\" time=\"1.500\"/>\n"
+      "    <testcase classname=\"unit\" name=\"rule_b\" time=\"0.250\">\n"
+      "      <failure message=\"snakemake exited with status 1\">"
+      "MissingOutputException: &lt;output&gt; &amp; more\n</failure>\n"
+      "    </testcase>\n"
+      "  </testsuite>\n"
+      "</testsuites>\n";
+  CPPUNIT_ASSERT_EQUAL(expected, read_file(report));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::unit_test_runnerTest);
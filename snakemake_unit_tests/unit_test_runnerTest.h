@@ -0,0 +1,92 @@
+/*!
+  \file unit_test_runnerTest.h
+  \brief unit_test_runner test fixture for snakemake_unit_tests
+  \author Cameron Palmer
+  \copyright Released under the MIT License. Copyright 2023 Cameron Palmer.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_UNIT_TEST_RUNNERTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_UNIT_TEST_RUNNERTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/archive.h"
+#include "snakemake_unit_tests/unit_test_runner.h"
+
+namespace snakemake_unit_tests {
+class unit_test_runnerTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(unit_test_runnerTest);
+  CPPUNIT_TEST(test_rule_test_constructor);
+  CPPUNIT_TEST(test_rule_test_result_constructor);
+  CPPUNIT_TEST_EXCEPTION(test_resource_budget_constructor_no_cores, std::logic_error);
+  CPPUNIT_TEST(test_resource_budget_clamp);
+  CPPUNIT_TEST(test_resource_budget_acquire);
+  CPPUNIT_TEST_EXCEPTION(test_resource_budget_acquire_oversized, std::logic_error);
+  CPPUNIT_TEST_EXCEPTION(test_unit_test_runner_constructor_missing_tests, std::runtime_error);
+  CPPUNIT_TEST(test_unit_test_runner_read_test_script);
+  CPPUNIT_TEST_EXCEPTION(test_unit_test_runner_read_test_script_missing_setting, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_unit_test_runner_read_test_script_invalid_resource, std::runtime_error);
+  CPPUNIT_TEST(test_unit_test_runner_discover);
+  CPPUNIT_TEST(test_unit_test_runner_run);
+  CPPUNIT_TEST(test_unit_test_runner_run_longest_first);
+  CPPUNIT_TEST(test_unit_test_runner_run_one);
+  CPPUNIT_TEST(test_unit_test_runner_run_one_failure);
+  CPPUNIT_TEST(test_unit_test_runner_run_one_archive);
+  CPPUNIT_TEST(test_unit_test_runner_copy_workspace);
+  CPPUNIT_TEST(test_unit_test_runner_remove_tree);
+  CPPUNIT_TEST(test_unit_test_runner_report_junit);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_rule_test_constructor();
+  void test_rule_test_result_constructor();
+  void test_resource_budget_constructor_no_cores();
+  void test_resource_budget_clamp();
+  void test_resource_budget_acquire();
+  void test_resource_budget_acquire_oversized();
+  void test_unit_test_runner_constructor_missing_tests();
+  void test_unit_test_runner_read_test_script();
+  void test_unit_test_runner_read_test_script_missing_setting();
+  void test_unit_test_runner_read_test_script_invalid_resource();
+  void test_unit_test_runner_discover();
+  void test_unit_test_runner_run();
+  void test_unit_test_runner_run_longest_first();
+  void test_unit_test_runner_run_one();
+  void test_unit_test_runner_run_one_failure();
+  void test_unit_test_runner_run_one_archive();
+  void test_unit_test_runner_copy_workspace();
+  void test_unit_test_runner_remove_tree();
+  void test_unit_test_runner_report_junit();
+
+ private:
+  void write_file(const boost::filesystem::path &filename, const std::string &contents) const;
+  void create_rule_test(const boost::filesystem::path &unit_dir, const std::string &rule_name,
+                        const std::string &extra_settings) const;
+  void install_stand_ins() const;
+  std::string read_file(const boost::filesystem::path &filename) const;
+  char *_tmp_dir;
+  std::string _previous_path;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_UNIT_TEST_RUNNERTEST_H_
@@ -8,6 +8,165 @@
 
 #include "snakemake_unit_tests/utilities.h"
 
+// older glibc headers do not define the renameat2 flags
+#if defined(__linux__) && !defined(RENAME_EXCHANGE)
+#define RENAME_EXCHANGE (1 << 1)
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*!
+  @brief find the next byte that changes lexer state
+  @param start first byte to search
+  @param end one past the last byte to search
+  @return position of first backslash, quote, tick, or '#', or end if none
+ */
+static const char *find_lexer_mark(const char *start, const char *end) {
+#if defined(__SSE2__)
+  const __m128i backslash = _mm_set1_epi8('\\'), quote = _mm_set1_epi8('"'), tick = _mm_set1_epi8('\''),
+                comment = _mm_set1_epi8('#');
+  while (end - start >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(start));
+    __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, backslash), _mm_cmpeq_epi8(chunk, quote)),
+                                _mm_or_si128(_mm_cmpeq_epi8(chunk, tick), _mm_cmpeq_epi8(chunk, comment)));
+    int mask = _mm_movemask_epi8(hits);
+    if (mask) return start + __builtin_ctz(mask);
+    start += 16;
+  }
+#endif
+  for (; start < end; ++start) {
+    if (*start == '\\' || *start == '"' || *start == '\'' || *start == '#') return start;
+  }
+  return end;
+}
+
+/*!
+  @brief span version of resolve_string_delimiter
+  @param line start of physical line
+  @param line_size number of bytes in physical line
+  @param active_quote_type if string or literal is currently open,
+  the type of opening delimiter found
+  @param parse_index index of delimiter being processed in current line
+  @param string_open whether there is a currently active single
+  delimiter string
+  @param literal_open whether there is a currently active triple
+  delimiter literal
+
+  the caller guarantees that parse_index points to a quote or tick
+ */
+static void resolve_span_delimiter(const char *line, unsigned line_size,
+                                   snakemake_unit_tests::quote_type *active_quote_type, unsigned *parse_index,
+                                   bool *string_open, bool *literal_open) {
+  char mark = line[*parse_index];
+  // an odd number of preceding escapes means this is not a delimiter
+  unsigned n_escapes = 0;
+  for (unsigned i = *parse_index; i > 0 && line[i - 1] == '\\'; --i) {
+    ++n_escapes;
+  }
+  if (n_escapes % 2) {
+    ++*parse_index;
+    return;
+  }
+  snakemake_unit_tests::quote_type new_quote_type;
+  if (*parse_index + 2 < line_size && line[*parse_index + 1] == mark && line[*parse_index + 2] == mark) {
+    new_quote_type = mark == '"' ? snakemake_unit_tests::triple_quote : snakemake_unit_tests::triple_tick;
+  } else {
+    new_quote_type = mark == '"' ? snakemake_unit_tests::single_quote : snakemake_unit_tests::single_tick;
+  }
+  if (*string_open) {
+    if (*active_quote_type == new_quote_type ||
+        (*active_quote_type == snakemake_unit_tests::single_tick &&
+         new_quote_type == snakemake_unit_tests::triple_tick) ||
+        (*active_quote_type == snakemake_unit_tests::single_quote &&
+         new_quote_type == snakemake_unit_tests::triple_quote)) {
+      *string_open = false;
+    }
+    ++*parse_index;
+  } else if (*literal_open) {
+    if ((*active_quote_type == snakemake_unit_tests::triple_tick &&
+         new_quote_type == snakemake_unit_tests::triple_quote) ||
+        (*active_quote_type == snakemake_unit_tests::triple_quote &&
+         new_quote_type == snakemake_unit_tests::triple_tick)) {
+      *parse_index += 3;
+    } else if (new_quote_type == snakemake_unit_tests::single_quote ||
+               new_quote_type == snakemake_unit_tests::single_tick) {
+      ++*parse_index;
+    } else {
+      *literal_open = false;
+      *parse_index += 3;
+    }
+  } else {
+    if (new_quote_type == snakemake_unit_tests::triple_quote || new_quote_type == snakemake_unit_tests::triple_tick) {
+      *literal_open = true;
+      *parse_index += 3;
+    } else {
+      *string_open = true;
+      ++*parse_index;
+    }
+    *active_quote_type = new_quote_type;
+  }
+}
+
+/*!
+  @brief span version of append_resolved_line
+  @param resolved_line start of resolved content
+  @param resolved_size number of bytes of resolved content
+  @param aggregated_line previous content ending with explicit
+  line extensions; cleared after use
+  @param verbatim_start unused: owned results are always copied
+  @param arena unused: owned results need no separate storage
+  @param results currently existing set of resolved lines
+ */
+static void append_resolved_span(const char *resolved_line, unsigned resolved_size, std::string *aggregated_line,
+                                 const char *verbatim_start, snakemake_unit_tests::string_arena *arena,
+                                 std::vector<std::string> *results) {
+  // trailing whitespace on this line is stripped
+  while (resolved_size && (resolved_line[resolved_size - 1] == ' ' || resolved_line[resolved_size - 1] == '\t')) {
+    --resolved_size;
+  }
+  if (aggregated_line->empty()) {
+    results->push_back(std::string(resolved_line, resolved_size));
+  } else {
+    aggregated_line->append(resolved_line, resolved_size);
+    results->push_back(std::string());
+    results->back().swap(*aggregated_line);
+  }
+}
+
+/*!
+  @brief add a resolved span to a set of logical lines held as views
+  @param resolved_line start of resolved content; must outlive results
+  @param resolved_size number of bytes of resolved content
+  @param aggregated_line previous content ending with explicit
+  line extensions; cleared after use
+  @param verbatim_start if aggregated_line is an exact copy of the buffer,
+  where it starts in the buffer; otherwise null
+  @param arena storage for lines that do not exist verbatim in the buffer
+  @param results currently existing set of resolved lines
+
+  a line that was not extended, or that only continued a string across
+  physical lines, is a view into the buffer itself
+ */
+static void append_resolved_span(const char *resolved_line, unsigned resolved_size, std::string *aggregated_line,
+                                 const char *verbatim_start, snakemake_unit_tests::string_arena *arena,
+                                 std::vector<std::string_view> *results) {
+  while (resolved_size && (resolved_line[resolved_size - 1] == ' ' || resolved_line[resolved_size - 1] == '\t')) {
+    --resolved_size;
+  }
+  if (aggregated_line->empty()) {
+    results->push_back(std::string_view(resolved_line, resolved_size));
+  } else if (verbatim_start && verbatim_start + aggregated_line->size() == resolved_line) {
+    results->push_back(std::string_view(verbatim_start, aggregated_line->size() + resolved_size));
+    aggregated_line->clear();
+  } else {
+    aggregated_line->append(resolved_line, resolved_size);
+    results->push_back(arena->store(*aggregated_line));
+    aggregated_line->clear();
+  }
+}
+
 std::vector<std::string> snakemake_unit_tests::lexical_parse(const std::vector<std::string> &lines, bool verbose) {
   unsigned current_line = 0;
   bool string_open = false, literal_open = false;
@@ -94,6 +253,111 @@ std::vector<std::string> snakemake_unit_tests::lexical_parse(const std::vector<s
   return results;
 }
 
+/*!
+  @brief buffer-based lexical parse, for either owned or viewed results
+  @param buffer start of file contents
+  @param buffer_size number of bytes of file contents
+  @param verbose whether to emit verbose logging output to cout
+  @param arena storage for joined lines; only used for viewed results
+  @param results logical lines
+ */
+template <class line_type>
+static void lexical_parse_buffer(const char *buffer, uint64_t buffer_size, bool verbose,
+                                 snakemake_unit_tests::string_arena *arena, std::vector<line_type> *results) {
+  if (!buffer && buffer_size) throw std::runtime_error("null pointer provided to lexical_parse");
+  bool string_open = false, literal_open = false;
+  std::string aggregated_line = "";
+  // while aggregated_line is an exact copy of part of the buffer, where that part starts
+  const char *verbatim_start = NULL;
+  snakemake_unit_tests::quote_type active_quote_type = snakemake_unit_tests::none;
+  unsigned line_counter = 0;
+  const char *buffer_end = buffer + buffer_size;
+  const char *line = buffer;
+  while (line < buffer_end) {
+    // physical lines are newline-delimited; a final newline does not start another line
+    const char *line_end = static_cast<const char *>(memchr(line, '\n', buffer_end - line));
+    if (!line_end) line_end = buffer_end;
+    unsigned line_size = line_end - line;
+    if (verbose) {
+      ++line_counter;
+      std::cout << "lexical parse: logical line " << line_counter << ": \"" << std::string(line, line_size) << "\""
+                << std::endl;
+    }
+    unsigned parse_index = 0;
+    // outside of strings, starting indentation can be skipped
+    if (!string_open && !literal_open) {
+      while (parse_index < line_size && (line[parse_index] == ' ' || line[parse_index] == '\t')) {
+        ++parse_index;
+      }
+    }
+    bool line_consumed = false;
+    while (parse_index < line_size) {
+      parse_index = find_lexer_mark(line + parse_index, line_end) - line;
+      if (parse_index >= line_size) break;
+      if (line[parse_index] == '\\') {
+        if (parse_index == line_size - 1 && !string_open && !literal_open) {
+          // line extension: accumulate without the extension character
+          aggregated_line.append(line, line_size - 1);
+          verbatim_start = NULL;
+          line_consumed = true;
+          break;
+        }
+        // otherwise this escapes the next character, if any
+        parse_index += parse_index < line_size - 1 ? 2 : 1;
+      } else if (line[parse_index] == '#') {
+        if (!string_open && !literal_open) {
+          // a comment: terminate the line here
+          append_resolved_span(line, parse_index, &aggregated_line, verbatim_start, arena, results);
+          line_consumed = true;
+          break;
+        }
+        ++parse_index;
+      } else {
+        resolve_span_delimiter(line, line_size, &active_quote_type, &parse_index, &string_open, &literal_open);
+      }
+    }
+    if (!line_consumed) {
+      if (string_open || literal_open) {
+        // the line continues inside a string
+        if (aggregated_line.empty()) verbatim_start = line;
+        aggregated_line.append(line, line_size);
+        aggregated_line += '\n';
+      } else {
+        append_resolved_span(line, line_size, &aggregated_line, verbatim_start, arena, results);
+      }
+    }
+    line = line_end < buffer_end ? line_end + 1 : buffer_end;
+  }
+  if (!aggregated_line.empty()) {
+    std::string remainder = "";
+    remainder.swap(aggregated_line);
+    // the remainder is temporary, so viewed results need a stable copy, unless
+    // it is verbatim. its final newline is only in the buffer if the buffer has one
+    const char *stable = remainder.data();
+    if (verbatim_start && verbatim_start + remainder.size() <= buffer_end) {
+      stable = verbatim_start;
+    } else if (arena) {
+      stable = arena->store(remainder).data();
+    }
+    append_resolved_span(stable, remainder.size(), &aggregated_line, NULL, arena, results);
+  }
+}
+
+std::vector<std::string> snakemake_unit_tests::lexical_parse(const char *buffer, uint64_t buffer_size,
+                                                             bool verbose) {
+  std::vector<std::string> results;
+  lexical_parse_buffer(buffer, buffer_size, verbose, NULL, &results);
+  return results;
+}
+
+std::vector<std::string_view> snakemake_unit_tests::lexical_parse(const char *buffer, uint64_t buffer_size,
+                                                                  string_arena *arena, bool verbose) {
+  if (!arena) throw std::runtime_error("null arena provided to lexical_parse");
+  std::vector<std::string_view> results;
+  lexical_parse_buffer(buffer, buffer_size, verbose, arena, &results);
+  return results;
+}
+
 void snakemake_unit_tests::split_comma_list(const std::string &s, std::vector<std::string> *target) {
   if (!target) throw std::runtime_error("null target vector to split_comma_list");
   target->clear();
@@ -216,57 +480,287 @@ void snakemake_unit_tests::append_resolved_line(const std::string &resolved_line
 
 std::vector<std::string> snakemake_unit_tests::exec(const std::string &cmd, bool fail_on_error,
                                                     bool emit_error_logging) {
-  // https://stackoverflow.com/questions/478898/how-do-i-execute-a-command-and-get-the-output-of-the-command-within-c-using-po
-  std::array<char, 128> buffer;
   std::vector<std::string> result;
-  FILE *pipe = 0;
-  pipe = popen(cmd.c_str(), "r");
-  if (!pipe) {
-    throw std::runtime_error("popen() failed!");
+  exec_streaming(
+      cmd,
+      [&result](const std::string &line) {
+        result.push_back(line);
+        return true;
+      },
+      fail_on_error, emit_error_logging);
+  return result;
+}
+
+// bounds on what exec_streaming keeps of a command's output
+#define EXEC_MAX_LINE_LENGTH 65536
+#define EXEC_LOGGED_LINES 500
+
+// pipe2 creates a pipe already flagged close-on-exec; elsewhere, pipe creation is serialized against fork
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#define EXEC_HAVE_PIPE2
+#else
+static std::mutex exec_fork_mutex;
+#endif
+
+/*!
+  @brief hand a line to an exec_streaming consumer, keeping it for error logging
+  @param line complete line, or a piece of an overlong one
+  @param consumer exec_streaming consumer
+  @param recent most recent lines, for error logging
+  @return whether the consumer wants more output
+ */
+static bool deliver_exec_line(const std::string &line, const std::function<bool(const std::string &)> &consumer,
+                              std::deque<std::string> *recent) {
+  recent->push_back(line);
+  if (recent->size() > EXEC_LOGGED_LINES) recent->pop_front();
+  return consumer(line);
+}
+
+bool snakemake_unit_tests::exec_streaming(const std::string &cmd,
+                                          const std::function<bool(const std::string &)> &consumer,
+                                          bool fail_on_error, bool emit_error_logging, int *exit_status) {
+  int fds[2];
+  pid_t pid = 0;
+  {
+    // other subprocesses started meanwhile, from other threads, must not hold this pipe open
+#if defined(EXEC_HAVE_PIPE2)
+    if (pipe2(fds, O_CLOEXEC))
+      throw std::runtime_error("pipe2() failed for subprocess: " + std::string(strerror(errno)));
+#else
+    // without pipe2, no other thread may fork between creating the pipe and flagging it
+    std::lock_guard<std::mutex> lock(exec_fork_mutex);
+    if (pipe(fds)) throw std::runtime_error("pipe() failed for subprocess: " + std::string(strerror(errno)));
+    if (fcntl(fds[0], F_SETFD, FD_CLOEXEC) || fcntl(fds[1], F_SETFD, FD_CLOEXEC)) {
+      std::string error = strerror(errno);
+      close(fds[0]);
+      close(fds[1]);
+      throw std::runtime_error("fcntl() failed for subprocess pipe: " + error);
+    }
+#endif
+    pid = fork();
   }
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    throw std::runtime_error("fork() failed for subprocess: " + std::string(strerror(errno)));
+  }
+  if (!pid) {
+    // child: a process group of its own, so an early stop reaches everything the shell starts
+    setpgid(0, 0);
+    close(fds[0]);
+    if (fds[1] != STDOUT_FILENO) {
+      dup2(fds[1], STDOUT_FILENO);
+      close(fds[1]);
+    } else {
+      // the pipe is already stdout, so only its close-on-exec flag, which dup2 would clear, remains
+      fcntl(STDOUT_FILENO, F_SETFD, 0);
+    }
+    execl("/bin/sh", "sh", "-c", cmd.c_str(), static_cast<char *>(NULL));
+    _exit(127);
+  }
+  // also set from the parent, so the group exists before any early stop
+  setpgid(pid, pid);
+  close(fds[1]);
+  std::deque<std::string> recent;
+  std::string line;
+  std::array<char, 4096> buffer;
+  bool completed = true;
   try {
-    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-      result.push_back(std::string(buffer.data()));
-    }
-    int status = pclose(pipe);
-    pipe = 0;
-    if (status == -1) {
-      for (std::vector<std::string>::const_iterator iter = result.begin(); iter != result.end() && emit_error_logging;
-           ++iter) {
-        std::cerr << *iter;
-      }
-      throw std::runtime_error(
-          "exec pipe close failed. this exit status is conceptually possible, but most likely "
-          "due to system inconsistency or instability, or killing a remote job on a cluster "
-          "mid-run. you might consider rerunning with more RAM or processes free. otherwise, "
-          "please consider posting any log output from python3 "
-          "to the snakemake_unit_tests repository for feedback.");
-    }
-    if (!WIFEXITED(status) && fail_on_error) {
-      for (std::vector<std::string>::const_iterator iter = result.begin(); iter != result.end() && emit_error_logging;
-           ++iter) {
-        std::cerr << *iter;
-      }
-      throw std::runtime_error(
-          "python subprocess terminated abnormally. this is probably a system configuration "
-          "issue, but may be due to a logic failure in snakemake_unit_tests. please post "
-          "the preceding log output from python3 to an issue in the snakemake_unit_tests "
-          "repository.");
-    }
-    if (WEXITSTATUS(status) && fail_on_error) {
-      for (std::vector<std::string>::const_iterator iter = result.begin(); iter != result.end() && emit_error_logging;
-           ++iter) {
-        std::cerr << *iter;
+    ssize_t n = 0;
+    while (completed && ((n = read(fds[0], buffer.data(), buffer.size())) > 0 || (n < 0 && errno == EINTR))) {
+      for (ssize_t i = 0; i < n && completed; ++i) {
+        line.push_back(buffer[i]);
+        if (buffer[i] == '\n' || line.size() >= EXEC_MAX_LINE_LENGTH) {
+          completed = deliver_exec_line(line, consumer, &recent);
+          line.clear();
+        }
       }
-      throw std::runtime_error(
-          "python subprocess returned error exit status. this is most likely due to "
-          "a logic error or snakemake feature in your pipeline that is not currently "
-          "supported by snakemake_unit_tests. please post the preceding log output from "
-          "python3 to an issue in the snakemake_unit_tests repository.");
     }
-    return result;
+    if (completed && !line.empty()) completed = deliver_exec_line(line, consumer, &recent);
   } catch (...) {
-    if (pipe) pclose(pipe);
+    kill(-pid, SIGTERM);
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
     throw;
   }
+  if (!completed) kill(-pid, SIGTERM);
+  close(fds[0]);
+  int status = 0;
+  pid_t waited = 0;
+  while ((waited = waitpid(pid, &status, 0)) < 0 && errno == EINTR) {
+  }
+  if (exit_status) *exit_status = waited >= 0 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  if (!completed) return false;
+  if (waited < 0) {
+    for (std::deque<std::string>::const_iterator iter = recent.begin(); iter != recent.end() && emit_error_logging;
+         ++iter) {
+      std::cerr << *iter;
+    }
+    throw std::runtime_error(
+        "exec pipe close failed. this exit status is conceptually possible, but most likely "
+        "due to system inconsistency or instability, or killing a remote job on a cluster "
+        "mid-run. you might consider rerunning with more RAM or processes free. otherwise, "
+        "please consider posting any log output from python3 "
+        "to the snakemake_unit_tests repository for feedback.");
+  }
+  if (!WIFEXITED(status) && fail_on_error) {
+    for (std::deque<std::string>::const_iterator iter = recent.begin(); iter != recent.end() && emit_error_logging;
+         ++iter) {
+      std::cerr << *iter;
+    }
+    throw std::runtime_error(
+        "python subprocess terminated abnormally. this is probably a system configuration "
+        "issue, but may be due to a logic failure in snakemake_unit_tests. please post "
+        "the preceding log output from python3 to an issue in the snakemake_unit_tests "
+        "repository.");
+  }
+  if (WEXITSTATUS(status) && fail_on_error) {
+    for (std::deque<std::string>::const_iterator iter = recent.begin(); iter != recent.end() && emit_error_logging;
+         ++iter) {
+      std::cerr << *iter;
+    }
+    throw std::runtime_error(
+        "python subprocess returned error exit status. this is most likely due to "
+        "a logic error or snakemake feature in your pipeline that is not currently "
+        "supported by snakemake_unit_tests. please post the preceding log output from "
+        "python3 to an issue in the snakemake_unit_tests repository.");
+  }
+  return true;
+}
+
+std::string snakemake_unit_tests::json_escape(const std::string &s) {
+  std::ostringstream o;
+  o << '"';
+  for (std::string::const_iterator iter = s.begin(); iter != s.end(); ++iter) {
+    if (*iter == '"' || *iter == '\\') {
+      o << '\\' << *iter;
+    } else if (*iter == '\n') {
+      o << "\\n";
+    } else if (*iter == '\t') {
+      o << "\\t";
+    } else if (*iter == '\r') {
+      o << "\\r";
+    } else if (static_cast<unsigned char>(*iter) < 0x20) {
+      o << "\\u00" << "0123456789abcdef"[(*iter >> 4) & 0xf] << "0123456789abcdef"[*iter & 0xf];
+    } else {
+      o << *iter;
+    }
+  }
+  o << '"';
+  return o.str();
+}
+
+std::string snakemake_unit_tests::shell_quote(const std::string &s) {
+  std::string res = "'";
+  for (std::string::const_iterator iter = s.begin(); iter != s.end(); ++iter) {
+    // a single quote cannot appear within single quotes, so close, escape, and reopen
+    if (*iter == '\'') {
+      res += "'\\''";
+    } else {
+      res += *iter;
+    }
+  }
+  return res + "'";
+}
+
+void snakemake_unit_tests::exchange_paths(const boost::filesystem::path &staged_path,
+                                          const boost::filesystem::path &target_path) {
+  if (!boost::filesystem::exists(boost::filesystem::symlink_status(staged_path))) {
+    throw std::runtime_error("cannot swap in staged content \"" + staged_path.string() + "\": it does not exist");
+  }
+  // nothing to exchange with: a plain rename is already atomic
+  if (!boost::filesystem::exists(boost::filesystem::symlink_status(target_path))) {
+    boost::filesystem::rename(staged_path, target_path);
+    return;
+  }
+#if defined(__linux__) && defined(SYS_renameat2)
+  // invoked via syscall, as the glibc wrapper is only present in newer versions
+  if (!syscall(SYS_renameat2, AT_FDCWD, staged_path.c_str(), AT_FDCWD, target_path.c_str(), RENAME_EXCHANGE)) {
+    return;
+  }
+  if (errno != ENOSYS && errno != EINVAL) {
+    throw std::runtime_error("cannot exchange \"" + staged_path.string() + "\" and \"" + target_path.string() +
+                             "\": " + std::strerror(errno));
+  }
+#elif defined(__APPLE__) && defined(RENAME_SWAP)
+  if (!renamex_np(staged_path.c_str(), target_path.c_str(), RENAME_SWAP)) {
+    return;
+  }
+  if (errno != ENOTSUP && errno != EINVAL) {
+    throw std::runtime_error("cannot exchange \"" + staged_path.string() + "\" and \"" + target_path.string() +
+                             "\": " + std::strerror(errno));
+  }
+#endif
+  // fallback: move the old version aside, then move the new version in
+  boost::filesystem::path displaced_path = staged_path.string() + ".displaced";
+  boost::filesystem::rename(target_path, displaced_path);
+  boost::filesystem::rename(staged_path, target_path);
+  boost::filesystem::rename(displaced_path, staged_path);
+}
+
+void snakemake_unit_tests::write_slices(const boost::filesystem::path &filename,
+                                        const std::vector<std::string_view> &slices) {
+  int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) throw std::runtime_error("cannot create file \"" + filename.string() + "\": " + std::strerror(errno));
+  std::vector<struct iovec> pending;
+  pending.reserve(slices.size() < IOV_MAX ? slices.size() : IOV_MAX);
+  std::vector<std::string_view>::const_iterator next = slices.begin();
+  while (next != slices.end() || !pending.empty()) {
+    // refill the batch, skipping empty slices
+    for (; next != slices.end() && pending.size() < IOV_MAX; ++next) {
+      if (next->empty()) continue;
+      struct iovec entry;
+      entry.iov_base = const_cast<char *>(next->data());
+      entry.iov_len = next->size();
+      pending.push_back(entry);
+    }
+    if (pending.empty()) break;
+    ssize_t written = writev(fd, &pending[0], pending.size());
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      int error_code = errno;
+      close(fd);
+      throw std::runtime_error("cannot write to file \"" + filename.string() + "\": " + std::strerror(error_code));
+    }
+    // drop what was written; a partial write resumes mid-slice
+    std::vector<struct iovec>::iterator iter = pending.begin();
+    for (; iter != pending.end() && static_cast<size_t>(written) >= iter->iov_len; ++iter) {
+      written -= iter->iov_len;
+    }
+    if (iter != pending.end()) {
+      iter->iov_base = static_cast<char *>(iter->iov_base) + written;
+      iter->iov_len -= written;
+    }
+    pending.erase(pending.begin(), iter);
+  }
+  if (close(fd)) throw std::runtime_error("cannot close file \"" + filename.string() + "\": " + std::strerror(errno));
+}
+
+void snakemake_unit_tests::write_cache_string(std::ostream &out, std::string_view s) {
+  out << s.size() << '\n';
+  out.write(s.data(), s.size());
+  out << '\n';
+}
+
+uint64_t snakemake_unit_tests::read_cache_number(std::string_view *record, char terminator) {
+  if (!record) throw std::runtime_error("null pointer provided to read_cache_number");
+  uint64_t res = 0;
+  std::string_view::size_type i = 0;
+  for (; i < record->size() && (*record)[i] >= '0' && (*record)[i] <= '9'; ++i) {
+    res = res * 10 + ((*record)[i] - '0');
+  }
+  if (!i || i > 19 || i == record->size() || (*record)[i] != terminator)
+    throw std::runtime_error("malformed number in parse cache record");
+  record->remove_prefix(i + 1);
+  return res;
+}
+
+std::string_view snakemake_unit_tests::read_cache_string(std::string_view *record) {
+  if (!record) throw std::runtime_error("null pointer provided to read_cache_string");
+  uint64_t length = read_cache_number(record, '\n');
+  if (length >= record->size() || (*record)[length] != '\n')
+    throw std::runtime_error("truncated string in parse cache record");
+  std::string_view res = record->substr(0, length);
+  record->remove_prefix(length + 1);
+  return res;
 }
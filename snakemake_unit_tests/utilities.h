@@ -9,14 +9,32 @@
 #ifndef SNAKEMAKE_UNIT_TESTS_UTILITIES_H_
 #define SNAKEMAKE_UNIT_TESTS_UTILITIES_H_
 
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "boost/filesystem.hpp"
 #include "boost/regex.hpp"
+#include "snakemake_unit_tests/arena.h"
 
 namespace snakemake_unit_tests {
 /*!
@@ -58,6 +76,33 @@ void append_resolved_line(const std::string &resolved_line, std::string *aggrega
   was known to break in certain toxic corner cases
  */
 std::vector<std::string> lexical_parse(const std::vector<std::string> &lines, bool verbose = false);
+/*!
+  \brief prune superfluous content from an entire snakemake file in memory
+  @param buffer start of file contents
+  @param buffer_size number of bytes of file contents
+  @param verbose whether to emit verbose logging output to cout
+  @return logical lines, identical to those from the line-based lexical_parse
+  applied to the lines of the same file
+
+  physical lines are found with memchr, and within each line the scan jumps
+  between backslashes, quotes, and '#' (16 bytes at a time where SSE2 is
+  available). each logical line is assembled from spans of the buffer,
+  so untouched content is only copied once.
+ */
+std::vector<std::string> lexical_parse(const char *buffer, uint64_t buffer_size, bool verbose = false);
+/*!
+  \brief prune superfluous content from a snakemake file without copying it
+  @param buffer start of file contents, which must outlive the results
+  @param buffer_size number of bytes of file contents
+  @param arena storage for logical lines joined from several physical lines
+  @param verbose whether to emit verbose logging output to cout
+  @return logical lines, as views into buffer or arena
+
+  the same lines as the owning overload; a line that is not extended
+  across physical lines is a view into the buffer itself
+ */
+std::vector<std::string_view> lexical_parse(const char *buffer, uint64_t buffer_size, string_arena *arena,
+                                            bool verbose = false);
 /*!
   @brief take a comma/space delimited list of filenames and break them up into a
   vector
@@ -78,6 +123,94 @@ https://stackoverflow.com/questions/478898/how-do-i-execute-a-command-and-get-th
 */
 std::vector<std::string> exec(const std::string &cmd, bool fail_on_error, bool emit_error_logging = true);
 
+/*!
+  @brief execute a system command, handing its output to a consumer as it arrives
+  @param cmd system command to execute
+  @param consumer called with each line of standard output, including its newline;
+  returns false once it has seen enough, which terminates the command
+  @param fail_on_error whether python errors should trigger immediate exception
+  @param emit_error_logging whether, in the case that the executed command returns an error code,
+  the most recent output should be emitted to std::cerr
+  @param exit_status if provided, where to store the command's exit status; a command
+  that terminated abnormally reports -1
+  @return whether the command ran to completion, rather than being stopped by the consumer
+
+  the command runs in its own process group, so stopping it also stops anything it
+  started. only a fixed number of recent lines are kept for error logging, and lines
+  longer than a fixed limit are delivered in pieces, so memory use does not grow with
+  the amount of output. a stopped command's exit status is not checked.
+ */
+bool exec_streaming(const std::string &cmd, const std::function<bool(const std::string &)> &consumer,
+                    bool fail_on_error, bool emit_error_logging = true, int *exit_status = NULL);
+
+/*!
+  @brief escape a string for use as a json string value
+  @param s raw string
+  @return escaped string, including surrounding double quotes
+ */
+std::string json_escape(const std::string &s);
+
+/*!
+  @brief quote a string for use as a single word in a shell command
+  @param s raw string
+  @return s in single quotes, with embedded single quotes escaped
+
+  the result is safe to pass to popen or system regardless of
+  whitespace or shell metacharacters in s
+ */
+std::string shell_quote(const std::string &s);
+
+/*!
+  @brief atomically replace a file or directory tree with a staged version
+  @param staged_path complete new version of content; after the call,
+  holds the previous content of target_path, if any existed
+  @param target_path location that should hold the new content
+
+  on linux, this uses renameat2(RENAME_EXCHANGE), and on macOS, renamex_np(RENAME_SWAP),
+  so that any process reading target_path sees either the entire old version
+  or the entire new version. if the exchange is not supported by the kernel or
+  filesystem, this falls back to two renames, during which target_path
+  briefly does not exist but is never partially populated. both paths
+  must be on the same filesystem.
+ */
+void exchange_paths(const boost::filesystem::path &staged_path, const boost::filesystem::path &target_path);
+
+/*!
+  @brief create or truncate a file, and fill it with a sequence of slices
+  @param filename file to write
+  @param slices contents of the file, in order
+
+  slices are gathered by writev(2), IOV_MAX at a time, so assembling
+  a file from many pieces of existing buffers costs no copies
+ */
+void write_slices(const boost::filesystem::path &filename, const std::vector<std::string_view> &slices);
+
+/*!
+  @brief write a string to a parse cache record
+  @param out stream receiving the record
+  @param s string to write
+
+  strings are written as their length, a newline, the bytes, and a newline,
+  so arbitrary content needs no escaping and can be viewed in place when
+  the record is read
+ */
+void write_cache_string(std::ostream &out, std::string_view s);
+
+/*!
+  @brief consume a decimal number from a parse cache record
+  @param record remaining record contents; advanced past the number and terminator
+  @param terminator character required to follow the number
+  @return the number
+ */
+uint64_t read_cache_number(std::string_view *record, char terminator);
+
+/*!
+  @brief consume a string written by write_cache_string from a parse cache record
+  @param record remaining record contents; advanced past the string
+  @return view of the string within the record
+ */
+std::string_view read_cache_string(std::string_view *record);
+
 }  // namespace snakemake_unit_tests
 
 #endif  // SNAKEMAKE_UNIT_TESTS_UTILITIES_H_
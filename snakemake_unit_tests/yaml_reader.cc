@@ -7,83 +7,148 @@
 
 #include "snakemake_unit_tests/yaml_reader.h"
 
+/*!
+  @brief join a series of queries into an index key path
+  @param queries ordered set of keys to query in node
+  @return key path: each query followed by a null byte
+ */
+static std::string query_path(const std::vector<std::string> &queries) {
+  std::string path;
+  for (std::vector<std::string>::const_iterator iter = queries.begin(); iter != queries.end(); ++iter) {
+    path += *iter;
+    path.push_back('\0');
+  }
+  return path;
+}
+
 bool snakemake_unit_tests::yaml_reader::operator==(const yaml_reader &obj) const {
-  YAML::Emitter out1, out2;
-  out1 << _data;
-  out2 << obj._data;
-  return !std::string(out1.c_str()).compare(std::string(out2.c_str()));
+  return !_emitted.compare(obj._emitted);
 }
 
 void snakemake_unit_tests::yaml_reader::load_file(const std::string &filename) {
-  // just use the yaml-cpp method for this operation
-  _data = YAML::LoadFile(filename.c_str());
+  // just use the yaml-cpp method for this operation. assigning to a node
+  // would overwrite the document shared with any copies, so rebind instead
+  _data.reset(YAML::LoadFile(filename.c_str()));
+  index();
 }
 
-std::vector<std::string> snakemake_unit_tests::yaml_reader::get_sequence(
+void snakemake_unit_tests::yaml_reader::load_node(const YAML::Node &data) {
+  _data.reset(YAML::Clone(data));
+  index();
+}
+
+void snakemake_unit_tests::yaml_reader::index() {
+  boost::shared_ptr<node_index> built(new node_index);
+  if (_data.IsMap() || _data.IsSequence()) {
+    index_node("", _data, built.get());
+  }
+  _index = built;
+  YAML::Emitter out;
+  out << _data;
+  _emitted = out.c_str();
+}
+
+/*
+  key paths are as built by query_path. sequences are
+  queried by element index, as yaml-cpp converts them to maps keyed by
+  index when queried with a string. null nodes cannot be queried, and
+  are left out.
+ */
+void snakemake_unit_tests::yaml_reader::index_node(const std::string &path, const YAML::Node &node,
+                                                   node_index *target) {
+  if (!target) throw std::runtime_error("index_node: null pointer");
+  unsigned position = 0;
+  for (YAML::const_iterator iter = node.begin(); iter != node.end(); ++iter, ++position) {
+    // sequence elements are the iterator value itself
+    const YAML::Node key = node.IsMap() ? iter->first : YAML::Node();
+    const YAML::Node value = node.IsMap() ? iter->second : static_cast<const YAML::Node &>(*iter);
+    if (node.IsMap() && !key.IsScalar()) continue;
+    if (!value.IsScalar() && !value.IsSequence() && !value.IsMap()) continue;
+    std::string child_path = path + (node.IsMap() ? key.Scalar() : std::to_string(position));
+    child_path.push_back('\0');
+    indexed_node entry;
+    entry.node = value;
+    entry.convertible = true;
+    if (value.IsScalar()) {
+      entry.values.push_back(value.Scalar());
+    } else if (value.IsSequence()) {
+      for (YAML::const_iterator element = value.begin(); element != value.end() && entry.convertible; ++element) {
+        entry.convertible = element->IsScalar();
+        if (entry.convertible) entry.values.push_back(element->Scalar());
+      }
+    } else {
+      for (YAML::const_iterator element = value.begin(); element != value.end() && entry.convertible; ++element) {
+        entry.convertible = element->first.IsScalar() && element->second.IsScalar();
+        if (entry.convertible) entry.pairs.push_back(std::make_pair(element->first.Scalar(), element->second.Scalar()));
+      }
+    }
+    if (!entry.convertible) {
+      entry.values.clear();
+      entry.pairs.clear();
+    }
+    // a repeated key resolves to its first occurrence, along with everything below it
+    if (!target->insert(std::make_pair(child_path, entry)).second) continue;
+    if (!value.IsScalar()) {
+      index_node(child_path, value, target);
+    }
+  }
+}
+
+const snakemake_unit_tests::yaml_reader::indexed_node &snakemake_unit_tests::yaml_reader::lookup(
     const std::vector<std::string> &queries) const {
-  // copy the top node of the file, lest it get scoped out of existence
+  if (!queries.empty()) {
+    node_index::const_iterator finder = _index->find(query_path(queries));
+    if (finder != _index->end()) return finder->second;
+  }
+  // failures are rare, so walk a copy of the document to report them in detail
   YAML::Node current = YAML::Clone(_data), next;
-  std::vector<std::string> res;
-  // query the copy using the provided keys
   apply_queries(queries, &current, &next);
+  throw std::logic_error("lookup: query succeeded on document but is missing from its index");
+}
+
+std::vector<std::string> snakemake_unit_tests::yaml_reader::get_sequence(
+    const std::vector<std::string> &queries) const {
+  const indexed_node &entry = lookup(queries);
   // handle detected type
-  if (current.Type() == YAML::NodeType::Scalar) {
-    // cast a Scalar as a string and return it
-    res.resize(1);
-    res.at(0) = current.as<std::string>();
-  } else if (current.Type() == YAML::NodeType::Sequence) {
-    // cast the entire Sequence as strings and return it
-    res.reserve(current.size());
-    for (YAML::const_iterator iter = current.begin(); iter != current.end(); ++iter) {
-      res.push_back(iter->as<std::string>());
+  if (entry.node.IsScalar() || (entry.node.IsSequence() && entry.convertible)) {
+    return entry.values;
+  }
+  if (entry.node.IsSequence()) {
+    // report the element that cannot be cast as a string
+    for (YAML::const_iterator iter = entry.node.begin(); iter != entry.node.end(); ++iter) {
+      iter->as<std::string>();
     }
-  } else {
-    // the user asked for a Sequence tho
-    throw std::runtime_error("get_value: query chain does not end in compatible type");
   }
-  return res;
+  // the user asked for a Sequence tho
+  throw std::runtime_error("get_value: query chain does not end in compatible type");
 }
 
 YAML::Node snakemake_unit_tests::yaml_reader::get_node(const std::vector<std::string> &queries) const {
   // the user just wants a node, so give it to them
-  // note that they get the copy, so they can do what they want with it
-  YAML::Node current = YAML::Clone(_data), next;
-  apply_queries(queries, &current, &next);
-  return current;
+  // note that they get a copy, so they can do what they want with it
+  return YAML::Clone(lookup(queries).node);
 }
 
 std::vector<std::pair<std::string, std::string> > snakemake_unit_tests::yaml_reader::get_map(
     const std::vector<std::string> &queries) const {
-  // copy the top node of the file, lest it get scoped out of existence
-  YAML::Node current = YAML::Clone(_data), next;
-  std::vector<std::pair<std::string, std::string> > res;
-  // search for keys
-  apply_queries(queries, &current, &next);
-  if (current.Type() == YAML::NodeType::Map) {
-    // if you find a Map, cast keys and values as strings and return them
-    res.reserve(current.size());
-    for (YAML::const_iterator iter = current.begin(); iter != current.end(); ++iter) {
-      std::pair<std::string, std::string> val(iter->first.as<std::string>(), iter->second.as<std::string>());
-      res.push_back(val);
+  const indexed_node &entry = lookup(queries);
+  if (entry.node.IsMap() && entry.convertible) {
+    return entry.pairs;
+  }
+  if (entry.node.IsMap()) {
+    // report the entry that cannot be cast as strings
+    for (YAML::const_iterator iter = entry.node.begin(); iter != entry.node.end(); ++iter) {
+      iter->first.as<std::string>();
+      iter->second.as<std::string>();
     }
-  } else {
-    // the user asked for a Map tho
-    throw std::runtime_error("get_value: query chain does not end in compatible type");
   }
-  return res;
+  // the user asked for a Map tho
+  throw std::runtime_error("get_value: query chain does not end in compatible type");
 }
 
 bool snakemake_unit_tests::yaml_reader::query_valid(const std::vector<std::string> &queries) const {
-  // copy the top level node as always
-  YAML::Node current = YAML::Clone(_data), next;
-  try {
-    // make sure the process works
-    apply_queries(queries, &current, &next);
-  } catch (const std::runtime_error &e) {
-    // exit gracefully if not
-    return false;
-  }
-  return true;
+  // every query that succeeds is indexed
+  return !queries.empty() && _index->find(query_path(queries)) != _index->end();
 }
 
 void snakemake_unit_tests::yaml_reader::apply_queries(const std::vector<std::string> &queries, YAML::Node *current,
@@ -8,10 +8,13 @@
 #ifndef SNAKEMAKE_UNIT_TESTS_YAML_READER_H_
 #define SNAKEMAKE_UNIT_TESTS_YAML_READER_H_
 
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "boost/shared_ptr.hpp"
 #include "yaml-cpp/yaml.h"
 
 namespace snakemake_unit_tests {
@@ -19,13 +22,18 @@ namespace snakemake_unit_tests {
   @class yaml_reader
   @brief provide somewhat higher level interface
   with yaml-cpp nodes
+
+  a loaded document is never modified. every key path that a query can
+  reach is indexed once, on load, so queries are lookups rather than walks
+  over a fresh copy of the document, and copies of a reader share both
+  the document and the index.
  */
 class yaml_reader {
  public:
   /*!
     @brief default constructor
    */
-  yaml_reader() {}
+  yaml_reader() { index(); }
   /*!
     @brief constructor: load yaml file
     @param filename name of yaml file to (attempt to) load
@@ -35,7 +43,7 @@ class yaml_reader {
     @brief copy constructor
     @param obj existing yaml reader
    */
-  yaml_reader(const yaml_reader &obj) : _data(YAML::Clone(obj._data)) {}
+  yaml_reader(const yaml_reader &obj) : _data(obj._data), _index(obj._index), _emitted(obj._emitted) {}
   /*!
     @brief destructor
    */
@@ -45,6 +53,11 @@ class yaml_reader {
     @param filename name of yaml file to (attempt to) load
    */
   void load_file(const std::string &filename);
+  /*!
+    @brief load yaml from an existing node
+    @param data top level node; the reader takes a copy
+   */
+  void load_node(const YAML::Node &data);
   /*!
     @brief get a single value corresponding to a single query
     @param query key to query in yaml node
@@ -134,10 +147,47 @@ class yaml_reader {
     @return whether the two objects contain same value contents
    */
   bool operator==(const yaml_reader &obj) const;
+  /*!
+    @brief get the loaded document
+    @return top level node of the document
+    @warning read only: copies share the document. use get_node for a copy that can be changed
+   */
+  const YAML::Node &get_document() const { return _data; }
 
  private:
   friend class yaml_readerTest;
   friend class cargsTest;
+  /*!
+    @brief a node reachable by some key path, with its contents as strings
+   */
+  struct indexed_node {
+    YAML::Node node;                                          //!< the node itself
+    bool convertible;                                         //!< whether every element is a scalar
+    std::vector<std::string> values;                          //!< scalar value, or sequence elements
+    std::vector<std::pair<std::string, std::string> > pairs;  //!< map entries
+  };
+  /*!
+    @brief map from joined key path to the node it reaches
+   */
+  typedef std::unordered_map<std::string, indexed_node> node_index;
+  /*!
+    @brief build the index and emitted form of the loaded document
+   */
+  void index();
+  /*!
+    @brief add everything below a node to an index
+    @param path joined key path of the node
+    @param node map or sequence reached by path
+    @param target index under construction
+   */
+  static void index_node(const std::string &path, const YAML::Node &node, node_index *target);
+  /*!
+    @brief find the node reached by a series of queries
+    @param queries ordered set of keys to query in node
+    @return indexed node
+    @warning throws the error the equivalent apply_queries walk reports, if the queries fail
+   */
+  const indexed_node &lookup(const std::vector<std::string> &queries) const;
   /*!
     @brief apply an arbitrary query to a node
     @param queries keys to search in node
@@ -149,6 +199,8 @@ class yaml_reader {
     @brief top level node representing config file, usually
    */
   YAML::Node _data;
+  boost::shared_ptr<const node_index> _index;  //!< every node reachable by a query
+  std::string _emitted;                        //!< emitted form of _data, for comparison
 };
 
 }  // namespace snakemake_unit_tests
@@ -65,15 +65,24 @@ void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_copy_constructor()
 }
 void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_string_constructor() {
   yaml_reader yr1(_yaml_file_1.string()), yr2;
-  yr2._data = YAML::LoadFile(_yaml_file_1.string().c_str());
+  yr2.load_node(YAML::LoadFile(_yaml_file_1.string().c_str()));
   CPPUNIT_ASSERT(yr1 == yr2);
 }
 void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_load_file() {
   yaml_reader yr1, yr2;
   yr1.load_file(_yaml_file_1.string());
-  yr2._data = YAML::LoadFile(_yaml_file_1.string().c_str());
+  yr2.load_node(YAML::LoadFile(_yaml_file_1.string().c_str()));
   CPPUNIT_ASSERT(yr1 == yr2);
 }
+void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_load_node() {
+  // the reader keeps its own copy, so later changes to the node do not reach it
+  YAML::Node n = YAML::Load("tag1: value1");
+  yaml_reader yr;
+  yr.load_node(n);
+  n["tag1"] = "value2";
+  CPPUNIT_ASSERT_EQUAL(std::string("value1"), yr.get_entry("tag1"));
+  CPPUNIT_ASSERT(!yr.query_valid("tag2"));
+}
 void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_load_file_bad_file() {
   yaml_reader yr1;
   yr1.load_file((_yaml_file_1 / "fakename").string());
@@ -160,8 +169,8 @@ void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_get_node_query() {
   // since the nodes are copied, direct identity isn't on offer
   // so hack the equality operator
   yaml_reader yr1, yr2;
-  yr1._data = result;
-  yr2._data = n;
+  yr1.load_node(result);
+  yr2.load_node(n);
   CPPUNIT_ASSERT(yr1 == yr2);
 }
 void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_get_node_queries() {
@@ -174,8 +183,8 @@ void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_get_node_queries()
   // since the nodes are copied, direct identity isn't on offer
   // so hack the equality operator
   yaml_reader yr1, yr2;
-  yr1._data = result;
-  yr2._data = n;
+  yr1.load_node(result);
+  yr2.load_node(n);
   CPPUNIT_ASSERT(yr1 == yr2);
 }
 void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_query_valid_query() {
@@ -199,6 +208,34 @@ void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_equality() {
   CPPUNIT_ASSERT(yr1 == yr3);
   CPPUNIT_ASSERT(!(yr1 == yr2));
 }
+void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_index() {
+  /*
+    queries answered from the index agree with walking the document: sequence
+    elements by position, the first of repeated keys, and no null entries
+   */
+  yaml_reader yr;
+  yr.load_node(YAML::Load("seq:\n  - a\n  - inner: b\nrep:\n  x: 1\nrep:\n  y: 2\nnothing: ~\nmixed: [c, [d]]\n"));
+  std::vector<std::string> queries;
+  queries.push_back("seq");
+  queries.push_back("1");
+  queries.push_back("inner");
+  CPPUNIT_ASSERT(yr.query_valid(queries));
+  CPPUNIT_ASSERT_EQUAL(std::string("b"), yr.get_entry(queries));
+  queries.clear();
+  queries.push_back("rep");
+  queries.push_back("x");
+  CPPUNIT_ASSERT_EQUAL(std::string("1"), yr.get_entry(queries));
+  queries.back() = "y";
+  CPPUNIT_ASSERT(!yr.query_valid(queries));
+  CPPUNIT_ASSERT(!yr.query_valid("nothing"));
+  CPPUNIT_ASSERT(!yr.query_valid(std::vector<std::string>()));
+  CPPUNIT_ASSERT_THROW(yr.get_sequence("mixed"), std::runtime_error);
+  CPPUNIT_ASSERT_THROW(yr.get_entry("nothing"), std::runtime_error);
+  // copies share the document and index
+  yaml_reader copy(yr);
+  CPPUNIT_ASSERT(copy == yr);
+  CPPUNIT_ASSERT_EQUAL(std::string("a"), copy.get_entry(std::vector<std::string>({"seq", "0"})));
+}
 void snakemake_unit_tests::yaml_readerTest::test_yaml_reader_apply_queries() {
   yaml_reader yr(_yaml_file_1.string());
   YAML::Node n = YAML::Clone(yr._data), next;
@@ -34,6 +34,7 @@ class yaml_readerTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_yaml_reader_string_constructor);
   CPPUNIT_TEST(test_yaml_reader_copy_constructor);
   CPPUNIT_TEST(test_yaml_reader_load_file);
+  CPPUNIT_TEST(test_yaml_reader_load_node);
   CPPUNIT_TEST_EXCEPTION(test_yaml_reader_load_file_bad_file, std::runtime_error);
   CPPUNIT_TEST(test_yaml_reader_get_entry_query);
   CPPUNIT_TEST(test_yaml_reader_get_entry_queries);
@@ -49,6 +50,7 @@ class yaml_readerTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_yaml_reader_query_valid_query);
   CPPUNIT_TEST(test_yaml_reader_query_valid_queries);
   CPPUNIT_TEST(test_yaml_reader_equality);
+  CPPUNIT_TEST(test_yaml_reader_index);
   CPPUNIT_TEST(test_yaml_reader_apply_queries);
   CPPUNIT_TEST_EXCEPTION(test_yaml_reader_apply_queries_null_pointer, std::runtime_error);
   CPPUNIT_TEST_EXCEPTION(test_yaml_reader_apply_queries_no_queries, std::runtime_error);
@@ -66,6 +68,7 @@ class yaml_readerTest : public CppUnit::TestFixture {
   void test_yaml_reader_string_constructor();
   void test_yaml_reader_copy_constructor();
   void test_yaml_reader_load_file();
+  void test_yaml_reader_load_node();
   void test_yaml_reader_load_file_bad_file();
   void test_yaml_reader_get_entry_query();
   void test_yaml_reader_get_entry_queries();
@@ -81,6 +84,7 @@ class yaml_readerTest : public CppUnit::TestFixture {
   void test_yaml_reader_query_valid_query();
   void test_yaml_reader_query_valid_queries();
   void test_yaml_reader_equality();
+  void test_yaml_reader_index();
   void test_yaml_reader_apply_queries();
   void test_yaml_reader_apply_queries_null_pointer();
   void test_yaml_reader_apply_queries_no_queries();
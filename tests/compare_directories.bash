@@ -11,7 +11,8 @@ TESTDESCRIPTION="$3"
 
 ## compare expected to observed output, ignoring pytest infrastructure
 ## new: ignore config.yaml recordkeeping file's contents
-for file in $(find "$EXPECTEDDIR" -type f \( -name "*" ! -name "*.py"  ! -name "config.yaml" ! -name "pytest_runner.bash" \) -print);
+## new: ignore expected.manifest, which only summarizes the expected/ trees compared here
+for file in $(find "$EXPECTEDDIR" -type f \( -name "*" ! -name "*.py"  ! -name "config.yaml" ! -name "pytest_runner.bash" ! -name "expected.manifest" \) -print);
 do
     actual=$(echo "$file" | sed 's/\/expected\//\/output\//')
     if [[ ! -f "$actual" ]] ; then
@@ -29,7 +30,8 @@ done
 ## compare observed to expected output, ignoring pytest infrastructure
 ##   flag files present in one absent in other
 ## new: note that we don't ignore config.yaml here: it should be consistent
-for file in $(find "$OUTPUTDIR" -type f \( -name "*" ! -name "*.py" ! -name "pytest_runner.bash" \) -print);
+## new: ignore the parse cache, whose entries are named by content hash
+for file in $(find "$OUTPUTDIR" -type f \( -name "*" ! -name "*.py" ! -name "pytest_runner.bash" ! -name "expected.manifest" ! -path "*/.parse_cache/*" \) -print);
 do
     expected=$(echo "$file" | sed 's/\/output\//\/expected\//')
     if [[ ! -f "$expected" ]] ; then